@@ -68,6 +68,8 @@ public:
 		/// Throws a FileNotFoundException if the file
 		/// cannot be found, or an OpenFileException if
 		/// the file cannot be opened.
+
+	using Poco::Net::HTTPServerResponse::sendFile;
 		
 	void sendBuffer(const void* pBuffer, std::size_t length);
 		/// Sends the response header to the client, followed
@@ -40,18 +40,40 @@ public:
 	Base32DecoderBuf(std::istream& istr);
 	~Base32DecoderBuf();
 	
+protected:
+	std::streamsize xsgetn(char* p, std::streamsize count);
+		/// Decodes all complete groups of five bytes with
+		/// Base32Decoder::decode(), instead of one byte at a time.
+
 private:
+	enum
+	{
+		BUFFER_GROUPS = 512
+	};
+
 	int readFromDevice();
 	int readOne();
+		/// Returns the next character, or eof. Once the end of the
+		/// data has been reached, the streambuf is not read anymore,
+		/// as it may not keep returning eof (e.g., a part of a
+		/// MultipartReader).
+
+	std::streamsize readGroups(char* p, std::streamsize groups);
+		/// Reads and decodes at most the given number of groups,
+		/// which must not exceed BUFFER_GROUPS. Returns the number
+		/// of bytes decoded.
+
+	static const unsigned char* inEncoding();
 
 	unsigned char   _group[8];
 	int             _groupLength;
 	int             _groupIndex;
 	std::streambuf& _buf;
-	
-	static unsigned char IN_ENCODING[256];
-	static bool          IN_ENCODING_INIT;
-	
+	const unsigned char* _pInEncoding;
+	bool            _eof;
+
+	friend class Base32Decoder;
+
 private:
 	Base32DecoderBuf(const Base32DecoderBuf&);
 	Base32DecoderBuf& operator = (const Base32DecoderBuf&);
@@ -94,6 +116,22 @@ public:
 	Base32Decoder(std::istream& istr);
 	~Base32Decoder();
 
+	static std::size_t decode(const char* data, std::size_t length, void* buffer);
+		/// Decodes length Base32 characters from data and writes the
+		/// decoded bytes to buffer, which must have room for at least
+		/// decodedLength(length) bytes. Returns the number of bytes
+		/// written.
+		///
+		/// Throws a DataFormatException if the data contains an
+		/// invalid character or a group of invalid length.
+
+	static std::string decode(const std::string& data);
+		/// Returns the decoded data.
+
+	static std::size_t decodedLength(std::size_t length);
+		/// Returns the maximum number of bytes decode() writes
+		/// for length characters.
+
 private:
 	Base32Decoder(const Base32Decoder&);
 	Base32Decoder& operator = (const Base32Decoder&);
@@ -43,7 +43,17 @@ public:
 	int close();
 		/// Closes the stream buffer.
 
+protected:
+	std::streamsize xsputn(const char* s, std::streamsize count);
+		/// Encodes all complete groups of five bytes with
+		/// Base32Encoder::encode(), instead of one byte at a time.
+
 private:
+	enum
+	{
+		BUFFER_GROUPS = 512
+	};
+
 	int writeToDevice(char c);
 
 	unsigned char   _group[5];
@@ -54,6 +64,7 @@ private:
 	static const unsigned char OUT_ENCODING[32];
 	
 	friend class Base32DecoderBuf;
+	friend class Base32Encoder;
 
 	Base32EncoderBuf(const Base32EncoderBuf&);
 	Base32EncoderBuf& operator = (const Base32EncoderBuf&);
@@ -100,6 +111,21 @@ public:
 	Base32Encoder(std::ostream& ostr, bool padding = true);
 	~Base32Encoder();
 
+	static std::size_t encode(const void* data, std::size_t length, char* buffer, bool padding = true);
+		/// Base32-encodes length bytes from data and writes the encoded
+		/// characters to buffer, which must have room for at least
+		/// encodedLength(length, padding) characters. Returns the
+		/// number of characters written.
+		///
+		/// The result is not zero-terminated.
+
+	static std::string encode(const std::string& data, bool padding = true);
+		/// Returns the Base32 encoding of data.
+
+	static std::size_t encodedLength(std::size_t length, bool padding = true);
+		/// Returns the number of characters encode() writes
+		/// for length bytes of data.
+
 private:
 	Base32Encoder(const Base32Encoder&);
 	Base32Encoder& operator = (const Base32Encoder&);
@@ -40,9 +40,30 @@ public:
 	Base64DecoderBuf(std::istream& istr, int options = 0);
 	~Base64DecoderBuf();
 
+protected:
+	std::streamsize xsgetn(char* p, std::streamsize count);
+		/// Decodes all complete groups of three bytes with
+		/// Base64Decoder::decode(), instead of one byte at a time.
+
 private:
+	enum
+	{
+		BUFFER_GROUPS = 1024
+	};
+
 	int readFromDevice();
 	int readOne();
+		/// Returns the next character, or eof. Once the end of the
+		/// data has been reached, the streambuf is not read anymore,
+		/// as it may not keep returning eof (e.g., a part of a
+		/// MultipartReader).
+
+	std::streamsize readGroups(char* p, std::streamsize groups);
+		/// Reads and decodes at most the given number of groups,
+		/// which must not exceed BUFFER_GROUPS. Returns the number
+		/// of bytes decoded.
+
+	static const unsigned char* inEncoding(int options);
 
 	int             _options;
 	unsigned char   _group[3];
@@ -50,11 +71,9 @@ private:
 	int             _groupIndex;
 	std::streambuf& _buf;
 	const unsigned char* _pInEncoding;
+	bool            _eof;
 
-	static unsigned char IN_ENCODING[256];
-	static bool          IN_ENCODING_INIT;
-	static unsigned char IN_ENCODING_URL[256];
-	static bool          IN_ENCODING_URL_INIT;
+	friend class Base64Decoder;
 
 private:
 	Base64DecoderBuf(const Base64DecoderBuf&);
@@ -98,6 +117,29 @@ public:
 	Base64Decoder(std::istream& istr, int options = 0);
 	~Base64Decoder();
 
+	static std::size_t decode(const char* data, std::size_t length, void* buffer, int options = 0);
+		/// Decodes length Base64 characters from data and writes the
+		/// decoded bytes to buffer, which must have room for at least
+		/// decodedLength(length) bytes. Returns the number of bytes
+		/// written.
+		///
+		/// The options and the accepted input are the same as for the
+		/// stream. In particular, whitespace is ignored unless
+		/// BASE64_URL_ENCODING is specified.
+		///
+		/// Throws a DataFormatException if the data contains an
+		/// invalid character or ends with an incomplete group.
+		///
+		/// On x86 CPUs supporting SSSE3, blocks of sixteen characters
+		/// are decoded with SIMD instructions.
+
+	static std::string decode(const std::string& data, int options = 0);
+		/// Returns the decoded data.
+
+	static std::size_t decodedLength(std::size_t length);
+		/// Returns the maximum number of bytes decode() writes
+		/// for length characters.
+
 private:
 	Base64Decoder(const Base64Decoder&);
 	Base64Decoder& operator = (const Base64Decoder&);
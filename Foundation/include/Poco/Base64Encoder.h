@@ -67,7 +67,17 @@ public:
 	int getLineLength() const;
 		/// Returns the currently set line length.
 
+protected:
+	std::streamsize xsputn(const char* s, std::streamsize count);
+		/// Encodes all complete groups of three bytes with
+		/// Base64Encoder::encode(), instead of one byte at a time.
+
 private:
+	enum
+	{
+		BUFFER_GROUPS = 1024
+	};
+
 	int writeToDevice(char c);
 
 	int             _options;
@@ -82,6 +92,7 @@ private:
 	static const unsigned char OUT_ENCODING_URL[64];
 
 	friend class Base64DecoderBuf;
+	friend class Base64Encoder;
 
 	Base64EncoderBuf(const Base64EncoderBuf&);
 	Base64EncoderBuf& operator = (const Base64EncoderBuf&);
@@ -128,6 +139,25 @@ public:
 	Base64Encoder(std::ostream& ostr, int options = 0);
 	~Base64Encoder();
 
+	static std::size_t encode(const void* data, std::size_t length, char* buffer, int options = 0);
+		/// Base64-encodes length bytes from data and writes the encoded
+		/// characters to buffer, which must have room for at least
+		/// encodedLength(length, options) characters. Returns the
+		/// number of characters written.
+		///
+		/// The options are the same as for the stream. No line breaks
+		/// are written, and the result is not zero-terminated.
+		///
+		/// On x86 CPUs supporting SSSE3, blocks of twelve bytes are
+		/// encoded with SIMD instructions.
+
+	static std::string encode(const std::string& data, int options = 0);
+		/// Returns the Base64 encoding of data, without line breaks.
+
+	static std::size_t encodedLength(std::size_t length, int options = 0);
+		/// Returns the number of characters encode() writes
+		/// for length bytes of data.
+
 private:
 	Base64Encoder(const Base64Encoder&);
 	Base64Encoder& operator = (const Base64Encoder&);
@@ -47,6 +47,8 @@ class Foundation_API FileIOS: public virtual std::ios
 	/// On Windows platforms, UTF-8 encoded Unicode paths are correctly handled.
 {
 public:
+	using NativeHandle = FileStreamBuf::NativeHandle;
+
 	FileIOS(std::ios::openmode defaultMode);
 		/// Creates the basic stream.
 		
@@ -70,6 +72,10 @@ public:
 	FileStreamBuf* rdbuf();
 		/// Returns a pointer to the underlying streambuf.
 
+	NativeHandle nativeHandle() const;
+		/// Returns the native file handle (file descriptor
+		/// or HANDLE) of the underlying file.
+
 protected:
 	FileStreamBuf _buf;
 	std::ios::openmode _defaultMode;
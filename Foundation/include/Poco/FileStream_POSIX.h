@@ -31,6 +31,8 @@ class Foundation_API FileStreamBuf: public BufferedBidirectionalStreamBuf
 	/// This stream buffer handles Fileio
 {
 public:
+	using NativeHandle = int;
+
 	FileStreamBuf();
 		/// Creates a FileStreamBuf.
 		
@@ -50,6 +52,10 @@ public:
 	std::streampos seekpos(std::streampos pos, std::ios::openmode mode = std::ios::in | std::ios::out);
 		/// Change to specified position, according to mode.
 
+	NativeHandle nativeHandle() const;
+		/// Returns the native file handle, or an invalid
+		/// handle if the file is not open.
+
 protected:
 	enum
 	{
@@ -21,6 +21,7 @@
 #include "Poco/Foundation.h"
 #include "Poco/Any.h"
 #include <vector>
+#include <cstring>
 #include <type_traits>
 
 
@@ -101,6 +102,11 @@ std::string Foundation_API format(const std::string& fmt, const Any& value);
 	///
 	/// If there are more values than format specifiers, the superfluous values are ignored.
 	///
+	/// The variadic variants of format() format integers, characters and strings
+	/// directly into the result, without creating an Any for every argument.
+	/// If the same format string is used repeatedly, a CompiledFormat can be used
+	/// instead, which parses the format string only once.
+	///
 	/// Usage Examples:
 	///     std::string s1 = format("The answer to life, the universe, and everything is %d", 42);
 	///     std::string s2 = format("second: %[1]d, first: %[0]d", 1, 2);
@@ -114,17 +120,143 @@ void Foundation_API format(std::string& result, const std::string& fmt, const st
 	/// all other variants of format().
 
 
+namespace Impl {
+
+
+enum FormatArgType
+	/// The types of format() arguments that are
+	/// formatted without an intermediate Any.
+{
+	FORMAT_ARG_OTHER,
+	FORMAT_ARG_BOOL,
+	FORMAT_ARG_CHAR,
+	FORMAT_ARG_SIGNED_CHAR,
+	FORMAT_ARG_UNSIGNED_CHAR,
+	FORMAT_ARG_SHORT,
+	FORMAT_ARG_UNSIGNED_SHORT,
+	FORMAT_ARG_INT,
+	FORMAT_ARG_UNSIGNED_INT,
+	FORMAT_ARG_LONG,
+	FORMAT_ARG_UNSIGNED_LONG,
+	FORMAT_ARG_LONG_LONG,
+	FORMAT_ARG_UNSIGNED_LONG_LONG,
+	FORMAT_ARG_FLOAT,
+	FORMAT_ARG_DOUBLE,
+	FORMAT_ARG_LONG_DOUBLE,
+	FORMAT_ARG_STRING
+};
+
+
+template <typename T> struct FormatArgTypeOf { static const FormatArgType value = FORMAT_ARG_OTHER; };
+template <> struct FormatArgTypeOf<bool> { static const FormatArgType value = FORMAT_ARG_BOOL; };
+template <> struct FormatArgTypeOf<char> { static const FormatArgType value = FORMAT_ARG_CHAR; };
+template <> struct FormatArgTypeOf<signed char> { static const FormatArgType value = FORMAT_ARG_SIGNED_CHAR; };
+template <> struct FormatArgTypeOf<unsigned char> { static const FormatArgType value = FORMAT_ARG_UNSIGNED_CHAR; };
+template <> struct FormatArgTypeOf<short> { static const FormatArgType value = FORMAT_ARG_SHORT; };
+template <> struct FormatArgTypeOf<unsigned short> { static const FormatArgType value = FORMAT_ARG_UNSIGNED_SHORT; };
+template <> struct FormatArgTypeOf<int> { static const FormatArgType value = FORMAT_ARG_INT; };
+template <> struct FormatArgTypeOf<unsigned int> { static const FormatArgType value = FORMAT_ARG_UNSIGNED_INT; };
+template <> struct FormatArgTypeOf<long> { static const FormatArgType value = FORMAT_ARG_LONG; };
+template <> struct FormatArgTypeOf<unsigned long> { static const FormatArgType value = FORMAT_ARG_UNSIGNED_LONG; };
+template <> struct FormatArgTypeOf<long long> { static const FormatArgType value = FORMAT_ARG_LONG_LONG; };
+template <> struct FormatArgTypeOf<unsigned long long> { static const FormatArgType value = FORMAT_ARG_UNSIGNED_LONG_LONG; };
+template <> struct FormatArgTypeOf<float> { static const FormatArgType value = FORMAT_ARG_FLOAT; };
+template <> struct FormatArgTypeOf<double> { static const FormatArgType value = FORMAT_ARG_DOUBLE; };
+template <> struct FormatArgTypeOf<long double> { static const FormatArgType value = FORMAT_ARG_LONG_DOUBLE; };
+template <> struct FormatArgTypeOf<std::string> { static const FormatArgType value = FORMAT_ARG_STRING; };
+
+
+class FormatArg
+	/// A reference to an argument of format(), together with its type.
+	/// Integers, characters and strings are formatted directly from
+	/// the referenced value. An Any holding a copy of the value is
+	/// only created for format specifications that need the generic,
+	/// stream-based formatting (e.g., floating-point values).
+	///
+	/// For internal use only.
+{
+public:
+	FormatArg():
+		_pValue(0),
+		_type(FORMAT_ARG_OTHER),
+		_toAny(0)
+	{
+	}
+
+	template <typename T>
+	FormatArg(const T& value):
+		_pValue(&value),
+		_type(FormatArgTypeOf<T>::value),
+		_toAny(&FormatArg::toAny<T>)
+	{
+	}
+
+	FormatArgType type() const
+	{
+		return _type;
+	}
+
+	template <typename T>
+	const T& value() const
+	{
+		return *static_cast<const T*>(_pValue);
+	}
+
+	Any any() const
+	{
+		return _toAny(_pValue);
+	}
+
+private:
+	template <typename T>
+	static Any toAny(const void* pValue)
+	{
+		return Any(*static_cast<const T*>(pValue));
+	}
+
+	const void* _pValue;
+	FormatArgType _type;
+	Any (*_toAny)(const void*);
+};
+
+
+struct FormatSpec
+	/// A parsed format specification.
+	///
+	/// For internal use only.
+{
+	std::size_t index;
+	bool hasIndex;
+	bool left;
+	bool showSign;
+	bool zero;
+	bool showBase;
+	int width;
+	bool widthArg;
+	int precision;
+	bool hasPrecision;
+	bool precisionArg;
+	char mod;
+	char type;
+};
+
+
+void Foundation_API format(std::string& result, const char* fmt, std::size_t length, const FormatArg* args, std::size_t count);
+	/// Appends the formatted string to result. Used by
+	/// the variadic variants of format().
+
+
+} // namespace Impl
+
+
 template <
 	typename T,
 	typename... Args>
 void format(std::string& result, const std::string& fmt, T arg1, Args... args)
 	/// Appends the formatted string to result.
 {
-	std::vector<Any> values;
-	values.reserve(sizeof...(Args) + 1);
-	values.emplace_back(arg1);
-	values.insert(values.end(), { args... });
-	format(result, fmt, values);
+	const Impl::FormatArg values[] = { Impl::FormatArg(arg1), Impl::FormatArg(args)... };
+	Impl::format(result, fmt.data(), fmt.size(), values, sizeof...(Args) + 1);
 }
 
 
@@ -134,11 +266,8 @@ template <
 void format(std::string& result, const char* fmt, T arg1, Args... args)
 	/// Appends the formatted string to result.
 {
-	std::vector<Any> values;
-	values.reserve(sizeof...(Args) + 1);
-	values.emplace_back(arg1);
-	values.insert(values.end(), { args... });
-	format(result, fmt, values);
+	const Impl::FormatArg values[] = { Impl::FormatArg(arg1), Impl::FormatArg(args)... };
+	Impl::format(result, fmt, std::strlen(fmt), values, sizeof...(Args) + 1);
 }
 
 
@@ -148,12 +277,9 @@ template <
 std::string format(const std::string& fmt, T arg1, Args... args)
 	/// Returns the formatted string.
 {
-	std::vector<Any> values;
-	values.reserve(sizeof...(Args) + 1);
-	values.emplace_back(arg1);
-	values.insert(values.end(), { args... });
+	const Impl::FormatArg values[] = { Impl::FormatArg(arg1), Impl::FormatArg(args)... };
 	std::string result;
-	format(result, fmt, values);
+	Impl::format(result, fmt.data(), fmt.size(), values, sizeof...(Args) + 1);
 	return result;
 }
 
@@ -164,16 +290,84 @@ template <
 std::string format(const char* fmt, T arg1, Args... args)
 	/// Returns the formatted string.
 {
-	std::vector<Any> values;
-	values.reserve(sizeof...(Args) + 1);
-	values.emplace_back(arg1);
-	values.insert(values.end(), { args... });
+	const Impl::FormatArg values[] = { Impl::FormatArg(arg1), Impl::FormatArg(args)... };
 	std::string result;
-	format(result, fmt, values);
+	Impl::format(result, fmt, std::strlen(fmt), values, sizeof...(Args) + 1);
 	return result;
 }
 
 
+class Foundation_API CompiledFormat
+	/// A format string for format() that is parsed only once, when
+	/// the CompiledFormat is created. Formatting with a CompiledFormat
+	/// produces the same result as format() with the same format string,
+	/// but avoids parsing the format string on every call.
+	///
+	/// Arguments are passed as for format(). Integers, characters and
+	/// strings are formatted directly into the result string.
+	///
+	/// Usage Example:
+	///     static const CompiledFormat fmt("%s: %d bytes received");
+	///     std::string s = fmt.format(peer, n);
+{
+public:
+	explicit CompiledFormat(const std::string& fmt);
+		/// Creates the CompiledFormat by parsing the given format string.
+
+	~CompiledFormat();
+		/// Destroys the CompiledFormat.
+
+	const std::string& toString() const;
+		/// Returns the format string.
+
+	template <typename... Args>
+	std::string format(Args... args) const
+		/// Returns the formatted string.
+	{
+		const Impl::FormatArg values[] = { Impl::FormatArg(), Impl::FormatArg(args)... };
+		std::string result;
+		formatArgs(result, values + 1, sizeof...(Args));
+		return result;
+	}
+
+	template <typename... Args>
+	void append(std::string& result, Args... args) const
+		/// Appends the formatted string to result.
+	{
+		const Impl::FormatArg values[] = { Impl::FormatArg(), Impl::FormatArg(args)... };
+		formatArgs(result, values + 1, sizeof...(Args));
+	}
+
+private:
+	CompiledFormat();
+
+	void formatArgs(std::string& result, const Impl::FormatArg* args, std::size_t count) const;
+
+	struct Segment
+		/// Either literal text, or a format specification
+		/// starting at offset (after the percent sign and
+		/// the index) and ending at offset + length.
+	{
+		std::size_t offset;
+		std::size_t length;
+		bool isSpec;
+		Impl::FormatSpec spec;
+	};
+
+	std::string _fmt;
+	std::vector<Segment> _segments;
+};
+
+
+//
+// inlines
+//
+inline const std::string& CompiledFormat::toString() const
+{
+	return _fmt;
+}
+
+
 } // namespace Poco
 
 
@@ -44,11 +44,26 @@ public:
 	HexBinaryDecoderBuf(std::istream& istr);
 	~HexBinaryDecoderBuf();
 	
+protected:
+	std::streamsize xsgetn(char* p, std::streamsize count);
+		/// Decodes the data with HexBinaryDecoder::decode(),
+		/// instead of one byte at a time.
+
 private:
+	enum
+	{
+		BUFFER_SIZE = 2048
+	};
+
 	int readFromDevice();
 	int readOne();
+		/// Returns the next character, or eof. Once the end of the
+		/// data has been reached, the streambuf is not read anymore,
+		/// as it may not keep returning eof (e.g., a part of a
+		/// MultipartReader).
 
 	std::streambuf& _buf;
+	bool _eof;
 };
 
 
@@ -85,6 +100,18 @@ class Foundation_API HexBinaryDecoder: public HexBinaryDecoderIOS, public std::i
 public:
 	HexBinaryDecoder(std::istream& istr);
 	~HexBinaryDecoder();
+
+	static std::size_t decode(const char* data, std::size_t length, void* buffer);
+		/// Decodes length hexadecimal digits from data and writes the
+		/// decoded bytes to buffer, which must have room for length/2
+		/// bytes. Whitespace is ignored. Returns the number of bytes
+		/// written.
+		///
+		/// Throws a DataFormatException if the data contains an invalid
+		/// character or an odd number of digits.
+
+	static std::string decode(const std::string& data);
+		/// Returns the decoded data.
 };
 
 
@@ -60,8 +60,18 @@ public:
 		
 	void setUppercase(bool flag = true);
 		/// Specify whether hex digits a-f are written in upper or lower case.
-	
+
+protected:
+	std::streamsize xsputn(const char* s, std::streamsize count);
+		/// Encodes the data with HexBinaryEncoder::encode(),
+		/// instead of one byte at a time.
+
 private:
+	enum
+	{
+		BUFFER_SIZE = 2048
+	};
+
 	int writeToDevice(char c);
 
 	int _pos;
@@ -108,6 +118,20 @@ class Foundation_API HexBinaryEncoder: public HexBinaryEncoderIOS, public std::o
 public:
 	HexBinaryEncoder(std::ostream& ostr);
 	~HexBinaryEncoder();
+
+	static std::size_t encode(const void* data, std::size_t length, char* buffer, bool uppercase = false);
+		/// Encodes length bytes from data and writes the hexadecimal
+		/// digits to buffer, which must have room for 2*length characters.
+		/// Returns the number of characters written (2*length).
+		///
+		/// No line breaks are written, and the result
+		/// is not zero-terminated.
+		///
+		/// On x86 CPUs, blocks of sixteen bytes are encoded
+		/// with SSE2 instructions.
+
+	static std::string encode(const std::string& data, bool uppercase = false);
+		/// Returns the hexBinary encoding of data, without line breaks.
 };
 
 
@@ -23,12 +23,14 @@
 #include "Poco/Mutex.h"
 #include "Poco/Event.h"
 #include <deque>
+#include <vector>
 
 
 namespace Poco {
 
 
 class NotificationCenter;
+class NotificationRing;
 
 
 class Foundation_API NotificationQueue
@@ -47,10 +49,25 @@ class Foundation_API NotificationQueue
 	///   2. call the wakeUpAll() method
 	///   3. join each worker thread
 	///   4. destroy the notification queue.
+	///
+	/// By default, a NotificationQueue is unbounded and protected
+	/// by a mutex. Alternatively, a bounded NotificationQueue
+	/// can be created by specifying its capacity. A bounded queue
+	/// stores notifications in a lock-free ring buffer, so that
+	/// many producers and consumers can enqueue and dequeue
+	/// notifications without contending for a lock. Threads
+	/// waiting for a notification on a bounded queue are only
+	/// signalled if they actually sleep. A bounded queue does
+	/// not support enqueueUrgentNotification() and remove().
 {
 public:
 	NotificationQueue();
-		/// Creates the NotificationQueue.
+		/// Creates an unbounded NotificationQueue.
+
+	explicit NotificationQueue(std::size_t capacity);
+		/// Creates a bounded, lock-free NotificationQueue that can
+		/// hold up to capacity notifications. The capacity is
+		/// rounded up to the next power of two.
 
 	~NotificationQueue();
 		/// Destroys the NotificationQueue.
@@ -62,6 +79,9 @@ public:
 		/// a call like
 		///     notificationQueue.enqueueNotification(new MyNotification);
 		/// does not result in a memory leak.
+		///
+		/// If the queue is bounded and full, waits until a
+		/// notification has been dequeued by another thread.
 		
 	void enqueueUrgentNotification(Notification::Ptr pNotification);
 		/// Enqueues the given notification by adding it to
@@ -71,6 +91,8 @@ public:
 		/// a call like
 		///     notificationQueue.enqueueUrgentNotification(new MyNotification);
 		/// does not result in a memory leak.
+		///
+		/// Throws a NotImplementedException if the queue is bounded.
 
 	Notification* dequeueNotification();
 		/// Dequeues the next pending notification.
@@ -107,6 +129,13 @@ public:
 		/// assigned to a Notification::Ptr, to avoid potential
 		/// memory management issues.
 
+	std::size_t dequeueMany(std::vector<Notification::Ptr>& notifications, std::size_t maxCount);
+		/// Dequeues up to maxCount pending notifications and appends
+		/// them to the given vector. Does not wait for notifications
+		/// to be enqueued.
+		///
+		/// Returns the number of notifications dequeued.
+
 	void dispatch(NotificationCenter& notificationCenter);
 		/// Dispatches all queued notifications to the given
 		/// notification center.
@@ -126,10 +155,16 @@ public:
 	bool remove(Notification::Ptr pNotification);
 		/// Removes a notification from the queue.
 		/// Returns true if remove succeeded, false otherwise
+		///
+		/// Throws a NotImplementedException if the queue is bounded.
 
 	bool hasIdleThreads() const;	
 		/// Returns true if the queue has at least one thread waiting 
 		/// for a notification.
+
+	std::size_t capacity() const;
+		/// Returns the capacity of a bounded queue,
+		/// or 0 if the queue is unbounded.
 		
 	static NotificationQueue& defaultQueue();
 		/// Returns a reference to the default
@@ -150,6 +185,7 @@ private:
 	NfQueue           _nfQueue;
 	WaitQueue         _waitQueue;
 	mutable FastMutex _mutex;
+	NotificationRing* _pRing;
 };
 
 
@@ -33,7 +33,13 @@ class Foundation_API NumberFormatter
 	///    * format* functions return a std::string containing
 	///      the formatted value.
 	///    * append* functions append the formatted value to
-	///      an existing string.
+	///      an existing string, or write it to a character
+	///      buffer supplied by the caller.
+	///
+	/// The append functions writing to a character buffer never
+	/// allocate memory. Integers are formatted two digits at a
+	/// time, floating-point numbers with the shortest representation
+	/// that round-trips.
 {
 public:
 	enum BoolFormat
@@ -45,6 +51,7 @@ public:
 
 	static const unsigned NF_MAX_INT_STRING_LEN = 32; // increase for 64-bit binary formatting support
 	static const unsigned NF_MAX_FLT_STRING_LEN = POCO_MAX_FLT_STRING_LEN;
+	static const unsigned NF_MAX_SHORTEST_FLT_STRING_LEN = 40; // shortest representation, see append(char*, double)
 
 	static std::string format(int value);
 		/// Formats an integer value in decimal notation.
@@ -500,6 +507,65 @@ public:
 		/// sixteen (64-bit architectures) characters wide
 		/// field in hexadecimal notation.
 
+	static char* append(char* buffer, int value);
+		/// Writes an integer value in decimal notation to buffer,
+		/// which must have room for at least NF_MAX_INT_STRING_LEN
+		/// characters. The result is not zero-terminated.
+		///
+		/// Returns a pointer past the last character written.
+
+	static char* append(char* buffer, unsigned value);
+		/// Writes an unsigned int value in decimal notation to buffer.
+		/// See append(char*, int).
+
+	static char* append(char* buffer, long value);
+		/// Writes a long value in decimal notation to buffer.
+		/// See append(char*, int).
+
+	static char* append(char* buffer, unsigned long value);
+		/// Writes an unsigned long value in decimal notation to buffer.
+		/// See append(char*, int).
+
+#ifdef POCO_HAVE_INT64
+#ifdef POCO_INT64_IS_LONG
+
+	static char* append(char* buffer, long long value);
+		/// Writes a 64-bit integer value in decimal notation to buffer.
+		/// See append(char*, int).
+
+	static char* append(char* buffer, unsigned long long value);
+		/// Writes an unsigned 64-bit integer value in decimal notation
+		/// to buffer. See append(char*, int).
+
+#else // ifndef POCO_INT64_IS_LONG
+
+	static char* append(char* buffer, Int64 value);
+		/// Writes a 64-bit integer value in decimal notation to buffer.
+		/// See append(char*, int).
+
+	static char* append(char* buffer, UInt64 value);
+		/// Writes an unsigned 64-bit integer value in decimal notation
+		/// to buffer. See append(char*, int).
+
+#endif // ifdef POCO_INT64_IS_LONG
+#endif // ifdef POCO_HAVE_INT64
+
+	static char* append(char* buffer, float value);
+		/// Writes a float value to buffer, like format(float).
+		/// The buffer must have room for at least
+		/// NF_MAX_SHORTEST_FLT_STRING_LEN characters.
+		/// The result is not zero-terminated.
+		///
+		/// Returns a pointer past the last character written.
+
+	static char* append(char* buffer, double value);
+		/// Writes a double value to buffer, like format(double).
+		/// The buffer must have room for at least
+		/// NF_MAX_SHORTEST_FLT_STRING_LEN characters.
+		/// The result is not zero-terminated.
+		///
+		/// Returns a pointer past the last character written.
+
 private:
 };
 
@@ -510,9 +576,8 @@ private:
 
 inline std::string NumberFormatter::format(int value)
 {
-	std::string result;
-	intToStr(value, 10, result);
-	return result;
+	char buffer[NF_MAX_INT_STRING_LEN];
+	return std::string(buffer, append(buffer, value));
 }
 
 
@@ -550,9 +615,8 @@ inline std::string NumberFormatter::formatHex(int value, int width, bool prefix)
 
 inline std::string NumberFormatter::format(unsigned value)
 {
-	std::string result;
-	uIntToStr(value, 10, result);
-	return result;
+	char buffer[NF_MAX_INT_STRING_LEN];
+	return std::string(buffer, append(buffer, value));
 }
 
 
@@ -590,9 +654,8 @@ inline std::string NumberFormatter::formatHex(unsigned value, int width, bool pr
 
 inline std::string NumberFormatter::format(long value)
 {
-	std::string result;
-	intToStr(value, 10, result);
-	return result;
+	char buffer[NF_MAX_INT_STRING_LEN];
+	return std::string(buffer, append(buffer, value));
 }
 
 
@@ -630,9 +693,8 @@ inline std::string NumberFormatter::formatHex(long value, int width, bool prefix
 
 inline std::string NumberFormatter::format(unsigned long value)
 {
-	std::string result;
-	uIntToStr(value, 10, result);
-	return result;
+	char buffer[NF_MAX_INT_STRING_LEN];
+	return std::string(buffer, append(buffer, value));
 }
 
 
@@ -674,9 +736,8 @@ inline std::string NumberFormatter::formatHex(unsigned long value, int width, bo
 
 inline std::string NumberFormatter::format(long long value)
 {
-	std::string result;
-	intToStr(value, 10, result);
-	return result;
+	char buffer[NF_MAX_INT_STRING_LEN];
+	return std::string(buffer, append(buffer, value));
 }
 
 
@@ -714,9 +775,8 @@ inline std::string NumberFormatter::formatHex(long long value, int width, bool p
 
 inline std::string NumberFormatter::format(unsigned long long value)
 {
-	std::string result;
-	uIntToStr(value, 10, result);
-	return result;
+	char buffer[NF_MAX_INT_STRING_LEN];
+	return std::string(buffer, append(buffer, value));
 }
 
 
@@ -757,9 +817,8 @@ inline std::string NumberFormatter::formatHex(unsigned long long value, int widt
 
 inline std::string NumberFormatter::format(Int64 value)
 {
-	std::string result;
-	intToStr(value, 10, result);
-	return result;
+	char buffer[NF_MAX_INT_STRING_LEN];
+	return std::string(buffer, append(buffer, value));
 }
 
 
@@ -797,9 +856,8 @@ inline std::string NumberFormatter::formatHex(Int64 value, int width, bool prefi
 
 inline std::string NumberFormatter::format(UInt64 value)
 {
-	std::string result;
-	uIntToStr(value, 10, result);
-	return result;
+	char buffer[NF_MAX_INT_STRING_LEN];
+	return std::string(buffer, append(buffer, value));
 }
 
 
@@ -841,9 +899,8 @@ inline std::string NumberFormatter::formatHex(UInt64 value, int width, bool pref
 
 inline std::string NumberFormatter::format(float value)
 {
-	char buffer[POCO_MAX_FLT_STRING_LEN];
-	floatToStr(buffer, POCO_MAX_FLT_STRING_LEN, value);
-	return std::string(buffer);
+	char buffer[NF_MAX_SHORTEST_FLT_STRING_LEN];
+	return std::string(buffer, append(buffer, value));
 }
 
 
@@ -865,9 +922,8 @@ inline std::string NumberFormatter::format(float value, int width, int precision
 
 inline std::string NumberFormatter::format(double value)
 {
-	char buffer[POCO_MAX_FLT_STRING_LEN];
-	doubleToStr(buffer, POCO_MAX_FLT_STRING_LEN, value);
-	return std::string(buffer);
+	char buffer[NF_MAX_SHORTEST_FLT_STRING_LEN];
+	return std::string(buffer, append(buffer, value));
 }
 
 
@@ -895,6 +951,65 @@ inline std::string NumberFormatter::format(const void* ptr)
 }
 
 
+inline char* NumberFormatter::append(char* buffer, int value)
+{
+	return intToDecStr(value, buffer);
+}
+
+
+inline char* NumberFormatter::append(char* buffer, unsigned value)
+{
+	return uIntToDecStr(value, buffer);
+}
+
+
+inline char* NumberFormatter::append(char* buffer, long value)
+{
+	return intToDecStr(value, buffer);
+}
+
+
+inline char* NumberFormatter::append(char* buffer, unsigned long value)
+{
+	return uIntToDecStr(value, buffer);
+}
+
+
+#ifdef POCO_HAVE_INT64
+#ifdef POCO_INT64_IS_LONG
+
+
+inline char* NumberFormatter::append(char* buffer, long long value)
+{
+	return intToDecStr(value, buffer);
+}
+
+
+inline char* NumberFormatter::append(char* buffer, unsigned long long value)
+{
+	return uIntToDecStr(value, buffer);
+}
+
+
+#else // ifndef POCO_INT64_IS_LONG
+
+
+inline char* NumberFormatter::append(char* buffer, Int64 value)
+{
+	return intToDecStr(value, buffer);
+}
+
+
+inline char* NumberFormatter::append(char* buffer, UInt64 value)
+{
+	return uIntToDecStr(value, buffer);
+}
+
+
+#endif // ifdef POCO_INT64_IS_LONG
+#endif // ifdef POCO_HAVE_INT64
+
+
 } // namespace Poco
 
 
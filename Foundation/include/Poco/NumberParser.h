@@ -59,6 +59,20 @@ public:
 		/// Returns true if a valid integer has been found, false otherwise. 
 		/// If parsing was not successful, value is undefined.
 
+	static bool tryParse(const char* s, std::size_t length, int& value, char thousandSeparator = ',');
+		/// Parses an integer value in decimal notation from the given
+		/// character array of the given length, which need not be
+		/// zero-terminated. Does not allocate memory.
+		/// Returns true if a valid integer has been found, false otherwise.
+		/// If parsing was not successful, value is undefined.
+
+	static bool tryParseUnsigned(const char* s, std::size_t length, unsigned& value, char thousandSeparator = ',');
+		/// Parses an unsigned integer value in decimal notation from the given
+		/// character array of the given length, which need not be
+		/// zero-terminated. Does not allocate memory.
+		/// Returns true if a valid integer has been found, false otherwise.
+		/// If parsing was not successful, value is undefined.
+
 	static unsigned parseHex(const std::string& s);
 		/// Parses an integer value in hexadecimal notation from the given string.
 		/// Throws a SyntaxException if the string does not hold a number in
@@ -99,6 +113,20 @@ public:
 		/// Returns true if a valid integer has been found, false otherwise. 
 		/// If parsing was not successful, value is undefined.
 
+	static bool tryParse64(const char* s, std::size_t length, Int64& value, char thousandSeparator = ',');
+		/// Parses a 64-bit integer value in decimal notation from the given
+		/// character array of the given length, which need not be
+		/// zero-terminated. Does not allocate memory.
+		/// Returns true if a valid integer has been found, false otherwise.
+		/// If parsing was not successful, value is undefined.
+
+	static bool tryParseUnsigned64(const char* s, std::size_t length, UInt64& value, char thousandSeparator = ',');
+		/// Parses an unsigned 64-bit integer value in decimal notation from
+		/// the given character array of the given length, which need not be
+		/// zero-terminated. Does not allocate memory.
+		/// Returns true if a valid integer has been found, false otherwise.
+		/// If parsing was not successful, value is undefined.
+
 	static UInt64 parseHex64(const std::string& s);
 		/// Parses a 64 bit-integer value in hexadecimal notation from the given string.
 		/// Throws a SyntaxException if the string does not hold a number in hexadecimal notation.
@@ -30,6 +30,8 @@
 #include <limits>
 #include <cmath>
 #include <cctype>
+#include <cstring>
+#include <type_traits>
 #if !defined(POCO_NO_LOCALE)
 	#include <locale>
 #endif
@@ -164,21 +166,81 @@ inline char thousandSeparator()
 // String to Number Conversions
 //
 
+namespace Impl {
+
+#if defined(POCO_ARCH_LITTLE_ENDIAN)
+
+	inline bool isEightDigits(UInt64 chunk)
+		/// Returns true if all eight characters in chunk are decimal digits.
+	{
+		return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+			(((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+	}
+
+	inline UInt32 eightDigitsValue(UInt64 chunk)
+		/// Returns the value of eight decimal digits, the first
+		/// (most significant) one in the lowest byte of chunk.
+	{
+		chunk = ((chunk & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+		chunk = ((chunk & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+		return static_cast<UInt32>(((chunk & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32);
+	}
+
+#endif
+
+	inline bool parseDecimal(const char* pStr, std::size_t length, UInt64& value)
+		/// Parses 1 to 19 decimal digits, without sign or separators,
+		/// eight digits at a time on little-endian platforms.
+		/// Returns false if length is out of range or the characters
+		/// are not all digits. For internal use only.
+	{
+		if (length == 0 || length > 19) return false;
+
+		UInt64 result = 0;
+#if defined(POCO_ARCH_LITTLE_ENDIAN)
+		while (length >= 8)
+		{
+			UInt64 chunk;
+			std::memcpy(&chunk, pStr, sizeof(chunk));
+			if (!isEightDigits(chunk)) return false;
+			result = result*100000000 + eightDigitsValue(chunk);
+			pStr += 8;
+			length -= 8;
+		}
+#endif
+		for (; length > 0; --length, ++pStr)
+		{
+			unsigned digit = static_cast<unsigned char>(*pStr) - '0';
+			if (digit > 9) return false;
+			result = result*10 + digit;
+		}
+		value = result;
+		return true;
+	}
+
+}
+
+
+
 template <typename I>
-bool strToInt(const char* pStr, I& outResult, short base, char thSep = ',')
-	/// Converts zero-terminated character array to integer number;
+bool strToInt(const char* pStr, std::size_t length, I& outResult, short base, char thSep = ',')
+	/// Converts a character array of the given length to integer number;
 	/// Thousand separators are recognized for base10 and current locale;
 	/// they are silently skipped and not verified for correct positioning.
 	/// It is not allowed to convert a negative number to unsigned integer.
 	///
+	/// Decimal numbers with up to 19 digits and without thousand separators
+	/// are parsed eight digits at a time.
+	///
 	/// Function returns true if successful. If parsing was unsuccessful,
 	/// the return value is false with the result value undetermined.
 {
 	poco_assert_dbg (base == 2 || base == 8 || base == 10 || base == 16);
 
 	if (!pStr) return false;
-	while (std::isspace(*pStr)) ++pStr;
-	if (*pStr == '\0') return false;
+	const char* pEnd = pStr + length;
+	while (pStr != pEnd && std::isspace(static_cast<unsigned char>(*pStr))) ++pStr;
+	if (pStr == pEnd) return false;
 	bool negative = false;
 	if ((base == 10) && (*pStr == '-'))
 	{
@@ -208,73 +270,84 @@ bool strToInt(const char* pStr, I& outResult, short base, char thSep = ',')
 	}
 
 	uintmax_t result = 0;
-	for (; *pStr != '\0'; ++pStr)
+	UInt64 decimal;
+	if ((base == 10) && Impl::parseDecimal(pStr, pEnd - pStr, decimal))
 	{
-		if  (result > (limitCheck / base)) return false;
-		switch (*pStr)
+		if (decimal > limitCheck) return false;
+		result = decimal;
+	}
+	else
+	{
+		for (; pStr != pEnd; ++pStr)
 		{
-		case '0': case '1': case '2': case '3':
-		case '4': case '5': case '6': case '7':
-			{
-				char add = (*pStr - '0');
-				if ((limitCheck - result) < add) return false;
-				result = result * base + add;
-			}
-			break;
-
-		case '8': case '9':
-			if ((base == 10) || (base == 0x10))
-			{
-				char  add = (*pStr - '0');
-				if ((limitCheck - result) < add) return false;
-				result = result * base + add;
-			}
-			else return false;
-
-			break;
-
-		case 'a': case 'b': case 'c': case 'd': case 'e': case 'f':
-			{
-				if (base != 0x10) return false;
-				char  add = (*pStr - 'a');
-				if ((limitCheck - result) < add) return false;
-				result = result * base + (10 + add);
-			}
-			break;
-
-		case 'A': case 'B': case 'C': case 'D': case 'E': case 'F':
+			if  (result > (limitCheck / base)) return false;
+			switch (*pStr)
 			{
-				if (base != 0x10) return false;
-				char add = (*pStr - 'A');
-				if ((limitCheck - result) < add) return false;
-				result = result * base + (10 + add);
+			case '0': case '1': case '2': case '3':
+			case '4': case '5': case '6': case '7':
+				{
+					char add = (*pStr - '0');
+					if ((limitCheck - result * base) < add) return false;
+					result = result * base + add;
+				}
+				break;
+
+			case '8': case '9':
+				if ((base == 10) || (base == 0x10))
+				{
+					char  add = (*pStr - '0');
+					if ((limitCheck - result * base) < add) return false;
+					result = result * base + add;
+				}
+				else return false;
+
+				break;
+
+			case 'a': case 'b': case 'c': case 'd': case 'e': case 'f':
+				{
+					if (base != 0x10) return false;
+					char add = 10 + (*pStr - 'a');
+					if ((limitCheck - result * base) < add) return false;
+					result = result * base + add;
+				}
+				break;
+
+			case 'A': case 'B': case 'C': case 'D': case 'E': case 'F':
+				{
+					if (base != 0x10) return false;
+					char add = 10 + (*pStr - 'A');
+					if ((limitCheck - result * base) < add) return false;
+					result = result * base + add;
+				}
+				break;
+
+			case '.':
+				if ((base == 10) && (thSep == '.')) break;
+				else return false;
+
+			case ',':
+				if ((base == 10) && (thSep == ',')) break;
+				else return false;
+
+			case ' ':
+				if ((base == 10) && (thSep == ' ')) break;
+
+			default:
+				return false;
 			}
-			break;
-
-		case '.':
-			if ((base == 10) && (thSep == '.')) break;
-			else return false;
-
-		case ',':
-			if ((base == 10) && (thSep == ',')) break;
-			else return false;
-
-		case ' ':
-			if ((base == 10) && (thSep == ' ')) break;
-
-		default:
-			return false;
 		}
 	}
 
 	if (negative && (base == 10))
 	{
 		poco_assert_dbg(std::numeric_limits<I>::is_signed);
+		// result does not exceed -min (see limitCheck), and can
+		// only be larger than INTMAX_MAX if it is equal to -INTMAX_MIN
 		intmax_t i;
-		if (sizeof(I) == sizeof(intmax_t))
-			i = static_cast<intmax_t>(FPEnvironment::copySign(static_cast<double>(result), -1));
+		if (result > static_cast<uintmax_t>(INTMAX_MAX))
+			i = std::numeric_limits<intmax_t>::min();
 		else
-			i = static_cast<intmax_t>(-result);
+			i = -static_cast<intmax_t>(result);
 		if (isIntOverflow<I>(i)) return false;
 		outResult = static_cast<I>(i);
 	}
@@ -288,6 +361,17 @@ bool strToInt(const char* pStr, I& outResult, short base, char thSep = ',')
 }
 
 
+template <typename I>
+bool strToInt(const char* pStr, I& outResult, short base, char thSep = ',')
+	/// Converts zero-terminated character array to integer number;
+	/// This is a wrapper function, for details see see the
+	/// bool strToInt(const char*, std::size_t, I&, short, char) implementation.
+{
+	if (!pStr) return false;
+	return strToInt(pStr, std::strlen(pStr), outResult, base, thSep);
+}
+
+
 template <typename I>
 bool strToInt(const std::string& str, I& result, short base, char thSep = ',')
 	/// Converts string to integer number;
@@ -372,9 +456,117 @@ namespace Impl {
 		const char* _end;
 };
 
+
+Foundation_API char* formatDecimal(UInt32 value, char* buffer);
+	/// Writes the decimal digits of value to buffer, two digits
+	/// at a time, and returns a pointer past the last digit.
+	/// The buffer must have room for 10 characters.
+	/// For internal use only; see uIntToDecStr().
+
+
+Foundation_API char* formatDecimal(UInt64 value, char* buffer);
+	/// Writes the decimal digits of value to buffer, two digits
+	/// at a time, and returns a pointer past the last digit.
+	/// The buffer must have room for 20 characters.
+	/// For internal use only; see uIntToDecStr().
+
+
+inline bool formatPadded(const char* digits, std::size_t length, const char* prefix, std::size_t prefixLength, char* result, std::size_t& size, int width, char fill)
+	/// Copies prefix (sign and/or base prefix) and digits to result,
+	/// padded to width as described for intToStr(), and zero-terminates
+	/// the result. Used by the fast paths of intToStr() and uIntToStr().
+{
+	std::size_t padding = 0;
+	if (width > 0 && static_cast<std::size_t>(width) > length + prefixLength)
+		padding = width - length - prefixLength;
+	if (length + prefixLength + padding >= size) throw RangeException();
+
+	char* ptr = result;
+	if ('0' != fill)
+	{
+		std::memset(ptr, fill, padding);
+		ptr += padding;
+	}
+	std::memcpy(ptr, prefix, prefixLength);
+	ptr += prefixLength;
+	if ('0' == fill)
+	{
+		std::memset(ptr, '0', padding);
+		ptr += padding;
+	}
+	std::memcpy(ptr, digits, length);
+	ptr += length;
+	*ptr = '\0';
+	size = ptr - result;
+	return true;
+}
+
+
 } // namespace Impl
 
 
+template <typename T>
+inline char* uIntToDecStr(T value, char* buffer)
+	/// Writes the decimal representation of the unsigned integer
+	/// value to buffer, which must have room for at least
+	/// std::numeric_limits<T>::digits10 + 1 characters.
+	/// The result is not zero-terminated.
+	///
+	/// Returns a pointer past the last character written.
+{
+	if (sizeof(T) <= sizeof(UInt32) || static_cast<UInt64>(value) <= 0xFFFFFFFFU)
+		return Impl::formatDecimal(static_cast<UInt32>(value), buffer);
+	else
+		return Impl::formatDecimal(static_cast<UInt64>(value), buffer);
+}
+
+
+template <typename T>
+inline char* intToDecStr(T value, char* buffer)
+	/// Writes the decimal representation of the integer value,
+	/// including a minus sign for negative values, to buffer, which
+	/// must have room for at least std::numeric_limits<T>::digits10 + 2
+	/// characters. The result is not zero-terminated.
+	///
+	/// Returns a pointer past the last character written.
+{
+	typedef typename std::make_unsigned<T>::type U;
+
+	U u = static_cast<U>(value);
+	if (isNegative(value))
+	{
+		*buffer++ = '-';
+		u = static_cast<U>(U(0) - u);
+	}
+	return uIntToDecStr(u, buffer);
+}
+
+
+template <typename T>
+inline char* uIntToHexStr(T value, char* buffer)
+	/// Writes the hexadecimal representation (using upper case digits)
+	/// of the unsigned integer value to buffer, which must have room for
+	/// at least 2*sizeof(T) characters. The result is not zero-terminated.
+	///
+	/// Returns a pointer past the last character written.
+{
+	typedef typename std::make_unsigned<T>::type U;
+
+	U u = static_cast<U>(value);
+	int length = 1;
+	for (U v = u; v > 0xF; v >>= 4) ++length;
+	char* end = buffer + length;
+	char* ptr = end;
+	do
+	{
+		*--ptr = "0123456789ABCDEF"[u & 0xF];
+		u >>= 4;
+	}
+	while (u);
+	return end;
+}
+
+
 template <typename T>
 bool intToStr(T value,
 	unsigned short base,
@@ -398,6 +590,14 @@ bool intToStr(T value,
 		return false;
 	}
 
+	if (base == 10 && !thSep)
+	{
+		char digits[POCO_MAX_INT_STRING_LEN];
+		char* end = intToDecStr(value, digits);
+		std::size_t prefixLength = (digits[0] == '-') ? 1 : 0;
+		return Impl::formatPadded(digits + prefixLength, end - digits - prefixLength, "-", prefixLength, result, size, width, fill);
+	}
+
 	Impl::Ptr ptr(result, size);
 	int thCount = 0;
 	T tmpVal;
@@ -476,6 +676,19 @@ bool uIntToStr(T value,
 		return false;
 	}
 
+	if (base == 10 && !thSep)
+	{
+		char digits[POCO_MAX_INT_STRING_LEN];
+		char* end = uIntToDecStr(value, digits);
+		return Impl::formatPadded(digits, end - digits, "", 0, result, size, width, fill);
+	}
+	else if (base == 0x10)
+	{
+		char digits[POCO_MAX_INT_STRING_LEN];
+		char* end = uIntToHexStr(value, digits);
+		return Impl::formatPadded(digits, end - digits, "0x", prefix ? 2 : 0, result, size, width, fill);
+	}
+
 	Impl::Ptr ptr(result, size);
 	int thCount = 0;
 	T tmpVal;
@@ -34,6 +34,10 @@ namespace Poco {
 class Foundation_API SHA1Engine: public DigestEngine
 	/// This class implements the SHA-1 message digest algorithm.
 	/// (FIPS 180-1, see http://www.itl.nist.gov/fipspubs/fip180-1.htm)
+	///
+	/// On x86 and x86_64 CPUs supporting the SHA extensions (SHA-NI),
+	/// blocks are processed using these instructions. The CPU is
+	/// checked at runtime; otherwise the portable implementation is used.
 {
 public:
 	enum
@@ -53,9 +57,6 @@ protected:
 	void updateImpl(const void* data, std::size_t length);
 
 private:
-	void transform();
-	static void byteReverse(UInt32* buffer, int byteCount);
-
 	typedef UInt8 BYTE;
 
 	struct Context
@@ -63,7 +64,7 @@ private:
 		UInt32 digest[5]; // Message digest
 		UInt32 countLo;   // 64-bit bit count
 		UInt32 countHi;
-		UInt32 data[16];  // SHA data buffer
+		UInt32 data[16];  // SHA data buffer (unprocessed message bytes)
 		UInt32 slop;      // # of bytes saved in data[]
 	};
 
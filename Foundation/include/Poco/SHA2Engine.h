@@ -26,6 +26,8 @@
 
 #include "Poco/Foundation.h"
 #include "Poco/DigestEngine.h"
+#include <string>
+#include <vector>
 
 
 namespace Poco {
@@ -34,6 +36,11 @@ namespace Poco {
 class Foundation_API SHA2Engine: public DigestEngine
 	/// This class implements the SHA-2 message digest algorithm.
 	/// (FIPS 180-4, see http://nvlpubs.nist.gov/nistpubs/FIPS/NIST.FIPS.180-4.pdf)
+	///
+	/// On x86 and x86_64 CPUs supporting the SHA extensions (SHA-NI),
+	/// SHA-224 and SHA-256 blocks are processed using these instructions.
+	/// The CPU is checked at runtime; otherwise the portable
+	/// implementation is used.
 {
 public:
 	enum ALGORITHM
@@ -51,6 +58,21 @@ public:
 	void reset();
 	const DigestEngine::Digest& digest();
 
+	static void digestMany(const void* const data[], const std::size_t lengths[], std::size_t count, unsigned char* digests, ALGORITHM algorithm = SHA_256);
+		/// Computes the digests of count independent messages, where
+		/// message i is given by data[i] and lengths[i], and stores
+		/// digest i at digests + i*algorithm/8. digests must be large
+		/// enough to hold count*algorithm/8 bytes.
+		///
+		/// On CPUs supporting AVX2, but not the SHA extensions,
+		/// SHA-224 and SHA-256 digests are computed for eight messages
+		/// in parallel, which is considerably faster than hashing
+		/// many small messages one after another.
+
+	static std::vector<DigestEngine::Digest> digestMany(const std::vector<std::string>& messages, ALGORITHM algorithm = SHA_256);
+		/// Computes the digests of the given messages and returns
+		/// them in the same order. See digestMany() above.
+
 protected:
 	void updateImpl(const void* data, std::size_t length);
 
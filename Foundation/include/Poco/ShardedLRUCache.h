@@ -0,0 +1,368 @@
+//
+// ShardedLRUCache.h
+//
+// Library: Foundation
+// Package: Cache
+// Module:  ShardedLRUCache
+//
+// Definition of the ShardedLRUCache class.
+//
+// Copyright (c) 2006-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Foundation_ShardedLRUCache_INCLUDED
+#define Foundation_ShardedLRUCache_INCLUDED
+
+
+#include "Poco/KeyValueArgs.h"
+#include "Poco/Mutex.h"
+#include "Poco/Exception.h"
+#include "Poco/FIFOEvent.h"
+#include "Poco/EventArgs.h"
+#include "Poco/SharedPtr.h"
+#include "Poco/Hash.h"
+#include <unordered_map>
+#include <set>
+#include <cstddef>
+
+
+namespace Poco {
+
+
+template <
+	class TKey,
+	class TValue,
+	class THash = Hash<TKey>,
+	class TMutex = FastMutex,
+	class TEventMutex = FastMutex
+>
+class ShardedLRUCache
+	/// A ShardedLRUCache implements Least Recently Used caching
+	/// for caches that are accessed concurrently by many threads.
+	///
+	/// The cache is split into a number of shards, each with
+	/// its own mutex, hash table and recency list. A key is
+	/// always stored in the same shard, which is selected by
+	/// the key's hash value, so that threads accessing different
+	/// keys rarely contend for the same lock. Lookup, insertion,
+	/// removal and replacement take constant time.
+	///
+	/// The capacity of the cache is divided evenly among the
+	/// shards, and replacement happens per shard. The least
+	/// recently used entry of the shard receiving a new entry is
+	/// removed, which is not necessarily the least recently used
+	/// entry of the whole cache. A cache with a single shard
+	/// behaves exactly like LRUCache.
+	///
+	/// The public interface follows AbstractCache. The events
+	/// (Add, Update, Remove, Get and Clear) are fired only if
+	/// enabled in the constructor. Disabling them avoids the cost
+	/// of event dispatching on every access. Events are fired
+	/// while the lock of the affected shard is held.
+{
+public:
+	FIFOEvent<const KeyValueArgs<TKey, TValue>, TEventMutex> Add;
+	FIFOEvent<const KeyValueArgs<TKey, TValue>, TEventMutex> Update;
+	FIFOEvent<const TKey, TEventMutex>                       Remove;
+	FIFOEvent<const TKey, TEventMutex>                       Get;
+	FIFOEvent<const EventArgs, TEventMutex>                  Clear;
+
+	typedef std::set<TKey> KeySet;
+
+	enum
+	{
+		DEFAULT_SHARDS = 16
+	};
+
+	ShardedLRUCache(std::size_t size = 1024, std::size_t shards = DEFAULT_SHARDS, bool enableEvents = true):
+		_pShards(0),
+		_shardMask(0),
+		_capacity(size),
+		_events(enableEvents)
+		/// Creates the ShardedLRUCache with the given total size
+		/// (number of entries) and number of shards.
+		///
+		/// The number of shards is rounded down to a power of two
+		/// and limited to the size of the cache.
+		///
+		/// If enableEvents is false, the Add, Update, Remove, Get
+		/// and Clear events are never fired.
+	{
+		if (size < 1) throw InvalidArgumentException("size must be > 0");
+		if (shards < 1) throw InvalidArgumentException("number of shards must be > 0");
+
+		std::size_t n = 1;
+		while (2*n <= shards && 2*n <= size) n *= 2;
+		_shardMask = n - 1;
+		_pShards = new Shard[n];
+		for (std::size_t i = 0; i < n; i++)
+		{
+			_pShards[i].capacity = size/n + (i < size % n ? 1 : 0);
+		}
+	}
+
+	~ShardedLRUCache()
+	{
+		delete [] _pShards;
+	}
+
+	void add(const TKey& key, const TValue& val)
+		/// Adds the key value pair to the cache.
+		/// If for the key already an entry exists, it will be overwritten.
+	{
+		SharedPtr<TValue> pVal(new TValue(val));
+		add(key, pVal);
+	}
+
+	void add(const TKey& key, SharedPtr<TValue> val)
+		/// Adds the key value pair to the cache. Note that adding a NULL SharedPtr will fail!
+		/// If for the key already an entry exists, it will be overwritten, ie. first a remove event
+		/// is thrown, then a add event
+	{
+		Shard& shard = shardFor(key);
+		typename TMutex::ScopedLock lock(shard.mutex);
+		typename Map::iterator it = shard.map.find(key);
+		if (it != shard.map.end())
+		{
+			if (_events) Remove.notify(this, key);
+			unlink(it->second);
+			shard.map.erase(it);
+		}
+		if (_events)
+		{
+			KeyValueArgs<TKey, TValue> args(key, *val);
+			Add.notify(this, args);
+		}
+		insert(shard, key, val);
+	}
+
+	void update(const TKey& key, const TValue& val)
+		/// Adds the key value pair to the cache.
+		/// If for the key already an entry exists, it will be overwritten.
+		/// The difference to add is that no remove or add events are thrown in this case,
+		/// just an Update is thrown.
+		/// If the key does not exist the behavior is equal to add, ie. an add event is thrown
+	{
+		SharedPtr<TValue> pVal(new TValue(val));
+		update(key, pVal);
+	}
+
+	void update(const TKey& key, SharedPtr<TValue> val)
+		/// Adds the key value pair to the cache. Note that adding a NULL SharedPtr will fail!
+		/// If for the key already an entry exists, it will be overwritten.
+		/// The difference to add is that no remove or add events are thrown in this case,
+		/// just an Update is thrown.
+		/// If the key does not exist the behavior is equal to add, ie. an add event is thrown
+	{
+		Shard& shard = shardFor(key);
+		typename TMutex::ScopedLock lock(shard.mutex);
+		typename Map::iterator it = shard.map.find(key);
+		if (it != shard.map.end())
+		{
+			if (_events)
+			{
+				KeyValueArgs<TKey, TValue> args(key, *val);
+				Update.notify(this, args);
+			}
+			it->second.pValue = val;
+			unlink(it->second);
+			linkFront(shard, it->second);
+		}
+		else
+		{
+			if (_events)
+			{
+				KeyValueArgs<TKey, TValue> args(key, *val);
+				Add.notify(this, args);
+			}
+			insert(shard, key, val);
+		}
+	}
+
+	void remove(const TKey& key)
+		/// Removes an entry from the cache. If the entry is not found,
+		/// the remove is ignored.
+	{
+		Shard& shard = shardFor(key);
+		typename TMutex::ScopedLock lock(shard.mutex);
+		typename Map::iterator it = shard.map.find(key);
+		if (it != shard.map.end())
+		{
+			if (_events) Remove.notify(this, key);
+			unlink(it->second);
+			shard.map.erase(it);
+		}
+	}
+
+	bool has(const TKey& key) const
+		/// Returns true if the cache contains a value for the key.
+	{
+		const Shard& shard = shardFor(key);
+		typename TMutex::ScopedLock lock(shard.mutex);
+		return shard.map.find(key) != shard.map.end();
+	}
+
+	SharedPtr<TValue> get(const TKey& key)
+		/// Returns a SharedPtr of the value. The SharedPointer will remain valid
+		/// even when cache replacement removes the element.
+		/// If for the key no value exists, an empty SharedPtr is returned.
+	{
+		Shard& shard = shardFor(key);
+		typename TMutex::ScopedLock lock(shard.mutex);
+		typename Map::iterator it = shard.map.find(key);
+		if (it != shard.map.end())
+		{
+			if (_events) Get.notify(this, key);
+			Node& node = it->second;
+			if (shard.head.pNext != &node)
+			{
+				unlink(node);
+				linkFront(shard, node);
+			}
+			return node.pValue;
+		}
+		return SharedPtr<TValue>();
+	}
+
+	void clear()
+		/// Removes all elements from the cache.
+	{
+		static EventArgs _emptyArgs;
+		if (_events) Clear.notify(this, _emptyArgs);
+		for (std::size_t i = 0; i <= _shardMask; i++)
+		{
+			Shard& shard = _pShards[i];
+			typename TMutex::ScopedLock lock(shard.mutex);
+			shard.map.clear();
+			shard.head.pPrev = &shard.head;
+			shard.head.pNext = &shard.head;
+		}
+	}
+
+	std::size_t size() const
+		/// Returns the number of cached elements.
+	{
+		std::size_t result = 0;
+		for (std::size_t i = 0; i <= _shardMask; i++)
+		{
+			const Shard& shard = _pShards[i];
+			typename TMutex::ScopedLock lock(shard.mutex);
+			result += shard.map.size();
+		}
+		return result;
+	}
+
+	std::size_t capacity() const
+		/// Returns the maximum number of elements the cache can hold.
+	{
+		return _capacity;
+	}
+
+	std::size_t shards() const
+		/// Returns the number of shards.
+	{
+		return _shardMask + 1;
+	}
+
+	std::set<TKey> getAllKeys() const
+		/// Returns a copy of all keys stored in the cache.
+	{
+		std::set<TKey> result;
+		for (std::size_t i = 0; i <= _shardMask; i++)
+		{
+			const Shard& shard = _pShards[i];
+			typename TMutex::ScopedLock lock(shard.mutex);
+			for (typename Map::const_iterator it = shard.map.begin(); it != shard.map.end(); ++it)
+			{
+				result.insert(it->first);
+			}
+		}
+		return result;
+	}
+
+private:
+	ShardedLRUCache(const ShardedLRUCache& aCache);
+	ShardedLRUCache& operator = (const ShardedLRUCache& aCache);
+
+	struct Node
+		/// A cache entry, stored in the hash table of its shard
+		/// and linked into the shard's recency list, most recently
+		/// used entry first.
+	{
+		Node(): pKey(0), pPrev(this), pNext(this)
+		{
+		}
+
+		SharedPtr<TValue> pValue;
+		const TKey*       pKey;
+		Node*             pPrev;
+		Node*             pNext;
+	};
+
+	typedef std::unordered_map<TKey, Node, THash> Map;
+
+	struct Shard
+	{
+		Shard(): capacity(0)
+		{
+		}
+
+		mutable TMutex mutex;
+		Map            map;
+		Node           head;
+		std::size_t    capacity;
+	};
+
+	Shard& shardFor(const TKey& key) const
+	{
+		Poco::UInt32 h = static_cast<Poco::UInt32>(_hash(key));
+		return _pShards[((h*2654435761U) >> 16) & _shardMask];
+	}
+
+	static void unlink(Node& node)
+	{
+		node.pPrev->pNext = node.pNext;
+		node.pNext->pPrev = node.pPrev;
+	}
+
+	static void linkFront(Shard& shard, Node& node)
+	{
+		node.pPrev = &shard.head;
+		node.pNext = shard.head.pNext;
+		shard.head.pNext->pPrev = &node;
+		shard.head.pNext = &node;
+	}
+
+	void insert(Shard& shard, const TKey& key, const SharedPtr<TValue>& val)
+	{
+		if (shard.map.size() >= shard.capacity)
+		{
+			Node* pLast = shard.head.pPrev;
+			if (_events) Remove.notify(this, *pLast->pKey);
+			unlink(*pLast);
+			typename Map::iterator it = shard.map.find(*pLast->pKey);
+			shard.map.erase(it);
+		}
+		std::pair<typename Map::iterator, bool> result = shard.map.insert(typename Map::value_type(key, Node()));
+		Node& node = result.first->second;
+		node.pKey = &result.first->first;
+		node.pValue = val;
+		linkFront(shard, node);
+	}
+
+	Shard*      _pShards;
+	std::size_t _shardMask;
+	std::size_t _capacity;
+	bool        _events;
+	THash       _hash;
+};
+
+
+} // namespace Poco
+
+
+#endif // Foundation_ShardedLRUCache_INCLUDED
@@ -0,0 +1,203 @@
+//
+// TimingWheel.h
+//
+// Library: Foundation
+// Package: Threading
+// Module:  TimingWheel
+//
+// Definition of the TimingWheel class.
+//
+// Copyright (c) 2004-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Foundation_TimingWheel_INCLUDED
+#define Foundation_TimingWheel_INCLUDED
+
+
+#include "Poco/Foundation.h"
+#include "Poco/Clock.h"
+#include <vector>
+
+
+namespace Poco {
+
+
+class Foundation_API TimingWheel
+	/// A hierarchical timing wheel, as described in "Hashed and
+	/// Hierarchical Timing Wheels" by Varghese and Lauck.
+	///
+	/// A TimingWheel keeps track of a large number of deadlines
+	/// with a fixed resolution (the tick). Scheduling and
+	/// cancelling an Entry take constant time, independent of
+	/// the number of scheduled entries, which makes the
+	/// TimingWheel well suited for things like per-connection
+	/// idle timeouts, which are rescheduled often and rarely
+	/// expire.
+	///
+	/// The wheel consists of four levels of 256 slots each, so
+	/// that deadlines up to 2^32 ticks in the future can be
+	/// represented directly. Deadlines farther in the future
+	/// are re-evaluated when the outermost level cascades.
+	/// Advancing the wheel skips over empty slots, so the cost
+	/// of advance() does not depend on the number of elapsed ticks.
+	///
+	/// An Entry never expires before its deadline, but may
+	/// expire up to one tick (plus the delay in calling
+	/// advance()) after it.
+	///
+	/// Entries are linked intrusively into the wheel, so the
+	/// TimingWheel never allocates memory. The TimingWheel does
+	/// not take ownership of its entries.
+	///
+	/// TimingWheel is not thread-safe. Synchronization, if required,
+	/// must be done by the user.
+{
+public:
+	class Foundation_API Entry
+		/// The base class for objects that can be
+		/// scheduled in a TimingWheel.
+		///
+		/// An Entry can be scheduled in at most one
+		/// TimingWheel at a time. It is automatically
+		/// cancelled when it is destroyed.
+	{
+	public:
+		Entry();
+			/// Creates the Entry.
+
+		virtual ~Entry();
+			/// Destroys the Entry, cancelling it if
+			/// it is scheduled.
+
+		bool isScheduled() const;
+			/// Returns true iff the Entry is currently
+			/// scheduled in a TimingWheel.
+
+	private:
+		Entry(const Entry&);
+		Entry& operator = (const Entry&);
+
+		Entry*       _pNext;
+		Entry**      _ppPrev;
+		TimingWheel* _pWheel;
+		Poco::UInt64 _tick;
+		int          _level;
+
+		friend class TimingWheel;
+	};
+
+	typedef std::vector<Entry*> EntryVec;
+
+	explicit TimingWheel(Clock::ClockDiff resolution = 1000);
+		/// Creates the TimingWheel, using the given resolution
+		/// (tick duration) in microseconds.
+
+	~TimingWheel();
+		/// Destroys the TimingWheel. All entries still
+		/// scheduled are cancelled.
+
+	void schedule(Entry& entry, const Clock& deadline);
+		/// Schedules the given entry to expire at the given deadline.
+		///
+		/// If the entry is already scheduled, its deadline
+		/// is changed. If the deadline lies in the past, the entry
+		/// expires in the next call to advance().
+
+	void cancel(Entry& entry);
+		/// Cancels the given entry. Does nothing if the
+		/// entry is not scheduled in this wheel.
+
+	void advance(const Clock& now, EntryVec& expired);
+		/// Advances the wheel to the given time, appending all
+		/// entries whose deadline has been reached to expired.
+		///
+		/// Expired entries are no longer scheduled and
+		/// may be rescheduled by the caller.
+
+	void clear(EntryVec& entries);
+		/// Cancels all scheduled entries, appending
+		/// them to the given vector.
+
+	Clock::ClockDiff timeout(const Clock& now) const;
+		/// Returns the time in microseconds after which
+		/// advance() should be called next, or -1 if no
+		/// entries are scheduled.
+		///
+		/// The returned value is never greater than the time
+		/// to the earliest deadline, but may be smaller if
+		/// entries must be moved between levels before.
+
+	Clock::ClockDiff resolution() const;
+		/// Returns the resolution (tick duration)
+		/// in microseconds.
+
+	std::size_t size() const;
+		/// Returns the number of scheduled entries.
+
+	bool empty() const;
+		/// Returns true iff no entries are scheduled.
+
+private:
+	TimingWheel(const TimingWheel&);
+	TimingWheel& operator = (const TimingWheel&);
+
+	enum
+	{
+		LEVELS    = 4,
+		SLOT_BITS = 8,
+		SLOTS     = 1 << SLOT_BITS,
+		SLOT_MASK = SLOTS - 1
+	};
+
+	Poco::UInt64 ticks(const Clock& clock, bool roundUp) const;
+	Poco::UInt64 nextTick() const;
+	void link(Entry& entry);
+	void unlink(Entry& entry);
+	void cascade(int level, int index);
+	void expire(Entry*& pList, EntryVec& expired);
+
+	Clock            _origin;
+	Clock::ClockDiff _resolution;
+	Poco::UInt64     _current;
+	std::size_t      _size;
+	std::size_t      _levelSize[LEVELS + 1];
+	Entry*           _slots[LEVELS][SLOTS];
+	Entry*           _pOverdue;
+};
+
+
+//
+// inlines
+//
+inline bool TimingWheel::Entry::isScheduled() const
+{
+	return _pWheel != 0;
+}
+
+
+inline Clock::ClockDiff TimingWheel::resolution() const
+{
+	return _resolution;
+}
+
+
+inline std::size_t TimingWheel::size() const
+{
+	return _size;
+}
+
+
+inline bool TimingWheel::empty() const
+{
+	return _size == 0;
+}
+
+
+} // namespace Poco
+
+
+#endif // Foundation_TimingWheel_INCLUDED
@@ -0,0 +1,167 @@
+//
+// WorkStealingThreadPool.h
+//
+// Library: Foundation
+// Package: Threading
+// Module:  WorkStealingThreadPool
+//
+// Definition of the WorkStealingThreadPool class.
+//
+// Copyright (c) 2004-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Foundation_WorkStealingThreadPool_INCLUDED
+#define Foundation_WorkStealingThreadPool_INCLUDED
+
+
+#include "Poco/Foundation.h"
+#include "Poco/Thread.h"
+#include "Poco/Mutex.h"
+#include "Poco/Condition.h"
+#include <vector>
+#include <atomic>
+
+
+namespace Poco {
+
+
+class Runnable;
+class WorkStealingThread;
+
+
+class Foundation_API WorkStealingThreadPool
+	/// A WorkStealingThreadPool is an alternative to ThreadPool
+	/// for workloads consisting of a large number of short-lived
+	/// tasks.
+	///
+	/// Unlike ThreadPool, which hands every Runnable to a single
+	/// idle thread and throws a NoThreadAvailableException if
+	/// there is none, a WorkStealingThreadPool runs a fixed number
+	/// of worker threads and queues an unbounded number of
+	/// Runnables.
+	///
+	/// Every worker thread owns a lock-free work-stealing deque
+	/// (Chase-Lev). Runnables started from within a worker thread
+	/// are pushed onto that worker's deque without any locking.
+	/// Runnables started from other threads are distributed
+	/// round-robin over small per-worker submission queues, so
+	/// that concurrent producers do not contend for a single lock.
+	/// A worker that runs out of work steals Runnables from the
+	/// other workers before going to sleep.
+	///
+	/// Runnables are executed in no particular order. As with
+	/// ThreadPool, the caller retains ownership of a Runnable,
+	/// which must stay alive until it has been executed.
+	/// Thread priorities and per-task thread names are not
+	/// supported, and, unlike PooledThread, a worker thread does
+	/// not clear its ThreadLocal storage between tasks.
+{
+public:
+	explicit WorkStealingThreadPool(int threads = 0, int stackSize = POCO_THREAD_STACK_SIZE);
+		/// Creates a WorkStealingThreadPool with the given number of
+		/// worker threads. If threads is 0, the number of worker
+		/// threads is equal to the number of processors.
+		/// Threads are created with the given stack size.
+
+	WorkStealingThreadPool(const std::string& name, int threads = 0, int stackSize = POCO_THREAD_STACK_SIZE);
+		/// Creates a WorkStealingThreadPool with the given name and
+		/// number of worker threads. If threads is 0, the number of
+		/// worker threads is equal to the number of processors.
+		/// Threads are created with the given stack size.
+
+	~WorkStealingThreadPool();
+		/// Stops all worker threads. Runnables that have
+		/// not been started yet are discarded.
+
+	int capacity() const;
+		/// Returns the number of worker threads.
+
+	int pending() const;
+		/// Returns the number of Runnables that have been started
+		/// but not yet completed.
+
+	void start(Runnable& target);
+		/// Queues the target for execution by one of the worker
+		/// threads. Never blocks and never throws a
+		/// NoThreadAvailableException.
+		///
+		/// Throws an InvalidAccessException if the pool
+		/// has been stopped.
+
+	void joinAll();
+		/// Waits until all queued Runnables have completed.
+		///
+		/// Must not be called from within a worker thread.
+
+	void stopAll();
+		/// Stops all worker threads and waits for their completion.
+		/// Runnables that are currently running are allowed to finish,
+		/// Runnables that have not been started yet are discarded.
+		///
+		/// If used, this method should be the last action before
+		/// the pool is deleted.
+
+	const std::string& name() const;
+		/// Returns the name of the pool, or an empty string
+		/// if no name has been specified in the constructor.
+
+	static WorkStealingThreadPool* current();
+		/// Returns the WorkStealingThreadPool the calling thread
+		/// belongs to, or null if the calling thread is not a
+		/// worker thread.
+
+protected:
+	void createThreads(int threads, int stackSize);
+	Runnable* steal(WorkStealingThread* pThief);
+	bool hasWork() const;
+	void wakeUp(WorkStealingThread* pPreferred);
+	void taskCompleted();
+
+private:
+	WorkStealingThreadPool(const WorkStealingThreadPool& pool);
+	WorkStealingThreadPool& operator = (const WorkStealingThreadPool& pool);
+
+	typedef std::vector<WorkStealingThread*> ThreadVec;
+
+	std::string _name;
+	ThreadVec _threads;
+	std::atomic<unsigned> _next;
+	std::atomic<int> _pending;
+	std::atomic<int> _sleeping;
+	std::atomic<bool> _stopped;
+	FastMutex _joinMutex;
+	Condition _joinCondition;
+
+	friend class WorkStealingThread;
+};
+
+
+//
+// inlines
+//
+inline int WorkStealingThreadPool::capacity() const
+{
+	return static_cast<int>(_threads.size());
+}
+
+
+inline int WorkStealingThreadPool::pending() const
+{
+	return _pending.load(std::memory_order_acquire);
+}
+
+
+inline const std::string& WorkStealingThreadPool::name() const
+{
+	return _name;
+}
+
+
+} // namespace Poco
+
+
+#endif // Foundation_WorkStealingThreadPool_INCLUDED
@@ -15,45 +15,86 @@
 #include "Poco/Base32Decoder.h"
 #include "Poco/Base32Encoder.h"
 #include "Poco/Exception.h"
-#include "Poco/Mutex.h"
 #include <cstring>
 
 
 namespace Poco {
 
 
-unsigned char Base32DecoderBuf::IN_ENCODING[256];
-bool Base32DecoderBuf::IN_ENCODING_INIT = false;
-
-
 namespace
 {
-	static FastMutex mutex;
-}
-
-
-Base32DecoderBuf::Base32DecoderBuf(std::istream& istr): 
-	_groupLength(0),
-	_groupIndex(0),
-	_buf(*istr.rdbuf())
-{
-	FastMutex::ScopedLock lock(mutex);
-	if (!IN_ENCODING_INIT)
+	struct InEncoding
 	{
-		for (unsigned i = 0; i < sizeof(IN_ENCODING); i++)
+		InEncoding(const unsigned char* outEncoding)
 		{
-			IN_ENCODING[i] = 0xFF;
+			for (unsigned i = 0; i < sizeof(table); i++)
+			{
+				table[i] = 0xFF;
+			}
+			for (unsigned i = 0; i < 32; i++)
+			{
+				table[outEncoding[i]] = static_cast<UInt8>(i);
+			}
+			table[static_cast<unsigned char>('=')] = '\0';
 		}
-		for (unsigned i = 0; i < sizeof(Base32EncoderBuf::OUT_ENCODING); i++)
+
+		unsigned char table[256];
+	};
+
+
+	std::size_t decodeBlock(const char* data, std::size_t length, unsigned char* buffer, const unsigned char* encoding)
+		/// Decodes the data group by group, like Base32DecoderBuf::readFromDevice().
+	{
+		const char* it  = data;
+		const char* end = data + length;
+		unsigned char* start = buffer;
+		while (it != end)
 		{
-			IN_ENCODING[Base32EncoderBuf::OUT_ENCODING[i]] = static_cast<UInt8>(i);
+			unsigned char chars[8];
+			std::memset(chars, '=', sizeof(chars));
+			int n = 0;
+			while (n < 8 && it != end)
+			{
+				chars[n] = static_cast<unsigned char>(*it++);
+				if (encoding[chars[n]] == 0xFF) throw DataFormatException();
+				++n;
+			}
+			// per RFC-4648, Section 6, permissible block lengths are:
+			// 2, 4, 5, 7, and 8 bytes. Any other length is malformed.
+			if (n == 1 || n == 3 || n == 6) throw DataFormatException();
+
+			buffer[0] = (encoding[chars[0]] << 3) | (encoding[chars[1]] >> 2);
+			buffer[1] = ((encoding[chars[1]] & 0x03) << 6) | (encoding[chars[2]] << 1) | (encoding[chars[3]] >> 4);
+			buffer[2] = ((encoding[chars[3]] & 0x0F) << 4) | (encoding[chars[4]] >> 1);
+			buffer[3] = ((encoding[chars[4]] & 0x01) << 7) | (encoding[chars[5]] << 2) | (encoding[chars[6]] >> 3);
+			buffer[4] = ((encoding[chars[6]] & 0x07) << 5) | encoding[chars[7]];
+
+			if (chars[2] == '=')
+				buffer += 1;
+			else if (chars[4] == '=')
+				buffer += 2;
+			else if (chars[5] == '=')
+				buffer += 3;
+			else if (chars[7] == '=')
+				buffer += 4;
+			else
+				buffer += 5;
 		}
-		IN_ENCODING[static_cast<unsigned char>('=')] = '\0';
-		IN_ENCODING_INIT = true;
+		return buffer - start;
 	}
 }
 
 
+Base32DecoderBuf::Base32DecoderBuf(std::istream& istr):
+	_groupLength(0),
+	_groupIndex(0),
+	_buf(*istr.rdbuf()),
+	_pInEncoding(inEncoding()),
+	_eof(false)
+{
+}
+
+
 Base32DecoderBuf::~Base32DecoderBuf()
 {
 }
@@ -77,35 +118,35 @@ int Base32DecoderBuf::readFromDevice()
 		do {
 			if ((c = readOne()) == -1) return -1;
 			buffer[0] = (unsigned char) c;
-			if (IN_ENCODING[buffer[0]] == 0xFF) throw DataFormatException();
+			if (_pInEncoding[buffer[0]] == 0xFF) throw DataFormatException();
 			if ((c = readOne()) == -1) throw DataFormatException();
 			buffer[1] = (unsigned char) c;
-			if (IN_ENCODING[buffer[1]] == 0xFF) throw DataFormatException();
+			if (_pInEncoding[buffer[1]] == 0xFF) throw DataFormatException();
 			if ((c = readOne()) == -1) break;
 			buffer[2] = (unsigned char) c;
-			if (IN_ENCODING[buffer[2]] == 0xFF) throw DataFormatException();
+			if (_pInEncoding[buffer[2]] == 0xFF) throw DataFormatException();
 			if ((c = readOne()) == -1) throw DataFormatException();
 			buffer[3] = (unsigned char) c;
-			if (IN_ENCODING[buffer[3]] == 0xFF) throw DataFormatException();
+			if (_pInEncoding[buffer[3]] == 0xFF) throw DataFormatException();
 			if ((c = readOne()) == -1) break;
 			buffer[4] = (unsigned char) c;
-			if (IN_ENCODING[buffer[4]] == 0xFF) throw DataFormatException();
+			if (_pInEncoding[buffer[4]] == 0xFF) throw DataFormatException();
 			if ((c = readOne()) == -1) break;
 			buffer[5] = (unsigned char) c;
-			if (IN_ENCODING[buffer[5]] == 0xFF) throw DataFormatException();
+			if (_pInEncoding[buffer[5]] == 0xFF) throw DataFormatException();
 			if ((c = readOne()) == -1) throw DataFormatException();
 			buffer[6] = (unsigned char) c;
-			if (IN_ENCODING[buffer[6]] == 0xFF) throw DataFormatException();
+			if (_pInEncoding[buffer[6]] == 0xFF) throw DataFormatException();
 			if ((c = readOne()) == -1) break;
 			buffer[7] = (unsigned char) c;
-			if (IN_ENCODING[buffer[7]] == 0xFF) throw DataFormatException();
+			if (_pInEncoding[buffer[7]] == 0xFF) throw DataFormatException();
 		} while (false);
 
-		_group[0] = (IN_ENCODING[buffer[0]] << 3) | (IN_ENCODING[buffer[1]] >> 2);
-		_group[1] = ((IN_ENCODING[buffer[1]] & 0x03) << 6) | (IN_ENCODING[buffer[2]] << 1) | (IN_ENCODING[buffer[3]] >> 4);
-		_group[2] = ((IN_ENCODING[buffer[3]] & 0x0F) << 4) | (IN_ENCODING[buffer[4]] >> 1);
-		_group[3] = ((IN_ENCODING[buffer[4]] & 0x01) << 7) | (IN_ENCODING[buffer[5]] << 2) | (IN_ENCODING[buffer[6]] >> 3);
-		_group[4] = ((IN_ENCODING[buffer[6]] & 0x07) << 5) | IN_ENCODING[buffer[7]];
+		_group[0] = (_pInEncoding[buffer[0]] << 3) | (_pInEncoding[buffer[1]] >> 2);
+		_group[1] = ((_pInEncoding[buffer[1]] & 0x03) << 6) | (_pInEncoding[buffer[2]] << 1) | (_pInEncoding[buffer[3]] >> 4);
+		_group[2] = ((_pInEncoding[buffer[3]] & 0x0F) << 4) | (_pInEncoding[buffer[4]] >> 1);
+		_group[3] = ((_pInEncoding[buffer[4]] & 0x01) << 7) | (_pInEncoding[buffer[5]] << 2) | (_pInEncoding[buffer[6]] >> 3);
+		_group[4] = ((_pInEncoding[buffer[6]] & 0x07) << 5) | _pInEncoding[buffer[7]];
 
 		if (buffer[2] == '=')
 			_groupLength = 1;
@@ -125,11 +166,67 @@ int Base32DecoderBuf::readFromDevice()
 
 int Base32DecoderBuf::readOne()
 {
+	if (_eof) return std::char_traits<char>::eof();
 	int ch = _buf.sbumpc();
+	if (ch == std::char_traits<char>::eof()) _eof = true;
 	return ch;
 }
 
 
+std::streamsize Base32DecoderBuf::xsgetn(char* p, std::streamsize count)
+{
+	static const int eof = std::char_traits<char>::eof();
+
+	// The first character, which may have been put back,
+	// the rest of the current group and the last incomplete
+	// group are read with uflow().
+	std::streamsize copied = 0;
+	bool bulk = true;
+	while (copied < count)
+	{
+		if (bulk && copied > 0 && _groupIndex == _groupLength && count - copied >= 5)
+		{
+			std::streamsize groups = (count - copied)/5;
+			if (groups > BUFFER_GROUPS) groups = BUFFER_GROUPS;
+			std::streamsize n = readGroups(p + copied, groups);
+			copied += n;
+			// Fewer bytes mean that the end of the data or
+			// padding has been reached.
+			if (n < 5*groups) bulk = false;
+			continue;
+		}
+		int c = uflow();
+		if (c == eof) break;
+		p[copied++] = static_cast<char>(c);
+	}
+	return copied;
+}
+
+
+std::streamsize Base32DecoderBuf::readGroups(char* p, std::streamsize groups)
+{
+	static const int eof = std::char_traits<char>::eof();
+
+	char buffer[8*BUFFER_GROUPS];
+	std::streamsize n = 0;
+	while (n < 8*groups)
+	{
+		int c = readOne();
+		if (c == eof) break;
+		buffer[n++] = static_cast<char>(c);
+	}
+	return static_cast<std::streamsize>(decodeBlock(buffer, static_cast<std::size_t>(n), reinterpret_cast<unsigned char*>(p), _pInEncoding));
+}
+
+
+const unsigned char* Base32DecoderBuf::inEncoding()
+{
+	static const InEncoding inEncoding(Base32EncoderBuf::OUT_ENCODING);
+
+	return inEncoding.table;
+}
+
+
 Base32DecoderIOS::Base32DecoderIOS(std::istream& istr): _buf(istr)
 {
 	poco_ios_init(&_buf);
@@ -157,4 +254,27 @@ Base32Decoder::~Base32Decoder()
 }
 
 
+std::size_t Base32Decoder::decode(const char* data, std::size_t length, void* buffer)
+{
+	return decodeBlock(data, length, static_cast<unsigned char*>(buffer), Base32DecoderBuf::inEncoding());
+}
+
+
+std::string Base32Decoder::decode(const std::string& data)
+{
+	std::string result(decodedLength(data.size()), '\0');
+	if (!result.empty())
+	{
+		result.resize(decode(data.data(), data.size(), &result[0]));
+	}
+	return result;
+}
+
+
+std::size_t Base32Decoder::decodedLength(std::size_t length)
+{
+	return (length + 7)/8*5;
+}
+
+
 } // namespace Poco
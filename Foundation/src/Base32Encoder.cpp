@@ -27,6 +27,51 @@ const unsigned char Base32EncoderBuf::OUT_ENCODING[32] =
 };
 
 
+namespace
+{
+	std::size_t encodeBlock(const unsigned char* data, std::size_t length, char* buffer, const unsigned char* encoding, bool padding)
+	{
+		char* start = buffer;
+		std::size_t i = 0;
+		for (; i + 5 <= length; i += 5)
+		{
+			UInt64 group = (UInt64(data[i]) << 32) | (UInt64(data[i + 1]) << 24) | (UInt64(data[i + 2]) << 16) | (UInt64(data[i + 3]) << 8) | data[i + 4];
+			for (int j = 7; j >= 0; j--)
+			{
+				buffer[j] = encoding[group & 0x1F];
+				group >>= 5;
+			}
+			buffer += 8;
+		}
+		std::size_t rest = length - i;
+		if (rest > 0)
+		{
+			// encode the last bytes, padded with zero bits
+			static const int chars[5] = {0, 2, 4, 5, 7};
+			UInt64 group = 0;
+			for (std::size_t j = 0; j < 5; j++)
+			{
+				group = (group << 8) | (j < rest ? data[i + j] : 0);
+			}
+			char tmp[8];
+			for (int j = 7; j >= 0; j--)
+			{
+				tmp[j] = encoding[group & 0x1F];
+				group >>= 5;
+			}
+			for (int j = 0; j < 8; j++)
+			{
+				if (j < chars[rest])
+					*buffer++ = tmp[j];
+				else if (padding)
+					*buffer++ = '=';
+			}
+		}
+		return buffer - start;
+	}
+}
+
+
 Base32EncoderBuf::Base32EncoderBuf(std::ostream& ostr, bool padding): 
 	_groupLength(0),
 	_buf(*ostr.rdbuf()),
@@ -78,6 +123,34 @@ int Base32EncoderBuf::writeToDevice(char c)
 }
 
 
+std::streamsize Base32EncoderBuf::xsputn(const char* s, std::streamsize count)
+{
+	static const int eof = std::char_traits<char>::eof();
+
+	std::streamsize written = 0;
+	while (_groupLength > 0 && written < count)
+	{
+		if (writeToDevice(s[written]) == eof) return written;
+		++written;
+	}
+	char buffer[8*BUFFER_GROUPS];
+	while (count - written >= 5)
+	{
+		std::streamsize groups = (count - written)/5;
+		if (groups > BUFFER_GROUPS) groups = BUFFER_GROUPS;
+		std::streamsize n = static_cast<std::streamsize>(encodeBlock(reinterpret_cast<const unsigned char*>(s + written), static_cast<std::size_t>(5*groups), buffer, OUT_ENCODING, _doPadding));
+		if (_buf.sputn(buffer, n) != n) return written;
+		written += 5*groups;
+	}
+	while (written < count)
+	{
+		if (writeToDevice(s[written]) == eof) return written;
+		++written;
+	}
+	return written;
+}
+
+
 int Base32EncoderBuf::close()
 {
 	static const int eof = std::char_traits<char>::eof();
@@ -199,4 +272,35 @@ Base32Encoder::~Base32Encoder()
 }
 
 
+std::size_t Base32Encoder::encode(const void* data, std::size_t length, char* buffer, bool padding)
+{
+	return encodeBlock(static_cast<const unsigned char*>(data), length, buffer, Base32EncoderBuf::OUT_ENCODING, padding);
+}
+
+
+std::string Base32Encoder::encode(const std::string& data, bool padding)
+{
+	std::string result(encodedLength(data.size(), padding), '\0');
+	if (!result.empty())
+	{
+		encode(data.data(), data.size(), &result[0], padding);
+	}
+	return result;
+}
+
+
+std::size_t Base32Encoder::encodedLength(std::size_t length, bool padding)
+{
+	if (padding)
+	{
+		return (length + 4)/5*8;
+	}
+	else
+	{
+		static const std::size_t tail[5] = {0, 2, 4, 5, 7};
+		return length/5*8 + tail[length % 5];
+	}
+}
+
+
 } // namespace Poco
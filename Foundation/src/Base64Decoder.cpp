@@ -15,67 +15,172 @@
 #include "Poco/Base64Decoder.h"
 #include "Poco/Base64Encoder.h"
 #include "Poco/Exception.h"
-#include "Poco/Mutex.h"
+#include <cstring>
 
 
-namespace Poco {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define POCO_BASE64_SSSE3
+#define POCO_BASE64_SSSE3_TARGET __attribute__((target("ssse3")))
+#include <tmmintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define POCO_BASE64_SSSE3
+#define POCO_BASE64_SSSE3_TARGET
+#include <intrin.h>
+#include <tmmintrin.h>
+#endif
 
 
-unsigned char Base64DecoderBuf::IN_ENCODING[256];
-bool Base64DecoderBuf::IN_ENCODING_INIT = false;
-unsigned char Base64DecoderBuf::IN_ENCODING_URL[256];
-bool Base64DecoderBuf::IN_ENCODING_URL_INIT = false;
+namespace Poco {
 
 
 namespace
 {
-	static FastMutex mutex;
-}
-
-
-Base64DecoderBuf::Base64DecoderBuf(std::istream& istr, int options):
-	_options(options),
-	_groupLength(0),
-	_groupIndex(0),
-	_buf(*istr.rdbuf()),
-	_pInEncoding((options & BASE64_URL_ENCODING) ? IN_ENCODING_URL : IN_ENCODING)
-{
-	FastMutex::ScopedLock lock(mutex);
-	if (options & BASE64_URL_ENCODING)
+	struct InEncoding
 	{
-		if (!IN_ENCODING_URL_INIT)
+		InEncoding(const unsigned char* outEncoding)
 		{
-			for (unsigned i = 0; i < sizeof(IN_ENCODING_URL); i++)
+			for (unsigned i = 0; i < sizeof(table); i++)
 			{
-				IN_ENCODING_URL[i] = 0xFF;
+				table[i] = 0xFF;
 			}
-			for (unsigned i = 0; i < sizeof(Base64EncoderBuf::OUT_ENCODING_URL); i++)
+			for (unsigned i = 0; i < 64; i++)
 			{
-				IN_ENCODING_URL[Base64EncoderBuf::OUT_ENCODING_URL[i]] = static_cast<UInt8>(i);
+				table[outEncoding[i]] = static_cast<UInt8>(i);
 			}
-			IN_ENCODING_URL[static_cast<unsigned char>('=')] = '\0';
-			IN_ENCODING_URL_INIT = true;
+			table[static_cast<unsigned char>('=')] = '\0';
 		}
+
+		unsigned char table[256];
+	};
+
+
+#if defined(POCO_BASE64_SSSE3)
+
+	bool hasSSSE3()
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+		return (info[2] & (1 << 9)) != 0;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("ssse3") != 0;
+#endif
 	}
-	else
+
+
+	const bool HAVE_SSSE3 = hasSSSE3();
+
+
+	POCO_BASE64_SSSE3_TARGET
+	bool decodeSSSE3(const char* data, char* buffer, char c62, char c63)
+		/// Decodes sixteen characters to twelve bytes. Returns false,
+		/// without writing anything, if the characters contain anything
+		/// else than the 64 characters of the alphabet (e.g., padding
+		/// or whitespace).
+	{
+		const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+		// characters >= 0x80 are negative and fail all range checks
+		const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('A' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('Z' + 1), in));
+		const __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('a' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), in));
+		const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('0' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), in));
+		const __m128i is62  = _mm_cmpeq_epi8(in, _mm_set1_epi8(c62));
+		const __m128i is63  = _mm_cmpeq_epi8(in, _mm_set1_epi8(c63));
+		const __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, _mm_or_si128(is62, is63)));
+		if (_mm_movemask_epi8(valid) != 0xFFFF) return false;
+
+		__m128i shift = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+		shift = _mm_or_si128(shift, _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+		shift = _mm_or_si128(shift, _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+		shift = _mm_or_si128(shift, _mm_and_si128(is62, _mm_set1_epi8(static_cast<char>(62 - c62))));
+		shift = _mm_or_si128(shift, _mm_and_si128(is63, _mm_set1_epi8(static_cast<char>(63 - c63))));
+		const __m128i values = _mm_add_epi8(in, shift);
+
+		// merge four 6-bit values into 24 bits, then reorder the bytes
+		const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+		const __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+		const __m128i out = _mm_shuffle_epi8(groups, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+		char tmp[16];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(tmp), out);
+		std::memcpy(buffer, tmp, 12);
+		return true;
+	}
+
+#endif
+
+
+	inline bool isBase64Space(char c)
+	{
+		return c == ' ' || c == '\r' || c == '\t' || c == '\n';
+	}
+
+
+	std::size_t decodeBlock(const char* data, std::size_t length, unsigned char* buffer, const unsigned char* encoding, int options)
+		/// Decodes the data group by group, like Base64DecoderBuf::readFromDevice().
 	{
-		if (!IN_ENCODING_INIT)
+		const bool skipSpace = !(options & BASE64_URL_ENCODING);
+#if defined(POCO_BASE64_SSSE3)
+		const char c62 = (options & BASE64_URL_ENCODING) ? '-' : '+';
+		const char c63 = (options & BASE64_URL_ENCODING) ? '_' : '/';
+#endif
+		const char* it  = data;
+		const char* end = data + length;
+		unsigned char* start = buffer;
+		while (it != end)
 		{
-			for (unsigned i = 0; i < sizeof(IN_ENCODING); i++)
+#if defined(POCO_BASE64_SSSE3)
+			if (HAVE_SSSE3)
 			{
-				IN_ENCODING[i] = 0xFF;
+				while (end - it >= 16 && decodeSSSE3(it, reinterpret_cast<char*>(buffer), c62, c63))
+				{
+					it += 16;
+					buffer += 12;
+				}
+				if (it == end) break;
 			}
-			for (unsigned i = 0; i < sizeof(Base64EncoderBuf::OUT_ENCODING); i++)
+#endif
+			// decode a single group, skipping whitespace
+			unsigned char chars[4];
+			int n = 0;
+			while (n < 4 && it != end)
 			{
-				IN_ENCODING[Base64EncoderBuf::OUT_ENCODING[i]] = static_cast<UInt8>(i);
+				char c = *it++;
+				if (skipSpace && isBase64Space(c)) continue;
+				if (encoding[static_cast<unsigned char>(c)] == 0xFF) throw DataFormatException();
+				chars[n++] = static_cast<unsigned char>(c);
 			}
-			IN_ENCODING[static_cast<unsigned char>('=')] = '\0';
-			IN_ENCODING_INIT = true;
+			if (n < 2) break;
+			if (n < 4)
+			{
+				if (!(options & BASE64_NO_PADDING)) throw DataFormatException();
+				while (n < 4) chars[n++] = '=';
+			}
+			buffer[0] = (encoding[chars[0]] << 2) | (encoding[chars[1]] >> 4);
+			buffer[1] = ((encoding[chars[1]] & 0x0F) << 4) | (encoding[chars[2]] >> 2);
+			buffer[2] = (encoding[chars[2]] << 6) | encoding[chars[3]];
+			if (chars[2] == '=')
+				buffer += 1;
+			else if (chars[3] == '=')
+				buffer += 2;
+			else
+				buffer += 3;
 		}
+		return buffer - start;
 	}
 }
 
 
+Base64DecoderBuf::Base64DecoderBuf(std::istream& istr, int options):
+	_options(options),
+	_groupLength(0),
+	_groupIndex(0),
+	_buf(*istr.rdbuf()),
+	_pInEncoding(inEncoding(options)),
+	_eof(false)
+{
+}
+
+
 Base64DecoderBuf::~Base64DecoderBuf()
 {
 }
@@ -138,16 +243,73 @@ int Base64DecoderBuf::readFromDevice()
 
 int Base64DecoderBuf::readOne()
 {
+	if (_eof) return std::char_traits<char>::eof();
 	int ch = _buf.sbumpc();
 	if (!(_options & BASE64_URL_ENCODING))
 	{
 		while (ch == ' ' || ch == '\r' || ch == '\t' || ch == '\n')
 			ch = _buf.sbumpc();
 	}
+	if (ch == std::char_traits<char>::eof()) _eof = true;
 	return ch;
 }
 
 
+std::streamsize Base64DecoderBuf::xsgetn(char* p, std::streamsize count)
+{
+	static const int eof = std::char_traits<char>::eof();
+
+	// The first character, which may have been put back,
+	// the rest of the current group and the last incomplete
+	// group are read with uflow().
+	std::streamsize copied = 0;
+	bool bulk = true;
+	while (copied < count)
+	{
+		if (bulk && copied > 0 && _groupIndex == _groupLength && count - copied >= 3)
+		{
+			std::streamsize groups = (count - copied)/3;
+			if (groups > BUFFER_GROUPS) groups = BUFFER_GROUPS;
+			std::streamsize n = readGroups(p + copied, groups);
+			copied += n;
+			// Fewer bytes mean that the end of the data or
+			// padding has been reached.
+			if (n < 3*groups) bulk = false;
+			continue;
+		}
+		int c = uflow();
+		if (c == eof) break;
+		p[copied++] = static_cast<char>(c);
+	}
+	return copied;
+}
+
+
+std::streamsize Base64DecoderBuf::readGroups(char* p, std::streamsize groups)
+{
+	static const int eof = std::char_traits<char>::eof();
+
+	char buffer[4*BUFFER_GROUPS];
+	std::streamsize n = 0;
+	while (n < 4*groups)
+	{
+		int c = readOne();
+		if (c == eof) break;
+		buffer[n++] = static_cast<char>(c);
+	}
+	return static_cast<std::streamsize>(decodeBlock(buffer, static_cast<std::size_t>(n), reinterpret_cast<unsigned char*>(p), _pInEncoding, _options));
+}
+
+
+const unsigned char* Base64DecoderBuf::inEncoding(int options)
+{
+	static const InEncoding inEncoding(Base64EncoderBuf::OUT_ENCODING);
+	static const InEncoding inEncodingURL(Base64EncoderBuf::OUT_ENCODING_URL);
+
+	return (options & BASE64_URL_ENCODING) ? inEncodingURL.table : inEncoding.table;
+}
+
+
 Base64DecoderIOS::Base64DecoderIOS(std::istream& istr, int options): _buf(istr, options)
 {
 	poco_ios_init(&_buf);
@@ -175,4 +337,27 @@ Base64Decoder::~Base64Decoder()
 }
 
 
+std::size_t Base64Decoder::decode(const char* data, std::size_t length, void* buffer, int options)
+{
+	return decodeBlock(data, length, static_cast<unsigned char*>(buffer), Base64DecoderBuf::inEncoding(options), options);
+}
+
+
+std::string Base64Decoder::decode(const std::string& data, int options)
+{
+	std::string result(decodedLength(data.size()), '\0');
+	if (!result.empty())
+	{
+		result.resize(decode(data.data(), data.size(), &result[0], options));
+	}
+	return result;
+}
+
+
+std::size_t Base64Decoder::decodedLength(std::size_t length)
+{
+	return (length + 3)/4*3;
+}
+
+
 } // namespace Poco
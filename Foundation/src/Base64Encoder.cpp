@@ -15,9 +15,123 @@
 #include "Poco/Base64Encoder.h"
 
 
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define POCO_BASE64_SSSE3
+#define POCO_BASE64_SSSE3_TARGET __attribute__((target("ssse3")))
+#include <tmmintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define POCO_BASE64_SSSE3
+#define POCO_BASE64_SSSE3_TARGET
+#include <intrin.h>
+#include <tmmintrin.h>
+#endif
+
+
 namespace Poco {
 
 
+namespace
+{
+#if defined(POCO_BASE64_SSSE3)
+
+	bool hasSSSE3()
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+		return (info[2] & (1 << 9)) != 0;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("ssse3") != 0;
+#endif
+	}
+
+
+	const bool HAVE_SSSE3 = hasSSSE3();
+
+
+	POCO_BASE64_SSSE3_TARGET
+	std::size_t encodeSSSE3(const unsigned char* data, std::size_t length, char* buffer, const unsigned char* encoding)
+		/// Encodes groups of twelve bytes, as long as sixteen bytes
+		/// can be loaded, and returns the number of bytes encoded.
+		/// See Wojciech Mula, Daniel Lemire: Faster Base64 Encoding
+		/// and Decoding Using AVX2 Instructions (2018).
+	{
+		const __m128i shuffle = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+		const __m128i offsets = _mm_setr_epi8(
+			'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, '0' - 52, '0' - 52, static_cast<char>(encoding[62] - 62), static_cast<char>(encoding[63] - 63), 'A', 0, 0);
+		std::size_t i = 0;
+		for (; i + 16 <= length; i += 12)
+		{
+			__m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+			in = _mm_shuffle_epi8(in, shuffle);
+			// split each group of three bytes into four 6-bit indices
+			const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+			const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+			const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+			const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+			const __m128i indices = _mm_or_si128(t1, t3);
+			// map the ranges 0..25, 26..51, 52..61, 62 and 63
+			// to an offset added to the index
+			__m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+			const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+			range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+			const __m128i out = _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, range));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(buffer), out);
+			buffer += 16;
+		}
+		return i;
+	}
+
+#endif
+
+
+	std::size_t encodeBlock(const unsigned char* data, std::size_t length, char* buffer, const unsigned char* encoding, int options)
+	{
+		char* start = buffer;
+		std::size_t i = 0;
+#if defined(POCO_BASE64_SSSE3)
+		if (HAVE_SSSE3 && length >= 16)
+		{
+			i = encodeSSSE3(data, length, buffer, encoding);
+			buffer += i/3*4;
+		}
+#endif
+		for (; i + 3 <= length; i += 3)
+		{
+			UInt32 group = (UInt32(data[i]) << 16) | (UInt32(data[i + 1]) << 8) | data[i + 2];
+			buffer[0] = encoding[group >> 18];
+			buffer[1] = encoding[(group >> 12) & 0x3F];
+			buffer[2] = encoding[(group >> 6) & 0x3F];
+			buffer[3] = encoding[group & 0x3F];
+			buffer += 4;
+		}
+		if (i + 1 == length)
+		{
+			*buffer++ = encoding[data[i] >> 2];
+			*buffer++ = encoding[(data[i] & 0x03) << 4];
+			if (!(options & BASE64_NO_PADDING))
+			{
+				*buffer++ = '=';
+				*buffer++ = '=';
+			}
+		}
+		else if (i + 2 == length)
+		{
+			*buffer++ = encoding[data[i] >> 2];
+			*buffer++ = encoding[((data[i] & 0x03) << 4) | (data[i + 1] >> 4)];
+			*buffer++ = encoding[(data[i + 1] & 0x0F) << 2];
+			if (!(options & BASE64_NO_PADDING))
+			{
+				*buffer++ = '=';
+			}
+		}
+		return buffer - start;
+	}
+}
+
+
 const unsigned char Base64EncoderBuf::OUT_ENCODING[64] =
 {
 	'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H',
@@ -108,6 +222,47 @@ int Base64EncoderBuf::writeToDevice(char c)
 }
 
 
+std::streamsize Base64EncoderBuf::xsputn(const char* s, std::streamsize count)
+{
+	static const int eof = std::char_traits<char>::eof();
+
+	std::streamsize written = 0;
+	while (_groupLength > 0 && written < count)
+	{
+		if (writeToDevice(s[written]) == eof) return written;
+		++written;
+	}
+	char buffer[4*BUFFER_GROUPS];
+	while (count - written >= 3)
+	{
+		std::streamsize groups = (count - written)/3;
+		if (groups > BUFFER_GROUPS) groups = BUFFER_GROUPS;
+		if (_lineLength > 0)
+		{
+			// a line break follows the group reaching the line length
+			std::streamsize lineGroups = (_lineLength - _pos + 3)/4;
+			if (lineGroups < 1) lineGroups = 1;
+			if (groups > lineGroups) groups = lineGroups;
+		}
+		std::streamsize n = static_cast<std::streamsize>(encodeBlock(reinterpret_cast<const unsigned char*>(s + written), static_cast<std::size_t>(3*groups), buffer, _pOutEncoding, _options));
+		if (_buf.sputn(buffer, n) != n) return written;
+		written += 3*groups;
+		_pos += static_cast<int>(n);
+		if (_lineLength > 0 && _pos >= _lineLength)
+		{
+			if (_buf.sputn("\r\n", 2) != 2) return written;
+			_pos = 0;
+		}
+	}
+	while (written < count)
+	{
+		if (writeToDevice(s[written]) == eof) return written;
+		++written;
+	}
+	return written;
+}
+
+
 int Base64EncoderBuf::close()
 {
 	static const int eof = std::char_traits<char>::eof();
@@ -180,4 +335,33 @@ Base64Encoder::~Base64Encoder()
 }
 
 
+std::size_t Base64Encoder::encode(const void* data, std::size_t length, char* buffer, int options)
+{
+	const unsigned char* encoding = (options & BASE64_URL_ENCODING) ? Base64EncoderBuf::OUT_ENCODING_URL : Base64EncoderBuf::OUT_ENCODING;
+	return encodeBlock(static_cast<const unsigned char*>(data), length, buffer, encoding, options);
+}
+
+
+std::string Base64Encoder::encode(const std::string& data, int options)
+{
+	std::string result(encodedLength(data.size(), options), '\0');
+	if (!result.empty())
+	{
+		encode(data.data(), data.size(), &result[0], options);
+	}
+	return result;
+}
+
+
+std::size_t Base64Encoder::encodedLength(std::size_t length, int options)
+{
+	if (options & BASE64_NO_PADDING)
+	{
+		static const std::size_t tail[3] = {0, 2, 3};
+		return length/3*4 + tail[length % 3];
+	}
+	else return (length + 2)/3*4;
+}
+
+
 } // namespace Poco
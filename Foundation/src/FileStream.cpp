@@ -58,6 +58,12 @@ FileStreamBuf* FileIOS::rdbuf()
 }
 
 
+FileIOS::NativeHandle FileIOS::nativeHandle() const
+{
+	return _buf.nativeHandle();
+}
+
+
 FileInputStream::FileInputStream():
 	FileIOS(std::ios::in),
 	std::istream(&_buf)
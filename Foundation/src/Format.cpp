@@ -15,6 +15,7 @@
 #include "Poco/Format.h"
 #include "Poco/Exception.h"
 #include "Poco/Ascii.h"
+#include "Poco/NumericString.h"
 #include <sstream>
 #if !defined(POCO_NO_LOCALE)
 #include <locale>
@@ -27,7 +28,14 @@ namespace Poco {
 
 namespace
 {
-	void parseFlags(std::ostream& str, std::string::const_iterator& itFmt, const std::string::const_iterator& endFmt)
+	const Any& nextValue(std::vector<Any>::const_iterator& itVal, const std::vector<Any>::const_iterator& endVal)
+	{
+		if (itVal == endVal) throw BadCastException("missing format argument");
+		return *itVal++;
+	}
+
+
+	void parseFlags(std::ostream& str, const char*& itFmt, const char* endFmt)
 	{
 		bool isFlag = true;
 		while (isFlag && itFmt != endFmt)
@@ -44,13 +52,13 @@ namespace
 	}
 
 
-	void parseWidth(std::ostream& str, std::string::const_iterator& itFmt, const std::string::const_iterator& endFmt, std::vector<Any>::const_iterator& itVal)
+	void parseWidth(std::ostream& str, const char*& itFmt, const char* endFmt, std::vector<Any>::const_iterator& itVal, const std::vector<Any>::const_iterator& endVal)
 	{
 		int width = 0;
 		if (itFmt != endFmt && *itFmt == '*')
 		{
 			++itFmt;
-			width = AnyCast<int>(*itVal++);
+			width = AnyCast<int>(nextValue(itVal, endVal));
 		}
 		else
 		{
@@ -64,7 +72,7 @@ namespace
 	}
 	
 	
-	void parsePrec(std::ostream& str, std::string::const_iterator& itFmt, const std::string::const_iterator& endFmt, std::vector<Any>::const_iterator& itVal)
+	void parsePrec(std::ostream& str, const char*& itFmt, const char* endFmt, std::vector<Any>::const_iterator& itVal, const std::vector<Any>::const_iterator& endVal)
 	{
 		if (itFmt != endFmt && *itFmt == '.')
 		{
@@ -73,7 +81,7 @@ namespace
 			if (itFmt != endFmt && *itFmt == '*')
 			{
 				++itFmt;
-				prec = AnyCast<int>(*itVal++);
+				prec = AnyCast<int>(nextValue(itVal, endVal));
 			}
 			else
 			{
@@ -87,7 +95,7 @@ namespace
 		}
 	}
 	
-	char parseMod(std::string::const_iterator& itFmt, const std::string::const_iterator& endFmt)
+	char parseMod(const char*& itFmt, const char* endFmt)
 	{
 		char mod = 0;
 		if (itFmt != endFmt)
@@ -103,7 +111,7 @@ namespace
 		return mod;
 	}
 	
-	std::size_t parseIndex(std::string::const_iterator& itFmt, const std::string::const_iterator& endFmt)
+	std::size_t parseIndex(const char*& itFmt, const char* endFmt)
 	{
 		int index = 0;
 		while (itFmt != endFmt && Ascii::isDigit(*itFmt))
@@ -160,7 +168,7 @@ namespace
 	}
 
 
-	void formatOne(std::string& result, std::string::const_iterator& itFmt, const std::string::const_iterator& endFmt, std::vector<Any>::const_iterator& itVal)
+	void formatOne(std::string& result, const char*& itFmt, const char* endFmt, std::vector<Any>::const_iterator& itVal, const std::vector<Any>::const_iterator& endVal)
 	{
 		std::ostringstream str;
 #if !defined(POCO_NO_LOCALE)
@@ -169,8 +177,8 @@ namespace
 		try
 		{
 			parseFlags(str, itFmt, endFmt);
-			parseWidth(str, itFmt, endFmt, itVal);
-			parsePrec(str, itFmt, endFmt, itVal);
+			parseWidth(str, itFmt, endFmt, itVal, endVal);
+			parsePrec(str, itFmt, endFmt, itVal, endVal);
 			char mod = parseMod(itFmt, endFmt);
 			if (itFmt != endFmt)
 			{
@@ -179,20 +187,20 @@ namespace
 				switch (type)
 				{
 				case 'b':
-					str << AnyCast<bool>(*itVal++);
+					str << AnyCast<bool>(nextValue(itVal, endVal));
 					break;
 				case 'c':
-					str << AnyCast<char>(*itVal++);
+					str << AnyCast<char>(nextValue(itVal, endVal));
 					break;
 				case 'd':
 				case 'i':
 					switch (mod)
 					{
-					case 'l': str << AnyCast<long>(*itVal++); break;
-					case 'L': str << AnyCast<Int64>(*itVal++); break;
-					case 'h': str << AnyCast<short>(*itVal++); break;
-					case '?': writeAnyInt(str, *itVal++); break;
-					default:  str << AnyCast<int>(*itVal++); break;
+					case 'l': str << AnyCast<long>(nextValue(itVal, endVal)); break;
+					case 'L': str << AnyCast<Int64>(nextValue(itVal, endVal)); break;
+					case 'h': str << AnyCast<short>(nextValue(itVal, endVal)); break;
+					case '?': writeAnyInt(str, nextValue(itVal, endVal)); break;
+					default:  str << AnyCast<int>(nextValue(itVal, endVal)); break;
 					}
 					break;
 				case 'o':
@@ -201,11 +209,11 @@ namespace
 				case 'X':
 					switch (mod)
 					{
-					case 'l': str << AnyCast<unsigned long>(*itVal++); break;
-					case 'L': str << AnyCast<UInt64>(*itVal++); break;
-					case 'h': str << AnyCast<unsigned short>(*itVal++); break;
-					case '?': writeAnyInt(str, *itVal++); break;
-					default:  str << AnyCast<unsigned>(*itVal++); break;
+					case 'l': str << AnyCast<unsigned long>(nextValue(itVal, endVal)); break;
+					case 'L': str << AnyCast<UInt64>(nextValue(itVal, endVal)); break;
+					case 'h': str << AnyCast<unsigned short>(nextValue(itVal, endVal)); break;
+					case '?': writeAnyInt(str, nextValue(itVal, endVal)); break;
+					default:  str << AnyCast<unsigned>(nextValue(itVal, endVal)); break;
 					}
 					break;
 				case 'e':
@@ -213,17 +221,17 @@ namespace
 				case 'f':
 					switch (mod)
 					{
-					case 'l': str << AnyCast<long double>(*itVal++); break;
-					case 'L': str << AnyCast<long double>(*itVal++); break;
-					case 'h': str << AnyCast<float>(*itVal++); break;
-					default:  str << AnyCast<double>(*itVal++); break;
+					case 'l': str << AnyCast<long double>(nextValue(itVal, endVal)); break;
+					case 'L': str << AnyCast<long double>(nextValue(itVal, endVal)); break;
+					case 'h': str << AnyCast<float>(nextValue(itVal, endVal)); break;
+					default:  str << AnyCast<double>(nextValue(itVal, endVal)); break;
 					}
 					break;
 				case 's':
-					str << RefAnyCast<std::string>(*itVal++);
+					str << RefAnyCast<std::string>(nextValue(itVal, endVal));
 					break;
 				case 'z':
-					str << AnyCast<std::size_t>(*itVal++); 
+					str << AnyCast<std::size_t>(nextValue(itVal, endVal)); 
 					break;
 				case 'I':
 				case 'D':
@@ -238,13 +246,371 @@ namespace
 		}
 		result.append(str.str());
 	}
+
+
+	void parseSpec(const char*& itFmt, const char* endFmt, Impl::FormatSpec& spec)
+		/// Parses flags, width, precision, modifier and type
+		/// the same way as formatOne() does.
+	{
+		spec.left = false;
+		spec.showSign = false;
+		spec.zero = false;
+		spec.showBase = false;
+		bool isFlag = true;
+		while (isFlag && itFmt != endFmt)
+		{
+			switch (*itFmt)
+			{
+			case '-': spec.left = true; ++itFmt; break;
+			case '+': spec.showSign = true; ++itFmt; break;
+			case '0': spec.zero = true; ++itFmt; break;
+			case '#': spec.showBase = true; ++itFmt; break;
+			default:  isFlag = false; break;
+			}
+		}
+		spec.width = 0;
+		spec.widthArg = false;
+		if (itFmt != endFmt && *itFmt == '*')
+		{
+			spec.widthArg = true;
+			++itFmt;
+		}
+		else
+		{
+			while (itFmt != endFmt && Ascii::isDigit(*itFmt))
+			{
+				spec.width = 10*spec.width + *itFmt - '0';
+				++itFmt;
+			}
+		}
+		spec.precision = 0;
+		spec.hasPrecision = false;
+		spec.precisionArg = false;
+		if (itFmt != endFmt && *itFmt == '.')
+		{
+			spec.hasPrecision = true;
+			++itFmt;
+			if (itFmt != endFmt && *itFmt == '*')
+			{
+				spec.precisionArg = true;
+				++itFmt;
+			}
+			else
+			{
+				while (itFmt != endFmt && Ascii::isDigit(*itFmt))
+				{
+					spec.precision = 10*spec.precision + *itFmt - '0';
+					++itFmt;
+				}
+			}
+		}
+		spec.mod = parseMod(itFmt, endFmt);
+		spec.type = itFmt != endFmt ? *itFmt++ : 0;
+	}
+
+
+	void appendPadded(std::string& result, const char* begin, const char* end, const Impl::FormatSpec& spec, bool numeric)
+		/// Appends the characters in [begin, end) to result, padded
+		/// to the field width like an std::ostream would pad them.
+	{
+		std::size_t length = end - begin;
+		std::size_t width = spec.width > 0 ? static_cast<std::size_t>(spec.width) : 0;
+		if (length >= width)
+		{
+			result.append(begin, end);
+		}
+		else if (spec.left)
+		{
+			result.append(begin, end);
+			result.append(width - length, ' ');
+		}
+		else if (spec.zero)
+		{
+			// std::ios::internal pads numbers after the sign
+			if (numeric && *begin == '-') result += *begin++;
+			result.append(width - length, '0');
+			result.append(begin, end);
+		}
+		else
+		{
+			result.append(width - length, ' ');
+			result.append(begin, end);
+		}
+	}
+
+
+	bool intValue(const Impl::FormatSpec& spec, const Impl::FormatArg& arg, bool& isSigned, Int64& sValue, UInt64& uValue, std::size_t& size)
+		/// Gets the value of an integer argument, if the argument has
+		/// the type formatOne() expects for the format specification.
+		/// For the ? modifier, these are the types handled by writeAnyInt().
+	{
+		using namespace Impl;
+
+		bool signedSpec = spec.type == 'd' || spec.type == 'i';
+		FormatArgType type = arg.type();
+		switch (spec.mod)
+		{
+		case 'l':
+			if (type != (signedSpec ? FORMAT_ARG_LONG : FORMAT_ARG_UNSIGNED_LONG)) return false;
+			break;
+		case 'L':
+			if (type != (signedSpec ? FormatArgTypeOf<Int64>::value : FormatArgTypeOf<UInt64>::value)) return false;
+			break;
+		case 'h':
+			if (type != (signedSpec ? FORMAT_ARG_SHORT : FORMAT_ARG_UNSIGNED_SHORT)) return false;
+			break;
+		case '?':
+			if (type == FORMAT_ARG_LONG_LONG && FormatArgTypeOf<Int64>::value != FORMAT_ARG_LONG_LONG) return false;
+			if (type == FORMAT_ARG_UNSIGNED_LONG_LONG && FormatArgTypeOf<UInt64>::value != FORMAT_ARG_UNSIGNED_LONG_LONG) return false;
+			break;
+		default:
+			if (type != (signedSpec ? FORMAT_ARG_INT : FORMAT_ARG_UNSIGNED_INT)) return false;
+			break;
+		}
+
+		isSigned = true;
+		switch (type)
+		{
+		case FORMAT_ARG_BOOL:
+			isSigned = false;
+			uValue = arg.value<bool>() ? 1 : 0;
+			size = sizeof(bool);
+			return true;
+		case FORMAT_ARG_CHAR:
+			sValue = static_cast<int>(arg.value<char>());
+			size = sizeof(int);
+			return true;
+		case FORMAT_ARG_SIGNED_CHAR:
+			sValue = static_cast<int>(arg.value<signed char>());
+			size = sizeof(int);
+			return true;
+		case FORMAT_ARG_UNSIGNED_CHAR:
+			isSigned = false;
+			uValue = static_cast<unsigned>(arg.value<unsigned char>());
+			size = sizeof(unsigned);
+			return true;
+		case FORMAT_ARG_SHORT:
+			sValue = arg.value<short>();
+			size = sizeof(short);
+			return true;
+		case FORMAT_ARG_UNSIGNED_SHORT:
+			isSigned = false;
+			uValue = arg.value<unsigned short>();
+			size = sizeof(unsigned short);
+			return true;
+		case FORMAT_ARG_INT:
+			sValue = arg.value<int>();
+			size = sizeof(int);
+			return true;
+		case FORMAT_ARG_UNSIGNED_INT:
+			isSigned = false;
+			uValue = arg.value<unsigned>();
+			size = sizeof(unsigned);
+			return true;
+		case FORMAT_ARG_LONG:
+			sValue = arg.value<long>();
+			size = sizeof(long);
+			return true;
+		case FORMAT_ARG_UNSIGNED_LONG:
+			isSigned = false;
+			uValue = arg.value<unsigned long>();
+			size = sizeof(unsigned long);
+			return true;
+		case FORMAT_ARG_LONG_LONG:
+			sValue = arg.value<long long>();
+			size = sizeof(long long);
+			return true;
+		case FORMAT_ARG_UNSIGNED_LONG_LONG:
+			isSigned = false;
+			uValue = arg.value<unsigned long long>();
+			size = sizeof(unsigned long long);
+			return true;
+		default:
+			return false;
+		}
+	}
+
+
+	char* formatInt(char type, bool isSigned, Int64 sValue, UInt64 uValue, std::size_t size, char* buffer)
+		/// Writes the integer to buffer, which must have room for
+		/// 24 characters, and returns a pointer past the last character.
+	{
+		if (type == 'o' || type == 'x' || type == 'X')
+		{
+			// Like std::ostream, show negative values in octal and
+			// hexadecimal as unsigned values of the same size.
+			UInt64 value = uValue;
+			if (isSigned)
+			{
+				value = static_cast<UInt64>(sValue);
+				if (size < sizeof(UInt64)) value &= (UInt64(1) << (8*size)) - 1;
+			}
+			const char* digits = type == 'X' ? "0123456789ABCDEF" : "0123456789abcdef";
+			unsigned shift = type == 'o' ? 3 : 4;
+			char tmp[24];
+			char* p = tmp + sizeof(tmp);
+			do
+			{
+				*--p = digits[value & ((1 << shift) - 1)];
+				value >>= shift;
+			}
+			while (value);
+			std::size_t length = tmp + sizeof(tmp) - p;
+			std::memcpy(buffer, p, length);
+			return buffer + length;
+		}
+		else if (isSigned && sValue < 0)
+		{
+			*buffer++ = '-';
+			return Impl::formatDecimal(UInt64(0) - static_cast<UInt64>(sValue), buffer);
+		}
+		else
+		{
+			return Impl::formatDecimal(isSigned ? static_cast<UInt64>(sValue) : uValue, buffer);
+		}
+	}
+
+
+	bool formatFast(std::string& result, const Impl::FormatSpec& spec, const Impl::FormatArg* args, std::size_t& pos)
+		/// Formats integers, characters and strings without an
+		/// std::ostream, producing the same output as formatOne().
+		/// Returns false if the format specification or the type
+		/// of the argument needs the generic formatOne().
+	{
+		using namespace Impl;
+
+		if (spec.widthArg || spec.hasPrecision || spec.showSign || spec.showBase || (spec.left && spec.zero))
+			return false;
+
+		char buffer[32];
+		char* end = buffer;
+		bool numeric = true;
+		switch (spec.type)
+		{
+		case 0:
+			return true;
+		case 'b':
+			if (args[pos].type() != FORMAT_ARG_BOOL) return false;
+			*end++ = args[pos].value<bool>() ? '1' : '0';
+			break;
+		case 'c':
+			if (args[pos].type() != FORMAT_ARG_CHAR) return false;
+			*end++ = args[pos].value<char>();
+			numeric = false;
+			break;
+		case 'd':
+		case 'i':
+		case 'o':
+		case 'u':
+		case 'x':
+		case 'X':
+			{
+				bool isSigned;
+				Int64 sValue = 0;
+				UInt64 uValue = 0;
+				std::size_t size = 0;
+				if (!intValue(spec, args[pos], isSigned, sValue, uValue, size)) return false;
+				end = formatInt(spec.type, isSigned, sValue, uValue, size, buffer);
+			}
+			break;
+		case 'e':
+		case 'E':
+		case 'f':
+			return false;
+		case 's':
+			if (args[pos].type() != FORMAT_ARG_STRING) return false;
+			{
+				const std::string& str = args[pos].value<std::string>();
+				appendPadded(result, str.data(), str.data() + str.size(), spec, false);
+			}
+			++pos;
+			return true;
+		case 'z':
+			if (args[pos].type() != FormatArgTypeOf<std::size_t>::value) return false;
+			end = Impl::formatDecimal(static_cast<UInt64>(args[pos].value<std::size_t>()), buffer);
+			break;
+		default:
+			// unknown types are copied, without consuming an argument
+			*end++ = spec.type;
+			appendPadded(result, buffer, end, spec, false);
+			return true;
+		}
+		appendPadded(result, buffer, end, spec, numeric);
+		++pos;
+		return true;
+	}
+
+
+	const char* formatSpec(std::string& result, const Impl::FormatSpec& spec, const char* itSpec, const char* endSpec, const char* endFmt, const Impl::FormatArg* args, std::size_t count, std::size_t& pos, std::vector<Any>& values)
+		/// Formats the argument at pos according to the format
+		/// specification in [itSpec, endSpec) and advances pos past
+		/// the consumed arguments. Returns the position in the format
+		/// string where formatting continues.
+	{
+		if (formatFast(result, spec, args, pos)) return endSpec;
+
+		if (values.empty())
+		{
+			values.reserve(count);
+			for (std::size_t i = 0; i < count; i++)
+			{
+				values.push_back(args[i].any());
+			}
+		}
+		std::vector<Any>::const_iterator itVal = values.begin() + pos;
+		formatOne(result, itSpec, endFmt, itVal, values.end());
+		pos = itVal - values.begin();
+		return itSpec;
+	}
+
+
+	void formatRange(std::string& result, const char* itFmt, const char* endFmt, const char* fmt, const Impl::FormatArg* args, std::size_t count, std::size_t& pos, std::vector<Any>& values)
+		/// Formats the part of the format string fmt starting at itFmt,
+		/// like format(std::string&, const std::string&, const std::vector<Any>&).
+	{
+		while (itFmt != endFmt)
+		{
+			if (*itFmt != '%')
+			{
+				const char* itText = itFmt;
+				while (itFmt != endFmt && *itFmt != '%') ++itFmt;
+				result.append(itText, itFmt);
+				continue;
+			}
+			++itFmt;
+			if (itFmt != endFmt && (pos < count || *itFmt == '['))
+			{
+				Impl::FormatSpec spec;
+				if (*itFmt == '[')
+				{
+					++itFmt;
+					std::size_t index = parseIndex(itFmt, endFmt);
+					if (index >= count) throw InvalidArgumentException("format argument index out of range", std::string(fmt, endFmt));
+					const char* itSpec = itFmt;
+					parseSpec(itFmt, endFmt, spec);
+					itFmt = formatSpec(result, spec, itSpec, itFmt, endFmt, args, count, index, values);
+				}
+				else
+				{
+					const char* itSpec = itFmt;
+					parseSpec(itFmt, endFmt, spec);
+					itFmt = formatSpec(result, spec, itSpec, itFmt, endFmt, args, count, pos, values);
+				}
+			}
+			else if (itFmt != endFmt)
+			{
+				result += *itFmt++;
+			}
+		}
+	}
 }
 
 
-std::string format(const std::string& fmt, const Any& value) 
+std::string format(const std::string& fmt, const Any& value)
 {
+	std::vector<Any> values(1, value);
 	std::string result;
-	format(result, fmt, value);
+	format(result, fmt, values);
 	return result;
 }
 
@@ -257,8 +623,8 @@ void format(std::string& result, const char *fmt, const std::vector<Any>& values
 
 void format(std::string& result, const std::string& fmt, const std::vector<Any>& values)
 {
-	std::string::const_iterator itFmt  = fmt.begin();
-	std::string::const_iterator endFmt = fmt.end();
+	const char* itFmt  = fmt.data();
+	const char* endFmt = fmt.data() + fmt.size();
 	std::vector<Any>::const_iterator itVal  = values.begin();
 	std::vector<Any>::const_iterator endVal = values.end(); 
 	while (itFmt != endFmt)
@@ -276,13 +642,13 @@ void format(std::string& result, const std::string& fmt, const std::vector<Any>&
 					if (index < values.size())
 					{
 						std::vector<Any>::const_iterator it = values.begin() + index;
-						formatOne(result, itFmt, endFmt, it);
+						formatOne(result, itFmt, endFmt, it, endVal);
 					}
 					else throw InvalidArgumentException("format argument index out of range", fmt);
 				}
 				else
 				{
-					formatOne(result, itFmt, endFmt, itVal);
+					formatOne(result, itFmt, endFmt, itVal, endVal);
 				}
 			}
 			else if (itFmt != endFmt)
@@ -298,4 +664,103 @@ void format(std::string& result, const std::string& fmt, const std::vector<Any>&
 }
 
 
+namespace Impl {
+
+
+void format(std::string& result, const char* fmt, std::size_t length, const FormatArg* args, std::size_t count)
+{
+	std::size_t pos = 0;
+	std::vector<Any> values;
+	formatRange(result, fmt, fmt + length, fmt, args, count, pos, values);
+}
+
+
+} // namespace Impl
+
+
+CompiledFormat::CompiledFormat(const std::string& fmt):
+	_fmt(fmt)
+{
+	const char* begin = _fmt.data();
+	const char* end   = begin + _fmt.size();
+	const char* it    = begin;
+	while (it != end)
+	{
+		Segment segment;
+		if (*it != '%')
+		{
+			segment.offset = it - begin;
+			while (it != end && *it != '%') ++it;
+			segment.length = it - begin - segment.offset;
+			segment.isSpec = false;
+			_segments.push_back(segment);
+			continue;
+		}
+		if (++it == end) break;
+		segment.isSpec = true;
+		segment.spec.hasIndex = false;
+		segment.spec.index = 0;
+		if (*it == '[')
+		{
+			++it;
+			segment.spec.hasIndex = true;
+			segment.spec.index = parseIndex(it, end);
+		}
+		segment.offset = it - begin;
+		parseSpec(it, end, segment.spec);
+		segment.length = it - begin - segment.offset;
+		_segments.push_back(segment);
+	}
+}
+
+
+CompiledFormat::~CompiledFormat()
+{
+}
+
+
+void CompiledFormat::formatArgs(std::string& result, const Impl::FormatArg* args, std::size_t count) const
+{
+	const char* begin = _fmt.data();
+	const char* end   = begin + _fmt.size();
+	std::size_t pos = 0;
+	std::vector<Any> values;
+	for (std::vector<Segment>::const_iterator it = _segments.begin(); it != _segments.end(); ++it)
+	{
+		const char* itSpec  = begin + it->offset;
+		const char* endSpec = itSpec + it->length;
+		if (!it->isSpec)
+		{
+			result.append(itSpec, endSpec);
+			continue;
+		}
+		const char* next;
+		if (it->spec.hasIndex)
+		{
+			if (it->spec.index >= count) throw InvalidArgumentException("format argument index out of range", _fmt);
+			std::size_t index = it->spec.index;
+			next = formatSpec(result, it->spec, itSpec, endSpec, end, args, count, index, values);
+		}
+		else if (pos < count)
+		{
+			next = formatSpec(result, it->spec, itSpec, endSpec, end, args, count, pos, values);
+		}
+		else
+		{
+			// no more values: the character following the percent
+			// sign is copied verbatim, like format() does
+			result += *itSpec;
+			next = itSpec + 1;
+		}
+		if (next != endSpec)
+		{
+			// formatting stopped within the format specification;
+			// continue without the pre-parsed segments
+			formatRange(result, next, end, begin, args, count, pos, values);
+			return;
+		}
+	}
+}
+
+
 } // namespace Poco
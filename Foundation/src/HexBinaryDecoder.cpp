@@ -19,8 +19,61 @@
 namespace Poco {
 
 
+namespace
+{
+	inline int hexValue(char c)
+	{
+		if (c >= '0' && c <= '9')
+			return c - '0';
+		else if (c >= 'A' && c <= 'F')
+			return c - 'A' + 10;
+		else if (c >= 'a' && c <= 'f')
+			return c - 'a' + 10;
+		else
+			return -1;
+	}
+
+
+	inline bool isHexSpace(char c)
+	{
+		return c == ' ' || c == '\r' || c == '\t' || c == '\n';
+	}
+
+
+	std::size_t decodeBlock(const char* data, std::size_t length, unsigned char* buffer)
+	{
+		const char* it  = data;
+		const char* end = data + length;
+		unsigned char* start = buffer;
+		while (it != end)
+		{
+			// fast path for pairs of digits
+			while (end - it >= 2)
+			{
+				int hi = hexValue(it[0]);
+				int lo = hexValue(it[1]);
+				if (hi < 0 || lo < 0) break;
+				*buffer++ = static_cast<unsigned char>((hi << 4) | lo);
+				it += 2;
+			}
+			while (it != end && isHexSpace(*it)) ++it;
+			if (it == end) break;
+			int hi = hexValue(*it++);
+			if (hi < 0) throw DataFormatException();
+			while (it != end && isHexSpace(*it)) ++it;
+			if (it == end) throw DataFormatException();
+			int lo = hexValue(*it++);
+			if (lo < 0) throw DataFormatException();
+			*buffer++ = static_cast<unsigned char>((hi << 4) | lo);
+		}
+		return buffer - start;
+	}
+}
+
+
 HexBinaryDecoderBuf::HexBinaryDecoderBuf(std::istream& istr): 
-	_buf(*istr.rdbuf())
+	_buf(*istr.rdbuf()),
+	_eof(false)
 {
 }
 
@@ -57,13 +110,48 @@ int HexBinaryDecoderBuf::readFromDevice()
 
 int HexBinaryDecoderBuf::readOne()
 {
+	if (_eof) return std::char_traits<char>::eof();
 	int ch = _buf.sbumpc();
 	while (ch == ' ' || ch == '\r' || ch == '\t' || ch == '\n')
 		ch = _buf.sbumpc();
+	if (ch == std::char_traits<char>::eof()) _eof = true;
 	return ch;
 }
 
 
+std::streamsize HexBinaryDecoderBuf::xsgetn(char* p, std::streamsize count)
+{
+	static const int eof = std::char_traits<char>::eof();
+
+	// The first character, which may have been put back,
+	// is read with uflow().
+	std::streamsize copied = 0;
+	if (count > 0)
+	{
+		int c = uflow();
+		if (c == eof) return 0;
+		p[copied++] = static_cast<char>(c);
+	}
+	char buffer[BUFFER_SIZE];
+	while (copied < count)
+	{
+		std::streamsize n = 2*(count - copied);
+		if (n > BUFFER_SIZE) n = BUFFER_SIZE;
+		std::streamsize length = 0;
+		while (length < n)
+		{
+			int c = readOne();
+			if (c == eof) break;
+			buffer[length++] = static_cast<char>(c);
+		}
+		if (length == 0) break;
+		copied += static_cast<std::streamsize>(decodeBlock(buffer, static_cast<std::size_t>(length), reinterpret_cast<unsigned char*>(p + copied)));
+		if (length < n) break;
+	}
+	return copied;
+}
+
+
 HexBinaryDecoderIOS::HexBinaryDecoderIOS(std::istream& istr): _buf(istr)
 {
 	poco_ios_init(&_buf);
@@ -91,4 +179,18 @@ HexBinaryDecoder::~HexBinaryDecoder()
 }
 
 
+std::size_t HexBinaryDecoder::decode(const char* data, std::size_t length, void* buffer)
+{
+	return decodeBlock(data, length, static_cast<unsigned char*>(buffer));
+}
+
+
+std::string HexBinaryDecoder::decode(const std::string& data)
+{
+	std::string result(data.size()/2 + 1, '\0');
+	result.resize(decode(data.data(), data.size(), &result[0]));
+	return result;
+}
+
+
 } // namespace Poco
@@ -15,9 +15,50 @@
 #include "Poco/HexBinaryEncoder.h"
 
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define POCO_HEXBINARY_SSE2
+#include <emmintrin.h>
+#endif
+
+
 namespace Poco {
 
 
+namespace
+{
+	std::size_t encodeBlock(const unsigned char* data, std::size_t length, char* buffer, bool uppercase)
+	{
+		static const char digits[] = "0123456789abcdef0123456789ABCDEF";
+
+		const char* pDigits = uppercase ? digits + 16 : digits;
+		std::size_t i = 0;
+#if defined(POCO_HEXBINARY_SSE2)
+		// digit = nibble + '0', plus the distance from '9' + 1 to 'a' (or 'A') for nibbles > 9
+		const __m128i mask = _mm_set1_epi8(0x0F);
+		const __m128i zero = _mm_set1_epi8('0');
+		const __m128i nine = _mm_set1_epi8(9);
+		const __m128i letter = _mm_set1_epi8(static_cast<char>(pDigits[10] - '0' - 10));
+		for (; i + 16 <= length; i += 16)
+		{
+			const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+			__m128i hi = _mm_and_si128(_mm_srli_epi16(in, 4), mask);
+			__m128i lo = _mm_and_si128(in, mask);
+			hi = _mm_add_epi8(_mm_add_epi8(hi, zero), _mm_and_si128(_mm_cmpgt_epi8(hi, nine), letter));
+			lo = _mm_add_epi8(_mm_add_epi8(lo, zero), _mm_and_si128(_mm_cmpgt_epi8(lo, nine), letter));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(buffer + 2*i), _mm_unpacklo_epi8(hi, lo));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(buffer + 2*i + 16), _mm_unpackhi_epi8(hi, lo));
+		}
+#endif
+		for (; i < length; i++)
+		{
+			buffer[2*i]     = pDigits[data[i] >> 4];
+			buffer[2*i + 1] = pDigits[data[i] & 0x0F];
+		}
+		return 2*length;
+	}
+}
+
+
 HexBinaryEncoderBuf::HexBinaryEncoderBuf(std::ostream& ostr): 
 	_pos(0),
 	_lineLength(72),
@@ -74,6 +115,35 @@ int HexBinaryEncoderBuf::writeToDevice(char c)
 }
 
 
+std::streamsize HexBinaryEncoderBuf::xsputn(const char* s, std::streamsize count)
+{
+	char buffer[BUFFER_SIZE];
+	std::streamsize written = 0;
+	while (written < count)
+	{
+		std::streamsize n = count - written;
+		if (n > BUFFER_SIZE/2) n = BUFFER_SIZE/2;
+		if (_lineLength > 0)
+		{
+			// a line break follows the byte reaching the line length
+			std::streamsize lineBytes = (_lineLength - _pos + 1)/2;
+			if (lineBytes < 1) lineBytes = 1;
+			if (n > lineBytes) n = lineBytes;
+		}
+		encodeBlock(reinterpret_cast<const unsigned char*>(s + written), static_cast<std::size_t>(n), buffer, _uppercase != 0);
+		if (_buf.sputn(buffer, 2*n) != 2*n) return written;
+		written += n;
+		_pos += static_cast<int>(2*n);
+		if (_lineLength > 0 && _pos >= _lineLength)
+		{
+			if (_buf.sputc('\n') == std::char_traits<char>::eof()) return written;
+			_pos = 0;
+		}
+	}
+	return written;
+}
+
+
 int HexBinaryEncoderBuf::close()
 {
 	sync();
@@ -114,4 +184,21 @@ HexBinaryEncoder::~HexBinaryEncoder()
 }
 
 
+std::size_t HexBinaryEncoder::encode(const void* data, std::size_t length, char* buffer, bool uppercase)
+{
+	return encodeBlock(static_cast<const unsigned char*>(data), length, buffer, uppercase);
+}
+
+
+std::string HexBinaryEncoder::encode(const std::string& data, bool uppercase)
+{
+	std::string result(2*data.size(), '\0');
+	if (!result.empty())
+	{
+		encode(data.data(), data.size(), &result[0], uppercase);
+	}
+	return result;
+}
+
+
 } // namespace Poco
@@ -16,12 +16,303 @@
 #include "Poco/NotificationCenter.h"
 #include "Poco/Notification.h"
 #include "Poco/SingletonHolder.h"
+#include "Poco/Semaphore.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Exception.h"
+#include <atomic>
+#include <limits>
 
 
 namespace Poco {
 
 
-NotificationQueue::NotificationQueue()
+class NotificationRing
+	/// A bounded, lock-free multi-producer/multi-consumer
+	/// ring buffer (after Dmitry Vyukov), used as the storage
+	/// of a bounded NotificationQueue.
+	///
+	/// Consumers that find the ring empty register themselves
+	/// in a waiter count and sleep on a semaphore. A producer
+	/// only signals the semaphore if it can claim a waiter, so
+	/// that enqueueing into a queue without sleeping consumers
+	/// never makes a system call. Likewise, producers that find
+	/// the ring full sleep on a second semaphore, which is only
+	/// signalled by a consumer if a producer is waiting.
+{
+public:
+	explicit NotificationRing(std::size_t capacity);
+	~NotificationRing();
+
+	void push(Notification* pNf);
+		/// Enqueues the notification, taking ownership of one
+		/// reference. Waits while the ring is full.
+
+	Notification* pop();
+		/// Dequeues a notification, or returns null if
+		/// the ring is empty.
+
+	Notification* waitPop(long milliseconds);
+		/// Dequeues a notification, waiting for up to the given
+		/// time (or forever, if milliseconds is negative).
+		/// Returns null on timeout or after wakeUpAll().
+
+	void wakeUpAll();
+	bool hasWaiters() const;
+	std::size_t size() const;
+	std::size_t capacity() const;
+
+private:
+	struct Cell
+	{
+		std::atomic<std::size_t> sequence;
+		Notification* pNf;
+	};
+
+	bool tryPush(Notification* pNf);
+	static void signal(std::atomic<int>& waiters, Semaphore& sema);
+	static void cancelWait(std::atomic<int>& waiters, Semaphore& sema);
+
+	enum
+	{
+		CACHE_LINE_SIZE = 64
+	};
+
+	Cell* _pCells;
+	std::size_t _mask;
+	char _pad1[CACHE_LINE_SIZE];
+	std::atomic<std::size_t> _enqueuePos;
+	char _pad2[CACHE_LINE_SIZE];
+	std::atomic<std::size_t> _dequeuePos;
+	char _pad3[CACHE_LINE_SIZE];
+	std::atomic<int> _waiters;
+	std::atomic<unsigned> _wakeUps;
+	Semaphore _sema;
+	std::atomic<int> _pushWaiters;
+	Semaphore _notFull;
+};
+
+
+NotificationRing::NotificationRing(std::size_t capacity):
+	_pCells(0),
+	_mask(0),
+	_enqueuePos(0),
+	_dequeuePos(0),
+	_waiters(0),
+	_wakeUps(0),
+	_sema(0, std::numeric_limits<int>::max()),
+	_pushWaiters(0),
+	_notFull(0, std::numeric_limits<int>::max())
+{
+	poco_assert (capacity > 0);
+
+	std::size_t n = 2;
+	while (n < capacity) n <<= 1;
+	_pCells = new Cell[n];
+	_mask = n - 1;
+	for (std::size_t i = 0; i < n; i++)
+	{
+		_pCells[i].sequence.store(i, std::memory_order_relaxed);
+		_pCells[i].pNf = 0;
+	}
+}
+
+
+NotificationRing::~NotificationRing()
+{
+	Notification* pNf = pop();
+	while (pNf)
+	{
+		pNf->release();
+		pNf = pop();
+	}
+	delete [] _pCells;
+}
+
+
+bool NotificationRing::tryPush(Notification* pNf)
+{
+	Cell* pCell;
+	std::size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		pCell = &_pCells[pos & _mask];
+		std::size_t seq = pCell->sequence.load(std::memory_order_acquire);
+		std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+		if (diff == 0)
+		{
+			if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+		{
+			return false;
+		}
+		else
+		{
+			pos = _enqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+	pCell->pNf = pNf;
+	pCell->sequence.store(pos + 1, std::memory_order_release);
+	return true;
+}
+
+
+void NotificationRing::push(Notification* pNf)
+{
+	while (!tryPush(pNf))
+	{
+		// register as a waiting producer before retrying, so that
+		// a consumer dequeueing in between is guaranteed to see us
+		_pushWaiters.fetch_add(1, std::memory_order_seq_cst);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (tryPush(pNf))
+		{
+			cancelWait(_pushWaiters, _notFull);
+			break;
+		}
+		_notFull.wait();
+	}
+	signal(_waiters, _sema);
+}
+
+
+Notification* NotificationRing::pop()
+{
+	Cell* pCell;
+	std::size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		pCell = &_pCells[pos & _mask];
+		std::size_t seq = pCell->sequence.load(std::memory_order_acquire);
+		std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+		if (diff == 0)
+		{
+			if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+		{
+			return 0;
+		}
+		else
+		{
+			pos = _dequeuePos.load(std::memory_order_relaxed);
+		}
+	}
+	Notification* pNf = pCell->pNf;
+	pCell->pNf = 0;
+	pCell->sequence.store(pos + _mask + 1, std::memory_order_release);
+	signal(_pushWaiters, _notFull);
+	return pNf;
+}
+
+
+Notification* NotificationRing::waitPop(long milliseconds)
+{
+	Notification* pNf = pop();
+	if (pNf) return pNf;
+
+	Timestamp start;
+	for (;;)
+	{
+		unsigned wakeUps = _wakeUps.load(std::memory_order_acquire);
+		_waiters.fetch_add(1, std::memory_order_seq_cst);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		pNf = pop();
+		if (pNf)
+		{
+			cancelWait(_waiters, _sema);
+			return pNf;
+		}
+		bool signalled = true;
+		if (milliseconds < 0)
+		{
+			_sema.wait();
+		}
+		else
+		{
+			long remaining = milliseconds - static_cast<long>(start.elapsed()/1000);
+			signalled = remaining > 0 && _sema.tryWait(remaining);
+			if (!signalled) cancelWait(_waiters, _sema);
+		}
+		if (_wakeUps.load(std::memory_order_acquire) != wakeUps) return 0;
+		pNf = pop();
+		if (pNf || !signalled) return pNf;
+	}
+}
+
+
+void NotificationRing::signal(std::atomic<int>& waiters, Semaphore& sema)
+{
+	// pairs with the fence in waitPop() and push(), so that either
+	// the waiter sees the change to the ring, or we see the waiter
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int n = waiters.load(std::memory_order_relaxed);
+	while (n > 0)
+	{
+		if (waiters.compare_exchange_weak(n, n - 1, std::memory_order_seq_cst))
+		{
+			sema.set();
+			return;
+		}
+	}
+}
+
+
+void NotificationRing::cancelWait(std::atomic<int>& waiters, Semaphore& sema)
+{
+	int n = waiters.load(std::memory_order_relaxed);
+	while (n > 0)
+	{
+		if (waiters.compare_exchange_weak(n, n - 1, std::memory_order_seq_cst))
+			return;
+	}
+	// Another thread has already claimed us and is about
+	// to signal the semaphore, so consume that signal.
+	sema.wait();
+}
+
+
+void NotificationRing::wakeUpAll()
+{
+	_wakeUps.fetch_add(1, std::memory_order_release);
+	int waiters = _waiters.exchange(0, std::memory_order_seq_cst);
+	while (waiters-- > 0)
+	{
+		_sema.set();
+	}
+}
+
+
+inline bool NotificationRing::hasWaiters() const
+{
+	return _waiters.load(std::memory_order_relaxed) > 0;
+}
+
+
+std::size_t NotificationRing::size() const
+{
+	std::size_t dequeuePos = _dequeuePos.load(std::memory_order_relaxed);
+	std::size_t enqueuePos = _enqueuePos.load(std::memory_order_relaxed);
+	return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0;
+}
+
+
+inline std::size_t NotificationRing::capacity() const
+{
+	return _mask + 1;
+}
+
+
+NotificationQueue::NotificationQueue():
+	_pRing(0)
+{
+}
+
+
+NotificationQueue::NotificationQueue(std::size_t capacity):
+	_pRing(new NotificationRing(capacity))
 {
 }
 
@@ -31,6 +322,7 @@ NotificationQueue::~NotificationQueue()
 	try
 	{
 		clear();
+		delete _pRing;
 	}
 	catch (...)
 	{
@@ -42,6 +334,11 @@ NotificationQueue::~NotificationQueue()
 void NotificationQueue::enqueueNotification(Notification::Ptr pNotification)
 {
 	poco_check_ptr (pNotification);
+	if (_pRing)
+	{
+		_pRing->push(pNotification.duplicate());
+		return;
+	}
 	FastMutex::ScopedLock lock(_mutex);
 	if (_waitQueue.empty())
 	{
@@ -60,6 +357,7 @@ void NotificationQueue::enqueueNotification(Notification::Ptr pNotification)
 void NotificationQueue::enqueueUrgentNotification(Notification::Ptr pNotification)
 {
 	poco_check_ptr (pNotification);
+	if (_pRing) throw NotImplementedException("urgent notifications in a bounded NotificationQueue");
 	FastMutex::ScopedLock lock(_mutex);
 	if (_waitQueue.empty())
 	{
@@ -77,6 +375,8 @@ void NotificationQueue::enqueueUrgentNotification(Notification::Ptr pNotificatio
 
 Notification* NotificationQueue::dequeueNotification()
 {
+	if (_pRing) return _pRing->pop();
+
 	FastMutex::ScopedLock lock(_mutex);
 	return dequeueOne().duplicate();
 }
@@ -84,6 +384,8 @@ Notification* NotificationQueue::dequeueNotification()
 
 Notification* NotificationQueue::waitDequeueNotification()
 {
+	if (_pRing) return _pRing->waitPop(-1);
+
 	Notification::Ptr pNf;
 	WaitInfo* pWI = 0;
 	{
@@ -102,6 +404,8 @@ Notification* NotificationQueue::waitDequeueNotification()
 
 Notification* NotificationQueue::waitDequeueNotification(long milliseconds)
 {
+	if (_pRing) return _pRing->waitPop(milliseconds < 0 ? 0 : milliseconds);
+
 	Notification::Ptr pNf;
 	WaitInfo* pWI = 0;
 	{
@@ -133,8 +437,45 @@ Notification* NotificationQueue::waitDequeueNotification(long milliseconds)
 }
 
 
+std::size_t NotificationQueue::dequeueMany(std::vector<Notification::Ptr>& notifications, std::size_t maxCount)
+{
+	std::size_t n = 0;
+	if (_pRing)
+	{
+		Notification* pNf;
+		while (n < maxCount && (pNf = _pRing->pop()))
+		{
+			notifications.push_back(Notification::Ptr(pNf));
+			++n;
+		}
+	}
+	else
+	{
+		FastMutex::ScopedLock lock(_mutex);
+		while (n < maxCount && !_nfQueue.empty())
+		{
+			notifications.push_back(_nfQueue.front());
+			_nfQueue.pop_front();
+			++n;
+		}
+	}
+	return n;
+}
+
+
 void NotificationQueue::dispatch(NotificationCenter& notificationCenter)
 {
+	if (_pRing)
+	{
+		Notification::Ptr pNf = _pRing->pop();
+		while (pNf)
+		{
+			notificationCenter.postNotification(pNf);
+			pNf = _pRing->pop();
+		}
+		return;
+	}
+
 	FastMutex::ScopedLock lock(_mutex);
 	Notification::Ptr pNf = dequeueOne();
 	while (pNf)
@@ -147,6 +488,12 @@ void NotificationQueue::dispatch(NotificationCenter& notificationCenter)
 
 void NotificationQueue::wakeUpAll()
 {
+	if (_pRing)
+	{
+		_pRing->wakeUpAll();
+		return;
+	}
+
 	FastMutex::ScopedLock lock(_mutex);
 	for (auto p: _waitQueue)
 	{
@@ -158,6 +505,8 @@ void NotificationQueue::wakeUpAll()
 
 bool NotificationQueue::empty() const
 {
+	if (_pRing) return _pRing->size() == 0;
+
 	FastMutex::ScopedLock lock(_mutex);
 	return _nfQueue.empty();
 }
@@ -165,6 +514,8 @@ bool NotificationQueue::empty() const
 	
 int NotificationQueue::size() const
 {
+	if (_pRing) return static_cast<int>(_pRing->size());
+
 	FastMutex::ScopedLock lock(_mutex);
 	return static_cast<int>(_nfQueue.size());
 }
@@ -172,6 +523,17 @@ int NotificationQueue::size() const
 
 void NotificationQueue::clear()
 {
+	if (_pRing)
+	{
+		Notification* pNf = _pRing->pop();
+		while (pNf)
+		{
+			pNf->release();
+			pNf = _pRing->pop();
+		}
+		return;
+	}
+
 	FastMutex::ScopedLock lock(_mutex);
 	_nfQueue.clear();	
 }
@@ -179,6 +541,8 @@ void NotificationQueue::clear()
 
 bool NotificationQueue::remove(Notification::Ptr pNotification)
 {
+	if (_pRing) throw NotImplementedException("remove from a bounded NotificationQueue");
+
 	FastMutex::ScopedLock lock(_mutex);
 	NfQueue::iterator it = std::find(_nfQueue.begin(), _nfQueue.end(), pNotification);
 	if (it == _nfQueue.end())
@@ -192,11 +556,19 @@ bool NotificationQueue::remove(Notification::Ptr pNotification)
 
 bool NotificationQueue::hasIdleThreads() const
 {
+	if (_pRing) return _pRing->hasWaiters();
+
 	FastMutex::ScopedLock lock(_mutex);
 	return !_waitQueue.empty();
 }
 
 
+std::size_t NotificationQueue::capacity() const
+{
+	return _pRing ? _pRing->capacity() : 0;
+}
+
+
 Notification::Ptr NotificationQueue::dequeueOne()
 {
 	Notification::Ptr pNf;
@@ -19,6 +19,7 @@
 #include <locale>
 #endif
 #include <cstdio>
+#include <cstring>
 #include <cinttypes>
 
 
@@ -58,9 +59,7 @@ std::string NumberFormatter::format(bool value, BoolFormat format)
 void NumberFormatter::append(std::string& str, int value)
 {
 	char result[NF_MAX_INT_STRING_LEN];
-	std::size_t sz = NF_MAX_INT_STRING_LEN;
-	intToStr(value, 10, result, sz);
-	str.append(result, sz);
+	str.append(result, append(result, value));
 }
 
 
@@ -103,9 +102,7 @@ void NumberFormatter::appendHex(std::string& str, int value, int width)
 void NumberFormatter::append(std::string& str, unsigned value)
 {
 	char result[NF_MAX_INT_STRING_LEN];
-	std::size_t sz = NF_MAX_INT_STRING_LEN;
-	uIntToStr(value, 10, result, sz);
-	str.append(result, sz);
+	str.append(result, append(result, value));
 }
 
 
@@ -148,9 +145,7 @@ void NumberFormatter::appendHex(std::string& str, unsigned value, int width)
 void NumberFormatter::append(std::string& str, long value)
 {
 	char result[NF_MAX_INT_STRING_LEN];
-	std::size_t sz = NF_MAX_INT_STRING_LEN;
-	intToStr(value, 10, result, sz);
-	str.append(result, sz);
+	str.append(result, append(result, value));
 }
 
 
@@ -193,9 +188,7 @@ void NumberFormatter::appendHex(std::string& str, long value, int width)
 void NumberFormatter::append(std::string& str, unsigned long value)
 {
 	char result[NF_MAX_INT_STRING_LEN];
-	std::size_t sz = NF_MAX_INT_STRING_LEN;
-	uIntToStr(value, 10, result, sz);
-	str.append(result, sz);
+	str.append(result, append(result, value));
 }
 
 
@@ -242,9 +235,7 @@ void NumberFormatter::appendHex(std::string& str, unsigned long value, int width
 void NumberFormatter::append(std::string& str, long long value)
 {
 	char result[NF_MAX_INT_STRING_LEN];
-	std::size_t sz = NF_MAX_INT_STRING_LEN;
-	intToStr(value, 10, result, sz);
-	str.append(result, sz);
+	str.append(result, append(result, value));
 }
 
 
@@ -287,9 +278,7 @@ void NumberFormatter::appendHex(std::string& str, long long value, int width)
 void NumberFormatter::append(std::string& str, unsigned long long value)
 {
 	char result[NF_MAX_INT_STRING_LEN];
-	std::size_t sz = NF_MAX_INT_STRING_LEN;
-	uIntToStr(value, 10, result, sz);
-	str.append(result, sz);
+	str.append(result, append(result, value));
 }
 
 
@@ -335,9 +324,7 @@ void NumberFormatter::appendHex(std::string& str, unsigned long long value, int
 void NumberFormatter::append(std::string& str, Int64 value)
 {
 	char result[NF_MAX_INT_STRING_LEN];
-	std::size_t sz = NF_MAX_INT_STRING_LEN;
-	intToStr(value, 10, result, sz);
-	str.append(result, sz);
+	str.append(result, append(result, value));
 }
 
 
@@ -380,9 +367,7 @@ void NumberFormatter::appendHex(std::string& str, Int64 value, int width)
 void NumberFormatter::append(std::string& str, UInt64 value)
 {
 	char result[NF_MAX_INT_STRING_LEN];
-	std::size_t sz = NF_MAX_INT_STRING_LEN;
-	uIntToStr(value, 10, result, sz);
-	str.append(result, sz);
+	str.append(result, append(result, value));
 }
 
 
@@ -428,9 +413,8 @@ void NumberFormatter::appendHex(std::string& str, UInt64 value, int width)
 
 void NumberFormatter::append(std::string& str, float value)
 {
-	char buffer[NF_MAX_FLT_STRING_LEN];
-	floatToStr(buffer, POCO_MAX_FLT_STRING_LEN, value);
-	str.append(buffer);
+	char buffer[NF_MAX_SHORTEST_FLT_STRING_LEN];
+	str.append(buffer, append(buffer, value));
 }
 
 
@@ -451,9 +435,8 @@ void NumberFormatter::append(std::string& str, float value, int width, int preci
 
 void NumberFormatter::append(std::string& str, double value)
 {
-	char buffer[NF_MAX_FLT_STRING_LEN];
-	doubleToStr(buffer, POCO_MAX_FLT_STRING_LEN, value);
-	str.append(buffer);
+	char buffer[NF_MAX_SHORTEST_FLT_STRING_LEN];
+	str.append(buffer, append(buffer, value));
 }
 
 
@@ -484,4 +467,18 @@ void NumberFormatter::append(std::string& str, const void* ptr)
 }
 
 
+char* NumberFormatter::append(char* buffer, float value)
+{
+	floatToStr(buffer, NF_MAX_SHORTEST_FLT_STRING_LEN, value);
+	return buffer + std::strlen(buffer);
+}
+
+
+char* NumberFormatter::append(char* buffer, double value)
+{
+	doubleToStr(buffer, NF_MAX_SHORTEST_FLT_STRING_LEN, value);
+	return buffer + std::strlen(buffer);
+}
+
+
 } // namespace Poco
@@ -50,7 +50,13 @@ int NumberParser::parse(const std::string& s, char thSep)
 
 bool NumberParser::tryParse(const std::string& s, int& value, char thSep)
 {
-	return strToInt(s.c_str(), value, NUM_BASE_DEC, thSep);
+	return strToInt(s.data(), s.size(), value, NUM_BASE_DEC, thSep);
+}
+
+
+bool NumberParser::tryParse(const char* s, std::size_t length, int& value, char thSep)
+{
+	return strToInt(s, length, value, NUM_BASE_DEC, thSep);
 }
 
 
@@ -66,7 +72,13 @@ unsigned NumberParser::parseUnsigned(const std::string& s, char thSep)
 
 bool NumberParser::tryParseUnsigned(const std::string& s, unsigned& value, char thSep)
 {
-	return strToInt(s.c_str(), value, NUM_BASE_DEC, thSep);
+	return strToInt(s.data(), s.size(), value, NUM_BASE_DEC, thSep);
+}
+
+
+bool NumberParser::tryParseUnsigned(const char* s, std::size_t length, unsigned& value, char thSep)
+{
+	return strToInt(s, length, value, NUM_BASE_DEC, thSep);
 }
 
 
@@ -119,7 +131,13 @@ Int64 NumberParser::parse64(const std::string& s, char thSep)
 
 bool NumberParser::tryParse64(const std::string& s, Int64& value, char thSep)
 {
-	return strToInt(s.c_str(), value, NUM_BASE_DEC, thSep);
+	return strToInt(s.data(), s.size(), value, NUM_BASE_DEC, thSep);
+}
+
+
+bool NumberParser::tryParse64(const char* s, std::size_t length, Int64& value, char thSep)
+{
+	return strToInt(s, length, value, NUM_BASE_DEC, thSep);
 }
 
 
@@ -135,7 +153,13 @@ UInt64 NumberParser::parseUnsigned64(const std::string& s, char thSep)
 
 bool NumberParser::tryParseUnsigned64(const std::string& s, UInt64& value, char thSep)
 {
-	return strToInt(s.c_str(), value, NUM_BASE_DEC, thSep);
+	return strToInt(s.data(), s.size(), value, NUM_BASE_DEC, thSep);
+}
+
+
+bool NumberParser::tryParseUnsigned64(const char* s, std::size_t length, UInt64& value, char thSep)
+{
+	return strToInt(s, length, value, NUM_BASE_DEC, thSep);
 }
 
 
@@ -157,16 +157,102 @@ void insertThousandSep(std::string& str, char thSep, char decSep = '.')
 }
 
 
+const char DIGIT_PAIRS[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+
+template <typename U>
+inline int countDecimalDigits(U value)
+{
+	int digits = 1;
+	for (;;)
+	{
+		if (value < 10) return digits;
+		if (value < 100) return digits + 1;
+		if (value < 1000) return digits + 2;
+		if (value < 10000) return digits + 3;
+		value /= 10000U;
+		digits += 4;
+	}
+}
+
+
+template <typename U>
+inline char* writeDecimal(U value, char* buffer)
+	/// Writes the digits from right to left, two at a time,
+	/// after determining the number of digits, so that no
+	/// reversal is needed.
+{
+	char* end = buffer + countDecimalDigits(value);
+	char* ptr = end;
+	while (value >= 100)
+	{
+		unsigned i = static_cast<unsigned>(value % 100) * 2;
+		value /= 100;
+		ptr -= 2;
+		ptr[0] = DIGIT_PAIRS[i];
+		ptr[1] = DIGIT_PAIRS[i + 1];
+	}
+	if (value >= 10)
+	{
+		unsigned i = static_cast<unsigned>(value) * 2;
+		ptr[-2] = DIGIT_PAIRS[i];
+		ptr[-1] = DIGIT_PAIRS[i + 1];
+	}
+	else
+	{
+		ptr[-1] = static_cast<char>('0' + value);
+	}
+	return end;
+}
+
+
 } // namespace
 
 
 namespace Poco {
 
 
+namespace Impl {
+
+
+char* formatDecimal(UInt32 value, char* buffer)
+{
+	return writeDecimal(value, buffer);
+}
+
+
+char* formatDecimal(UInt64 value, char* buffer)
+{
+	return writeDecimal(value, buffer);
+}
+
+
+} // namespace Impl
+
+
 void floatToStr(char* buffer, int bufferSize, float value, int lowDec, int highDec)
 {
 	using namespace double_conversion;
 
+	// Integral values below 10^6 are printed in decimal notation
+	// with all digits; this is exactly what the shortest conversion
+	// produces, so the integer formatting can be used instead.
+	if (highDec >= 6 && bufferSize > 8 && std::fabs(value) < 1e6f && value == static_cast<float>(static_cast<Int32>(value)))
+	{
+		*intToDecStr(static_cast<Int32>(value), buffer) = '\0';
+		return;
+	}
+
 	StringBuilder builder(buffer, bufferSize);
 	int flags = DoubleToStringConverter::UNIQUE_ZERO |
 		DoubleToStringConverter::EMIT_POSITIVE_EXPONENT_SIGN;
@@ -229,6 +315,14 @@ void doubleToStr(char* buffer, int bufferSize, double value, int lowDec, int hig
 {
 	using namespace double_conversion;
 
+	// See floatToStr(); integral values below 10^15 have at most
+	// 15 digits and are always exactly representable.
+	if (highDec >= 15 && bufferSize > 17 && std::fabs(value) < 1e15 && value == static_cast<double>(static_cast<Int64>(value)))
+	{
+		*intToDecStr(static_cast<Int64>(value), buffer) = '\0';
+		return;
+	}
+
 	StringBuilder builder(buffer, bufferSize);
 	int flags = DoubleToStringConverter::UNIQUE_ZERO |
 		DoubleToStringConverter::EMIT_POSITIVE_EXPONENT_SIGN;
@@ -19,42 +19,237 @@
 #include <cstring>
 
 
-#ifdef POCO_ARCH_LITTLE_ENDIAN
-	#define SHA1_BYTE_REVERSE(x, y) byteReverse(x, y)
-#else
-	#define SHA1_BYTE_REVERSE(x, y)
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define POCO_SHA1_SHANI
+#define POCO_SHA1_SHANI_TARGET __attribute__((target("sha,sse4.1,ssse3")))
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define POCO_SHA1_SHANI
+#define POCO_SHA1_SHANI_TARGET
+#include <intrin.h>
+#include <immintrin.h>
 #endif
 
 
 namespace Poco {
 
 
-SHA1Engine::SHA1Engine()
+namespace
 {
-	_digest.reserve(16);
-	reset();
+	void transform(UInt32 digest[5], const unsigned char* data, std::size_t blocks);
+
+
+#if defined(POCO_SHA1_SHANI)
+
+	bool hasSHANI()
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) return false;
+		__cpuid(info, 1);
+		if ((info[2] & (1 << 9)) == 0 || (info[2] & (1 << 19)) == 0) return false;
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 29)) != 0;
+#else
+		unsigned a, b, c, d;
+		if (__get_cpuid_max(0, 0) < 7) return false;
+		__cpuid(1, a, b, c, d);
+		if ((c & (1 << 9)) == 0 || (c & (1 << 19)) == 0) return false;
+		__cpuid_count(7, 0, a, b, c, d);
+		return (b & (1 << 29)) != 0;
+#endif
+	}
+
+
+	const bool HAVE_SHANI = hasSHANI();
+
+
+	POCO_SHA1_SHANI_TARGET
+	void transformSHANI(UInt32 digest[5], const unsigned char* data, std::size_t blocks)
+		/// Processes the given number of 64-byte blocks using
+		/// the Intel SHA extensions.
+	{
+		const __m128i mask = _mm_set_epi64x(0x0001020304050607LL, 0x08090a0b0c0d0e0fLL);
+		__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(digest)), 0x1B);
+		__m128i e0 = _mm_set_epi32(static_cast<int>(digest[4]), 0, 0, 0);
+		__m128i e1;
+		__m128i msg0, msg1, msg2, msg3;
+		while (blocks-- > 0)
+		{
+			const __m128i abcdSave = abcd;
+			const __m128i eSave = e0;
+			// rounds 0-3
+			msg0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0)), mask);
+			e0 = _mm_add_epi32(e0, msg0);
+			e1 = abcd;
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+			// rounds 4-7
+			msg1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16)), mask);
+			e1 = _mm_sha1nexte_epu32(e1, msg1);
+			e0 = abcd;
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+			msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+			// rounds 8-11
+			msg2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32)), mask);
+			e0 = _mm_sha1nexte_epu32(e0, msg2);
+			e1 = abcd;
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+			msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+			msg0 = _mm_xor_si128(msg0, msg2);
+			// rounds 12-15
+			msg3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48)), mask);
+			e1 = _mm_sha1nexte_epu32(e1, msg3);
+			e0 = abcd;
+			msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+			msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+			msg1 = _mm_xor_si128(msg1, msg3);
+			// rounds 16-19
+			e0 = _mm_sha1nexte_epu32(e0, msg0);
+			e1 = abcd;
+			msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+			msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+			msg2 = _mm_xor_si128(msg2, msg0);
+			// rounds 20-23
+			e1 = _mm_sha1nexte_epu32(e1, msg1);
+			e0 = abcd;
+			msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+			msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+			msg3 = _mm_xor_si128(msg3, msg1);
+			// rounds 24-27
+			e0 = _mm_sha1nexte_epu32(e0, msg2);
+			e1 = abcd;
+			msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+			msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+			msg0 = _mm_xor_si128(msg0, msg2);
+			// rounds 28-31
+			e1 = _mm_sha1nexte_epu32(e1, msg3);
+			e0 = abcd;
+			msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+			msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+			msg1 = _mm_xor_si128(msg1, msg3);
+			// rounds 32-35
+			e0 = _mm_sha1nexte_epu32(e0, msg0);
+			e1 = abcd;
+			msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 1);
+			msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+			msg2 = _mm_xor_si128(msg2, msg0);
+			// rounds 36-39
+			e1 = _mm_sha1nexte_epu32(e1, msg1);
+			e0 = abcd;
+			msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 1);
+			msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+			msg3 = _mm_xor_si128(msg3, msg1);
+			// rounds 40-43
+			e0 = _mm_sha1nexte_epu32(e0, msg2);
+			e1 = abcd;
+			msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+			msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+			msg0 = _mm_xor_si128(msg0, msg2);
+			// rounds 44-47
+			e1 = _mm_sha1nexte_epu32(e1, msg3);
+			e0 = abcd;
+			msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+			msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+			msg1 = _mm_xor_si128(msg1, msg3);
+			// rounds 48-51
+			e0 = _mm_sha1nexte_epu32(e0, msg0);
+			e1 = abcd;
+			msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+			msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+			msg2 = _mm_xor_si128(msg2, msg0);
+			// rounds 52-55
+			e1 = _mm_sha1nexte_epu32(e1, msg1);
+			e0 = abcd;
+			msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 2);
+			msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+			msg3 = _mm_xor_si128(msg3, msg1);
+			// rounds 56-59
+			e0 = _mm_sha1nexte_epu32(e0, msg2);
+			e1 = abcd;
+			msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 2);
+			msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+			msg0 = _mm_xor_si128(msg0, msg2);
+			// rounds 60-63
+			e1 = _mm_sha1nexte_epu32(e1, msg3);
+			e0 = abcd;
+			msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+			msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+			msg1 = _mm_xor_si128(msg1, msg3);
+			// rounds 64-67
+			e0 = _mm_sha1nexte_epu32(e0, msg0);
+			e1 = abcd;
+			msg1 = _mm_sha1msg2_epu32(msg1, msg0);
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+			msg3 = _mm_sha1msg1_epu32(msg3, msg0);
+			msg2 = _mm_xor_si128(msg2, msg0);
+			// rounds 68-71
+			e1 = _mm_sha1nexte_epu32(e1, msg1);
+			e0 = abcd;
+			msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+			msg3 = _mm_xor_si128(msg3, msg1);
+			// rounds 72-75
+			e0 = _mm_sha1nexte_epu32(e0, msg2);
+			e1 = abcd;
+			msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+			abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+			// rounds 76-79
+			e1 = _mm_sha1nexte_epu32(e1, msg3);
+			e0 = abcd;
+			abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+			e0 = _mm_sha1nexte_epu32(e0, eSave);
+			abcd = _mm_add_epi32(abcd, abcdSave);
+			data += 64;
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(digest), _mm_shuffle_epi32(abcd, 0x1B));
+		digest[4] = static_cast<UInt32>(_mm_extract_epi32(e0, 3));
+	}
+
+#endif // POCO_SHA1_SHANI
+
+
+	inline void process(UInt32 digest[5], const unsigned char* data, std::size_t blocks)
+	{
+#if defined(POCO_SHA1_SHANI)
+		if (HAVE_SHANI)
+		{
+			transformSHANI(digest, data, blocks);
+			return;
+		}
+#endif
+		transform(digest, data, blocks);
+	}
 }
 
 
-SHA1Engine::~SHA1Engine()
+SHA1Engine::SHA1Engine()
 {
+	_digest.reserve(DIGEST_SIZE);
 	reset();
 }
 
 
-inline void SHA1Engine::byteReverse(UInt32* buffer, int byteCount)
+SHA1Engine::~SHA1Engine()
 {
-#ifdef POCO_ARCH_LITTLE_ENDIAN
-	byteCount /= sizeof(UInt32);
-	for(int count = 0; count < byteCount; count++)
-	{
-		UInt32 value = (buffer[ count ] << 16) | (buffer[ count ] >> 16);
-		buffer[count] = ((value & 0xFF00FF00L) >> 8) | ((value & 0x00FF00FFL) << 8);
-	}
-#endif // POCO_ARCH_LITTLE_ENDIAN
+	reset();
 }
 
-	
+
 void SHA1Engine::updateImpl(const void* buffer_, std::size_t count)
 {
 	const BYTE* buffer = (const BYTE*) buffer_;
@@ -66,17 +261,34 @@ void SHA1Engine::updateImpl(const void* buffer_, std::size_t count)
 	_context.countLo += ((UInt32) count << 3);
 	_context.countHi += ((UInt32 ) count >> 29);
 
-	/* Process data in BLOCK_SIZE chunks */
-	while (count-- > 0)
+	/* Complete a partially filled block first */
+	if (_context.slop > 0)
 	{
-		db[_context.slop++] = *(buffer++);
-		if (_context.slop == BLOCK_SIZE)
-		{ 
-			/* transform this one block */
-			SHA1_BYTE_REVERSE(_context.data, BLOCK_SIZE);
-			transform();
-			_context.slop = 0 ;	/* no slop left */
-		}
+		std::size_t n = BLOCK_SIZE - _context.slop;
+		if (n > count) n = count;
+		std::memcpy(db + _context.slop, buffer, n);
+		_context.slop += static_cast<UInt32>(n);
+		buffer += n;
+		count -= n;
+		if (_context.slop < BLOCK_SIZE) return;
+		process(_context.digest, db, 1);
+		_context.slop = 0;
+	}
+
+	/* Process whole blocks directly from the caller's buffer */
+	if (count >= BLOCK_SIZE)
+	{
+		std::size_t blocks = count/BLOCK_SIZE;
+		process(_context.digest, buffer, blocks);
+		buffer += blocks*BLOCK_SIZE;
+		count -= blocks*BLOCK_SIZE;
+	}
+
+	/* Save the remaining bytes */
+	if (count > 0)
+	{
+		std::memcpy(db, buffer, count);
+		_context.slop = static_cast<UInt32>(count);
 	}
 }
 
@@ -112,32 +324,32 @@ const DigestEngine::Digest& SHA1Engine::digest()
 
 	/* Set the first char of padding to 0x80.  This is safe since there is
 		always at least one byte free */
-	((BYTE*) _context.data)[count++] = 0x80;
+	BYTE* db = (BYTE*) _context.data;
+	db[count++] = 0x80;
 
 	/* Pad out to 56 mod 64 */
 	if (count > 56)
 	{
 		/* Two lots of padding:  Pad the first block to 64 bytes */
-		std::memset((BYTE*) &_context.data + count, 0, 64 - count);
-		SHA1_BYTE_REVERSE(_context.data, BLOCK_SIZE);
-		transform();
+		std::memset(db + count, 0, 64 - count);
+		process(_context.digest, db, 1);
 
 		/* Now fill the next block with 56 bytes */
-		std::memset(&_context.data, 0, 56);
+		std::memset(db, 0, 56);
 	}
 	else
 	{
 		/* Pad block to 56 bytes */
-		std::memset((BYTE*) &_context.data + count, 0, 56 - count);
+		std::memset(db + count, 0, 56 - count);
 	}
-	SHA1_BYTE_REVERSE(_context.data, BLOCK_SIZE);
-
-	/* Append length in bits and transform */
-	_context.data[14] = highBitcount;
-	_context.data[15] = lowBitcount;
 
-	transform();
-	SHA1_BYTE_REVERSE(_context.data, DIGEST_SIZE);
+	/* Append length in bits (big-endian) and transform */
+	for (count = 0; count < 4; count++)
+	{
+		db[56 + count] = (BYTE) (highBitcount >> (8*(3 - count)));
+		db[60 + count] = (BYTE) (lowBitcount >> (8*(3 - count)));
+	}
+	process(_context.digest, db, 1);
 
 	unsigned char hash[DIGEST_SIZE];
 	for (count = 0; count < DIGEST_SIZE; count++)
@@ -216,67 +428,73 @@ typedef UInt32 UL;	/* to save space */
 }
 
 
-void SHA1Engine::transform()
+namespace
 {
-	UInt32 W[80];
-	UInt32 temp;
-	UInt32 A, B, C, D, E;
-	int i;
-
-	/* Step A.  Copy the data buffer into the local work buffer */
-	for( i = 0; i < 16; i++ )
-	W[ i ] = _context.data[ i ];
-
-	/* Step B.  Expand the 16 words into 64 temporary data words */
-	expand( 16 ); expand( 17 ); expand( 18 ); expand( 19 ); expand( 20 );
-	expand( 21 ); expand( 22 ); expand( 23 ); expand( 24 ); expand( 25 );
-	expand( 26 ); expand( 27 ); expand( 28 ); expand( 29 ); expand( 30 );
-	expand( 31 ); expand( 32 ); expand( 33 ); expand( 34 ); expand( 35 );
-	expand( 36 ); expand( 37 ); expand( 38 ); expand( 39 ); expand( 40 );
-	expand( 41 ); expand( 42 ); expand( 43 ); expand( 44 ); expand( 45 );
-	expand( 46 ); expand( 47 ); expand( 48 ); expand( 49 ); expand( 50 );
-	expand( 51 ); expand( 52 ); expand( 53 ); expand( 54 ); expand( 55 );
-	expand( 56 ); expand( 57 ); expand( 58 ); expand( 59 ); expand( 60 );
-	expand( 61 ); expand( 62 ); expand( 63 ); expand( 64 ); expand( 65 );
-	expand( 66 ); expand( 67 ); expand( 68 ); expand( 69 ); expand( 70 );
-	expand( 71 ); expand( 72 ); expand( 73 ); expand( 74 ); expand( 75 );
-	expand( 76 ); expand( 77 ); expand( 78 ); expand( 79 );
-
-	/* Step C.  Set up first buffer */
-	A = _context.digest[ 0 ];
-	B = _context.digest[ 1 ];
-	C = _context.digest[ 2 ];
-	D = _context.digest[ 3 ];
-	E = _context.digest[ 4 ];
-
-	/* Step D.  Serious mangling, divided into four sub-rounds */
-	subRound1( 0 ); subRound1( 1 ); subRound1( 2 ); subRound1( 3 );
-	subRound1( 4 ); subRound1( 5 ); subRound1( 6 ); subRound1( 7 );
-	subRound1( 8 ); subRound1( 9 ); subRound1( 10 ); subRound1( 11 );
-	subRound1( 12 ); subRound1( 13 ); subRound1( 14 ); subRound1( 15 );
-	subRound1( 16 ); subRound1( 17 ); subRound1( 18 ); subRound1( 19 );
-	subRound2( 20 ); subRound2( 21 ); subRound2( 22 ); subRound2( 23 );
-	subRound2( 24 ); subRound2( 25 ); subRound2( 26 ); subRound2( 27 );
-	subRound2( 28 ); subRound2( 29 ); subRound2( 30 ); subRound2( 31 );
-	subRound2( 32 ); subRound2( 33 ); subRound2( 34 ); subRound2( 35 );
-	subRound2( 36 ); subRound2( 37 ); subRound2( 38 ); subRound2( 39 );
-	subRound3( 40 ); subRound3( 41 ); subRound3( 42 ); subRound3( 43 );
-	subRound3( 44 ); subRound3( 45 ); subRound3( 46 ); subRound3( 47 );
-	subRound3( 48 ); subRound3( 49 ); subRound3( 50 ); subRound3( 51 );
-	subRound3( 52 ); subRound3( 53 ); subRound3( 54 ); subRound3( 55 );
-	subRound3( 56 ); subRound3( 57 ); subRound3( 58 ); subRound3( 59 );
-	subRound4( 60 ); subRound4( 61 ); subRound4( 62 ); subRound4( 63 );
-	subRound4( 64 ); subRound4( 65 ); subRound4( 66 ); subRound4( 67 );
-	subRound4( 68 ); subRound4( 69 ); subRound4( 70 ); subRound4( 71 );
-	subRound4( 72 ); subRound4( 73 ); subRound4( 74 ); subRound4( 75 );
-	subRound4( 76 ); subRound4( 77 ); subRound4( 78 ); subRound4( 79 );
-
-	/* Step E.  Build message digest */
-	_context.digest[ 0 ] += A;
-	_context.digest[ 1 ] += B;
-	_context.digest[ 2 ] += C;
-	_context.digest[ 3 ] += D;
-	_context.digest[ 4 ] += E;
+	void transform(UInt32 digest[5], const unsigned char* data, std::size_t blocks)
+	{
+		UInt32 W[80];
+		UInt32 temp;
+		UInt32 A, B, C, D, E;
+		int i;
+
+		for (; blocks > 0; blocks--, data += 64)
+		{
+			/* Step A.  Copy the (big-endian) data block into the local work buffer */
+			for (i = 0; i < 16; i++)
+				W[i] = ((UInt32) data[4*i] << 24) | ((UInt32) data[4*i + 1] << 16) | ((UInt32) data[4*i + 2] << 8) | (UInt32) data[4*i + 3];
+
+			/* Step B.  Expand the 16 words into 64 temporary data words */
+			expand( 16 ); expand( 17 ); expand( 18 ); expand( 19 ); expand( 20 );
+			expand( 21 ); expand( 22 ); expand( 23 ); expand( 24 ); expand( 25 );
+			expand( 26 ); expand( 27 ); expand( 28 ); expand( 29 ); expand( 30 );
+			expand( 31 ); expand( 32 ); expand( 33 ); expand( 34 ); expand( 35 );
+			expand( 36 ); expand( 37 ); expand( 38 ); expand( 39 ); expand( 40 );
+			expand( 41 ); expand( 42 ); expand( 43 ); expand( 44 ); expand( 45 );
+			expand( 46 ); expand( 47 ); expand( 48 ); expand( 49 ); expand( 50 );
+			expand( 51 ); expand( 52 ); expand( 53 ); expand( 54 ); expand( 55 );
+			expand( 56 ); expand( 57 ); expand( 58 ); expand( 59 ); expand( 60 );
+			expand( 61 ); expand( 62 ); expand( 63 ); expand( 64 ); expand( 65 );
+			expand( 66 ); expand( 67 ); expand( 68 ); expand( 69 ); expand( 70 );
+			expand( 71 ); expand( 72 ); expand( 73 ); expand( 74 ); expand( 75 );
+			expand( 76 ); expand( 77 ); expand( 78 ); expand( 79 );
+
+			/* Step C.  Set up first buffer */
+			A = digest[ 0 ];
+			B = digest[ 1 ];
+			C = digest[ 2 ];
+			D = digest[ 3 ];
+			E = digest[ 4 ];
+
+			/* Step D.  Serious mangling, divided into four sub-rounds */
+			subRound1( 0 ); subRound1( 1 ); subRound1( 2 ); subRound1( 3 );
+			subRound1( 4 ); subRound1( 5 ); subRound1( 6 ); subRound1( 7 );
+			subRound1( 8 ); subRound1( 9 ); subRound1( 10 ); subRound1( 11 );
+			subRound1( 12 ); subRound1( 13 ); subRound1( 14 ); subRound1( 15 );
+			subRound1( 16 ); subRound1( 17 ); subRound1( 18 ); subRound1( 19 );
+			subRound2( 20 ); subRound2( 21 ); subRound2( 22 ); subRound2( 23 );
+			subRound2( 24 ); subRound2( 25 ); subRound2( 26 ); subRound2( 27 );
+			subRound2( 28 ); subRound2( 29 ); subRound2( 30 ); subRound2( 31 );
+			subRound2( 32 ); subRound2( 33 ); subRound2( 34 ); subRound2( 35 );
+			subRound2( 36 ); subRound2( 37 ); subRound2( 38 ); subRound2( 39 );
+			subRound3( 40 ); subRound3( 41 ); subRound3( 42 ); subRound3( 43 );
+			subRound3( 44 ); subRound3( 45 ); subRound3( 46 ); subRound3( 47 );
+			subRound3( 48 ); subRound3( 49 ); subRound3( 50 ); subRound3( 51 );
+			subRound3( 52 ); subRound3( 53 ); subRound3( 54 ); subRound3( 55 );
+			subRound3( 56 ); subRound3( 57 ); subRound3( 58 ); subRound3( 59 );
+			subRound4( 60 ); subRound4( 61 ); subRound4( 62 ); subRound4( 63 );
+			subRound4( 64 ); subRound4( 65 ); subRound4( 66 ); subRound4( 67 );
+			subRound4( 68 ); subRound4( 69 ); subRound4( 70 ); subRound4( 71 );
+			subRound4( 72 ); subRound4( 73 ); subRound4( 74 ); subRound4( 75 );
+			subRound4( 76 ); subRound4( 77 ); subRound4( 78 ); subRound4( 79 );
+
+			/* Step E.  Build message digest */
+			digest[ 0 ] += A;
+			digest[ 1 ] += B;
+			digest[ 2 ] += C;
+			digest[ 3 ] += D;
+			digest[ 4 ] += E;
+		}
+	}
 }
 
 
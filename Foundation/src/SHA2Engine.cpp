@@ -24,6 +24,21 @@
 #include <string.h>
 
 
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define POCO_SHA2_X86
+#define POCO_SHA2_SHANI_TARGET __attribute__((target("sha,sse4.1,ssse3")))
+#define POCO_SHA2_AVX2_TARGET __attribute__((target("avx2")))
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define POCO_SHA2_X86
+#define POCO_SHA2_SHANI_TARGET
+#define POCO_SHA2_AVX2_TARGET
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+
 namespace Poco {
 
 
@@ -197,127 +212,644 @@ do {                                              \
 #endif
 
 
-SHA2Engine::SHA2Engine(ALGORITHM algorithm):
-	_context(NULL),
-	_algorithm(algorithm)
+namespace
 {
-	_digest.reserve(digestLength());
-	reset();
-}
+	void sha256Process(Poco::UInt32 state[8], const unsigned char data[64])
+	{
+		unsigned int i;
+		Poco::UInt32 temp1, temp2, temp3[8], W[64];
+		for (i = 0; i < 8; i++) temp3[i] = state[i];
+		for (i = 0; i < 16; i++) { GET_UINT32(W[i], data, 4 * i); }
+		for (i = 0; i < 16; i += 8)
+		{
+			P32(temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], W[i + 0], K32[i + 0]);
+			P32(temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], W[i + 1], K32[i + 1]);
+			P32(temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], W[i + 2], K32[i + 2]);
+			P32(temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], W[i + 3], K32[i + 3]);
+			P32(temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], W[i + 4], K32[i + 4]);
+			P32(temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], W[i + 5], K32[i + 5]);
+			P32(temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], W[i + 6], K32[i + 6]);
+			P32(temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], W[i + 7], K32[i + 7]);
+		}
+		for (i = 16; i < 64; i += 8)
+		{
+			P32(temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], R32(i + 0), K32[i + 0]);
+			P32(temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], R32(i + 1), K32[i + 1]);
+			P32(temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], R32(i + 2), K32[i + 2]);
+			P32(temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], R32(i + 3), K32[i + 3]);
+			P32(temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], R32(i + 4), K32[i + 4]);
+			P32(temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], R32(i + 5), K32[i + 5]);
+			P32(temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], R32(i + 6), K32[i + 6]);
+			P32(temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], R32(i + 7), K32[i + 7]);
+		}
+		for (i = 0; i < 8; i++) state[i] += temp3[i];
+	}
 
 
-SHA2Engine::~SHA2Engine()
-{
-	reset();
-	free(_context);
-}
+	void sha512Process(HASHCONTEXT* pContext, const unsigned char data[128])
+	{
+		int i;
+		Poco::UInt64 temp1, temp2, temp3[8], W[80];
+		for (i = 0; i < 16; i++) { GET_UINT64(W[i], data, i << 3); }
+		for (; i < 80; i++) { W[i] = S641(W[i - 2]) + W[i - 7] + S640(W[i - 15]) + W[i - 16]; }
+		for (i = 0; i < 8; i++) temp3[i] = pContext->state.state64[i];
+		i = 0;
+		do
+		{
+			P64(temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], W[i], K64[i]); i++;
+			P64(temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], W[i], K64[i]); i++;
+			P64(temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], W[i], K64[i]); i++;
+			P64(temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], W[i], K64[i]); i++;
+			P64(temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], W[i], K64[i]); i++;
+			P64(temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], W[i], K64[i]); i++;
+			P64(temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], W[i], K64[i]); i++;
+			P64(temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], W[i], K64[i]); i++;
+		} while (i < 80);
+		for (i = 0; i < 8; i++) pContext->state.state64[i] += temp3[i];
+	}
 
 
-void _sha256_process(HASHCONTEXT* pContext, const unsigned char data[64])
-{
-	unsigned int i;
-	Poco::UInt32 temp1, temp2, temp3[8], W[64];
-	for (i = 0; i < 8; i++) temp3[i] = pContext->state.state32[i];
-	for (i = 0; i < 16; i++) { GET_UINT32(W[i], data, 4 * i); }
-	for (i = 0; i < 16; i += 8)
+#if defined(POCO_SHA2_X86)
+
+	bool hasSHANI()
 	{
-		P32(temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], W[i + 0], K32[i + 0]);
-		P32(temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], W[i + 1], K32[i + 1]);
-		P32(temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], W[i + 2], K32[i + 2]);
-		P32(temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], W[i + 3], K32[i + 3]);
-		P32(temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], W[i + 4], K32[i + 4]);
-		P32(temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], W[i + 5], K32[i + 5]);
-		P32(temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], W[i + 6], K32[i + 6]);
-		P32(temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], W[i + 7], K32[i + 7]);
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) return false;
+		__cpuid(info, 1);
+		if ((info[2] & (1 << 9)) == 0 || (info[2] & (1 << 19)) == 0) return false;
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 29)) != 0;
+#else
+		unsigned a, b, c, d;
+		if (__get_cpuid_max(0, 0) < 7) return false;
+		__cpuid(1, a, b, c, d);
+		if ((c & (1 << 9)) == 0 || (c & (1 << 19)) == 0) return false;
+		__cpuid_count(7, 0, a, b, c, d);
+		return (b & (1 << 29)) != 0;
+#endif
 	}
-	for (i = 16; i < 64; i += 8)
+
+
+	bool hasAVX2()
 	{
-		P32(temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], R32(i + 0), K32[i + 0]);
-		P32(temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], R32(i + 1), K32[i + 1]);
-		P32(temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], R32(i + 2), K32[i + 2]);
-		P32(temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], R32(i + 3), K32[i + 3]);
-		P32(temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], R32(i + 4), K32[i + 4]);
-		P32(temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], R32(i + 5), K32[i + 5]);
-		P32(temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], R32(i + 6), K32[i + 6]);
-		P32(temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], R32(i + 7), K32[i + 7]);
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) return false;
+		__cpuid(info, 1);
+		if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0) return false;
+		if ((_xgetbv(0) & 6) != 6) return false;
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") != 0;
+#endif
 	}
-	for (i = 0; i < 8; i++) pContext->state.state32[i] += temp3[i];
-}
 
 
-void _sha512_process(HASHCONTEXT* pContext, const unsigned char data[128])
-{
-	int i;
-	Poco::UInt64 temp1, temp2, temp3[8], W[80];
-	for (i = 0; i < 16; i++) { GET_UINT64(W[i], data, i << 3); }
-	for (; i < 80; i++) { W[i] = S641(W[i - 2]) + W[i - 7] + S640(W[i - 15]) + W[i - 16]; }
-	for (i = 0; i < 8; i++) temp3[i] = pContext->state.state64[i];
-	i = 0;
-	do
+	const bool HAVE_SHANI = hasSHANI();
+	const bool HAVE_AVX2 = hasAVX2();
+
+
+	POCO_SHA2_SHANI_TARGET
+	void sha256ProcessSHANI(Poco::UInt32 state[8], const unsigned char* data, std::size_t blocks)
+		/// Processes the given number of 64-byte blocks using
+		/// the Intel SHA extensions.
 	{
-		P64(temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], W[i], K64[i]); i++;
-		P64(temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], W[i], K64[i]); i++;
-		P64(temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], W[i], K64[i]); i++;
-		P64(temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], temp3[4], W[i], K64[i]); i++;
-		P64(temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], temp3[3], W[i], K64[i]); i++;
-		P64(temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], temp3[2], W[i], K64[i]); i++;
-		P64(temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], temp3[1], W[i], K64[i]); i++;
-		P64(temp3[1], temp3[2], temp3[3], temp3[4], temp3[5], temp3[6], temp3[7], temp3[0], W[i], K64[i]); i++;
-	} while (i < 80);
-	for (i = 0; i < 8; i++) pContext->state.state64[i] += temp3[i];
-}
+		const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL);
+		__m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xB1); // CDAB
+		__m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1B); // EFGH
+		__m128i state0 = _mm_alignr_epi8(tmp, state1, 8); // ABEF
+		state1 = _mm_blend_epi16(state1, tmp, 0xF0); // CDGH
+		__m128i msg, msg0, msg1, msg2, msg3;
+		while (blocks-- > 0)
+		{
+			const __m128i abefSave = state0;
+			const __m128i cdghSave = state1;
+			// rounds 0-3
+			msg0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0)), mask);
+			msg = _mm_add_epi32(msg0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K32 + 0)));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+			// rounds 4-7
+			msg1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16)), mask);
+			msg = _mm_add_epi32(msg1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K32 + 4)));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+			msg0 = _mm_sha256msg1_epu32(msg0, msg1);
+			// rounds 8-11
+			msg2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32)), mask);
+			msg = _mm_add_epi32(msg2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K32 + 8)));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+			msg1 = _mm_sha256msg1_epu32(msg1, msg2);
+			// rounds 12-15
+			msg3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48)), mask);
+			msg = _mm_add_epi32(msg3, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K32 + 12)));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msg0 = _mm_sha256msg2_epu32(_mm_add_epi32(msg0, _mm_alignr_epi8(msg3, msg2, 4)), msg3);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+			msg2 = _mm_sha256msg1_epu32(msg2, msg3);
+			// rounds 16-19
+			msg = _mm_add_epi32(msg0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K32 + 16)));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msg1 = _mm_sha256msg2_epu32(_mm_add_epi32(msg1, _mm_alignr_epi8(msg0, msg3, 4)), msg0);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+			msg3 = _mm_sha256msg1_epu32(msg3, msg0);
+			// rounds 20-23
+			msg = _mm_add_epi32(msg1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K32 + 20)));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msg2 = _mm_sha256msg2_epu32(_mm_add_epi32(msg2, _mm_alignr_epi8(msg1, msg0, 4)), msg1);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+			msg0 = _mm_sha256msg1_epu32(msg0, msg1);
+			// rounds 24-27
+			msg = _mm_add_epi32(msg2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K32 + 24)));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msg3 = _mm_sha256msg2_epu32(_mm_add_epi32(msg3, _mm_alignr_epi8(msg2, msg1, 4)), msg2);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+			msg1 = _mm_sha256msg1_epu32(msg1, msg2);
+			// rounds 28-31
+			msg = _mm_add_epi32(msg3, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K32 + 28)));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msg0 = _mm_sha256msg2_epu32(_mm_add_epi32(msg0, _mm_alignr_epi8(msg3, msg2, 4)), msg3);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+			msg2 = _mm_sha256msg1_epu32(msg2, msg3);
+			// rounds 32-35
+			msg = _mm_add_epi32(msg0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K32 + 32)));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msg1 = _mm_sha256msg2_epu32(_mm_add_epi32(msg1, _mm_alignr_epi8(msg0, msg3, 4)), msg0);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+			msg3 = _mm_sha256msg1_epu32(msg3, msg0);
+			// rounds 36-39
+			msg = _mm_add_epi32(msg1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K32 + 36)));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msg2 = _mm_sha256msg2_epu32(_mm_add_epi32(msg2, _mm_alignr_epi8(msg1, msg0, 4)), msg1);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+			msg0 = _mm_sha256msg1_epu32(msg0, msg1);
+			// rounds 40-43
+			msg = _mm_add_epi32(msg2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K32 + 40)));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msg3 = _mm_sha256msg2_epu32(_mm_add_epi32(msg3, _mm_alignr_epi8(msg2, msg1, 4)), msg2);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+			msg1 = _mm_sha256msg1_epu32(msg1, msg2);
+			// rounds 44-47
+			msg = _mm_add_epi32(msg3, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K32 + 44)));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msg0 = _mm_sha256msg2_epu32(_mm_add_epi32(msg0, _mm_alignr_epi8(msg3, msg2, 4)), msg3);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+			msg2 = _mm_sha256msg1_epu32(msg2, msg3);
+			// rounds 48-51
+			msg = _mm_add_epi32(msg0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K32 + 48)));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msg1 = _mm_sha256msg2_epu32(_mm_add_epi32(msg1, _mm_alignr_epi8(msg0, msg3, 4)), msg0);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+			msg3 = _mm_sha256msg1_epu32(msg3, msg0);
+			// rounds 52-55
+			msg = _mm_add_epi32(msg1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K32 + 52)));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msg2 = _mm_sha256msg2_epu32(_mm_add_epi32(msg2, _mm_alignr_epi8(msg1, msg0, 4)), msg1);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+			// rounds 56-59
+			msg = _mm_add_epi32(msg2, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K32 + 56)));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			msg3 = _mm_sha256msg2_epu32(_mm_add_epi32(msg3, _mm_alignr_epi8(msg2, msg1, 4)), msg2);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+			// rounds 60-63
+			msg = _mm_add_epi32(msg3, _mm_loadu_si128(reinterpret_cast<const __m128i*>(K32 + 60)));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+			state0 = _mm_add_epi32(state0, abefSave);
+			state1 = _mm_add_epi32(state1, cdghSave);
+			data += 64;
+		}
+		tmp = _mm_shuffle_epi32(state0, 0x1B); // FEBA
+		state1 = _mm_shuffle_epi32(state1, 0xB1); // DCHG
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_blend_epi16(tmp, state1, 0xF0)); // DCBA
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), _mm_alignr_epi8(state1, tmp, 8)); // HGFE
+	}
 
 
-void SHA2Engine::updateImpl(const void* buffer_, std::size_t count)
-{
-	if (_context == NULL || buffer_ == NULL || count == 0) return;
-	Poco::UInt32 left = 0;
-	HASHCONTEXT* pContext = (HASHCONTEXT*)_context;
-	unsigned char* data = (unsigned char*)buffer_;
-	if (pContext->size > SHA_256)
+#define ROTR256(x,n) _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n))
+#define S2560(x) _mm256_xor_si256(_mm256_xor_si256(ROTR256(x, 7), ROTR256(x,18)), _mm256_srli_epi32(x, 3))
+#define S2561(x) _mm256_xor_si256(_mm256_xor_si256(ROTR256(x,17), ROTR256(x,19)), _mm256_srli_epi32(x,10))
+#define S2562(x) _mm256_xor_si256(_mm256_xor_si256(ROTR256(x, 2), ROTR256(x,13)), ROTR256(x,22))
+#define S2563(x) _mm256_xor_si256(_mm256_xor_si256(ROTR256(x, 6), ROTR256(x,11)), ROTR256(x,25))
+
+
+	POCO_SHA2_AVX2_TARGET
+	void transpose8(__m256i r[8])
+		/// Transposes a matrix of 8 x 8 32-bit words.
 	{
-		left = (Poco::UInt32)(pContext->total.total64[0] & 0x7F);
-		size_t fill = 128 - left;
-		pContext->total.total64[0] += (Poco::UInt64)count;
-		if (pContext->total.total64[0] < (Poco::UInt64)count)	pContext->total.total64[1]++;
-		if (left && count >= fill)
+		const __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+		const __m256i t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+		const __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+		const __m256i t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+		const __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+		const __m256i t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+		const __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+		const __m256i t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+		const __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+		const __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+		const __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+		const __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+		const __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+		const __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+		const __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+		const __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+		r[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+		r[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+		r[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+		r[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+		r[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+		r[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+		r[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+		r[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+	}
+
+
+	POCO_SHA2_AVX2_TARGET
+	void sha256ProcessLanesAVX2(Poco::UInt32 state[8][8], const unsigned char* const data[8])
+		/// Processes one 64-byte block for each of eight independent
+		/// messages. state[i][lane] holds word i of the lane's state.
+	{
+		const __m256i swap = _mm256_setr_epi8(
+			3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+			3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+		__m256i W[16];
+		int i;
+		for (i = 0; i < 8; i++)
 		{
-			memcpy((void *)(pContext->buffer + left), data, fill);
-			_sha512_process(pContext, pContext->buffer);
-			data += fill;
-			count -= fill;
-			left = 0;
+			W[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data[i]));
+			W[i + 8] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data[i] + 32));
 		}
-		while (count >= 128)
+		transpose8(W);
+		transpose8(W + 8);
+		for (i = 0; i < 16; i++) W[i] = _mm256_shuffle_epi8(W[i], swap);
+
+		__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[0]));
+		__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[1]));
+		__m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[2]));
+		__m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[3]));
+		__m256i e = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[4]));
+		__m256i f = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[5]));
+		__m256i g = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[6]));
+		__m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[7]));
+		for (i = 0; i < 64; i++)
 		{
-			_sha512_process(pContext, data);
-			data += 128;
-			count -= 128;
+			if (i >= 16)
+			{
+				W[i & 15] = _mm256_add_epi32(
+					_mm256_add_epi32(W[i & 15], S2561(W[(i - 2) & 15])),
+					_mm256_add_epi32(W[(i - 7) & 15], S2560(W[(i - 15) & 15])));
+			}
+			const __m256i ch = _mm256_xor_si256(g, _mm256_and_si256(e, _mm256_xor_si256(f, g)));
+			const __m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+			const __m256i temp1 = _mm256_add_epi32(
+				_mm256_add_epi32(h, S2563(e)),
+				_mm256_add_epi32(ch, _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(K32[i])), W[i & 15])));
+			const __m256i temp2 = _mm256_add_epi32(S2562(a), maj);
+			h = g;
+			g = f;
+			f = e;
+			e = _mm256_add_epi32(d, temp1);
+			d = c;
+			c = b;
+			b = a;
+			a = _mm256_add_epi32(temp1, temp2);
 		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(state[0]), _mm256_add_epi32(a, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[0]))));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(state[1]), _mm256_add_epi32(b, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[1]))));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(state[2]), _mm256_add_epi32(c, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[2]))));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(state[3]), _mm256_add_epi32(d, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[3]))));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(state[4]), _mm256_add_epi32(e, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[4]))));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(state[5]), _mm256_add_epi32(f, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[5]))));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(state[6]), _mm256_add_epi32(g, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[6]))));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(state[7]), _mm256_add_epi32(h, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[7]))));
 	}
-	else
+
+
+#undef ROTR256
+#undef S2560
+#undef S2561
+#undef S2562
+#undef S2563
+
+#endif // POCO_SHA2_X86
+
+
+	void sha256Blocks(HASHCONTEXT* pContext, const unsigned char* data, std::size_t blocks)
 	{
-		left = (Poco::UInt32)(pContext->total.total32[0] & 0x3F);
-		size_t fill = 64 - left;
-		pContext->total.total32[0] += (Poco::UInt32)count;
-		pContext->total.total32[0] &= 0xFFFFFFFF;
-		if (pContext->total.total32[0] < (Poco::UInt32)count) pContext->total.total32[1]++;
-		if (left && count >= fill)
+#if defined(POCO_SHA2_X86)
+		if (HAVE_SHANI)
 		{
-			memcpy((void *)(pContext->buffer + left), data, fill);
-			_sha256_process(pContext, pContext->buffer);
-			data += fill;
-			count -= fill;
-			left = 0;
+			sha256ProcessSHANI(pContext->state.state32, data, blocks);
+			return;
 		}
-		while (count >= 64)
+#endif
+		for (; blocks > 0; blocks--, data += 64)
 		{
-			_sha256_process(pContext, data);
-			data += 64;
-			count -= 64;
+			sha256Process(pContext->state.state32, data);
+		}
+	}
+
+
+	void sha2Init(HASHCONTEXT* pContext, SHA2Engine::ALGORITHM algorithm)
+	{
+		memset(pContext, 0, sizeof(HASHCONTEXT));
+		pContext->size = algorithm;
+		if (algorithm == SHA2Engine::SHA_224)
+		{
+			pContext->state.state32[0] = 0xC1059ED8;
+			pContext->state.state32[1] = 0x367CD507;
+			pContext->state.state32[2] = 0x3070DD17;
+			pContext->state.state32[3] = 0xF70E5939;
+			pContext->state.state32[4] = 0xFFC00B31;
+			pContext->state.state32[5] = 0x68581511;
+			pContext->state.state32[6] = 0x64F98FA7;
+			pContext->state.state32[7] = 0xBEFA4FA4;
+		}
+		else if (algorithm == SHA2Engine::SHA_256)
+		{
+			pContext->state.state32[0] = 0x6A09E667;
+			pContext->state.state32[1] = 0xBB67AE85;
+			pContext->state.state32[2] = 0x3C6EF372;
+			pContext->state.state32[3] = 0xA54FF53A;
+			pContext->state.state32[4] = 0x510E527F;
+			pContext->state.state32[5] = 0x9B05688C;
+			pContext->state.state32[6] = 0x1F83D9AB;
+			pContext->state.state32[7] = 0x5BE0CD19;
+		}
+		else if (algorithm == SHA2Engine::SHA_384)
+		{
+			pContext->state.state64[0] = UL64(0xCBBB9D5DC1059ED8);
+			pContext->state.state64[1] = UL64(0x629A292A367CD507);
+			pContext->state.state64[2] = UL64(0x9159015A3070DD17);
+			pContext->state.state64[3] = UL64(0x152FECD8F70E5939);
+			pContext->state.state64[4] = UL64(0x67332667FFC00B31);
+			pContext->state.state64[5] = UL64(0x8EB44A8768581511);
+			pContext->state.state64[6] = UL64(0xDB0C2E0D64F98FA7);
+			pContext->state.state64[7] = UL64(0x47B5481DBEFA4FA4);
+		}
+		else
+		{
+			pContext->state.state64[0] = UL64(0x6A09E667F3BCC908);
+			pContext->state.state64[1] = UL64(0xBB67AE8584CAA73B);
+			pContext->state.state64[2] = UL64(0x3C6EF372FE94F82B);
+			pContext->state.state64[3] = UL64(0xA54FF53A5F1D36F1);
+			pContext->state.state64[4] = UL64(0x510E527FADE682D1);
+			pContext->state.state64[5] = UL64(0x9B05688C2B3E6C1F);
+			pContext->state.state64[6] = UL64(0x1F83D9ABFB41BD6B);
+			pContext->state.state64[7] = UL64(0x5BE0CD19137E2179);
+		}
+	}
+
+
+	void sha2Update(HASHCONTEXT* pContext, const unsigned char* data, std::size_t count)
+	{
+		if (count == 0) return;
+		Poco::UInt32 left = 0;
+		if (pContext->size > SHA2Engine::SHA_256)
+		{
+			left = (Poco::UInt32)(pContext->total.total64[0] & 0x7F);
+			size_t fill = 128 - left;
+			pContext->total.total64[0] += (Poco::UInt64)count;
+			if (pContext->total.total64[0] < (Poco::UInt64)count)	pContext->total.total64[1]++;
+			if (left && count >= fill)
+			{
+				memcpy((void *)(pContext->buffer + left), data, fill);
+				sha512Process(pContext, pContext->buffer);
+				data += fill;
+				count -= fill;
+				left = 0;
+			}
+			while (count >= 128)
+			{
+				sha512Process(pContext, data);
+				data += 128;
+				count -= 128;
+			}
+		}
+		else
+		{
+			left = (Poco::UInt32)(pContext->total.total32[0] & 0x3F);
+			size_t fill = 64 - left;
+			pContext->total.total32[0] += (Poco::UInt32)count;
+			pContext->total.total32[0] &= 0xFFFFFFFF;
+			if (pContext->total.total32[0] < (Poco::UInt32)count) pContext->total.total32[1]++;
+			if (left && count >= fill)
+			{
+				memcpy((void *)(pContext->buffer + left), data, fill);
+				sha256Blocks(pContext, pContext->buffer, 1);
+				data += fill;
+				count -= fill;
+				left = 0;
+			}
+			if (count >= 64)
+			{
+				std::size_t blocks = count/64;
+				sha256Blocks(pContext, data, blocks);
+				data += blocks*64;
+				count -= blocks*64;
+			}
 		}
+		if (count > 0) memcpy((void *)(pContext->buffer + left), data, count);
 	}
-	if (count > 0) memcpy((void *)(pContext->buffer + left), data, count);
+
+
+	void sha2Final(HASHCONTEXT* pContext, unsigned char hash[64])
+	{
+		size_t last, padn;
+		memset(hash, 0, 64);
+		if (pContext->size > SHA2Engine::SHA_256)
+		{
+			unsigned char msglen[16];
+			Poco::UInt64 high = (pContext->total.total64[0] >> 61) | (pContext->total.total64[1] << 3);
+			Poco::UInt64 low = (pContext->total.total64[0] << 3);
+			PUT_UINT64(high, msglen, 0);
+			PUT_UINT64(low, msglen, 8);
+			last = (size_t)(pContext->total.total64[0] & 0x7F);
+			padn = (last < 112) ? (112 - last) : (240 - last);
+			sha2Update(pContext, padding, padn);
+			sha2Update(pContext, msglen, 16);
+			PUT_UINT64(pContext->state.state64[0], hash, 0);
+			PUT_UINT64(pContext->state.state64[1], hash, 8);
+			PUT_UINT64(pContext->state.state64[2], hash, 16);
+			PUT_UINT64(pContext->state.state64[3], hash, 24);
+			PUT_UINT64(pContext->state.state64[4], hash, 32);
+			PUT_UINT64(pContext->state.state64[5], hash, 40);
+			if (pContext->size > SHA2Engine::SHA_384)
+			{
+				PUT_UINT64(pContext->state.state64[6], hash, 48);
+				PUT_UINT64(pContext->state.state64[7], hash, 56);
+			}
+		}
+		else
+		{
+			unsigned char msglen[8];
+			Poco::UInt32 high = (pContext->total.total32[0] >> 29) | (pContext->total.total32[1] << 3);
+			Poco::UInt32 low = (pContext->total.total32[0] << 3);
+			PUT_UINT32(high, msglen, 0);
+			PUT_UINT32(low, msglen, 4);
+			last = pContext->total.total32[0] & 0x3F;
+			padn = (last < 56) ? (56 - last) : (120 - last);
+			sha2Update(pContext, padding, padn);
+			sha2Update(pContext, msglen, 8);
+			PUT_UINT32(pContext->state.state32[0], hash, 0);
+			PUT_UINT32(pContext->state.state32[1], hash, 4);
+			PUT_UINT32(pContext->state.state32[2], hash, 8);
+			PUT_UINT32(pContext->state.state32[3], hash, 12);
+			PUT_UINT32(pContext->state.state32[4], hash, 16);
+			PUT_UINT32(pContext->state.state32[5], hash, 20);
+			PUT_UINT32(pContext->state.state32[6], hash, 24);
+			if (pContext->size > SHA2Engine::SHA_224) PUT_UINT32(pContext->state.state32[7], hash, 28);
+		}
+	}
+
+
+#if defined(POCO_SHA2_X86)
+
+	class SHA256Lanes
+		/// Schedules many independent messages onto the eight
+		/// lanes of sha256ProcessLanesAVX2(). Whenever a lane
+		/// has finished its message, the next message is started
+		/// in that lane.
+	{
+	public:
+		enum
+		{
+			LANES = 8
+		};
+
+		SHA256Lanes(SHA2Engine::ALGORITHM algorithm, const void* const data[], const std::size_t lengths[], std::size_t count, unsigned char* digests):
+			_data(data),
+			_lengths(lengths),
+			_count(count),
+			_next(0),
+			_digests(digests),
+			_digestLength(algorithm/8)
+		{
+			HASHCONTEXT context;
+			sha2Init(&context, algorithm);
+			memcpy(_iv, context.state.state32, sizeof(_iv));
+		}
+
+		void run()
+		{
+			static const unsigned char idle[64] = { 0 };
+			const unsigned char* blocks[LANES];
+			int active = 0;
+			for (int lane = 0; lane < LANES; lane++)
+			{
+				if (start(lane)) active++;
+			}
+			while (active > 0)
+			{
+				for (int lane = 0; lane < LANES; lane++)
+				{
+					Lane& l = _lanes[lane];
+					if (l.index == NONE)
+						blocks[lane] = idle;
+					else if (l.block < l.full)
+						blocks[lane] = l.data + 64*l.block;
+					else
+						blocks[lane] = l.tail + 64*(l.block - l.full);
+				}
+				sha256ProcessLanesAVX2(_state, blocks);
+				for (int lane = 0; lane < LANES; lane++)
+				{
+					Lane& l = _lanes[lane];
+					if (l.index != NONE && ++l.block == l.blocks)
+					{
+						unsigned char* hash = _digests + l.index*_digestLength;
+						for (std::size_t i = 0; i < _digestLength/4; i++)
+						{
+							PUT_UINT32(_state[i][lane], hash, 4*i);
+						}
+						if (!start(lane)) active--;
+					}
+				}
+			}
+		}
+
+	private:
+		static const std::size_t NONE = ~std::size_t(0);
+
+		struct Lane
+		{
+			std::size_t index;
+			const unsigned char* data;
+			std::size_t full;
+			std::size_t block;
+			std::size_t blocks;
+			unsigned char tail[128];
+		};
+
+		bool start(int lane)
+			/// Starts the next message in the given lane and returns true,
+			/// or marks the lane as idle and returns false if all
+			/// messages have been started.
+		{
+			Lane& l = _lanes[lane];
+			if (_next == _count)
+			{
+				l.index = NONE;
+				return false;
+			}
+			l.index = _next++;
+			std::size_t length = _lengths[l.index];
+			l.data = static_cast<const unsigned char*>(_data[l.index]);
+			l.full = length/64;
+			l.block = 0;
+			std::size_t rest = length - 64*l.full;
+			std::size_t tailLength = rest < 56 ? 64 : 128;
+			l.blocks = l.full + tailLength/64;
+			if (rest > 0) memcpy(l.tail, l.data + 64*l.full, rest);
+			memset(l.tail + rest, 0, tailLength - rest);
+			l.tail[rest] = 0x80;
+			Poco::UInt64 bits = Poco::UInt64(length) << 3;
+			PUT_UINT32(Poco::UInt32(bits >> 32), l.tail, tailLength - 8);
+			PUT_UINT32(Poco::UInt32(bits), l.tail, tailLength - 4);
+			for (int i = 0; i < 8; i++) _state[i][lane] = _iv[i];
+			return true;
+		}
+
+		const void* const* _data;
+		const std::size_t* _lengths;
+		std::size_t _count;
+		std::size_t _next;
+		unsigned char* _digests;
+		std::size_t _digestLength;
+		Poco::UInt32 _iv[8];
+		Poco::UInt32 _state[8][LANES];
+		Lane _lanes[LANES];
+	};
+
+#endif // POCO_SHA2_X86
+}
+
+
+SHA2Engine::SHA2Engine(ALGORITHM algorithm):
+	_context(NULL),
+	_algorithm(algorithm)
+{
+	_digest.reserve(digestLength());
+	reset();
+}
+
+
+SHA2Engine::~SHA2Engine()
+{
+	free(_context);
+}
+
+
+void SHA2Engine::updateImpl(const void* buffer_, std::size_t count)
+{
+	if (_context == NULL || buffer_ == NULL || count == 0) return;
+	sha2Update((HASHCONTEXT*)_context, (const unsigned char*)buffer_, count);
 }
 
 
@@ -329,54 +861,8 @@ std::size_t SHA2Engine::digestLength() const
 
 void SHA2Engine::reset()
 {
-	if (_context != NULL) free(_context);
-	_context = calloc(1, sizeof(HASHCONTEXT));
-	HASHCONTEXT* pContext = (HASHCONTEXT*)_context;
-	pContext->size = _algorithm;
-	if (_algorithm == SHA_224)
-	{
-		pContext->state.state32[0] = 0xC1059ED8;
-		pContext->state.state32[1] = 0x367CD507;
-		pContext->state.state32[2] = 0x3070DD17;
-		pContext->state.state32[3] = 0xF70E5939;
-		pContext->state.state32[4] = 0xFFC00B31;
-		pContext->state.state32[5] = 0x68581511;
-		pContext->state.state32[6] = 0x64F98FA7;
-		pContext->state.state32[7] = 0xBEFA4FA4;
-	}
-	else if (_algorithm == SHA_256)
-	{
-		pContext->state.state32[0] = 0x6A09E667;
-		pContext->state.state32[1] = 0xBB67AE85;
-		pContext->state.state32[2] = 0x3C6EF372;
-		pContext->state.state32[3] = 0xA54FF53A;
-		pContext->state.state32[4] = 0x510E527F;
-		pContext->state.state32[5] = 0x9B05688C;
-		pContext->state.state32[6] = 0x1F83D9AB;
-		pContext->state.state32[7] = 0x5BE0CD19;
-	}
-	else if (_algorithm == SHA_384)
-	{
-		pContext->state.state64[0] = UL64(0xCBBB9D5DC1059ED8);
-		pContext->state.state64[1] = UL64(0x629A292A367CD507);
-		pContext->state.state64[2] = UL64(0x9159015A3070DD17);
-		pContext->state.state64[3] = UL64(0x152FECD8F70E5939);
-		pContext->state.state64[4] = UL64(0x67332667FFC00B31);
-		pContext->state.state64[5] = UL64(0x8EB44A8768581511);
-		pContext->state.state64[6] = UL64(0xDB0C2E0D64F98FA7);
-		pContext->state.state64[7] = UL64(0x47B5481DBEFA4FA4);
-	}
-	else
-	{
-		pContext->state.state64[0] = UL64(0x6A09E667F3BCC908);
-		pContext->state.state64[1] = UL64(0xBB67AE8584CAA73B);
-		pContext->state.state64[2] = UL64(0x3C6EF372FE94F82B);
-		pContext->state.state64[3] = UL64(0xA54FF53A5F1D36F1);
-		pContext->state.state64[4] = UL64(0x510E527FADE682D1);
-		pContext->state.state64[5] = UL64(0x9B05688C2B3E6C1F);
-		pContext->state.state64[6] = UL64(0x1F83D9ABFB41BD6B);
-		pContext->state.state64[7] = UL64(0x5BE0CD19137E2179);
-	}
+	if (_context == NULL) _context = malloc(sizeof(HASHCONTEXT));
+	sha2Init((HASHCONTEXT*)_context, _algorithm);
 }
 
 
@@ -384,56 +870,57 @@ const DigestEngine::Digest& SHA2Engine::digest()
 {
 	_digest.clear();
 	if (_context == NULL) return _digest;
-	HASHCONTEXT* pContext = (HASHCONTEXT*)_context;
-	size_t last, padn;
 	unsigned char hash[64];
-	memset(hash, 0, 64);
-	if (pContext->size > SHA_256)
+	sha2Final((HASHCONTEXT*)_context, hash);
+	_digest.insert(_digest.begin(), hash, hash + digestLength());
+	reset();
+	return _digest;
+}
+
+
+void SHA2Engine::digestMany(const void* const data[], const std::size_t lengths[], std::size_t count, unsigned char* digests, ALGORITHM algorithm)
+{
+	const std::size_t length = (std::size_t)((int)algorithm / 8);
+#if defined(POCO_SHA2_X86)
+	if (algorithm <= SHA_256 && HAVE_AVX2 && !HAVE_SHANI && count > 1)
 	{
-		unsigned char msglen[16];
-		Poco::UInt64 high = (pContext->total.total64[0] >> 61) | (pContext->total.total64[1] << 3);
-		Poco::UInt64 low = (pContext->total.total64[0] << 3);
-		PUT_UINT64(high, msglen, 0);
-		PUT_UINT64(low, msglen, 8);
-		last = (size_t)(pContext->total.total64[0] & 0x7F);
-		padn = (last < 112) ? (112 - last) : (240 - last);
-		updateImpl(padding, padn);
-		updateImpl(msglen, 16);
-		PUT_UINT64(pContext->state.state64[0], hash, 0);
-		PUT_UINT64(pContext->state.state64[1], hash, 8);
-		PUT_UINT64(pContext->state.state64[2], hash, 16);
-		PUT_UINT64(pContext->state.state64[3], hash, 24);
-		PUT_UINT64(pContext->state.state64[4], hash, 32);
-		PUT_UINT64(pContext->state.state64[5], hash, 40);
-		if (pContext->size > SHA_384)
-		{
-			PUT_UINT64(pContext->state.state64[6], hash, 48);
-			PUT_UINT64(pContext->state.state64[7], hash, 56);
-		}
+		SHA256Lanes lanes(algorithm, data, lengths, count, digests);
+		lanes.run();
+		return;
 	}
-	else
+#endif
+	HASHCONTEXT context;
+	unsigned char hash[64];
+	for (std::size_t i = 0; i < count; i++)
 	{
-		unsigned char msglen[8];
-		Poco::UInt32 high = (pContext->total.total32[0] >> 29) | (pContext->total.total32[1] << 3);
-		Poco::UInt32 low = (pContext->total.total32[0] << 3);
-		PUT_UINT32(high, msglen, 0);
-		PUT_UINT32(low, msglen, 4);
-		last = pContext->total.total32[0] & 0x3F;
-		padn = (last < 56) ? (56 - last) : (120 - last);
-		updateImpl(padding, padn);
-		updateImpl(msglen, 8);
-		PUT_UINT32(pContext->state.state32[0], hash, 0);
-		PUT_UINT32(pContext->state.state32[1], hash, 4);
-		PUT_UINT32(pContext->state.state32[2], hash, 8);
-		PUT_UINT32(pContext->state.state32[3], hash, 12);
-		PUT_UINT32(pContext->state.state32[4], hash, 16);
-		PUT_UINT32(pContext->state.state32[5], hash, 20);
-		PUT_UINT32(pContext->state.state32[6], hash, 24);
-		if (pContext->size > SHA_224) PUT_UINT32(pContext->state.state32[7], hash, 28);
+		sha2Init(&context, algorithm);
+		sha2Update(&context, static_cast<const unsigned char*>(data[i]), lengths[i]);
+		sha2Final(&context, hash);
+		memcpy(digests + i*length, hash, length);
 	}
-	_digest.insert(_digest.begin(), hash, hash + digestLength());
-	reset();
-	return _digest;
+}
+
+
+std::vector<DigestEngine::Digest> SHA2Engine::digestMany(const std::vector<std::string>& messages, ALGORITHM algorithm)
+{
+	const std::size_t count = messages.size();
+	const std::size_t length = (std::size_t)((int)algorithm / 8);
+	std::vector<const void*> data(count);
+	std::vector<std::size_t> lengths(count);
+	for (std::size_t i = 0; i < count; i++)
+	{
+		data[i] = messages[i].data();
+		lengths[i] = messages[i].size();
+	}
+	std::vector<unsigned char> digests(count*length);
+	if (count > 0) digestMany(&data[0], &lengths[0], count, &digests[0], algorithm);
+	std::vector<DigestEngine::Digest> result;
+	result.reserve(count);
+	for (std::size_t i = 0; i < count; i++)
+	{
+		result.push_back(DigestEngine::Digest(digests.begin() + i*length, digests.begin() + (i + 1)*length));
+	}
+	return result;
 }
 
 
@@ -0,0 +1,263 @@
+//
+// TimingWheel.cpp
+//
+// Library: Foundation
+// Package: Threading
+// Module:  TimingWheel
+//
+// Copyright (c) 2004-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/TimingWheel.h"
+#include "Poco/Bugcheck.h"
+
+
+namespace Poco {
+
+
+TimingWheel::Entry::Entry():
+	_pNext(0),
+	_ppPrev(0),
+	_pWheel(0),
+	_tick(0),
+	_level(0)
+{
+}
+
+
+TimingWheel::Entry::~Entry()
+{
+	if (_pWheel) _pWheel->cancel(*this);
+}
+
+
+TimingWheel::TimingWheel(Clock::ClockDiff resolution):
+	_resolution(resolution),
+	_current(0),
+	_size(0),
+	_pOverdue(0)
+{
+	poco_assert (resolution > 0);
+
+	_levelSize[LEVELS] = 0;
+	for (int level = 0; level < LEVELS; level++)
+	{
+		_levelSize[level] = 0;
+		for (int index = 0; index < SLOTS; index++)
+		{
+			_slots[level][index] = 0;
+		}
+	}
+}
+
+
+TimingWheel::~TimingWheel()
+{
+	EntryVec entries;
+	clear(entries);
+}
+
+
+void TimingWheel::schedule(Entry& entry, const Clock& deadline)
+{
+	if (entry._pWheel) entry._pWheel->cancel(entry);
+
+	entry._tick = ticks(deadline, true);
+	entry._pWheel = this;
+	link(entry);
+	++_size;
+}
+
+
+void TimingWheel::cancel(Entry& entry)
+{
+	if (entry._pWheel == this)
+	{
+		unlink(entry);
+		entry._pWheel = 0;
+		--_size;
+	}
+}
+
+
+void TimingWheel::advance(const Clock& now, EntryVec& expired)
+{
+	expire(_pOverdue, expired);
+
+	Poco::UInt64 target = ticks(now, false);
+	while (_current <= target)
+	{
+		if (_size == 0)
+		{
+			_current = target + 1;
+			break;
+		}
+
+		_current = nextTick();
+		if (_current > target)
+		{
+			_current = target + 1;
+			break;
+		}
+
+		int index = static_cast<int>(_current & SLOT_MASK);
+		if (index == 0)
+		{
+			for (int level = 1; level < LEVELS; level++)
+			{
+				int levelIndex = static_cast<int>((_current >> (level*SLOT_BITS)) & SLOT_MASK);
+				cascade(level, levelIndex);
+				if (levelIndex != 0) break;
+			}
+		}
+
+		expire(_slots[0][index], expired);
+		++_current;
+	}
+}
+
+
+void TimingWheel::clear(EntryVec& entries)
+{
+	expire(_pOverdue, entries);
+	for (int level = 0; level < LEVELS; level++)
+	{
+		for (int index = 0; index < SLOTS; index++)
+		{
+			expire(_slots[level][index], entries);
+		}
+	}
+}
+
+
+Clock::ClockDiff TimingWheel::timeout(const Clock& now) const
+{
+	if (_size == 0) return -1;
+	if (_pOverdue) return 0;
+
+	Clock deadline(_origin);
+	deadline += static_cast<Clock::ClockDiff>(nextTick())*_resolution;
+	Clock::ClockDiff diff = deadline - now;
+	return diff > 0 ? diff : 0;
+}
+
+
+Poco::UInt64 TimingWheel::ticks(const Clock& clock, bool roundUp) const
+{
+	Clock::ClockDiff diff = clock - _origin;
+	if (diff <= 0) return 0;
+	if (roundUp)
+		return static_cast<Poco::UInt64>((diff + _resolution - 1)/_resolution);
+	else
+		return static_cast<Poco::UInt64>(diff/_resolution);
+}
+
+
+Poco::UInt64 TimingWheel::nextTick() const
+{
+	// Find the first tick at which something happens, i.e. either
+	// entries expire, or entries must be cascaded from an outer level.
+	// All levels below the innermost non-empty level are empty, so only
+	// the boundaries of that level's slots need to be considered.
+	int level = 0;
+	while (level < LEVELS - 1 && _levelSize[level] == 0) ++level;
+
+	int shift = level*SLOT_BITS;
+	Poco::UInt64 unit = Poco::UInt64(1) << shift;
+	Poco::UInt64 tick = ((_current + unit - 1) >> shift) << shift;
+	for (;;)
+	{
+		int index = static_cast<int>((tick >> shift) & SLOT_MASK);
+		if (index == 0 || _slots[level][index]) break;
+		tick += unit;
+	}
+	return tick;
+}
+
+
+void TimingWheel::link(Entry& entry)
+{
+	Entry** ppSlot;
+	int level = 0;
+	if (entry._tick < _current)
+	{
+		// The wheel has already moved past the deadline.
+		ppSlot = &_pOverdue;
+		level = LEVELS;
+	}
+	else if (entry._tick == _current)
+	{
+		ppSlot = &_slots[0][_current & SLOT_MASK];
+	}
+	else
+	{
+		Poco::UInt64 delta = entry._tick - _current;
+		Poco::UInt64 tick = entry._tick;
+		while (level < LEVELS - 1 && delta >= (Poco::UInt64(1) << ((level + 1)*SLOT_BITS)))
+		{
+			++level;
+		}
+		if (level == LEVELS - 1 && delta >= (Poco::UInt64(1) << (LEVELS*SLOT_BITS)))
+		{
+			// Too far in the future; park the entry in the outermost
+			// level, it will be re-linked when that slot cascades.
+			tick = _current + (Poco::UInt64(1) << (LEVELS*SLOT_BITS)) - 1;
+		}
+		ppSlot = &_slots[level][(tick >> (level*SLOT_BITS)) & SLOT_MASK];
+	}
+	entry._pNext = *ppSlot;
+	if (entry._pNext) entry._pNext->_ppPrev = &entry._pNext;
+	entry._ppPrev = ppSlot;
+	entry._level = level;
+	*ppSlot = &entry;
+	++_levelSize[level];
+}
+
+
+void TimingWheel::unlink(Entry& entry)
+{
+	*entry._ppPrev = entry._pNext;
+	if (entry._pNext) entry._pNext->_ppPrev = entry._ppPrev;
+	entry._pNext = 0;
+	entry._ppPrev = 0;
+	--_levelSize[entry._level];
+}
+
+
+void TimingWheel::cascade(int level, int index)
+{
+	Entry* pEntry = _slots[level][index];
+	_slots[level][index] = 0;
+	while (pEntry)
+	{
+		Entry* pNext = pEntry->_pNext;
+		--_levelSize[level];
+		link(*pEntry);
+		pEntry = pNext;
+	}
+}
+
+
+void TimingWheel::expire(Entry*& pList, EntryVec& expired)
+{
+	Entry* pEntry = pList;
+	pList = 0;
+	while (pEntry)
+	{
+		Entry* pNext = pEntry->_pNext;
+		pEntry->_pNext = 0;
+		pEntry->_ppPrev = 0;
+		pEntry->_pWheel = 0;
+		--_levelSize[pEntry->_level];
+		--_size;
+		expired.push_back(pEntry);
+		pEntry = pNext;
+	}
+}
+
+
+} // namespace Poco
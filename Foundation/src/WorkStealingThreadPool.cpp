@@ -0,0 +1,550 @@
+//
+// WorkStealingThreadPool.cpp
+//
+// Library: Foundation
+// Package: Threading
+// Module:  WorkStealingThreadPool
+//
+// Copyright (c) 2004-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/WorkStealingThreadPool.h"
+#include "Poco/Runnable.h"
+#include "Poco/Event.h"
+#include "Poco/Environment.h"
+#include "Poco/ErrorHandler.h"
+#include "Poco/Exception.h"
+#include <deque>
+#include <sstream>
+
+
+namespace Poco {
+
+
+class WorkStealingDeque
+	/// A lock-free, growable work-stealing deque, as described in
+	/// "Dynamic Circular Work-Stealing Deque" by Chase and Lev,
+	/// using the memory orderings from "Correct and Efficient
+	/// Work-Stealing for Weak Memory Models" by Le et al.
+	///
+	/// Only the owning thread may call push() and pop(),
+	/// any thread may call steal().
+{
+public:
+	WorkStealingDeque(): _top(0), _bottom(0), _pArray(new Array(64))
+	{
+	}
+
+	~WorkStealingDeque()
+	{
+		delete _pArray.load(std::memory_order_relaxed);
+		for (auto pArray: _garbage) delete pArray;
+	}
+
+	void push(Runnable* pTarget)
+	{
+		Poco::Int64 b = _bottom.load(std::memory_order_relaxed);
+		Poco::Int64 t = _top.load(std::memory_order_acquire);
+		Array* pArray = _pArray.load(std::memory_order_relaxed);
+		if (b - t > pArray->capacity() - 1)
+		{
+			pArray = grow(pArray, b, t);
+		}
+		pArray->put(b, pTarget);
+		std::atomic_thread_fence(std::memory_order_release);
+		_bottom.store(b + 1, std::memory_order_relaxed);
+	}
+
+	Runnable* pop()
+	{
+		Poco::Int64 b = _bottom.load(std::memory_order_relaxed) - 1;
+		Array* pArray = _pArray.load(std::memory_order_relaxed);
+		_bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		Poco::Int64 t = _top.load(std::memory_order_relaxed);
+		Runnable* pTarget = 0;
+		if (t <= b)
+		{
+			pTarget = pArray->get(b);
+			if (t == b)
+			{
+				// last element - race against thieves
+				if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					pTarget = 0;
+				_bottom.store(b + 1, std::memory_order_relaxed);
+			}
+		}
+		else
+		{
+			_bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return pTarget;
+	}
+
+	Runnable* steal()
+	{
+		Poco::Int64 t = _top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		Poco::Int64 b = _bottom.load(std::memory_order_acquire);
+		if (t < b)
+		{
+			Array* pArray = _pArray.load(std::memory_order_acquire);
+			Runnable* pTarget = pArray->get(t);
+			if (_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return pTarget;
+		}
+		return 0;
+	}
+
+	bool empty() const
+	{
+		Poco::Int64 b = _bottom.load(std::memory_order_relaxed);
+		Poco::Int64 t = _top.load(std::memory_order_relaxed);
+		return b <= t;
+	}
+
+private:
+	class Array
+	{
+	public:
+		explicit Array(Poco::Int64 capacity):
+			_capacity(capacity),
+			_mask(capacity - 1),
+			_pItems(new std::atomic<Runnable*>[static_cast<std::size_t>(capacity)])
+		{
+		}
+
+		~Array()
+		{
+			delete [] _pItems;
+		}
+
+		Poco::Int64 capacity() const
+		{
+			return _capacity;
+		}
+
+		void put(Poco::Int64 i, Runnable* pTarget)
+		{
+			_pItems[i & _mask].store(pTarget, std::memory_order_relaxed);
+		}
+
+		Runnable* get(Poco::Int64 i) const
+		{
+			return _pItems[i & _mask].load(std::memory_order_relaxed);
+		}
+
+	private:
+		Poco::Int64 _capacity;
+		Poco::Int64 _mask;
+		std::atomic<Runnable*>* _pItems;
+	};
+
+	Array* grow(Array* pArray, Poco::Int64 b, Poco::Int64 t)
+	{
+		Array* pNewArray = new Array(pArray->capacity()*2);
+		for (Poco::Int64 i = t; i < b; ++i)
+		{
+			pNewArray->put(i, pArray->get(i));
+		}
+		// Thieves may still be reading from the old array,
+		// so it is kept around until the deque is destroyed.
+		_garbage.push_back(pArray);
+		_pArray.store(pNewArray, std::memory_order_release);
+		return pNewArray;
+	}
+
+	std::atomic<Poco::Int64> _top;
+	std::atomic<Poco::Int64> _bottom;
+	std::atomic<Array*> _pArray;
+	std::vector<Array*> _garbage;
+};
+
+
+class WorkStealingThread: public Runnable
+{
+public:
+	WorkStealingThread(WorkStealingThreadPool& pool, const std::string& name, int index, int stackSize);
+	~WorkStealingThread();
+
+	void start();
+	void submit(Runnable& target);
+	void push(Runnable& target);
+	Runnable* steal();
+	bool hasWork() const;
+	bool wakeUp();
+	void stop();
+	void run();
+
+	static WorkStealingThread* current();
+
+private:
+	Runnable* next();
+	void execute(Runnable* pTarget);
+	void sleep();
+
+	typedef std::deque<Runnable*> TargetQueue;
+
+	WorkStealingThreadPool& _pool;
+	Poco::UInt32            _seed;
+	WorkStealingDeque       _deque;
+	TargetQueue             _submitted;
+	mutable FastMutex       _submitMutex;
+	std::atomic<bool>       _sleeping;
+	Event                   _wakeUp;
+	Event                   _started;
+	Thread                  _thread;
+
+	static thread_local WorkStealingThread* _pCurrent;
+
+	friend class WorkStealingThreadPool;
+};
+
+
+thread_local WorkStealingThread* WorkStealingThread::_pCurrent = 0;
+
+
+WorkStealingThread::WorkStealingThread(WorkStealingThreadPool& pool, const std::string& name, int index, int stackSize):
+	_pool(pool),
+	_seed(2654435761U*static_cast<Poco::UInt32>(index + 1)),
+	_sleeping(false),
+	_thread(name)
+{
+	poco_assert_dbg (stackSize >= 0);
+	_thread.setStackSize(stackSize);
+}
+
+
+WorkStealingThread::~WorkStealingThread()
+{
+}
+
+
+void WorkStealingThread::start()
+{
+	_thread.start(*this);
+	_started.wait();
+}
+
+
+void WorkStealingThread::submit(Runnable& target)
+{
+	FastMutex::ScopedLock lock(_submitMutex);
+	_submitted.push_back(&target);
+}
+
+
+void WorkStealingThread::push(Runnable& target)
+{
+	_deque.push(&target);
+}
+
+
+Runnable* WorkStealingThread::steal()
+{
+	Runnable* pTarget = _deque.steal();
+	if (!pTarget && _submitMutex.tryLock())
+	{
+		if (!_submitted.empty())
+		{
+			pTarget = _submitted.front();
+			_submitted.pop_front();
+		}
+		_submitMutex.unlock();
+	}
+	return pTarget;
+}
+
+
+bool WorkStealingThread::hasWork() const
+{
+	if (!_deque.empty()) return true;
+	FastMutex::ScopedLock lock(_submitMutex);
+	return !_submitted.empty();
+}
+
+
+bool WorkStealingThread::wakeUp()
+{
+	if (_sleeping.load(std::memory_order_seq_cst))
+	{
+		_wakeUp.set();
+		return true;
+	}
+	return false;
+}
+
+
+void WorkStealingThread::stop()
+{
+	_wakeUp.set();
+	_thread.join();
+}
+
+
+inline WorkStealingThread* WorkStealingThread::current()
+{
+	return _pCurrent;
+}
+
+
+Runnable* WorkStealingThread::next()
+{
+	Runnable* pTarget = _deque.pop();
+	if (pTarget) return pTarget;
+
+	{
+		// Move everything submitted from the outside onto
+		// the deque, where other threads can steal it.
+		FastMutex::ScopedLock lock(_submitMutex);
+		if (!_submitted.empty())
+		{
+			pTarget = _submitted.front();
+			_submitted.pop_front();
+			while (!_submitted.empty())
+			{
+				_deque.push(_submitted.front());
+				_submitted.pop_front();
+			}
+		}
+	}
+	if (pTarget) return pTarget;
+
+	return _pool.steal(this);
+}
+
+
+void WorkStealingThread::execute(Runnable* pTarget)
+{
+	try
+	{
+		pTarget->run();
+	}
+	catch (Exception& exc)
+	{
+		ErrorHandler::handle(exc);
+	}
+	catch (std::exception& exc)
+	{
+		ErrorHandler::handle(exc);
+	}
+	catch (...)
+	{
+		ErrorHandler::handle();
+	}
+	_pool.taskCompleted();
+}
+
+
+void WorkStealingThread::sleep()
+{
+	_sleeping.store(true, std::memory_order_seq_cst);
+	_pool._sleeping.fetch_add(1, std::memory_order_seq_cst);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (!_pool._stopped.load(std::memory_order_seq_cst) && !_pool.hasWork())
+	{
+		_wakeUp.wait();
+	}
+	_pool._sleeping.fetch_sub(1, std::memory_order_seq_cst);
+	_sleeping.store(false, std::memory_order_seq_cst);
+}
+
+
+void WorkStealingThread::run()
+{
+	_pCurrent = this;
+	_started.set();
+	while (!_pool._stopped.load(std::memory_order_acquire))
+	{
+		Runnable* pTarget = next();
+		if (pTarget)
+		{
+			execute(pTarget);
+		}
+		else
+		{
+			sleep();
+		}
+	}
+	_pCurrent = 0;
+}
+
+
+WorkStealingThreadPool::WorkStealingThreadPool(int threads, int stackSize):
+	_next(0),
+	_pending(0),
+	_sleeping(0),
+	_stopped(false)
+{
+	createThreads(threads, stackSize);
+}
+
+
+WorkStealingThreadPool::WorkStealingThreadPool(const std::string& name, int threads, int stackSize):
+	_name(name),
+	_next(0),
+	_pending(0),
+	_sleeping(0),
+	_stopped(false)
+{
+	createThreads(threads, stackSize);
+}
+
+
+WorkStealingThreadPool::~WorkStealingThreadPool()
+{
+	try
+	{
+		stopAll();
+	}
+	catch (...)
+	{
+		poco_unexpected();
+	}
+}
+
+
+void WorkStealingThreadPool::createThreads(int threads, int stackSize)
+{
+	poco_assert (threads >= 0);
+
+	if (threads == 0) threads = static_cast<int>(Environment::processorCount());
+	if (threads < 1) threads = 1;
+
+	_threads.reserve(threads);
+	for (int i = 0; i < threads; i++)
+	{
+		std::ostringstream name;
+		name << _name << "[#" << i + 1 << "]";
+		_threads.push_back(new WorkStealingThread(*this, name.str(), i, stackSize));
+	}
+	for (auto pThread: _threads)
+	{
+		pThread->start();
+	}
+}
+
+
+void WorkStealingThreadPool::start(Runnable& target)
+{
+	if (_stopped.load(std::memory_order_acquire))
+		throw InvalidAccessException("WorkStealingThreadPool has been stopped");
+
+	_pending.fetch_add(1, std::memory_order_acq_rel);
+	WorkStealingThread* pCurrent = WorkStealingThread::current();
+	if (pCurrent && &pCurrent->_pool == this)
+	{
+		pCurrent->push(target);
+		wakeUp(0);
+	}
+	else
+	{
+		WorkStealingThread* pThread = _threads[_next.fetch_add(1, std::memory_order_relaxed) % _threads.size()];
+		pThread->submit(target);
+		wakeUp(pThread);
+	}
+}
+
+
+void WorkStealingThreadPool::joinAll()
+{
+	poco_assert (WorkStealingThread::current() == 0 || &WorkStealingThread::current()->_pool != this);
+
+	FastMutex::ScopedLock lock(_joinMutex);
+	while (_pending.load(std::memory_order_acquire) > 0 && !_stopped.load(std::memory_order_acquire))
+	{
+		_joinCondition.wait(_joinMutex);
+	}
+}
+
+
+void WorkStealingThreadPool::stopAll()
+{
+	if (_stopped.exchange(true)) return;
+
+	for (auto pThread: _threads)
+	{
+		pThread->stop();
+	}
+	for (auto pThread: _threads)
+	{
+		delete pThread;
+	}
+	_threads.clear();
+
+	FastMutex::ScopedLock lock(_joinMutex);
+	_joinCondition.broadcast();
+}
+
+
+WorkStealingThreadPool* WorkStealingThreadPool::current()
+{
+	WorkStealingThread* pCurrent = WorkStealingThread::current();
+	return pCurrent ? &pCurrent->_pool : 0;
+}
+
+
+Runnable* WorkStealingThreadPool::steal(WorkStealingThread* pThief)
+{
+	std::size_t n = _threads.size();
+	if (n < 2) return 0;
+
+	// start at a pseudo-random victim to spread contention
+	pThief->_seed ^= pThief->_seed << 13;
+	pThief->_seed ^= pThief->_seed >> 17;
+	pThief->_seed ^= pThief->_seed << 5;
+	std::size_t start = pThief->_seed % n;
+	for (std::size_t i = 0; i < n; i++)
+	{
+		WorkStealingThread* pVictim = _threads[(start + i) % n];
+		if (pVictim != pThief)
+		{
+			Runnable* pTarget = pVictim->steal();
+			if (pTarget) return pTarget;
+		}
+	}
+	return 0;
+}
+
+
+bool WorkStealingThreadPool::hasWork() const
+{
+	for (auto pThread: _threads)
+	{
+		if (pThread->hasWork()) return true;
+	}
+	return false;
+}
+
+
+void WorkStealingThreadPool::wakeUp(WorkStealingThread* pPreferred)
+{
+	// pairs with the fence in WorkStealingThread::sleep(), so that
+	// either the sleeper sees the new work or we see the sleeper
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (pPreferred && pPreferred->wakeUp()) return;
+	if (_sleeping.load(std::memory_order_seq_cst) > 0)
+	{
+		for (auto pThread: _threads)
+		{
+			if (pThread != pPreferred && pThread->wakeUp()) return;
+		}
+	}
+}
+
+
+void WorkStealingThreadPool::taskCompleted()
+{
+	if (_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		FastMutex::ScopedLock lock(_joinMutex);
+		_joinCondition.broadcast();
+	}
+}
+
+
+} // namespace Poco
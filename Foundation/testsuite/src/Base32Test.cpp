@@ -14,6 +14,7 @@
 #include "Poco/Base32Encoder.h"
 #include "Poco/Base32Decoder.h"
 #include "Poco/Exception.h"
+#include "Poco/UnbufferedStreamBuf.h"
 #include <sstream>
 
 
@@ -22,6 +23,40 @@ using Poco::Base32Decoder;
 using Poco::DataFormatException;
 
 
+namespace
+{
+	class PartStreamBuf: public Poco::UnbufferedStreamBuf
+		/// Returns eof once at the end of the part, and then
+		/// the rest of the data, like a part of a MultipartReader.
+	{
+	public:
+		PartStreamBuf(const std::string& part, const std::string& rest):
+			_data(part + rest),
+			_end(part.size()),
+			_pos(0)
+		{
+		}
+
+	protected:
+		int readFromDevice()
+		{
+			if (_pos == _end)
+			{
+				_end = std::string::npos;
+				return -1;
+			}
+			if (_pos == _data.size()) return -1;
+			return static_cast<unsigned char>(_data[_pos++]);
+		}
+
+	private:
+		std::string _data;
+		std::size_t _end;
+		std::size_t _pos;
+	};
+}
+
+
 Base32Test::Base32Test(const std::string& name): CppUnit::TestCase(name)
 {
 }
@@ -160,6 +195,67 @@ void Base32Test::testEncodeDecode()
 }
 
 
+void Base32Test::testBuffer()
+{
+	char buffer[64];
+	std::size_t n = Base32Encoder::encode("\00\01\02\03\04\05", 6, buffer);
+	assertTrue (std::string(buffer, n) == "AAAQEAYEAU======");
+	n = Base32Encoder::encode("ab", 2, buffer, false);
+	assertTrue (std::string(buffer, n) == "MFRA");
+	assertTrue (Base32Encoder::encodedLength(2) == 8);
+	assertTrue (Base32Encoder::encodedLength(2, false) == 4);
+	assertTrue (Base32Encoder::encode(std::string("The quick brown fox")) == "KRUGKIDROVUWG2ZAMJZG653OEBTG66A=");
+
+	n = Base32Decoder::decode("AAAQEAYEAU======", 16, buffer);
+	assertTrue (std::string(buffer, n) == std::string("\00\01\02\03\04\05", 6));
+	assertTrue (Base32Decoder::decode(std::string("MFRA")) == "ab");
+	assertTrue (Base32Decoder::decode(std::string("KRUGKIDROVUWG2ZAMJZG653OEBTG66A=")) == "The quick brown fox");
+	try
+	{
+		Base32Decoder::decode(std::string("MFR"));
+		fail("invalid group length - must throw");
+	}
+	catch (DataFormatException&)
+	{
+	}
+
+	std::string src;
+	for (int i = 0; i < 10000; ++i) src += char(i*7);
+	std::string enc = Base32Encoder::encode(src);
+	assertTrue (Base32Decoder::decode(enc) == src);
+
+	std::stringstream str;
+	Base32Encoder encoder(str);
+	encoder.write(src.data(), 3);
+	encoder.write(src.data() + 3, (std::streamsize) src.size() - 3);
+	encoder.close();
+	assertTrue (str.str() == enc);
+	Base32Decoder decoder(str);
+	std::string s(src.size(), '\0');
+	decoder.read(&s[0], (std::streamsize) s.size());
+	assertTrue (decoder.gcount() == (std::streamsize) src.size());
+	assertTrue (s == src);
+	assertTrue (decoder.get() == -1);
+}
+
+void Base32Test::testDecoderPart()
+{
+	// The decoder must not read past the end of the part,
+	// where the invalid data would make it fail.
+	std::string src;
+	for (int i = 0; i < 100; ++i) src += char('a' + i % 26);
+	PartStreamBuf buf(Base32Encoder::encode(src), "!MFRGG===");
+	std::istream istr(&buf);
+	Base32Decoder decoder(istr);
+	char buffer[200];
+	decoder.read(buffer, sizeof(buffer));
+	assertTrue (decoder.gcount() == (std::streamsize) src.size());
+	assertTrue (std::string(buffer, decoder.gcount()) == src);
+	assertTrue (decoder.eof());
+	assertTrue (!decoder.bad());
+}
+
+
 void Base32Test::setUp()
 {
 }
@@ -177,6 +273,8 @@ CppUnit::Test* Base32Test::suite()
 	CppUnit_addTest(pSuite, Base32Test, testEncoder);
 	CppUnit_addTest(pSuite, Base32Test, testDecoder);
 	CppUnit_addTest(pSuite, Base32Test, testEncodeDecode);
+	CppUnit_addTest(pSuite, Base32Test, testBuffer);
+	CppUnit_addTest(pSuite, Base32Test, testDecoderPart);
 
 	return pSuite;
 }
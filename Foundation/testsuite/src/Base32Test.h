@@ -27,6 +27,8 @@ public:
 	void testEncoder();
 	void testDecoder();
 	void testEncodeDecode();
+	void testBuffer();
+	void testDecoderPart();
 
 	void setUp();
 	void tearDown();
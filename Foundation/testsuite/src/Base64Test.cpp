@@ -14,6 +14,7 @@
 #include "Poco/Base64Encoder.h"
 #include "Poco/Base64Decoder.h"
 #include "Poco/Exception.h"
+#include "Poco/UnbufferedStreamBuf.h"
 #include <sstream>
 
 
@@ -22,6 +23,40 @@ using Poco::Base64Decoder;
 using Poco::DataFormatException;
 
 
+namespace
+{
+	class PartStreamBuf: public Poco::UnbufferedStreamBuf
+		/// Returns eof once at the end of the part, and then
+		/// the rest of the data, like a part of a MultipartReader.
+	{
+	public:
+		PartStreamBuf(const std::string& part, const std::string& rest):
+			_data(part + rest),
+			_end(part.size()),
+			_pos(0)
+		{
+		}
+
+	protected:
+		int readFromDevice()
+		{
+			if (_pos == _end)
+			{
+				_end = std::string::npos;
+				return -1;
+			}
+			if (_pos == _data.size()) return -1;
+			return static_cast<unsigned char>(_data[_pos++]);
+		}
+
+	private:
+		std::string _data;
+		std::size_t _end;
+		std::size_t _pos;
+	};
+}
+
+
 Base64Test::Base64Test(const std::string& name): CppUnit::TestCase(name)
 {
 }
@@ -343,6 +378,79 @@ void Base64Test::testEncodeDecode()
 }
 
 
+void Base64Test::testBuffer()
+{
+	char buffer[64];
+	std::size_t n = Base64Encoder::encode("\00\01\02\03\04\05", 6, buffer);
+	assertTrue (std::string(buffer, n) == "AAECAwQF");
+	n = Base64Encoder::encode("ab", 2, buffer);
+	assertTrue (std::string(buffer, n) == "YWI=");
+	n = Base64Encoder::encode("\373\377", 2, buffer, Poco::BASE64_URL_ENCODING | Poco::BASE64_NO_PADDING);
+	assertTrue (std::string(buffer, n) == "-_8");
+	assertTrue (Base64Encoder::encodedLength(2) == 4);
+	assertTrue (Base64Encoder::encodedLength(2, Poco::BASE64_NO_PADDING) == 3);
+	assertTrue (Base64Encoder::encode(std::string("The quick brown fox jumped over the lazy dog.")) == "VGhlIHF1aWNrIGJyb3duIGZveCBqdW1wZWQgb3ZlciB0aGUgbGF6eSBkb2cu");
+
+	n = Base64Decoder::decode("AAEC\r\nAwQF", 10, buffer);
+	assertTrue (std::string(buffer, n) == std::string("\00\01\02\03\04\05", 6));
+	assertTrue (Base64Decoder::decode(std::string("-_8"), Poco::BASE64_URL_ENCODING | Poco::BASE64_NO_PADDING) == "\373\377");
+	assertTrue (Base64Decoder::decode(std::string("VGhlIHF1aWNrIGJyb3duIGZveCBqdW1wZWQgb3ZlciB0aGUgbGF6eSBkb2cu")) == "The quick brown fox jumped over the lazy dog.");
+	try
+	{
+		Base64Decoder::decode(std::string("YWI"));
+		fail("incomplete group - must throw");
+	}
+	catch (DataFormatException&)
+	{
+	}
+	try
+	{
+		Base64Decoder::decode(std::string("VGhlIHF1aWNrIGJyb3duIGZveCBqdW1wZWQgb3Zl*iB0aGUgbGF6eSBkb2cu"));
+		fail("invalid character - must throw");
+	}
+	catch (DataFormatException&)
+	{
+	}
+
+	std::string src;
+	for (int i = 0; i < 10000; ++i) src += char(i*7);
+	std::string enc = Base64Encoder::encode(src);
+	assertTrue (Base64Decoder::decode(enc) == src);
+
+	std::stringstream str;
+	Base64Encoder encoder(str);
+	encoder.write(src.data(), 1);
+	encoder.write(src.data() + 1, (std::streamsize) src.size() - 1);
+	encoder.close();
+	std::string encoded = str.str();
+	assertTrue (encoded.substr(0, 72) == enc.substr(0, 72));
+	assertTrue (encoded.substr(72, 2) == "\r\n");
+	Base64Decoder decoder(str);
+	std::string s(src.size(), '\0');
+	decoder.read(&s[0], (std::streamsize) s.size());
+	assertTrue (decoder.gcount() == (std::streamsize) src.size());
+	assertTrue (s == src);
+	assertTrue (decoder.get() == -1);
+}
+
+void Base64Test::testDecoderPart()
+{
+	// The decoder must not read past the end of the part,
+	// where the invalid data would make it fail.
+	std::string src;
+	for (int i = 0; i < 100; ++i) src += char('a' + i % 26);
+	PartStreamBuf buf(Base64Encoder::encode(src), "!QUJD");
+	std::istream istr(&buf);
+	Base64Decoder decoder(istr);
+	char buffer[200];
+	decoder.read(buffer, sizeof(buffer));
+	assertTrue (decoder.gcount() == (std::streamsize) src.size());
+	assertTrue (std::string(buffer, decoder.gcount()) == src);
+	assertTrue (decoder.eof());
+	assertTrue (!decoder.bad());
+}
+
+
 void Base64Test::setUp()
 {
 }
@@ -364,6 +472,8 @@ CppUnit::Test* Base64Test::suite()
 	CppUnit_addTest(pSuite, Base64Test, testDecoderURL);
 	CppUnit_addTest(pSuite, Base64Test, testDecoderNoPadding);
 	CppUnit_addTest(pSuite, Base64Test, testEncodeDecode);
+	CppUnit_addTest(pSuite, Base64Test, testBuffer);
+	CppUnit_addTest(pSuite, Base64Test, testDecoderPart);
 
 	return pSuite;
 }
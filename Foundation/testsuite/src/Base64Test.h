@@ -31,6 +31,8 @@ public:
 	void testDecoderURL();
 	void testDecoderNoPadding();
 	void testEncodeDecode();
+	void testBuffer();
+	void testDecoderPart();
 
 	void setUp();
 	void tearDown();
@@ -10,6 +10,7 @@
 
 #include "CacheTestSuite.h"
 #include "LRUCacheTest.h"
+#include "ShardedLRUCacheTest.h"
 #include "ExpireCacheTest.h"
 #include "ExpireLRUCacheTest.h"
 #include "UniqueExpireCacheTest.h"
@@ -20,6 +21,7 @@ CppUnit::Test* CacheTestSuite::suite()
 	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("CacheTestSuite");
 
 	pSuite->addTest(LRUCacheTest::suite());
+	pSuite->addTest(ShardedLRUCacheTest::suite());
 	pSuite->addTest(ExpireCacheTest::suite());
 	pSuite->addTest(UniqueExpireCacheTest::suite());
 	pSuite->addTest(ExpireLRUCacheTest::suite());
@@ -17,6 +17,9 @@
 
 
 using Poco::format;
+using Poco::CompiledFormat;
+using Poco::Any;
+using Poco::InvalidArgumentException;
 using Poco::BadCastException;
 using Poco::Int64;
 using Poco::UInt64;
@@ -453,6 +456,65 @@ void FormatTest::testIndex()
 }
 
 
+void FormatTest::testMissingArgs()
+{
+	std::string s(format("%d %d", 1));
+	assertTrue (s == "1 d");
+
+	s = format("%*d", 5);
+	assertTrue (s == "[ERRFMT]");
+
+	s = format("%*.*f|%d", 5, 2);
+	assertTrue (s == "[ERRFMT]|d");
+
+	std::vector<Any> values;
+	values.push_back(5);
+	s.clear();
+	format(s, "%*d", values);
+	assertTrue (s == "[ERRFMT]");
+}
+
+
+void FormatTest::testCompiledFormat()
+{
+	CompiledFormat fmt("%s: %5d [%04x] %-3c|%.2f%%");
+	assertTrue (fmt.toString() == "%s: %5d [%04x] %-3c|%.2f%%");
+	std::string s(fmt.format(std::string("abc"), 42, 255u, 'z', 1.5));
+	assertTrue (s == "abc:    42 [00ff] z  |1.50%");
+
+	s = "> ";
+	fmt.append(s, std::string("x"), -1, 10u, 'a', 0.25);
+	assertTrue (s == "> x:    -1 [000a] a  |0.25%");
+
+	s = fmt.format(std::string("abc"), 4.2);
+	assertTrue (s == "abc: [ERRFMT] [04x] -3c|.2f%");
+
+	s = fmt.format();
+	assertTrue (s == "s: 5d [04x] -3c|.2f%");
+
+	CompiledFormat fmtIndex("%[1]d-%[0]s-%s");
+	s = fmtIndex.format(std::string("a"), 1);
+	assertTrue (s == "1-a-a");
+
+	CompiledFormat fmtAny("%?d %?x %Lu %z %hd %b");
+	s = fmtAny.format('a', static_cast<short>(-1), UInt64(123), std::size_t(7), static_cast<short>(-2), true);
+	assertTrue (s == "97 ffff 123 7 -2 1");
+
+	CompiledFormat fmtStar("%*d|%-*s|%d");
+	s = fmtStar.format(4, 1, 3, std::string("a"), 2);
+	assertTrue (s == "   1|a  |2");
+
+	try
+	{
+		fmtIndex.format(1);
+		fail("argument index out of range - must throw");
+	}
+	catch (InvalidArgumentException&)
+	{
+	}
+}
+
+
 void FormatTest::setUp()
 {
 }
@@ -476,6 +538,8 @@ CppUnit::Test* FormatTest::suite()
 	CppUnit_addTest(pSuite, FormatTest, testString);
 	CppUnit_addTest(pSuite, FormatTest, testMultiple);
 	CppUnit_addTest(pSuite, FormatTest, testIndex);
+	CppUnit_addTest(pSuite, FormatTest, testMissingArgs);
+	CppUnit_addTest(pSuite, FormatTest, testCompiledFormat);
 
 	return pSuite;
 }
@@ -30,6 +30,8 @@ public:
 	void testString();
 	void testMultiple();
 	void testIndex();
+	void testMissingArgs();
+	void testCompiledFormat();
 
 	void setUp();
 	void tearDown();
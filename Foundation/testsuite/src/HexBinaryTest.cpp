@@ -14,6 +14,7 @@
 #include "Poco/HexBinaryEncoder.h"
 #include "Poco/HexBinaryDecoder.h"
 #include "Poco/Exception.h"
+#include "Poco/UnbufferedStreamBuf.h"
 #include <sstream>
 
 
@@ -22,6 +23,40 @@ using Poco::HexBinaryDecoder;
 using Poco::DataFormatException;
 
 
+namespace
+{
+	class PartStreamBuf: public Poco::UnbufferedStreamBuf
+		/// Returns eof once at the end of the part, and then
+		/// the rest of the data, like a part of a MultipartReader.
+	{
+	public:
+		PartStreamBuf(const std::string& part, const std::string& rest):
+			_data(part + rest),
+			_end(part.size()),
+			_pos(0)
+		{
+		}
+
+	protected:
+		int readFromDevice()
+		{
+			if (_pos == _end)
+			{
+				_end = std::string::npos;
+				return -1;
+			}
+			if (_pos == _data.size()) return -1;
+			return static_cast<unsigned char>(_data[_pos++]);
+		}
+
+	private:
+		std::string _data;
+		std::size_t _end;
+		std::size_t _pos;
+	};
+}
+
+
 HexBinaryTest::HexBinaryTest(const std::string& name): CppUnit::TestCase(name)
 {
 }
@@ -183,6 +218,73 @@ void HexBinaryTest::testEncodeDecode()
 }
 
 
+void HexBinaryTest::testBuffer()
+{
+	char buffer[64];
+	std::size_t n = HexBinaryEncoder::encode("\00\01\02\03\04\05\372\373\374\375\376\377\00\01\02\03\04\05", 18, buffer);
+	assertTrue (std::string(buffer, n) == "000102030405fafbfcfdfeff000102030405");
+	n = HexBinaryEncoder::encode("\253\315\357", 3, buffer, true);
+	assertTrue (std::string(buffer, n) == "ABCDEF");
+	assertTrue (HexBinaryEncoder::encode(std::string("Hello")) == "48656c6c6f");
+
+	n = HexBinaryDecoder::decode("00 01\n02ff", 10, buffer);
+	assertTrue (std::string(buffer, n) == std::string("\00\01\02\377", 4));
+	assertTrue (HexBinaryDecoder::decode(std::string("48656C6c6f")) == "Hello");
+	try
+	{
+		HexBinaryDecoder::decode(std::string("486"));
+		fail("odd number of digits - must throw");
+	}
+	catch (DataFormatException&)
+	{
+	}
+	try
+	{
+		HexBinaryDecoder::decode(std::string("4g"));
+		fail("invalid character - must throw");
+	}
+	catch (DataFormatException&)
+	{
+	}
+
+	std::string src;
+	for (int i = 0; i < 10000; ++i) src += char(i*7);
+	std::string enc = HexBinaryEncoder::encode(src);
+	assertTrue (HexBinaryDecoder::decode(enc) == src);
+
+	std::stringstream str;
+	HexBinaryEncoder encoder(str);
+	encoder.write(src.data(), (std::streamsize) src.size());
+	encoder.close();
+	std::string encoded = str.str();
+	assertTrue (encoded.substr(0, 72) == enc.substr(0, 72));
+	assertTrue (encoded[72] == '\n');
+	HexBinaryDecoder decoder(str);
+	std::string s(src.size(), '\0');
+	decoder.read(&s[0], (std::streamsize) s.size());
+	assertTrue (decoder.gcount() == (std::streamsize) src.size());
+	assertTrue (s == src);
+	assertTrue (decoder.get() == -1);
+}
+
+void HexBinaryTest::testDecoderPart()
+{
+	// The decoder must not read past the end of the part,
+	// where the invalid data would make it fail.
+	std::string src;
+	for (int i = 0; i < 100; ++i) src += char('a' + i % 26);
+	PartStreamBuf buf(HexBinaryEncoder::encode(src), "zz4142");
+	std::istream istr(&buf);
+	HexBinaryDecoder decoder(istr);
+	char buffer[200];
+	decoder.read(buffer, sizeof(buffer));
+	assertTrue (decoder.gcount() == (std::streamsize) src.size());
+	assertTrue (std::string(buffer, decoder.gcount()) == src);
+	assertTrue (decoder.eof());
+	assertTrue (!decoder.bad());
+}
+
+
 void HexBinaryTest::setUp()
 {
 }
@@ -200,6 +302,8 @@ CppUnit::Test* HexBinaryTest::suite()
 	CppUnit_addTest(pSuite, HexBinaryTest, testEncoder);
 	CppUnit_addTest(pSuite, HexBinaryTest, testDecoder);
 	CppUnit_addTest(pSuite, HexBinaryTest, testEncodeDecode);
+	CppUnit_addTest(pSuite, HexBinaryTest, testBuffer);
+	CppUnit_addTest(pSuite, HexBinaryTest, testDecoderPart);
 
 	return pSuite;
 }
@@ -17,6 +17,7 @@
 #include "Poco/Runnable.h"
 #include "Poco/RunnableAdapter.h"
 #include "Poco/Random.h"
+#include "Poco/Exception.h"
 
 
 using Poco::NotificationQueue;
@@ -44,10 +45,31 @@ namespace
 	private:
 		std::string _data;
 	};
+
+	class QTestProducer: public Poco::Runnable
+	{
+	public:
+		QTestProducer(NotificationQueue& queue, int count): _queue(queue), _count(count)
+		{
+		}
+		void run()
+		{
+			for (int i = 0; i < _count; ++i)
+			{
+				_queue.enqueueNotification(new QTestNotification(std::to_string(i)));
+			}
+		}
+
+	private:
+		NotificationQueue& _queue;
+		int _count;
+	};
 }
 
 
-NotificationQueueTest::NotificationQueueTest(const std::string& name): CppUnit::TestCase(name)
+NotificationQueueTest::NotificationQueueTest(const std::string& name):
+	CppUnit::TestCase(name),
+	_boundedQueue(64)
 {
 }
 
@@ -188,6 +210,157 @@ void NotificationQueueTest::testDefaultQueue()
 }
 
 
+void NotificationQueueTest::testDequeueMany()
+{
+	NotificationQueue queue;
+	std::vector<Notification::Ptr> nfs;
+	assertTrue (queue.dequeueMany(nfs, 10) == 0);
+	assertTrue (nfs.empty());
+
+	queue.enqueueNotification(new QTestNotification("first"));
+	queue.enqueueNotification(new QTestNotification("second"));
+	queue.enqueueNotification(new QTestNotification("third"));
+	assertTrue (queue.dequeueMany(nfs, 2) == 2);
+	assertTrue (nfs.size() == 2);
+	assertTrue (nfs[0].cast<QTestNotification>()->data() == "first");
+	assertTrue (nfs[1].cast<QTestNotification>()->data() == "second");
+	assertTrue (queue.size() == 1);
+	assertTrue (queue.dequeueMany(nfs, 10) == 1);
+	assertTrue (nfs.size() == 3);
+	assertTrue (nfs[2].cast<QTestNotification>()->data() == "third");
+	assertTrue (queue.empty());
+}
+
+
+void NotificationQueueTest::testBoundedQueueDequeue()
+{
+	NotificationQueue queue(3);
+	assertTrue (queue.capacity() == 4);
+	assertTrue (queue.empty());
+	assertTrue (queue.size() == 0);
+	Notification* pNf = queue.dequeueNotification();
+	assertNullPtr(pNf);
+
+	queue.enqueueNotification(new QTestNotification("first"));
+	queue.enqueueNotification(new QTestNotification("second"));
+	assertTrue (!queue.empty());
+	assertTrue (queue.size() == 2);
+	QTestNotification* pTNf = dynamic_cast<QTestNotification*>(queue.dequeueNotification());
+	assertNotNullPtr(pTNf);
+	assertTrue (pTNf->data() == "first");
+	pTNf->release();
+	assertTrue (queue.size() == 1);
+
+	for (int i = 0; i < 3; ++i)
+	{
+		queue.enqueueNotification(new QTestNotification("more"));
+	}
+	assertTrue (queue.size() == 4);
+	std::vector<Notification::Ptr> nfs;
+	assertTrue (queue.dequeueMany(nfs, 10) == 4);
+	assertTrue (nfs[0].cast<QTestNotification>()->data() == "second");
+	assertTrue (queue.empty());
+
+	try
+	{
+		queue.enqueueUrgentNotification(new Notification);
+		failmsg("bounded queue - must throw exception");
+	}
+	catch (Poco::NotImplementedException&)
+	{
+	}
+
+	queue.enqueueNotification(new Notification);
+	queue.clear();
+	assertTrue (queue.empty());
+	pNf = queue.dequeueNotification();
+	assertNullPtr(pNf);
+}
+
+
+void NotificationQueueTest::testBoundedWaitDequeue()
+{
+	NotificationQueue queue(16);
+	queue.enqueueNotification(new QTestNotification("third"));
+	queue.enqueueNotification(new QTestNotification("fourth"));
+	QTestNotification* pTNf = dynamic_cast<QTestNotification*>(queue.waitDequeueNotification(10));
+	assertNotNullPtr(pTNf);
+	assertTrue (pTNf->data() == "third");
+	pTNf->release();
+	pTNf = dynamic_cast<QTestNotification*>(queue.waitDequeueNotification(10));
+	assertNotNullPtr(pTNf);
+	assertTrue (pTNf->data() == "fourth");
+	pTNf->release();
+	assertTrue (queue.empty());
+
+	Notification* pNf = queue.waitDequeueNotification(10);
+	assertNullPtr(pNf);
+	assertTrue (!queue.hasIdleThreads());
+}
+
+
+void NotificationQueueTest::testBoundedThreads()
+{
+	const int NOTIFICATION_COUNT = 5000;
+
+	Thread t1("thread1");
+	Thread t2("thread2");
+	Thread t3("thread3");
+
+	RunnableAdapter<NotificationQueueTest> ra(*this, &NotificationQueueTest::workBounded);
+	t1.start(ra);
+	t2.start(ra);
+	t3.start(ra);
+	for (int i = 0; i < NOTIFICATION_COUNT; ++i)
+	{
+		_boundedQueue.enqueueNotification(new Notification);
+	}
+	while (!_boundedQueue.empty()) Thread::sleep(50);
+	Thread::sleep(20);
+	_boundedQueue.wakeUpAll();
+	t1.join();
+	t2.join();
+	t3.join();
+	assertTrue (_handled.size() == NOTIFICATION_COUNT);
+	assertTrue (_handled.count("thread1") > 0);
+	assertTrue (_handled.count("thread2") > 0);
+	assertTrue (_handled.count("thread3") > 0);
+}
+
+
+void NotificationQueueTest::testBoundedFull()
+{
+	const int NOTIFICATION_COUNT = 200;
+
+	NotificationQueue queue(2);
+	QTestProducer producer1(queue, NOTIFICATION_COUNT);
+	QTestProducer producer2(queue, NOTIFICATION_COUNT);
+	Thread t1;
+	Thread t2;
+	t1.start(producer1);
+	t2.start(producer2);
+	Thread::sleep(50);
+	assertTrue (queue.size() == 2);
+
+	int next1 = 0;
+	int next2 = 0;
+	for (int i = 0; i < 2*NOTIFICATION_COUNT; ++i)
+	{
+		if (i % 50 == 0) Thread::sleep(10);
+		QTestNotification* pTNf = dynamic_cast<QTestNotification*>(queue.waitDequeueNotification(5000));
+		assertNotNullPtr(pTNf);
+		int n = std::stoi(pTNf->data());
+		pTNf->release();
+		// each producer's notifications arrive in order
+		assertTrue (n == next1 || n == next2);
+		if (n == next1) ++next1; else ++next2;
+	}
+	t1.join();
+	t2.join();
+	assertTrue (queue.empty());
+}
+
+
 void NotificationQueueTest::setUp()
 {
 	_handled.clear();
@@ -200,10 +373,22 @@ void NotificationQueueTest::tearDown()
 
 
 void NotificationQueueTest::work()
+{
+	work(_queue);
+}
+
+
+void NotificationQueueTest::workBounded()
+{
+	work(_boundedQueue);
+}
+
+
+void NotificationQueueTest::work(NotificationQueue& queue)
 {
 	Poco::Random rnd;
 	Thread::sleep(50);
-	Notification* pNf = _queue.waitDequeueNotification();
+	Notification* pNf = queue.waitDequeueNotification();
 	while (pNf)
 	{
 		pNf->release();
@@ -211,7 +396,7 @@ void NotificationQueueTest::work()
 		_handled.insert(Thread::current()->name());
 		_mutex.unlock();
 		Thread::sleep(rnd.next(5));
-		pNf = _queue.waitDequeueNotification();
+		pNf = queue.waitDequeueNotification();
 	}
 }
 
@@ -225,6 +410,11 @@ CppUnit::Test* NotificationQueueTest::suite()
 	CppUnit_addTest(pSuite, NotificationQueueTest, testWaitDequeue);
 	CppUnit_addTest(pSuite, NotificationQueueTest, testThreads);
 	CppUnit_addTest(pSuite, NotificationQueueTest, testDefaultQueue);
+	CppUnit_addTest(pSuite, NotificationQueueTest, testDequeueMany);
+	CppUnit_addTest(pSuite, NotificationQueueTest, testBoundedQueueDequeue);
+	CppUnit_addTest(pSuite, NotificationQueueTest, testBoundedWaitDequeue);
+	CppUnit_addTest(pSuite, NotificationQueueTest, testBoundedThreads);
+	CppUnit_addTest(pSuite, NotificationQueueTest, testBoundedFull);
 
 	return pSuite;
 }
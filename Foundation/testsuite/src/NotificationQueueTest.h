@@ -32,6 +32,11 @@ public:
 	void testWaitDequeue();
 	void testThreads();
 	void testDefaultQueue();
+	void testDequeueMany();
+	void testBoundedQueueDequeue();
+	void testBoundedWaitDequeue();
+	void testBoundedThreads();
+	void testBoundedFull();
 
 	void setUp();
 	void tearDown();
@@ -40,9 +45,12 @@ public:
 
 protected:
 	void work();
+	void workBounded();
+	void work(Poco::NotificationQueue& queue);
 
 private:
 	Poco::NotificationQueue    _queue;
+	Poco::NotificationQueue    _boundedQueue;
 	std::multiset<std::string> _handled;
 	Poco::FastMutex            _mutex;
 };
@@ -13,6 +13,7 @@
 #include "CppUnit/TestSuite.h"
 #include "Poco/NumberFormatter.h"
 #include <sstream>
+#include <limits>
 
 
 using Poco::NumberFormatter;
@@ -315,6 +316,50 @@ void NumberFormatterTest::testAppend()
 }
 
 
+void NumberFormatterTest::testAppendBuffer()
+{
+	char buffer[NumberFormatter::NF_MAX_SHORTEST_FLT_STRING_LEN];
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, 0)) == "0");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, 7)) == "7");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, 10)) == "10");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, -123)) == "-123");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, 123456789)) == "123456789");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, std::numeric_limits<int>::min())) == "-2147483648");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, std::numeric_limits<int>::max())) == "2147483647");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, std::numeric_limits<unsigned>::max())) == "4294967295");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, -1234567890L)) == "-1234567890");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, 1234567890UL)) == "1234567890");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, std::numeric_limits<Int64>::min())) == "-9223372036854775808");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, std::numeric_limits<Int64>::max())) == "9223372036854775807");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, std::numeric_limits<UInt64>::max())) == "18446744073709551615");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, UInt64(4294967296ULL))) == "4294967296");
+
+	UInt64 value = 1;
+	std::string expected("1");
+	for (int i = 0; i < 19; i++)
+	{
+		assertTrue (std::string(buffer, NumberFormatter::append(buffer, value)) == expected);
+		assertTrue (std::string(buffer, NumberFormatter::append(buffer, value - 1)) == NumberFormatter::format(value - 1));
+		value *= 10;
+		expected += '0';
+	}
+
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, 0.0)) == "0");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, -0.0)) == "0");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, 123.0)) == "123");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, -123.0)) == "-123");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, 123.4)) == "123.4");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, 0.1)) == "0.1");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, 999999999999999.0)) == "999999999999999");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, 1e15)) == "1e+15");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, -1.2345678901234567e-14)) == "-0.000000000000012345678901234567");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, -1.7976931348623157e308)) == "-1.7976931348623157e+308");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, 999999.0f)) == "999999");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, 1e6f)) == "1e+6");
+	assertTrue (std::string(buffer, NumberFormatter::append(buffer, 1.5f)) == "1.5");
+}
+
+
 void NumberFormatterTest::setUp()
 {
 }
@@ -335,6 +380,7 @@ CppUnit::Test* NumberFormatterTest::suite()
 	CppUnit_addTest(pSuite, NumberFormatterTest, testFormatHex);
 	CppUnit_addTest(pSuite, NumberFormatterTest, testFormatFloat);
 	CppUnit_addTest(pSuite, NumberFormatterTest, testAppend);
+	CppUnit_addTest(pSuite, NumberFormatterTest, testAppendBuffer);
 
 	return pSuite;
 }
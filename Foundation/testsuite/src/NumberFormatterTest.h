@@ -30,6 +30,7 @@ public:
 	void testFormatHex();
 	void testFormatFloat();
 	void testAppend();
+	void testAppendBuffer();
 
 	void setUp();
 	void tearDown();
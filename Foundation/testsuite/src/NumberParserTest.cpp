@@ -303,6 +303,58 @@ void NumberParserTest::testParseError()
 }
 
 
+void NumberParserTest::testParseBuffer()
+{
+	int i = 0;
+	unsigned u = 0;
+	const char* buffer = "123456789012345678901234";
+	assertTrue (NumberParser::tryParse(buffer, 3, i) && i == 123);
+	assertTrue (NumberParser::tryParse(buffer, 9, i) && i == 123456789);
+	assertTrue (NumberParser::tryParse(buffer, 10, i) && i == 1234567890);
+	assertTrue (!NumberParser::tryParse(buffer, 11, i));
+	assertTrue (NumberParser::tryParseUnsigned(buffer, 9, u) && u == 123456789);
+	assertTrue (!NumberParser::tryParse(buffer, 0, i));
+	assertTrue (!NumberParser::tryParse("-", 0, i));
+	assertTrue (NumberParser::tryParse("1,000", 5, i) && i == 1000);
+	assertTrue (NumberParser::tryParse("1.000", 5, i, '.') && i == 1000);
+	assertTrue (!NumberParser::tryParse("12\0", 3, i));
+	assertTrue (!NumberParser::tryParse(std::string("12\0", 3), i));
+
+#if defined(POCO_HAVE_INT64)
+	Int64 i64 = 0;
+	UInt64 u64 = 0;
+	assertTrue (NumberParser::tryParse64(buffer, 8, i64) && i64 == 12345678);
+	assertTrue (NumberParser::tryParse64(buffer, 16, i64) && i64 == 1234567890123456LL);
+	assertTrue (NumberParser::tryParse64(buffer, 19, i64) && i64 == 1234567890123456789LL);
+	assertTrue (!NumberParser::tryParse64(buffer, 20, i64));
+	assertTrue (NumberParser::tryParseUnsigned64(buffer, 20, u64) && u64 == 12345678901234567890ULL);
+	assertTrue (!NumberParser::tryParseUnsigned64(buffer, 21, u64));
+	assertTrue (NumberParser::tryParse64("-1234567890123456789", 20, i64) && i64 == -1234567890123456789LL);
+	assertTrue (NumberParser::tryParse64("-9223372036854775808", 20, i64) && i64 == std::numeric_limits<Int64>::min());
+	assertTrue (!NumberParser::tryParse64("-9223372036854775809", 20, i64));
+	assertTrue (NumberParser::tryParse64("+0000000000000000000000042", 26, i64) && i64 == 42);
+	assertTrue (NumberParser::tryParseUnsigned64("18446744073709551615", 20, u64) && u64 == std::numeric_limits<UInt64>::max());
+	assertTrue (!NumberParser::tryParseUnsigned64("18446744073709551616", 20, u64));
+	assertTrue (!NumberParser::tryParseUnsigned64("-1", 2, u64));
+	assertTrue (NumberParser::tryParseHex64("FFFFFFFFFFFFFFFF", u64) && u64 == std::numeric_limits<UInt64>::max());
+	assertTrue (!NumberParser::tryParseHex64("10000000000000000", u64));
+	assertTrue (!NumberParser::tryParseHex64("1FFFFFFFFFFFFFFFF", u64));
+
+	// a non-digit at every position of an eight-digit block
+	for (int pos = 0; pos < 16; pos++)
+	{
+		std::string s("1234567812345678");
+		s[pos] = ':';
+		assertTrue (!NumberParser::tryParse64(s.data(), s.size(), i64));
+		s[pos] = '/';
+		assertTrue (!NumberParser::tryParse64(s.data(), s.size(), i64));
+		s[pos] = '\xB0';
+		assertTrue (!NumberParser::tryParse64(s.data(), s.size(), i64));
+	}
+#endif // POCO_HAVE_INT64
+}
+
+
 void NumberParserTest::setUp()
 {
 }
@@ -320,6 +372,7 @@ CppUnit::Test* NumberParserTest::suite()
 	CppUnit_addTest(pSuite, NumberParserTest, testParse);
 	CppUnit_addTest(pSuite, NumberParserTest, testLimits);
 	CppUnit_addTest(pSuite, NumberParserTest, testParseError);
+	CppUnit_addTest(pSuite, NumberParserTest, testParseBuffer);
 
 	return pSuite;
 }
@@ -31,6 +31,7 @@ public:
 	void testParse();
 	void testLimits();
 	void testParseError();
+	void testParseBuffer();
 
 	void setUp();
 	void tearDown();
@@ -43,6 +43,11 @@ void SHA1EngineTest::testSHA1()
 	for (int i = 0; i < 1000000; ++i)
 		engine.update('a');
 	assertTrue (DigestEngine::digestToHex(engine.digest()) == "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+
+	std::string a(1000000, 'a');
+	engine.update(a.data(), 3);
+	engine.update(a.data() + 3, a.size() - 3);
+	assertTrue (DigestEngine::digestToHex(engine.digest()) == "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
 }
 
 
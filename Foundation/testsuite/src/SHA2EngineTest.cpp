@@ -108,6 +108,43 @@ void SHA2EngineTest::testSHA512()
 }
 
 
+void SHA2EngineTest::testDigestMany()
+{
+	std::vector<std::string> messages;
+	messages.push_back("abc");
+	messages.push_back("");
+	messages.push_back("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq");
+	messages.push_back(std::string(1000000, 'a'));
+	for (int i = 0; i < 100; ++i)
+	{
+		std::string message;
+		for (int j = 0; j < i*7; ++j) message += static_cast<char>(i + j*13);
+		messages.push_back(message);
+	}
+
+	std::vector<DigestEngine::Digest> digests = SHA2Engine::digestMany(messages);
+	assertTrue (digests.size() == messages.size());
+	assertTrue (DigestEngine::digestToHex(digests[0]) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+	assertTrue (DigestEngine::digestToHex(digests[1]) == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+	assertTrue (DigestEngine::digestToHex(digests[2]) == "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+	assertTrue (DigestEngine::digestToHex(digests[3]) == "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+
+	SHA2Engine::ALGORITHM algorithms[] = { SHA2Engine::SHA_224, SHA2Engine::SHA_256, SHA2Engine::SHA_384, SHA2Engine::SHA_512 };
+	for (int k = 0; k < 4; ++k)
+	{
+		digests = SHA2Engine::digestMany(messages, algorithms[k]);
+		SHA2Engine engine(algorithms[k]);
+		for (std::size_t i = 0; i < messages.size(); ++i)
+		{
+			engine.update(messages[i]);
+			assertTrue (digests[i] == engine.digest());
+		}
+	}
+
+	assertTrue (SHA2Engine::digestMany(std::vector<std::string>()).empty());
+}
+
+
 void SHA2EngineTest::setUp()
 {
 }
@@ -126,6 +163,7 @@ CppUnit::Test* SHA2EngineTest::suite()
 	CppUnit_addTest(pSuite, SHA2EngineTest, testSHA256);
 	CppUnit_addTest(pSuite, SHA2EngineTest, testSHA384);
 	CppUnit_addTest(pSuite, SHA2EngineTest, testSHA512);
+	CppUnit_addTest(pSuite, SHA2EngineTest, testDigestMany);
 
 	return pSuite;
 }
@@ -28,6 +28,7 @@ public:
 	void testSHA256();
 	void testSHA384();
 	void testSHA512();
+	void testDigestMany();
 
 	void setUp();
 	void tearDown();
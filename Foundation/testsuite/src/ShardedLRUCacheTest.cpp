@@ -0,0 +1,288 @@
+//
+// ShardedLRUCacheTest.cpp
+//
+// Copyright (c) 2006-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "ShardedLRUCacheTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+#include "Poco/Exception.h"
+#include "Poco/ShardedLRUCache.h"
+#include "Poco/Delegate.h"
+#include "Poco/Thread.h"
+#include "Poco/Runnable.h"
+#include "Poco/AtomicCounter.h"
+
+
+using namespace Poco;
+
+
+namespace
+{
+	class CacheWorker: public Poco::Runnable
+	{
+	public:
+		CacheWorker(ShardedLRUCache<int, int>& cache, int offset, Poco::AtomicCounter& errors):
+			_cache(cache),
+			_offset(offset),
+			_errors(errors)
+		{
+		}
+
+		void run()
+		{
+			for (int i = 0; i < 20000; i++)
+			{
+				int key = _offset + (i % 500);
+				_cache.add(key, key*2);
+				SharedPtr<int> pVal = _cache.get(key);
+				if (pVal && *pVal != key*2) ++_errors;
+				_cache.get(_offset + ((i*7) % 500));
+				if (i % 10 == 0) _cache.remove(key);
+			}
+		}
+
+	private:
+		ShardedLRUCache<int, int>& _cache;
+		int _offset;
+		Poco::AtomicCounter& _errors;
+	};
+}
+
+
+ShardedLRUCacheTest::ShardedLRUCacheTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+ShardedLRUCacheTest::~ShardedLRUCacheTest()
+{
+}
+
+
+void ShardedLRUCacheTest::testClear()
+{
+	ShardedLRUCache<int, int> aCache(64);
+	assertTrue (aCache.size() == 0);
+	assertTrue (aCache.getAllKeys().size() == 0);
+	aCache.add(1, 2);
+	aCache.add(3, 4);
+	aCache.add(5, 6);
+	assertTrue (aCache.size() == 3);
+	assertTrue (aCache.getAllKeys().size() == 3);
+	assertTrue (aCache.has(1));
+	assertTrue (aCache.has(3));
+	assertTrue (aCache.has(5));
+	assertTrue (*aCache.get(1) == 2);
+	assertTrue (*aCache.get(3) == 4);
+	assertTrue (*aCache.get(5) == 6);
+	aCache.clear();
+	assertTrue (!aCache.has(1));
+	assertTrue (!aCache.has(3));
+	assertTrue (!aCache.has(5));
+	assertTrue (aCache.size() == 0);
+}
+
+
+void ShardedLRUCacheTest::testCacheSize0()
+{
+	// cache size 0 is illegal
+	try
+	{
+		ShardedLRUCache<int, int> aCache(0);
+		failmsg ("cache size of 0 is illegal, test should fail");
+	}
+	catch (Poco::InvalidArgumentException&)
+	{
+	}
+}
+
+
+void ShardedLRUCacheTest::testCacheSizeN()
+{
+	// with a single shard, replacement is exact LRU
+	ShardedLRUCache<int, int> aCache(3, 1);
+	assertTrue (aCache.shards() == 1);
+	aCache.add(1, 2);
+	aCache.add(3, 4);
+	aCache.add(5, 6); // 5 3 1
+	assertTrue (aCache.has(1));
+	assertTrue (aCache.has(3));
+	assertTrue (aCache.has(5));
+
+	assertTrue (*aCache.get(1) == 2); // 1 5 3
+	aCache.add(7, 8); // 7 1 5, 3 removed
+	assertTrue (!aCache.has(3));
+	assertTrue (aCache.has(1));
+	assertTrue (aCache.has(5));
+	assertTrue (aCache.has(7));
+
+	aCache.update(5, 10); // 5 7 1
+	aCache.add(9, 11); // 9 5 7, 1 removed
+	assertTrue (!aCache.has(1));
+	assertTrue (*aCache.get(5) == 10);
+	assertTrue (aCache.has(7));
+	assertTrue (aCache.has(9));
+	assertTrue (aCache.size() == 3);
+
+	aCache.remove(5);
+	assertTrue (!aCache.has(5));
+	assertTrue (aCache.size() == 2);
+	aCache.add(11, 12);
+	aCache.add(13, 14); // 13 11 9, 7 removed
+	assertTrue (!aCache.has(7));
+	assertTrue (aCache.size() == 3);
+}
+
+
+void ShardedLRUCacheTest::testShards()
+{
+	ShardedLRUCache<int, int> aCache(100, 16);
+	assertTrue (aCache.shards() == 16);
+	assertTrue (aCache.capacity() == 100);
+
+	ShardedLRUCache<int, int> smallCache(3, 16);
+	assertTrue (smallCache.shards() == 2);
+
+	ShardedLRUCache<int, int> oddCache(100, 12);
+	assertTrue (oddCache.shards() == 8);
+
+	for (int i = 0; i < 1000; i++)
+	{
+		aCache.add(i, i);
+	}
+	assertTrue (aCache.size() <= 100);
+	assertTrue (aCache.size() > 0);
+	// the most recently added entry is always present
+	assertTrue (aCache.has(999));
+	assertTrue (*aCache.get(999) == 999);
+}
+
+
+void ShardedLRUCacheTest::testUpdate()
+{
+	addCnt = 0;
+	updateCnt = 0;
+	removeCnt = 0;
+	ShardedLRUCache<int, int> aCache(1, 1);
+	aCache.Add += delegate(this, &ShardedLRUCacheTest::onAdd);
+	aCache.Remove += delegate(this, &ShardedLRUCacheTest::onRemove);
+	aCache.Update += delegate(this, &ShardedLRUCacheTest::onUpdate);
+	aCache.add(1, 2); // 1 ,one add event
+	assertTrue (addCnt == 1);
+	assertTrue (updateCnt == 0);
+	assertTrue (removeCnt == 0);
+
+	assertTrue (aCache.has(1));
+	assertTrue (*aCache.get(1) == 2);
+	aCache.update(1, 3); // one update event only!
+	assertTrue (addCnt == 1);
+	assertTrue (updateCnt == 1);
+	assertTrue (removeCnt == 0);
+	assertTrue (aCache.has(1));
+	assertTrue (*aCache.get(1) == 3);
+
+	aCache.add(1, 4); // remove and add
+	assertTrue (addCnt == 2);
+	assertTrue (removeCnt == 1);
+
+	aCache.add(2, 5); // replaces 1
+	assertTrue (addCnt == 3);
+	assertTrue (removeCnt == 2);
+	assertTrue (!aCache.has(1));
+}
+
+
+void ShardedLRUCacheTest::testEventsDisabled()
+{
+	addCnt = 0;
+	updateCnt = 0;
+	removeCnt = 0;
+	ShardedLRUCache<int, int> aCache(1, 1, false);
+	aCache.Add += delegate(this, &ShardedLRUCacheTest::onAdd);
+	aCache.Remove += delegate(this, &ShardedLRUCacheTest::onRemove);
+	aCache.Update += delegate(this, &ShardedLRUCacheTest::onUpdate);
+	aCache.add(1, 2);
+	aCache.update(1, 3);
+	aCache.add(2, 4);
+	aCache.remove(2);
+	assertTrue (addCnt == 0);
+	assertTrue (updateCnt == 0);
+	assertTrue (removeCnt == 0);
+	assertTrue (aCache.size() == 0);
+}
+
+
+void ShardedLRUCacheTest::testThreads()
+{
+	ShardedLRUCache<int, int> aCache(1024, 16, false);
+	Poco::AtomicCounter errors;
+	CacheWorker worker1(aCache, 0, errors);
+	CacheWorker worker2(aCache, 250, errors);
+	CacheWorker worker3(aCache, 1000, errors);
+	CacheWorker worker4(aCache, 5000, errors);
+	Poco::Thread thread1;
+	Poco::Thread thread2;
+	Poco::Thread thread3;
+	Poco::Thread thread4;
+	thread1.start(worker1);
+	thread2.start(worker2);
+	thread3.start(worker3);
+	thread4.start(worker4);
+	thread1.join();
+	thread2.join();
+	thread3.join();
+	thread4.join();
+	assertTrue (errors.value() == 0);
+	assertTrue (aCache.size() <= 1024);
+	assertTrue (aCache.getAllKeys().size() == aCache.size());
+}
+
+
+void ShardedLRUCacheTest::onUpdate(const void*, const Poco::KeyValueArgs<int, int>&)
+{
+	++updateCnt;
+}
+
+
+void ShardedLRUCacheTest::onAdd(const void*, const Poco::KeyValueArgs<int, int>&)
+{
+	++addCnt;
+}
+
+
+void ShardedLRUCacheTest::onRemove(const void*, const int&)
+{
+	++removeCnt;
+}
+
+
+void ShardedLRUCacheTest::setUp()
+{
+}
+
+
+void ShardedLRUCacheTest::tearDown()
+{
+}
+
+
+CppUnit::Test* ShardedLRUCacheTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("ShardedLRUCacheTest");
+
+	CppUnit_addTest(pSuite, ShardedLRUCacheTest, testClear);
+	CppUnit_addTest(pSuite, ShardedLRUCacheTest, testCacheSize0);
+	CppUnit_addTest(pSuite, ShardedLRUCacheTest, testCacheSizeN);
+	CppUnit_addTest(pSuite, ShardedLRUCacheTest, testShards);
+	CppUnit_addTest(pSuite, ShardedLRUCacheTest, testUpdate);
+	CppUnit_addTest(pSuite, ShardedLRUCacheTest, testEventsDisabled);
+	CppUnit_addTest(pSuite, ShardedLRUCacheTest, testThreads);
+
+	return pSuite;
+}
@@ -0,0 +1,51 @@
+//
+// ShardedLRUCacheTest.h
+//
+// Tests for ShardedLRUCache
+//
+// Copyright (c) 2006-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+#ifndef ShardedLRUCacheTest_INCLUDED
+#define ShardedLRUCacheTest_INCLUDED
+
+
+#include "Poco/Foundation.h"
+#include "Poco/KeyValueArgs.h"
+#include "CppUnit/TestCase.h"
+
+
+class ShardedLRUCacheTest: public CppUnit::TestCase
+{
+public:
+	ShardedLRUCacheTest(const std::string& name);
+	~ShardedLRUCacheTest();
+
+	void testClear();
+	void testCacheSize0();
+	void testCacheSizeN();
+	void testShards();
+	void testUpdate();
+	void testEventsDisabled();
+	void testThreads();
+
+	void setUp();
+	void tearDown();
+	static CppUnit::Test* suite();
+
+private:
+	void onUpdate(const void* pSender, const Poco::KeyValueArgs<int, int>& args);
+	void onAdd(const void* pSender, const Poco::KeyValueArgs<int, int>& args);
+	void onRemove(const void* pSender, const int& args);
+
+private:
+	int addCnt;
+	int updateCnt;
+	int removeCnt;
+};
+
+
+#endif // ShardedLRUCacheTest_INCLUDED
@@ -0,0 +1,251 @@
+//
+// TimingWheelTest.cpp
+//
+// Copyright (c) 2004-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "TimingWheelTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+#include "Poco/TimingWheel.h"
+#include "Poco/Clock.h"
+
+
+using Poco::TimingWheel;
+using Poco::Clock;
+
+
+namespace
+{
+	class TestEntry: public TimingWheel::Entry
+	{
+	public:
+		TestEntry(int id = 0): _id(id)
+		{
+		}
+
+		int id() const
+		{
+			return _id;
+		}
+
+	private:
+		int _id;
+	};
+
+	Clock offset(const Clock& base, Clock::ClockDiff diff)
+	{
+		Clock clock(base);
+		clock += diff;
+		return clock;
+	}
+}
+
+
+TimingWheelTest::TimingWheelTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+TimingWheelTest::~TimingWheelTest()
+{
+}
+
+
+void TimingWheelTest::testSchedule()
+{
+	TimingWheel wheel(1000);
+	Clock start;
+	assertTrue (wheel.empty());
+	assertTrue (wheel.resolution() == 1000);
+
+	TestEntry e1(1);
+	TestEntry e2(2);
+	TestEntry e3(3);
+	wheel.schedule(e1, offset(start, 5000));
+	wheel.schedule(e2, offset(start, 10000));
+	wheel.schedule(e3, offset(start, 10000));
+	assertTrue (wheel.size() == 3);
+	assertTrue (e1.isScheduled());
+
+	TimingWheel::EntryVec expired;
+	wheel.advance(offset(start, 4000), expired);
+	assertTrue (expired.empty());
+
+	wheel.advance(offset(start, 6000), expired);
+	assertTrue (expired.size() == 1);
+	assertTrue (static_cast<TestEntry*>(expired[0])->id() == 1);
+	assertTrue (!e1.isScheduled());
+	assertTrue (wheel.size() == 2);
+
+	expired.clear();
+	wheel.advance(offset(start, 20000), expired);
+	assertTrue (expired.size() == 2);
+	assertTrue (wheel.empty());
+
+	expired.clear();
+	wheel.schedule(e1, offset(start, -1000));
+	wheel.advance(offset(start, 20000), expired);
+	assertTrue (expired.size() == 1);
+}
+
+
+void TimingWheelTest::testCancel()
+{
+	TimingWheel wheel(1000);
+	Clock start;
+
+	TestEntry e1(1);
+	TestEntry e2(2);
+	wheel.schedule(e1, offset(start, 5000));
+	wheel.schedule(e2, offset(start, 5000));
+	wheel.cancel(e1);
+	assertTrue (!e1.isScheduled());
+	assertTrue (wheel.size() == 1);
+	{
+		TestEntry e3(3);
+		wheel.schedule(e3, offset(start, 5000));
+		assertTrue (wheel.size() == 2);
+	}
+	assertTrue (wheel.size() == 1);
+
+	TimingWheel::EntryVec expired;
+	wheel.advance(offset(start, 10000), expired);
+	assertTrue (expired.size() == 1);
+	assertTrue (expired[0] == &e2);
+
+	wheel.schedule(e1, offset(start, 50000));
+	wheel.schedule(e2, offset(start, 500000000));
+	expired.clear();
+	wheel.clear(expired);
+	assertTrue (expired.size() == 2);
+	assertTrue (wheel.empty());
+	assertTrue (!e1.isScheduled());
+	assertTrue (!e2.isScheduled());
+}
+
+
+void TimingWheelTest::testReschedule()
+{
+	TimingWheel wheel(1000);
+	Clock start;
+
+	TestEntry e1(1);
+	wheel.schedule(e1, offset(start, 5000));
+	wheel.schedule(e1, offset(start, 15000));
+	assertTrue (wheel.size() == 1);
+
+	TimingWheel::EntryVec expired;
+	wheel.advance(offset(start, 10000), expired);
+	assertTrue (expired.empty());
+	wheel.advance(offset(start, 16000), expired);
+	assertTrue (expired.size() == 1);
+
+	TimingWheel other(1000);
+	wheel.schedule(e1, offset(start, 20000));
+	other.schedule(e1, offset(start, 20000));
+	assertTrue (wheel.empty());
+	assertTrue (other.size() == 1);
+}
+
+
+void TimingWheelTest::testCascade()
+{
+	TimingWheel wheel(1);
+	Clock start;
+
+	const Clock::ClockDiff deadlines[] = {1, 255, 256, 257, 1000, 65535, 65536, 65537, 100000, 16777216, 16777217, 20000000};
+	const int n = sizeof(deadlines)/sizeof(deadlines[0]);
+	TestEntry entries[n];
+	for (int i = 0; i < n; ++i)
+	{
+		wheel.schedule(entries[i], offset(start, deadlines[i]));
+	}
+	assertTrue (wheel.size() == n);
+
+	for (int i = 0; i < n; ++i)
+	{
+		TimingWheel::EntryVec expired;
+		wheel.advance(offset(start, deadlines[i] - 1), expired);
+		assertTrue (expired.empty());
+		wheel.advance(offset(start, deadlines[i]), expired);
+		assertTrue (expired.size() == 1);
+		assertTrue (expired[0] == &entries[i]);
+	}
+	assertTrue (wheel.empty());
+}
+
+
+void TimingWheelTest::testFarFuture()
+{
+	TimingWheel wheel(1);
+	Clock start;
+
+	TestEntry e1(1);
+	TestEntry e2(2);
+	Clock::ClockDiff far = (Clock::ClockDiff(1) << 32) + 12345;
+	wheel.schedule(e1, offset(start, far));
+	wheel.schedule(e2, offset(start, 10));
+
+	TimingWheel::EntryVec expired;
+	wheel.advance(offset(start, 10), expired);
+	assertTrue (expired.size() == 1);
+	expired.clear();
+	wheel.advance(offset(start, far - 1), expired);
+	assertTrue (expired.empty());
+	wheel.advance(offset(start, far), expired);
+	assertTrue (expired.size() == 1);
+	assertTrue (expired[0] == &e1);
+}
+
+
+void TimingWheelTest::testTimeout()
+{
+	TimingWheel wheel(1000);
+	Clock start;
+	assertTrue (wheel.timeout(start) == -1);
+
+	TestEntry e1(1);
+	wheel.schedule(e1, offset(start, 10000));
+	Clock::ClockDiff timeout = wheel.timeout(start);
+	assertTrue (timeout >= 0 && timeout <= 10000);
+
+	TimingWheel::EntryVec expired;
+	Clock now(start);
+	while (expired.empty())
+	{
+		now += wheel.timeout(now);
+		wheel.advance(now, expired);
+	}
+	assertTrue (now - start >= 10000);
+	assertTrue (now - start <= 11000);
+}
+
+
+void TimingWheelTest::setUp()
+{
+}
+
+
+void TimingWheelTest::tearDown()
+{
+}
+
+
+CppUnit::Test* TimingWheelTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("TimingWheelTest");
+
+	CppUnit_addTest(pSuite, TimingWheelTest, testSchedule);
+	CppUnit_addTest(pSuite, TimingWheelTest, testCancel);
+	CppUnit_addTest(pSuite, TimingWheelTest, testReschedule);
+	CppUnit_addTest(pSuite, TimingWheelTest, testCascade);
+	CppUnit_addTest(pSuite, TimingWheelTest, testFarFuture);
+	CppUnit_addTest(pSuite, TimingWheelTest, testTimeout);
+
+	return pSuite;
+}
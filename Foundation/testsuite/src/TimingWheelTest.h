@@ -0,0 +1,41 @@
+//
+// TimingWheelTest.h
+//
+// Definition of the TimingWheelTest class.
+//
+// Copyright (c) 2004-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef TimingWheelTest_INCLUDED
+#define TimingWheelTest_INCLUDED
+
+
+#include "Poco/Foundation.h"
+#include "CppUnit/TestCase.h"
+
+
+class TimingWheelTest: public CppUnit::TestCase
+{
+public:
+	TimingWheelTest(const std::string& name);
+	~TimingWheelTest();
+
+	void testSchedule();
+	void testCancel();
+	void testReschedule();
+	void testCascade();
+	void testFarFuture();
+	void testTimeout();
+
+	void setUp();
+	void tearDown();
+
+	static CppUnit::Test* suite();
+};
+
+
+#endif // TimingWheelTest_INCLUDED
@@ -0,0 +1,134 @@
+//
+// WorkStealingThreadPoolTest.cpp
+//
+// Copyright (c) 2004-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "WorkStealingThreadPoolTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+#include "Poco/WorkStealingThreadPool.h"
+#include "Poco/RunnableAdapter.h"
+#include "Poco/Exception.h"
+
+
+using Poco::WorkStealingThreadPool;
+using Poco::RunnableAdapter;
+
+
+WorkStealingThreadPoolTest::WorkStealingThreadPoolTest(const std::string& name):
+	CppUnit::TestCase(name),
+	_counter(*this, &WorkStealingThreadPoolTest::count)
+{
+}
+
+
+WorkStealingThreadPoolTest::~WorkStealingThreadPoolTest()
+{
+}
+
+
+void WorkStealingThreadPoolTest::testStart()
+{
+	WorkStealingThreadPool pool("test", 4);
+	assertTrue (pool.capacity() == 4);
+	assertTrue (pool.name() == "test");
+	assertTrue (pool.pending() == 0);
+	assertTrue (WorkStealingThreadPool::current() == 0);
+
+	RunnableAdapter<WorkStealingThreadPoolTest> ra(*this, &WorkStealingThreadPoolTest::count);
+	for (int i = 0; i < 10000; ++i)
+	{
+		pool.start(ra);
+	}
+	pool.joinAll();
+	assertTrue (pool.pending() == 0);
+	assertTrue (_count.value() == 10000);
+
+	for (int i = 0; i < 10000; ++i)
+	{
+		pool.start(ra);
+	}
+	pool.joinAll();
+	assertTrue (_count.value() == 20000);
+}
+
+
+void WorkStealingThreadPoolTest::testSpawnFromWorker()
+{
+	WorkStealingThreadPool pool(3);
+	assertTrue (pool.capacity() == 3);
+
+	RunnableAdapter<WorkStealingThreadPoolTest> ra(*this, &WorkStealingThreadPoolTest::spawn);
+	for (int i = 0; i < 10; ++i)
+	{
+		pool.start(ra);
+	}
+	pool.joinAll();
+	assertTrue (_count.value() == 10*1000);
+}
+
+
+void WorkStealingThreadPoolTest::testStop()
+{
+	WorkStealingThreadPool pool(2);
+	RunnableAdapter<WorkStealingThreadPoolTest> ra(*this, &WorkStealingThreadPoolTest::count);
+	pool.start(ra);
+	pool.joinAll();
+	pool.stopAll();
+	assertTrue (pool.capacity() == 0);
+	try
+	{
+		pool.start(ra);
+		failmsg("pool stopped - must throw exception");
+	}
+	catch (Poco::InvalidAccessException&)
+	{
+	}
+	pool.joinAll();
+}
+
+
+void WorkStealingThreadPoolTest::setUp()
+{
+	_count = 0;
+}
+
+
+void WorkStealingThreadPoolTest::tearDown()
+{
+}
+
+
+void WorkStealingThreadPoolTest::count()
+{
+	++_count;
+}
+
+
+void WorkStealingThreadPoolTest::spawn()
+{
+	WorkStealingThreadPool* pPool = WorkStealingThreadPool::current();
+	poco_check_ptr (pPool);
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		pPool->start(_counter);
+	}
+}
+
+
+CppUnit::Test* WorkStealingThreadPoolTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("WorkStealingThreadPoolTest");
+
+	CppUnit_addTest(pSuite, WorkStealingThreadPoolTest, testStart);
+	CppUnit_addTest(pSuite, WorkStealingThreadPoolTest, testSpawnFromWorker);
+	CppUnit_addTest(pSuite, WorkStealingThreadPoolTest, testStop);
+
+	return pSuite;
+}
@@ -0,0 +1,48 @@
+//
+// WorkStealingThreadPoolTest.h
+//
+// Definition of the WorkStealingThreadPoolTest class.
+//
+// Copyright (c) 2004-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef WorkStealingThreadPoolTest_INCLUDED
+#define WorkStealingThreadPoolTest_INCLUDED
+
+
+#include "Poco/Foundation.h"
+#include "CppUnit/TestCase.h"
+#include "Poco/AtomicCounter.h"
+#include "Poco/RunnableAdapter.h"
+
+
+class WorkStealingThreadPoolTest: public CppUnit::TestCase
+{
+public:
+	WorkStealingThreadPoolTest(const std::string& name);
+	~WorkStealingThreadPoolTest();
+
+	void testStart();
+	void testSpawnFromWorker();
+	void testStop();
+
+	void setUp();
+	void tearDown();
+
+	static CppUnit::Test* suite();
+
+protected:
+	void count();
+	void spawn();
+
+private:
+	Poco::AtomicCounter _count;
+	Poco::RunnableAdapter<WorkStealingThreadPoolTest> _counter;
+};
+
+
+#endif // WorkStealingThreadPoolTest_INCLUDED
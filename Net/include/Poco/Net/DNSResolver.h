@@ -0,0 +1,228 @@
+//
+// DNSResolver.h
+//
+// Library: Net
+// Package: NetCore
+// Module:  DNSResolver
+//
+// Definition of the DNSResolver class.
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_DNSResolver_INCLUDED
+#define Net_DNSResolver_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/DNS.h"
+#include "Poco/Net/HostEntry.h"
+#include "Poco/Net/IPAddress.h"
+#include "Poco/ActiveResult.h"
+#include "Poco/NotificationQueue.h"
+#include "Poco/Runnable.h"
+#include "Poco/Thread.h"
+#include "Poco/Mutex.h"
+#include "Poco/Timespan.h"
+#include "Poco/Timestamp.h"
+#include <vector>
+#include <list>
+#include <map>
+
+
+namespace Poco {
+namespace Net {
+
+
+class Net_API DNSResolver: public Poco::Runnable
+	/// DNSResolver resolves host names asynchronously, using a
+	/// fixed number of resolver threads, and caches the results.
+	///
+	/// Lookups are queued and performed by the resolver threads
+	/// with DNS::hostByName(). The result of a lookup is an
+	/// ActiveResult<HostEntry>, which becomes available when the
+	/// lookup has completed. Concurrent lookups of the same host
+	/// name share a single query and the same ActiveResult.
+	/// Host names are compared case-insensitively.
+	///
+	/// Successful lookups are cached for the time-to-live given
+	/// in the constructor. Failed lookups (HostNotFoundException,
+	/// NoAddressFoundException) are cached for the negative
+	/// time-to-live, so that lookups of non-existing hosts do not
+	/// repeatedly wait for the system resolver. Other errors, e.g.
+	/// temporary DNS failures, are not cached. As getaddrinfo() does
+	/// not report the TTLs of DNS records, the cache uses the
+	/// configured time-to-live for all entries; it should be set
+	/// to a value not exceeding the TTLs of the resolved records.
+	///
+	/// The cache holds at most the given number of entries. If it
+	/// is full, the least recently used entry is evicted.
+	///
+	/// IP addresses in numeric notation are resolved immediately,
+	/// without a query and without being cached.
+	///
+	/// Usage example:
+	///     DNSResolver& resolver = DNSResolver::defaultResolver();
+	///     Poco::ActiveResult<HostEntry> result = resolver.hostByNameAsync("www.pocoproject.org");
+	///     // ... do something else ...
+	///     result.wait();
+	///     if (!result.failed())
+	///         SocketAddress address(result.data().addresses()[0], 80);
+	///
+	/// All methods of DNSResolver can be called from any thread.
+{
+public:
+	enum
+	{
+		DEFAULT_THREADS     = 4,
+		DEFAULT_MAX_ENTRIES = 1024
+	};
+
+	DNSResolver();
+		/// Creates a DNSResolver with DEFAULT_THREADS resolver threads,
+		/// a time-to-live of 60 seconds for successful and 5 seconds for
+		/// failed lookups, and at most DEFAULT_MAX_ENTRIES cache entries.
+
+	DNSResolver(int threads, const Poco::Timespan& ttl, const Poco::Timespan& negativeTTL, std::size_t maxEntries = DEFAULT_MAX_ENTRIES);
+		/// Creates a DNSResolver with the given number of resolver threads,
+		/// the given time-to-live for successful and failed lookups, and
+		/// the given maximum number of cache entries.
+
+	virtual ~DNSResolver();
+		/// Stops the resolver threads and destroys the DNSResolver.
+		///
+		/// Queued lookups that have not been started fail with an
+		/// InvalidAccessException.
+
+	Poco::ActiveResult<HostEntry> hostByNameAsync(const std::string& hostname, unsigned hintFlags =
+#ifdef POCO_HAVE_ADDRINFO
+		DNS::DNS_HINT_AI_CANONNAME | DNS::DNS_HINT_AI_ADDRCONFIG
+#else
+		DNS::DNS_HINT_NONE
+#endif
+		);
+		/// Returns the result of a lookup of the given host name,
+		/// which is taken from the cache or queued for the resolver
+		/// threads. The hint flags are passed to DNS::hostByName().
+		///
+		/// If the lookup fails, the exception thrown by DNS::hostByName()
+		/// is stored in the result.
+
+	HostEntry hostByName(const std::string& hostname, unsigned hintFlags =
+#ifdef POCO_HAVE_ADDRINFO
+		DNS::DNS_HINT_AI_CANONNAME | DNS::DNS_HINT_AI_ADDRCONFIG
+#else
+		DNS::DNS_HINT_NONE
+#endif
+		);
+		/// Returns a HostEntry object containing the DNS information
+		/// for the host with the given name, waiting for the lookup
+		/// if the host is not in the cache.
+		///
+		/// Throws the exception that DNS::hostByName() has thrown
+		/// (e.g., a HostNotFoundException) if the lookup has failed.
+
+	IPAddress resolveOne(const std::string& address);
+		/// Convenience method that calls hostByName() and returns
+		/// only the first address.
+
+	void setTTL(const Poco::Timespan& ttl);
+		/// Sets the time-to-live for successful lookups.
+		/// Only affects lookups completed after the call.
+
+	Poco::Timespan getTTL() const;
+		/// Returns the time-to-live for successful lookups.
+
+	void setNegativeTTL(const Poco::Timespan& ttl);
+		/// Sets the time-to-live for failed lookups. A zero
+		/// time-to-live disables negative caching.
+		/// Only affects lookups completed after the call.
+
+	Poco::Timespan getNegativeTTL() const;
+		/// Returns the time-to-live for failed lookups.
+
+	std::size_t size() const;
+		/// Returns the number of cache entries, including
+		/// lookups in progress.
+
+	void purge();
+		/// Removes all expired entries from the cache.
+
+	void clear();
+		/// Removes all completed entries from the cache.
+		/// Lookups in progress are not affected.
+
+	static DNSResolver& defaultResolver();
+		/// Returns a reference to the default DNSResolver,
+		/// which has the default parameters.
+
+protected:
+	virtual HostEntry lookup(const std::string& hostname, unsigned hintFlags);
+		/// Performs a lookup in a resolver thread.
+		///
+		/// The default implementation calls DNS::hostByName().
+		/// Can be overridden by subclasses, e.g. for testing.
+
+	void stop();
+		/// Stops the resolver threads, fails all queued lookups
+		/// with an InvalidAccessException and clears the cache.
+		/// Subsequent lookups throw an InvalidAccessException.
+		///
+		/// Called by the destructor. Subclasses overriding lookup()
+		/// must call stop() in their destructor.
+
+	void run();
+		/// The resolver thread function.
+
+private:
+	DNSResolver(const DNSResolver&);
+	DNSResolver& operator = (const DNSResolver&);
+
+	typedef Poco::ActiveResult<HostEntry> Result;
+
+	struct Entry
+	{
+		Entry(const Result& r, Poco::UInt64 s):
+			result(r),
+			serial(s),
+			pending(true)
+		{
+		}
+
+		Result result;
+		Poco::UInt64 serial;
+		bool pending;
+		Poco::Timestamp expires;
+		std::list<std::string>::iterator lru;
+	};
+
+	typedef std::map<std::string, Entry> EntryMap;
+
+	class LookupNotification;
+	class StopNotification;
+
+	void init(int threads);
+	void complete(const std::string& key, Poco::UInt64 serial, bool succeeded, bool cacheable);
+	void remove(EntryMap::iterator it);
+	static std::string keyFor(const std::string& hostname, unsigned hintFlags);
+
+	Poco::Timespan _ttl;
+	Poco::Timespan _negativeTTL;
+	std::size_t _maxEntries;
+	Poco::UInt64 _serial;
+	EntryMap _entries;
+	std::list<std::string> _lru;
+	Poco::NotificationQueue _queue;
+	std::vector<Poco::Thread*> _threads;
+	mutable Poco::FastMutex _mutex;
+};
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_DNSResolver_INCLUDED
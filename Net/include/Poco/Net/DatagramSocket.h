@@ -210,6 +210,61 @@ public:
 		/// The flags parameter can be used to pass system-defined flags
 		/// for recvfrom() like MSG_PEEK.
 
+	int sendMessages(SocketMessageVec& messages, int flags = 0);
+		/// Sends the given datagrams through the socket,
+		/// using a single sendmmsg() system call for up to
+		/// 64 datagrams on Linux.
+		///
+		/// The pBuffer and bufferLength members of each
+		/// SocketMessage give the payload, and pAddress and
+		/// addressLength the destination, unless the socket
+		/// is connected. If segmentSize is greater than 0, the
+		/// payload is split into multiple datagrams by the kernel
+		/// or network interface (UDP segmentation offload, Linux only).
+		///
+		/// Returns the number of datagrams sent, which may be
+		/// less than messages.size(). The number of bytes sent
+		/// is stored in the length member of each datagram sent.
+		///
+		/// The flags parameter can be used to pass system-defined flags
+		/// for sendmmsg() like MSG_DONTROUTE.
+
+	int receiveMessages(SocketMessageVec& messages, int flags = 0);
+		/// Receives up to messages.size() datagrams from the
+		/// socket, using a single recvmmsg() system call for up
+		/// to 64 datagrams on Linux. The method only waits for the
+		/// first datagram, and also returns the datagrams that
+		/// are available at that time.
+		///
+		/// The pBuffer and bufferLength members of each
+		/// SocketMessage give the buffer receiving the payload.
+		/// If pAddress is not null, the address of the sender is
+		/// stored there, and its length in addressLength, which
+		/// must initially hold the size of the address buffer.
+		/// The number of bytes received is stored in the length member.
+		///
+		/// Returns the number of datagrams received, or 0 if the
+		/// socket is non-blocking and no datagram is available.
+		/// On platforms other than Linux, at most one datagram is received.
+		///
+		/// The flags parameter can be used to pass system-defined flags
+		/// for recvmmsg() like MSG_PEEK.
+
+	void setReceiveOffload(bool flag);
+		/// Enables or disables UDP receive offload (UDP_GRO).
+		///
+		/// If enabled, multiple datagrams from the same sender
+		/// may be coalesced into a single SocketMessage
+		/// by receiveMessages(), which then stores the size of the
+		/// individual datagrams in its segmentSize member. Buffers
+		/// must be large enough for the coalesced datagrams (up to 64 KB).
+		///
+		/// Throws a NotImplementedException if not supported
+		/// by the platform.
+
+	bool getReceiveOffload() const;
+		/// Returns true if UDP receive offload is enabled.
+
 	void setBroadcast(bool flag);
 		/// Sets the value of the SO_BROADCAST socket option.
 		///
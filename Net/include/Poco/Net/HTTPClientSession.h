@@ -357,6 +357,7 @@ private:
 	HTTPClientSession& operator = (const HTTPClientSession&);
 
 	friend class WebSocket;
+	friend class HTTPClientSessionPool;
 };
 
 
@@ -0,0 +1,287 @@
+//
+// HTTPClientSessionPool.h
+//
+// Library: Net
+// Package: HTTPClient
+// Module:  HTTPClientSessionPool
+//
+// Definition of the HTTPClientSessionPool class.
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_HTTPClientSessionPool_INCLUDED
+#define Net_HTTPClientSessionPool_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/HTTPClientSession.h"
+#include "Poco/Net/HTTPSessionFactory.h"
+#include "Poco/URI.h"
+#include "Poco/Mutex.h"
+#include "Poco/Condition.h"
+#include "Poco/Timespan.h"
+#include "Poco/Timestamp.h"
+#include <vector>
+#include <map>
+
+
+namespace Poco {
+namespace Net {
+
+
+class Net_API HTTPClientSessionPool
+	/// A pool of persistent (keep-alive) HTTPClientSession objects.
+	///
+	/// Sessions are created by a HTTPSessionFactory, and are
+	/// kept separately for every combination of URI scheme,
+	/// host, port and proxy. A session taken from the pool with
+	/// get() is returned to the pool when the PooledSession
+	/// object holding it is destroyed, and can then be used for
+	/// further requests to the same server, without establishing
+	/// a new connection.
+	///
+	/// Usage example:
+	///     HTTPClientSessionPool pool;
+	///     Poco::URI uri("http://www.appinf.com/index.html");
+	///     HTTPClientSessionPool::PooledSession pSession = pool.get(uri);
+	///     HTTPRequest request(HTTPRequest::HTTP_GET, uri.getPathEtc(), HTTPMessage::HTTP_1_1);
+	///     pSession->sendRequest(request);
+	///     HTTPResponse response;
+	///     std::istream& rs = pSession->receiveResponse(response);
+	///     StreamCopier::copyStream(rs, ostr);
+	///
+	/// The response body must be read completely before a session
+	/// is returned to the pool.
+	///
+	/// The number of sessions (in use and idle) per server is
+	/// limited. If all sessions for a server are in use, get()
+	/// waits until a session is returned to the pool.
+	///
+	/// Idle sessions are closed and removed from the pool after
+	/// the idle timeout has expired. This is done whenever a session
+	/// is taken from or returned to the pool, and by purge().
+	///
+	/// Before an idle session is handed out, its connection is
+	/// checked. If the server has closed the connection, or has
+	/// sent unexpected data, the connection is closed, and the
+	/// HTTPClientSession will connect again when sending the next
+	/// request. The existing keep-alive logic of HTTPClientSession
+	/// (the keep-alive timeout and the server's Connection header)
+	/// also remains in effect. The HTTPClientSession objects are
+	/// kept even if their connection is closed, so that a
+	/// HTTPSClientSession can resume its TLS session when
+	/// reconnecting.
+	///
+	/// The pool must outlive all sessions taken from it.
+	///
+	/// HTTPClientSessionPool is safe for use by multiple threads.
+{
+public:
+	class Net_API PooledSession
+		/// Holds a HTTPClientSession taken from a HTTPClientSessionPool,
+		/// and returns it to the pool when destroyed.
+	{
+	public:
+		PooledSession();
+			/// Creates an empty PooledSession.
+
+		PooledSession(PooledSession&& other) noexcept;
+			/// Takes over the session from other.
+
+		~PooledSession();
+			/// Returns the session to the pool.
+
+		PooledSession& operator = (PooledSession&& other) noexcept;
+			/// Returns the current session to the pool and
+			/// takes over the session from other.
+
+		HTTPClientSession* operator -> () const;
+			/// Returns a pointer to the session.
+
+		HTTPClientSession& operator * () const;
+			/// Returns a reference to the session.
+
+		HTTPClientSession* get() const;
+			/// Returns a pointer to the session, or null
+			/// if the PooledSession is empty.
+
+		bool isNull() const;
+			/// Returns true if the PooledSession is empty.
+
+		void release();
+			/// Returns the session to the pool.
+
+	private:
+		PooledSession(HTTPClientSessionPool* pPool, const std::string& key, HTTPClientSession* pSession);
+		PooledSession(const PooledSession&);
+		PooledSession& operator = (const PooledSession&);
+
+		HTTPClientSessionPool* _pPool;
+		std::string _key;
+		HTTPClientSession* _pSession;
+
+		friend class HTTPClientSessionPool;
+	};
+
+	enum
+	{
+		DEFAULT_MAX_PER_HOST = 8
+	};
+
+	explicit HTTPClientSessionPool(std::size_t maxPerHost = DEFAULT_MAX_PER_HOST, const Poco::Timespan& idleTimeout = Poco::Timespan(60, 0));
+		/// Creates the HTTPClientSessionPool, using the default
+		/// HTTPSessionFactory.
+		///
+		/// At most maxPerHost sessions are created for every
+		/// server. Idle sessions are closed after idleTimeout.
+
+	HTTPClientSessionPool(HTTPSessionFactory& factory, std::size_t maxPerHost = DEFAULT_MAX_PER_HOST, const Poco::Timespan& idleTimeout = Poco::Timespan(60, 0));
+		/// Creates the HTTPClientSessionPool, using the given
+		/// HTTPSessionFactory, which must outlive the pool.
+		///
+		/// At most maxPerHost sessions are created for every
+		/// server. Idle sessions are closed after idleTimeout.
+
+	~HTTPClientSessionPool();
+		/// Destroys the HTTPClientSessionPool and all idle sessions.
+
+	PooledSession get(const Poco::URI& uri);
+		/// Returns a session for the server given in uri,
+		/// taken from the pool if possible. Otherwise, a new
+		/// session is created if the limit for the server has
+		/// not been reached yet, or the method waits until a
+		/// session is returned to the pool.
+		///
+		/// Throws a TimeoutException if no session becomes
+		/// available within the wait timeout, and an
+		/// InvalidAccessException if the pool has been shut down.
+
+	void setWaitTimeout(const Poco::Timespan& timeout);
+		/// Sets the maximum time get() waits for a session.
+
+	Poco::Timespan getWaitTimeout() const;
+		/// Returns the maximum time get() waits for a session.
+
+	std::size_t maxPerHost() const;
+		/// Returns the maximum number of sessions per server.
+
+	Poco::Timespan idleTimeout() const;
+		/// Returns the time after which idle sessions are closed.
+
+	std::size_t used() const;
+		/// Returns the number of sessions currently in use.
+
+	std::size_t idle() const;
+		/// Returns the number of idle sessions in the pool.
+
+	void purge();
+		/// Closes and removes all idle sessions whose
+		/// idle timeout has expired.
+
+	void shutdown();
+		/// Closes and removes all idle sessions. Sessions currently
+		/// in use are deleted when they are returned to the pool.
+		/// Afterwards, get() can no longer be called.
+
+protected:
+	void putBack(const std::string& key, HTTPClientSession* pSession);
+		/// Returns a session to the pool.
+
+	std::string keyFor(const Poco::URI& uri) const;
+		/// Returns the key of the server given in uri.
+
+	static bool isReusable(HTTPClientSession& session);
+		/// Returns true if the connection of the given idle
+		/// session can still be used for another request.
+
+private:
+	HTTPClientSessionPool(const HTTPClientSessionPool&);
+	HTTPClientSessionPool& operator = (const HTTPClientSessionPool&);
+
+	struct IdleSession
+	{
+		HTTPClientSession* pSession;
+		Poco::Timestamp    lastUsed;
+	};
+
+	typedef std::vector<IdleSession> IdleVec;
+
+	struct HostPool
+	{
+		HostPool(): used(0)
+		{
+		}
+
+		IdleVec     idle;
+		std::size_t used;
+	};
+
+	typedef std::map<std::string, HostPool> HostMap;
+
+	void purge(HostPool& host, const Poco::Timestamp& now);
+
+	HTTPSessionFactory& _factory;
+	std::size_t         _maxPerHost;
+	Poco::Timespan      _idleTimeout;
+	Poco::Timespan      _waitTimeout;
+	HostMap             _hosts;
+	std::size_t         _used;
+	std::size_t         _idle;
+	bool                _shutdown;
+	Poco::Condition     _available;
+	mutable Poco::FastMutex _mutex;
+};
+
+
+//
+// inlines
+//
+inline HTTPClientSession* HTTPClientSessionPool::PooledSession::operator -> () const
+{
+	poco_check_ptr (_pSession);
+
+	return _pSession;
+}
+
+
+inline HTTPClientSession& HTTPClientSessionPool::PooledSession::operator * () const
+{
+	poco_check_ptr (_pSession);
+
+	return *_pSession;
+}
+
+
+inline HTTPClientSession* HTTPClientSessionPool::PooledSession::get() const
+{
+	return _pSession;
+}
+
+
+inline bool HTTPClientSessionPool::PooledSession::isNull() const
+{
+	return _pSession == 0;
+}
+
+
+inline std::size_t HTTPClientSessionPool::maxPerHost() const
+{
+	return _maxPerHost;
+}
+
+
+inline Poco::Timespan HTTPClientSessionPool::idleTimeout() const
+{
+	return _idleTimeout;
+}
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_HTTPClientSessionPool_INCLUDED
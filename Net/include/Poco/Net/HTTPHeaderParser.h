@@ -0,0 +1,210 @@
+//
+// HTTPHeaderParser.h
+//
+// Library: Net
+// Package: HTTP
+// Module:  HTTPHeaderParser
+//
+// Definition of the HTTPHeaderParser class.
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_HTTPHeaderParser_INCLUDED
+#define Net_HTTPHeaderParser_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include <vector>
+#include <string>
+#include <cstddef>
+
+
+namespace Poco {
+namespace Net {
+
+
+class Net_API HTTPHeaderParser
+	/// A fast parser for HTTP message headers that are available
+	/// in a contiguous buffer, such as the receive buffer of
+	/// a HTTPSession.
+	///
+	/// The parser scans the complete header block (start line,
+	/// header fields and the terminating empty line) for line
+	/// delimiters, using SSE2 instructions where available.
+	/// Instead of copying the header into strings, the parser
+	/// only records the positions of the start line tokens and
+	/// of the names and values of all header fields as Slice
+	/// objects, which refer into the parsed buffer. The slices
+	/// are only valid as long as the buffer is.
+	///
+	/// HTTPRequest::read() and HTTPResponse::read() use the parser
+	/// to read the header directly from the session buffer, and
+	/// only then create strings for the slices.
+	///
+	/// The parser is deliberately strict. Headers that it does not
+	/// handle in exactly the same way as MessageHeader::read(),
+	/// such as headers with folded field values, fields exceeding the
+	/// length limits or more fields than the field limit, are
+	/// reported as HEADER_UNSUPPORTED, and must be read with
+	/// HTTPRequest::read(std::istream&) or
+	/// HTTPResponse::read(std::istream&) instead.
+{
+public:
+	class Slice
+		/// A reference to a range of characters in a buffer.
+	{
+	public:
+		Slice():
+			_pBegin(0),
+			_length(0)
+		{
+		}
+
+		Slice(const char* pBegin, std::size_t length):
+			_pBegin(pBegin),
+			_length(length)
+		{
+		}
+
+		const char* data() const
+			/// Returns a pointer to the first character.
+		{
+			return _pBegin;
+		}
+
+		std::size_t size() const
+			/// Returns the number of characters.
+		{
+			return _length;
+		}
+
+		bool empty() const
+			/// Returns true if the slice is empty.
+		{
+			return _length == 0;
+		}
+
+		std::string str() const
+			/// Returns a copy of the characters as std::string.
+		{
+			return std::string(_pBegin, _length);
+		}
+
+	private:
+		const char* _pBegin;
+		std::size_t _length;
+	};
+
+	struct Field
+		/// Name and value of a header field.
+	{
+		Slice name;
+		Slice value;
+	};
+
+	typedef std::vector<Field> FieldVec;
+
+	enum Result
+	{
+		HEADER_COMPLETE,    /// The header has been parsed.
+		HEADER_INCOMPLETE,  /// The buffer does not contain the complete header.
+		HEADER_UNSUPPORTED  /// The header must be read with MessageHeader::read().
+	};
+
+	enum Limits
+	{
+		MAX_NAME_LENGTH  = 256,
+		MAX_VALUE_LENGTH = 8192
+	};
+
+	explicit HTTPHeaderParser(int fieldLimit = 0, bool fullStartLine = false);
+		/// Creates the HTTPHeaderParser.
+		///
+		/// If fieldLimit is greater than 0, headers with more
+		/// than fieldLimit fields are reported as HEADER_UNSUPPORTED.
+		///
+		/// If fullStartLine is true, a start line with an empty
+		/// third token is reported as HEADER_UNSUPPORTED. This is
+		/// used for requests, as HTTPRequest::read(std::istream&)
+		/// takes a missing version from the following line.
+
+	~HTTPHeaderParser();
+		/// Destroys the HTTPHeaderParser.
+
+	Result parse(const char* begin, const char* end);
+		/// Parses the header contained in the buffer given by begin
+		/// and end. Whitespace preceding the start line is skipped.
+		///
+		/// The start line is split into three tokens. The first
+		/// and second token are delimited by whitespace, the third
+		/// token is the remainder of the line.
+		///
+		/// If the result is HEADER_COMPLETE, length() returns the
+		/// size of the header, including the empty line terminating it.
+		/// Otherwise, the state of the parser is unspecified.
+
+	const Slice& token(int index) const;
+		/// Returns the start line token with the given index (0 - 2).
+		///
+		/// For a request, these are method, URI and version.
+		/// For a response, these are version, status and reason.
+
+	const FieldVec& fields() const;
+		/// Returns the header fields, in the order they
+		/// appear in the header.
+
+	std::size_t length() const;
+		/// Returns the number of bytes consumed by the
+		/// last successful call to parse().
+
+	void reset();
+		/// Clears the parser state.
+
+	static const char* findLineEnd(const char* begin, const char* end);
+		/// Returns a pointer to the first CR or LF character in the
+		/// given range, or end if there is none.
+
+private:
+	HTTPHeaderParser(const HTTPHeaderParser&);
+	HTTPHeaderParser& operator = (const HTTPHeaderParser&);
+
+	int         _fieldLimit;
+	bool        _fullStartLine;
+	Slice       _tokens[3];
+	FieldVec    _fields;
+	std::size_t _length;
+};
+
+
+//
+// inlines
+//
+inline const HTTPHeaderParser::Slice& HTTPHeaderParser::token(int index) const
+{
+	poco_assert (index >= 0 && index < 3);
+
+	return _tokens[index];
+}
+
+
+inline const HTTPHeaderParser::FieldVec& HTTPHeaderParser::fields() const
+{
+	return _fields;
+}
+
+
+inline std::size_t HTTPHeaderParser::length() const
+{
+	return _length;
+}
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_HTTPHeaderParser_INCLUDED
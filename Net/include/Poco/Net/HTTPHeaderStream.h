@@ -31,6 +31,7 @@ namespace Net {
 
 
 class HTTPSession;
+class HTTPHeaderParser;
 
 
 class Net_API HTTPHeaderStreamBuf: public HTTPBasicStreamBuf
@@ -42,6 +43,21 @@ public:
 
 	HTTPHeaderStreamBuf(HTTPSession& session, openmode mode);
 	~HTTPHeaderStreamBuf();
+
+	bool readHeader(HTTPHeaderParser& parser);
+		/// Parses the complete header directly from the buffer of
+		/// the session, using the given HTTPHeaderParser, receiving
+		/// more data as necessary.
+		///
+		/// Returns true and consumes the header if successful.
+		/// The slices of the parser remain valid until data is
+		/// read from the session again.
+		///
+		/// Returns false if nothing has been read from the stream,
+		/// and the header is larger than the session buffer, not
+		/// supported by the parser or incomplete due to end of file.
+		/// In this case nothing is consumed, and the header must be
+		/// read from the stream.
 	
 protected:
 	int readFromDevice(char* buffer, std::streamsize length);
@@ -27,6 +27,7 @@ namespace Net {
 
 
 class MediaType;
+class HTTPHeaderParser;
 
 
 class Net_API HTTPMessage: public MessageHeader
@@ -163,6 +164,10 @@ protected:
 	virtual ~HTTPMessage();
 		/// Destroys the HTTPMessage.
 
+	void addFields(const HTTPHeaderParser& parser);
+		/// Adds all header fields parsed by the given HTTPHeaderParser.
+		/// Field values are decoded as in MessageHeader::read().
+
 private:
 	std::string _version;
 };
@@ -0,0 +1,239 @@
+//
+// HTTPReactorServer.h
+//
+// Library: Net
+// Package: HTTPServer
+// Module:  HTTPReactorServer
+//
+// Definition of the HTTPReactorServer class.
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_HTTPReactorServer_INCLUDED
+#define Net_HTTPReactorServer_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/ServerSocket.h"
+#include "Poco/Net/SocketNotification.h"
+#include "Poco/Net/HTTPRequestHandlerFactory.h"
+#include "Poco/Net/HTTPServerParams.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/TimingWheel.h"
+#include "Poco/NotificationQueue.h"
+#include "Poco/ThreadPool.h"
+#include "Poco/Thread.h"
+#include "Poco/Runnable.h"
+#include "Poco/Mutex.h"
+#include "Poco/Event.h"
+#include "Poco/AutoPtr.h"
+#include "Poco/Buffer.h"
+#include <atomic>
+#include <map>
+
+
+namespace Poco {
+namespace Net {
+
+
+class HTTPServerSession;
+class HTTPReactorServerConnection;
+class HTTPReactorServerReactor;
+
+
+class Net_API HTTPReactorServer: protected Poco::Runnable
+	/// An event-driven HTTP server.
+	///
+	/// HTTPReactorServer serves the same HTTPRequestHandlerFactory
+	/// and HTTPRequestHandler classes as HTTPServer, but handles
+	/// persistent connections differently. HTTPServer dedicates a
+	/// thread to a connection for the entire lifetime of the
+	/// connection, including the time the connection is idle
+	/// between requests. HTTPReactorServer instead monitors all
+	/// idle connections with a single SocketReactor thread, which
+	/// also reads incoming request headers. Only when a complete
+	/// request header has been received, the connection is handed
+	/// over to a worker thread, which creates the request handler,
+	/// handles the request and sends the response. Afterwards the
+	/// connection is given back to the reactor.
+	///
+	/// This allows a server to keep a large number of mostly
+	/// idle persistent connections open with a small number
+	/// of threads.
+	///
+	/// Request handlers can read request bodies and write responses
+	/// just as with HTTPServer, using blocking I/O. Since a worker
+	/// thread is busy until the request handler returns, long-running
+	/// requests still occupy a worker thread each.
+	///
+	/// The number of worker threads is given by the maxThreads
+	/// parameter of the HTTPServerParams. If maxThreads is 0, the
+	/// capacity of the thread pool is used. Worker threads are taken
+	/// from the thread pool when the server is started, and returned
+	/// when the server is stopped.
+	///
+	/// The timeout parameter of the HTTPServerParams limits the
+	/// time for receiving the header of the first request on a new
+	/// connection, the keepAliveTimeout parameter limits the time
+	/// for receiving the header of a subsequent request. Connections
+	/// exceeding these limits are closed. Request headers larger
+	/// than HTTPBufferAllocator::BUFFER_SIZE bytes are partially
+	/// read by the worker thread.
+	///
+	/// The maxQueued parameter of the HTTPServerParams is
+	/// not used by HTTPReactorServer.
+{
+public:
+	HTTPReactorServer(HTTPRequestHandlerFactory::Ptr pFactory, const ServerSocket& socket, HTTPServerParams::Ptr pParams);
+		/// Creates the HTTPReactorServer, using the given ServerSocket.
+		///
+		/// The server takes ownership of the HTTPRequstHandlerFactory
+		/// and deletes it when it's no longer needed.
+		///
+		/// The server also takes ownership of the HTTPServerParams object.
+		///
+		/// Worker threads are taken from the default thread pool.
+
+	HTTPReactorServer(HTTPRequestHandlerFactory::Ptr pFactory, Poco::ThreadPool& threadPool, const ServerSocket& socket, HTTPServerParams::Ptr pParams);
+		/// Creates the HTTPReactorServer, using the given ServerSocket.
+		///
+		/// The server takes ownership of the HTTPRequstHandlerFactory
+		/// and deletes it when it's no longer needed.
+		///
+		/// The server also takes ownership of the HTTPServerParams object.
+		///
+		/// Worker threads are taken from the given thread pool.
+
+	~HTTPReactorServer();
+		/// Stops and destroys the HTTPReactorServer.
+
+	void start();
+		/// Starts the server. The reactor thread and
+		/// the worker threads are started.
+		///
+		/// Throws a NoThreadAvailableException if the
+		/// thread pool has no threads available.
+
+	void stop();
+		/// Stops the server.
+		///
+		/// No new connections are accepted, and all idle
+		/// connections are closed. Requests currently being
+		/// handled are allowed to complete, after which their
+		/// connections are closed as well. Waits until all worker
+		/// threads have finished.
+
+	void stopAll(bool abortCurrent = false);
+		/// Stops the server. In contrast to stop(), this allows
+		/// finer control over client connections.
+		///
+		/// If abortCurrent is false, all current requests are allowed to
+		/// complete. If abortCurrent is true, the underlying sockets of
+		/// all client connections are shut down, causing all requests
+		/// to abort.
+
+	Poco::UInt16 port() const;
+		/// Returns the port the server socket listens on.
+
+	const HTTPServerParams& params() const;
+		/// Returns a const reference to the HTTPServerParams object
+		/// used by the server.
+
+	int currentConnections() const;
+		/// Returns the number of currently open connections.
+
+	int idleConnections() const;
+		/// Returns the number of open connections that are
+		/// currently not handled by a worker thread.
+
+	int totalConnections() const;
+		/// Returns the total number of connections accepted
+		/// by the server.
+
+	int currentThreads() const;
+		/// Returns the number of worker threads.
+
+protected:
+	void run();
+		/// Runs a worker thread.
+
+	void onAccept(ReadableNotification* pNotification);
+		/// Accepts a new connection and gives it to the reactor.
+
+	void onTick();
+		/// Closes all idle connections whose timeout has expired.
+		/// Called by the reactor thread in every iteration.
+
+	void park(HTTPReactorServerConnection* pConnection, const Poco::Timespan& timeout);
+		/// Gives the connection to the reactor, which reads the
+		/// next request header, or closes the connection if
+		/// the header is not received within the given timeout.
+
+	void dispatch(HTTPReactorServerConnection* pConnection);
+		/// Takes the connection from the reactor and
+		/// gives it to a worker thread.
+
+	void close(HTTPReactorServerConnection* pConnection);
+		/// Closes the connection.
+
+	void handleConnection(HTTPReactorServerConnection* pConnection, Poco::Buffer<char>& buffer);
+		/// Handles all complete requests received on the
+		/// connection, then parks or closes the connection.
+
+	bool handleRequest(HTTPServerSession& session, HTTPReactorServerConnection& connection);
+		/// Handles a single request. Returns true if the
+		/// connection should be kept alive.
+
+	void sendErrorResponse(HTTPServerSession& session, HTTPResponse::HTTPStatus status);
+		/// Sends an error response with the given status
+		/// and closes the connection.
+
+private:
+	HTTPReactorServer();
+	HTTPReactorServer(const HTTPReactorServer&);
+	HTTPReactorServer& operator = (const HTTPReactorServer&);
+
+	typedef Poco::AutoPtr<HTTPReactorServerConnection> ConnectionPtr;
+	typedef std::map<HTTPReactorServerConnection*, ConnectionPtr> ConnectionMap;
+
+	HTTPRequestHandlerFactory::Ptr _pFactory;
+	HTTPServerParams::Ptr          _pParams;
+	ServerSocket                   _socket;
+	Poco::ThreadPool&              _threadPool;
+	HTTPReactorServerReactor*      _pReactor;
+	Poco::Thread                   _reactorThread;
+	Poco::NotificationQueue        _queue;
+	Poco::TimingWheel              _timeouts;
+	ConnectionMap                  _connections;
+	int                            _idleConnections;
+	int                            _totalConnections;
+	int                            _threads;
+	std::atomic<int>               _activeThreads;
+	Poco::Event                    _threadsDone;
+	bool                           _started;
+	std::atomic<bool>              _stopped;
+	mutable Poco::FastMutex        _mutex;
+
+	friend class HTTPReactorServerConnection;
+	friend class HTTPReactorServerReactor;
+};
+
+
+//
+// inlines
+//
+inline const HTTPServerParams& HTTPReactorServer::params() const
+{
+	return *_pParams;
+}
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_HTTPReactorServer_INCLUDED
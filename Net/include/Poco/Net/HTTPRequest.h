@@ -145,6 +145,15 @@ public:
 	void read(std::istream& istr);
 		/// Reads the HTTP request from the
 		/// given input stream.
+		///
+		/// If the stream is a HTTPHeaderInputStream, the header is
+		/// parsed directly from the session buffer with a
+		/// HTTPHeaderParser, if possible.
+
+	void read(const HTTPHeaderParser& parser);
+		/// Reads the HTTP request from the given
+		/// HTTPHeaderParser, which must have successfully
+		/// parsed a request header.
 
 	static const std::string HTTP_GET;
 	static const std::string HTTP_HEAD;
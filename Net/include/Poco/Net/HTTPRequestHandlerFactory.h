@@ -68,6 +68,7 @@ private:
 	HTTPRequestHandlerFactory& operator = (const HTTPRequestHandlerFactory&);
 	
 	friend class HTTPServer;
+	friend class HTTPReactorServer;
 	friend class HTTPServerConnection;
 };
 
@@ -193,6 +193,15 @@ public:
 		/// given input stream.
 		///
 		/// 100 Continue responses are ignored.
+		///
+		/// If the stream is a HTTPHeaderInputStream, the header is
+		/// parsed directly from the session buffer with a
+		/// HTTPHeaderParser, if possible.
+
+	void read(const HTTPHeaderParser& parser);
+		/// Reads the HTTP response from the given
+		/// HTTPHeaderParser, which must have successfully
+		/// parsed a response header.
 
 	static const std::string& getReasonForStatus(HTTPStatus status);
 		/// Returns an appropriate reason phrase
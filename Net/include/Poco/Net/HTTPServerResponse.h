@@ -75,6 +75,23 @@ public:
 		/// Throws a FileNotFoundException if the file
 		/// cannot be found, or an OpenFileException if
 		/// the file cannot be opened.
+
+	void sendFile(const std::string& path, const std::string& mediaType, Poco::UInt64 offset, Poco::UInt64 length);
+		/// Sends a 206 (Partial Content) response header to the
+		/// client, with a Content-Range header field for the given
+		/// range, followed by length bytes of the given file,
+		/// starting at offset. This can be used to answer requests
+		/// containing a Range header field.
+		///
+		/// The header and the range are sent with sendFileContent().
+		///
+		/// Must not be called after send(), sendBuffer()
+		/// or redirect() has been called.
+		///
+		/// Throws a FileNotFoundException if the file
+		/// cannot be found, an OpenFileException if
+		/// the file cannot be opened, or a RangeException
+		/// if length is 0 or the range exceeds the file.
 		
 	virtual void sendBuffer(const void* pBuffer, std::size_t length) = 0;
 		/// Sends the response header to the client, followed
@@ -107,6 +124,18 @@ public:
 		
 	virtual bool sent() const = 0;
 		/// Returns true if the response (header) has been sent.
+
+protected:
+	virtual void sendFileContent(const std::string& path, Poco::UInt64 offset, Poco::UInt64 length);
+		/// Sends the response header to the client, followed
+		/// by length bytes of the given file, starting at offset.
+		/// Called by sendFile() after the header fields have been set.
+		///
+		/// The default implementation copies the range to the
+		/// stream returned by send(). Subclasses can override it
+		/// to send the file more efficiently.
+		///
+		/// Throws an OpenFileException if the file cannot be opened.
 };
 
 
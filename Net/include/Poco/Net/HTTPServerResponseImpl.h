@@ -67,12 +67,18 @@ public:
 		/// Sends the response header to the client, followed
 		/// by the content of the given file.
 		///
+		/// The file content is sent with StreamSocket::sendFile(),
+		/// which avoids copying the content through user space
+		/// on platforms supporting it.
+		///
 		/// Must not be called after send(), sendBuffer() 
 		/// or redirect() has been called.
 		///
 		/// Throws a FileNotFoundException if the file
 		/// cannot be found, or an OpenFileException if
 		/// the file cannot be opened.
+
+	using HTTPServerResponse::sendFile;
 		
 	void sendBuffer(const void* pBuffer, std::size_t length);
 		/// Sends the response header to the client, followed
@@ -108,6 +114,9 @@ public:
 
 protected:
 	void attachRequest(HTTPServerRequestImpl* pRequest);
+	void sendFileContent(const std::string& path, Poco::UInt64 offset, Poco::UInt64 length);
+		/// Sends the range with StreamSocket::sendFile().
+		/// Throws an IOException if not all of it can be sent.
 	
 private:
 	HTTPServerSession& _session;
@@ -111,6 +111,17 @@ public:
 		/// obtain any data already read from the socket, but not
 		/// yet processed.
 
+	void fillBuffer(const char* buffer, std::size_t length);
+		/// Copies the given bytes to the internal buffer, where they
+		/// will be read before any further data from the socket.
+		///
+		/// This is the counterpart to drainBuffer(). It is usually
+		/// used to hand data that has already been read from the
+		/// socket by someone else over to the session.
+		///
+		/// The internal buffer must be empty, and length must not
+		/// exceed HTTPBufferAllocator::BUFFER_SIZE.
+
 protected:
 	HTTPSession();
 		/// Creates a HTTP session using an
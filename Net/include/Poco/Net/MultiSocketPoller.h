@@ -75,12 +75,9 @@ public:
 	void poll()
 	{
 		if (_reader.handlerStopped()) return;
-		PollSet::SocketModeMap sm;
-		PollSet::SocketModeMap::iterator it;
-		PollSet::SocketModeMap::iterator end;
-		sm = _pollSet.poll(_timeout);
-		it = sm.begin();
-		end = sm.end();
+		_pollSet.poll(_timeout, _events);
+		PollSet::SocketModeList::iterator it = _events.begin();
+		PollSet::SocketModeList::iterator end = _events.end();
 		for (; it != end; ++it)
 		{
 			if (it->second & PollSet::POLL_READ)
@@ -93,6 +90,7 @@ public:
 				_reader.setError(it->first.impl()->sockfd());
 			}
 		}
+		_events.clear();
 	}
 
 	void stop()
@@ -115,10 +113,11 @@ private:
 		}
 	}
 
-	PollSet            _pollSet;
-	SocketAddress      _address;
-	Poco::Timespan     _timeout;
-	UDPSocketReader<S> _reader;
+	PollSet                 _pollSet;
+	PollSet::SocketModeList _events;
+	SocketAddress           _address;
+	Poco::Timespan          _timeout;
+	UDPSocketReader<S>      _reader;
 };
 
 
@@ -21,6 +21,7 @@
 #include "Poco/Net/Net.h"
 #include "Poco/String.h"
 #include "Poco/ListMap.h"
+#include <vector>
 #include <cstddef>
 
 
@@ -36,6 +37,18 @@ class Net_API NameValueCollection
 	///
 	/// There can be more than one name-value pair with the 
 	/// same name.
+	///
+	/// The name-value pairs are kept in a flat vector, in
+	/// insertion order, with all pairs with the same name
+	/// grouped together. For every name, a case-insensitive
+	/// hash value is computed once when the pair is added,
+	/// and kept in a separate vector. Looking up a name
+	/// compares the hash value of the name with these hash
+	/// values first, so that a case-insensitive string
+	/// comparison is only done for matching hash values.
+	/// With the small number of name-value pairs typically
+	/// found in Internet messages, this is faster than
+	/// a tree or hash table.
 {
 public:
 	using HeaderMap = Poco::ListMap<std::string, std::string>;
@@ -73,6 +86,10 @@ public:
 		
 	void add(const std::string& name, const std::string& value);
 		/// Adds a new name-value pair with the given name and value.
+
+	void add(std::string&& name, std::string&& value);
+		/// Adds a new name-value pair with the given name and value,
+		/// taking over the given strings.
 		
 	const std::string& get(const std::string& name) const;
 		/// Returns the value of the first name-value pair with the given name.
@@ -112,8 +129,24 @@ public:
 	void clear();
 		/// Removes all name-value pairs and their values.
 
+	static Poco::UInt32 hash(const std::string& name);
+		/// Returns the case-insensitive hash value of the given name.
+
 private:
-	HeaderMap _map;
+	enum
+	{
+		INITIAL_RESERVE = 16
+	};
+
+	using Container = std::vector<HeaderMap::ValueType>;
+	using HashVec = std::vector<Poco::UInt32>;
+
+	std::size_t indexOf(const std::string& name) const;
+	std::size_t indexOf(const std::string& name, Poco::UInt32 h) const;
+	void insert(Poco::UInt32 h, HeaderMap::ValueType&& value);
+
+	Container _entries;
+	HashVec   _hashes;
 };
 
 
@@ -19,6 +19,7 @@
 
 
 #include "Poco/Net/ParallelSocketReactor.h"
+#include "Poco/Net/SocketReactorBalancer.h"
 #include "Poco/Net/StreamSocket.h"
 #include "Poco/Net/ServerSocket.h"
 #include "Poco/Environment.h"
@@ -51,6 +52,12 @@ class ParallelSocketAcceptor
 	/// by event handler. See ParallelSocketAcceptor::onAccept and 
 	/// ParallelSocketAcceptor::createServiceHandler documentation and implementation for 
 	/// details.
+	///
+	/// Instead of rotating the reactors, new connections can be assigned
+	/// by a SocketReactorBalancer, for example to the reactor with the
+	/// fewest sockets (LeastConnectionsBalancer), the reactor with the
+	/// lowest recent load (LeastLoadBalancer), or to a reactor determined
+	/// by the peer address (PeerHashBalancer). See setBalancer().
 {
 public:
 	using ParallelReactor = Poco::Net::ParallelSocketReactor<SR>;
@@ -99,6 +106,23 @@ public:
 		}
 	}
 
+	void setBalancer(const SocketReactorBalancer::Ptr& pBalancer)
+		/// Sets the SocketReactorBalancer used to select the
+		/// reactor for new connections. If a null pointer is
+		/// given, reactors are rotated in round-robin fashion.
+		///
+		/// Should be set before the acceptor starts
+		/// accepting connections.
+	{
+		_pBalancer = pBalancer;
+	}
+
+	SocketReactorBalancer::Ptr getBalancer() const
+		/// Returns the SocketReactorBalancer, which may be null.
+	{
+		return _pBalancer;
+	}
+
 	void setReactor(SocketReactor& reactor)
 		/// Sets the reactor for this acceptor.
 	{
@@ -152,17 +176,25 @@ protected:
 		/// Create and initialize a new ServiceHandler instance.
 		/// If socket is already registered with a reactor, the new
 		/// ServiceHandler instance is given that reactor; otherwise,
-		/// the next reactor is used. Reactors are rotated in round-robin
-		/// fashion.
+		/// the reactor selected by the SocketReactorBalancer is used.
+		/// If no SocketReactorBalancer has been set, reactors are rotated
+		/// in round-robin fashion.
 		///
 		/// Subclasses can override this method.
 	{
 		SocketReactor* pReactor = reactor(socket);
 		if (!pReactor)
 		{
-			std::size_t next = _next++;
-			if (_next == _reactors.size()) _next = 0;
-			pReactor = _reactors[next];
+			if (_pBalancer)
+			{
+				pReactor = _reactorPtrs.at(_pBalancer->select(_reactorPtrs, socket));
+			}
+			else
+			{
+				std::size_t next = _next++;
+				if (_next == _reactors.size()) _next = 0;
+				pReactor = _reactors[next];
+			}
 		}
 		pReactor->wakeUp();
 		return new ServiceHandler(socket, *pReactor);
@@ -202,7 +234,10 @@ protected:
 		poco_assert (_threads > 0);
 
 		for (unsigned i = 0; i < _threads; ++i)
+		{
 			_reactors.push_back(new ParallelReactor);
+			_reactorPtrs.push_back(_reactors.back().get());
+		}
 	}
 
 	ReactorVec& reactors()
@@ -232,6 +267,8 @@ private:
 	SocketReactor* _pReactor;
 	unsigned       _threads;
 	ReactorVec     _reactors;
+	SocketReactorBalancer::ReactorVec _reactorPtrs;
+	SocketReactorBalancer::Ptr _pBalancer;
 	std::size_t    _next;
 };
 
@@ -20,6 +20,8 @@
 
 #include "Poco/Net/Socket.h"
 #include <map>
+#include <vector>
+#include <utility>
 
 
 namespace Poco {
@@ -35,16 +37,40 @@ class Net_API PollSet
 	/// If supported, PollSet is implemented using epoll (Linux) or
 	/// poll (BSD) APIs. A fallback implementation using select()
 	/// is also provided.
+	///
+	/// On Linux 5.11 or newer, PollSet can alternatively be implemented
+	/// using io_uring, by defining POCO_HAVE_FD_IO_URING when building
+	/// the Net library (CMake option ENABLE_NET_IO_URING). Poll requests
+	/// for all sockets that became ready are then resubmitted and the
+	/// next completions awaited with a single system call, and completions
+	/// that are already available are collected without a system call.
 {
 public:
 	enum Mode
 	{
 		POLL_READ  = 0x01,
 		POLL_WRITE = 0x02,
-		POLL_ERROR = 0x04
+		POLL_ERROR = 0x04,
+
+		POLL_EDGE_TRIGGERED = 0x08,
+			/// The socket is only reported when its state changes,
+			/// not as long as it is readable or writable. The socket
+			/// must therefore be read or written until the operation
+			/// would block. Implementations that do not support
+			/// edge-triggered polling (poll and select) ignore this flag,
+			/// and report the socket as long as it is ready.
+
+		POLL_ONE_SHOT = 0x10
+			/// The socket is reported only once, and then disabled
+			/// until it is enabled again by calling update().
+			/// This allows multiple threads to poll the same PollSet
+			/// without the same socket being reported to more than
+			/// one thread at a time.
 	};
 
 	using SocketModeMap = std::map<Poco::Net::Socket, int>;
+	using SocketMode = std::pair<Poco::Net::Socket, int>;
+	using SocketModeList = std::vector<SocketMode>;
 
 	PollSet();
 		/// Creates an empty PollSet.
@@ -55,13 +81,17 @@ public:
 	void add(const Poco::Net::Socket& socket, int mode);
 		/// Adds the given socket to the set, for polling with
 		/// the given mode, which can be an OR'd combination of
-		/// POLL_READ, POLL_WRITE and POLL_ERROR.
+		/// POLL_READ, POLL_WRITE and POLL_ERROR, optionally
+		/// combined with POLL_EDGE_TRIGGERED or POLL_ONE_SHOT.
 
 	void remove(const Poco::Net::Socket& socket);
 		/// Removes the given socket from the set.
 
 	void update(const Poco::Net::Socket& socket, int mode);
 		/// Updates the mode of the given socket.
+		///
+		/// A socket registered with POLL_ONE_SHOT is enabled
+		/// again by calling update().
 
 	bool has(const Socket& socket) const;
 		/// Returns true if socket is registered for polling.
@@ -78,6 +108,26 @@ public:
 		/// Returns a PollMap containing the sockets that have had
 		/// their state changed.
 
+	int poll(const Poco::Timespan& timeout, SocketModeList& result);
+		/// Waits until the state of at least one of the PollSet's sockets
+		/// changes accordingly to its mode, or the timeout expires.
+		/// Clears result and fills it with the sockets that have had
+		/// their state changed, together with their new state. Every
+		/// socket appears at most once. Returns the number of sockets.
+		///
+		/// As the capacity of result is retained, a SocketModeList
+		/// that is reused for every call does not require any memory
+		/// allocations once it has grown large enough. The caller should
+		/// clear the list after processing the result, so that the
+		/// sockets are not kept open by the list.
+
+	void wakeUp();
+		/// Wakes up a thread waiting in poll(), which then returns
+		/// even if none of the sockets has become ready. If no thread
+		/// is waiting, the next call to poll() returns immediately.
+		///
+		/// Can be called from any thread.
+
 private:
 	PollSetImpl* _pImpl;
 
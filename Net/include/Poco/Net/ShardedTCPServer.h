@@ -0,0 +1,197 @@
+//
+// ShardedTCPServer.h
+//
+// Library: Net
+// Package: TCPServer
+// Module:  ShardedTCPServer
+//
+// Definition of the ShardedTCPServer class.
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_ShardedTCPServer_INCLUDED
+#define Net_ShardedTCPServer_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/TCPServer.h"
+#include "Poco/Net/SocketAddress.h"
+#include "Poco/ThreadPool.h"
+#include <vector>
+
+
+namespace Poco {
+namespace Net {
+
+
+class Net_API ShardedTCPServer
+	/// A multithreaded TCP server consisting of several independent
+	/// TCPServer instances (shards), each listening on its own
+	/// ServerSocket bound to the same address with SO_REUSEPORT.
+	///
+	/// The operating system distributes incoming connections across
+	/// the listening sockets. Every shard has its own accept thread,
+	/// its own TCPServerDispatcher and connection queue, and its own
+	/// ThreadPool, so that accepting and dispatching connections does
+	/// not involve any state shared between the shards. This helps
+	/// with servers that must accept a large number of connections
+	/// in a short time, for example when many clients reconnect at
+	/// the same time.
+	///
+	/// Optionally, the accept thread of every shard can be bound to
+	/// a CPU (shard n is bound to CPU n modulo the number of CPUs).
+	/// This is currently only supported on Linux, and silently ignored
+	/// on other platforms.
+	///
+	/// The TCPServerConnectionFactory and the TCPServerParams are
+	/// shared by all shards. The TCPServerConnectionFactory must
+	/// therefore be safe for use by multiple threads. The maximum
+	/// number of threads and queued connections given in the
+	/// TCPServerParams apply to every shard.
+	///
+	/// Note that with SO_REUSEPORT, connections are assigned to
+	/// a shard when they arrive, so connections waiting in the
+	/// queue of a busy shard are not taken over by an idle one.
+	/// Also note that on platforms not supporting SO_REUSEPORT
+	/// (or supporting it without load balancing), binding more
+	/// than one socket to the same address fails, or not all
+	/// shards receive connections.
+{
+public:
+	enum
+	{
+		DEFAULT_MAX_THREADS = 16
+			/// Maximum number of connection threads per shard,
+			/// if not specified in the TCPServerParams.
+	};
+
+	ShardedTCPServer(TCPServerConnectionFactory::Ptr pFactory, const SocketAddress& address, int shardCount = 0, TCPServerParams::Ptr pParams = 0);
+		/// Creates the ShardedTCPServer with shardCount shards,
+		/// listening on the given address. If shardCount is 0, one
+		/// shard per CPU is created.
+		///
+		/// If the port given in address is 0, the first shard is
+		/// bound to an available port, and all further shards to
+		/// the same port. The port number can be queried with port().
+		///
+		/// The server takes ownership of the TCPServerConnectionFactory
+		/// and the TCPServerParams object. If no TCPServerParams object
+		/// is given, a default one is created.
+
+	ShardedTCPServer(TCPServerConnectionFactory::Ptr pFactory, Poco::UInt16 portNumber = 0, int shardCount = 0, TCPServerParams::Ptr pParams = 0);
+		/// Creates the ShardedTCPServer with shardCount shards,
+		/// listening on the given port on all IPv4 interfaces.
+
+	~ShardedTCPServer();
+		/// Stops and destroys the ShardedTCPServer.
+
+	void setCPUAffinity(bool enable);
+		/// Enables or disables binding the accept thread of every
+		/// shard to a CPU. Must be called before start().
+
+	bool getCPUAffinity() const;
+		/// Returns true if the accept threads are bound to CPUs.
+
+	void setConnectionFilter(const TCPServerConnectionFilter::Ptr& pFilter);
+		/// Sets a TCPServerConnectionFilter for all shards.
+		/// Must be called before start().
+
+	void start();
+		/// Starts all shards.
+
+	void stop();
+		/// Stops all shards. No new connections will be accepted.
+		/// Already handled connections will continue being served.
+
+	int shards() const;
+		/// Returns the number of shards.
+
+	TCPServer& shard(int index) const;
+		/// Returns the TCPServer for the shard with the given index.
+
+	Poco::UInt16 port() const;
+		/// Returns the port the server listens on.
+
+	const TCPServerParams& params() const;
+		/// Returns the TCPServerParams used by all shards.
+
+	int currentThreads() const;
+		/// Returns the number of currently used connection threads
+		/// of all shards.
+
+	int maxThreads() const;
+		/// Returns the maximum number of threads available in all shards.
+
+	int totalConnections() const;
+		/// Returns the total number of connections handled by all shards.
+
+	int currentConnections() const;
+		/// Returns the number of connections currently handled by all shards.
+
+	int maxConcurrentConnections() const;
+		/// Returns the sum of the maximum number of concurrently
+		/// handled connections of all shards.
+
+	int queuedConnections() const;
+		/// Returns the number of queued connections of all shards.
+
+	int refusedConnections() const;
+		/// Returns the number of refused connections of all shards.
+
+protected:
+	static void bindToCPU(int cpu);
+		/// Binds the calling thread to the given CPU, if supported
+		/// by the platform.
+
+private:
+	ShardedTCPServer();
+	ShardedTCPServer(const ShardedTCPServer&);
+	ShardedTCPServer& operator = (const ShardedTCPServer&);
+
+	void init(TCPServerConnectionFactory::Ptr pFactory, const SocketAddress& address, int shardCount, TCPServerParams::Ptr pParams);
+
+	class Shard;
+
+	typedef std::vector<Poco::ThreadPool*> PoolVec;
+	typedef std::vector<Shard*> ShardVec;
+
+	TCPServerParams::Ptr _pParams;
+	PoolVec _pools;
+	ShardVec _shards;
+	bool _cpuAffinity;
+	bool _started;
+
+	friend class Shard;
+};
+
+
+//
+// inlines
+//
+inline bool ShardedTCPServer::getCPUAffinity() const
+{
+	return _cpuAffinity;
+}
+
+
+inline int ShardedTCPServer::shards() const
+{
+	return static_cast<int>(_shards.size());
+}
+
+
+inline const TCPServerParams& ShardedTCPServer::params() const
+{
+	return *_pParams;
+}
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_ShardedTCPServer_INCLUDED
@@ -364,6 +364,44 @@ namespace Net {
 
 typedef std::vector<SocketBuf> SocketBufVec;
 
+struct SocketMessage
+	/// Describes a single datagram sent or received with
+	/// DatagramSocket::sendMessages() or DatagramSocket::receiveMessages().
+{
+	SocketMessage():
+		pBuffer(0),
+		bufferLength(0),
+		pAddress(0),
+		addressLength(0),
+		length(0),
+		segmentSize(0)
+	{
+	}
+
+	void*            pBuffer;
+		/// The buffer containing or receiving the payload.
+	int              bufferLength;
+		/// The size of the buffer. When sending, the number
+		/// of bytes to send.
+	struct sockaddr* pAddress;
+		/// The address of the peer. May be null if the socket
+		/// is connected or the sender address is not needed.
+	poco_socklen_t   addressLength;
+		/// The length of the address. When receiving, the size of
+		/// the address buffer on input, and the length of the
+		/// received address on output.
+	int              length;
+		/// The number of bytes sent or received.
+	int              segmentSize;
+		/// The segment size for UDP segmentation offload.
+		/// If greater than 0 when sending, the kernel splits the
+		/// payload into datagrams of segmentSize bytes (UDP GSO).
+		/// When receiving with receive offload enabled, the size
+		/// of the coalesced datagrams (UDP GRO), otherwise 0.
+};
+
+typedef std::vector<SocketMessage> SocketMessageVec;
+
 struct AddressFamily
 	/// AddressFamily::Family replaces the previously used IPAddress::Family
 	/// enumeration and is now used for IPAddress::Family and SocketAddress::Family.
@@ -27,6 +27,11 @@
 
 
 namespace Poco {
+
+
+class FileInputStream;
+
+
 namespace Net {
 
 
@@ -175,6 +180,21 @@ public:
 		///
 		/// Always returns zero for platforms where not implemented.
 
+	virtual Poco::Int64 sendFile(FileInputStream& fileInputStream, Poco::UInt64 offset, Poco::UInt64 count);
+		/// Sends count bytes of the given file, starting at offset,
+		/// through the socket. The position of the stream is not
+		/// used and may be changed.
+		///
+		/// On Linux, the file is sent with sendfile(), without copying
+		/// its content to user space. On other platforms, and for secure
+		/// sockets, the file is read in blocks which are sent with
+		/// sendBytes().
+		///
+		/// Returns the number of bytes sent, which is less than count
+		/// only if the end of the file has been reached.
+		///
+		/// The socket must be in blocking mode.
+
 	virtual int receiveBytes(void* buffer, int length, int flags = 0);
 		/// Receives data from the socket and stores it
 		/// in buffer. Up to length bytes are received.
@@ -248,6 +268,25 @@ public:
 		///
 		/// Returns the number of bytes received.
 
+	virtual int sendMessages(SocketMessageVec& messages, int flags = 0);
+		/// Sends the given datagrams through the socket, using
+		/// as few system calls as possible (sendmmsg() on Linux).
+		///
+		/// Returns the number of datagrams sent, which may be
+		/// less than the number of datagrams given. The number of
+		/// bytes sent is stored in the length member of each
+		/// datagram sent.
+
+	virtual int receiveMessages(SocketMessageVec& messages, int flags = 0);
+		/// Receives up to messages.size() datagrams from the socket,
+		/// using as few system calls as possible (recvmmsg() on Linux).
+		/// Waits only for the first datagram.
+		///
+		/// Returns the number of datagrams received, or 0 if the
+		/// socket is non-blocking and no datagram is available.
+		/// On platforms without recvmmsg(), at most one datagram
+		/// is received.
+
 	virtual void sendUrgent(unsigned char data);
 		/// Sends one byte of urgent data through
 		/// the socket.
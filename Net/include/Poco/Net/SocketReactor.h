@@ -23,8 +23,13 @@
 #include "Poco/Net/PollSet.h"
 #include "Poco/Runnable.h"
 #include "Poco/Timespan.h"
+#include "Poco/Timestamp.h"
 #include "Poco/Observer.h"
 #include "Poco/AutoPtr.h"
+#include "Poco/RefCountedObject.h"
+#include "Poco/TimingWheel.h"
+#include <functional>
+#include <vector>
 #include <map>
 #include <atomic>
 
@@ -112,8 +117,44 @@ class Net_API SocketReactor: public Poco::Runnable
 	/// from another thread while the SocketReactor is running. Also,
 	/// it is safe to call addEventHandler() and removeEventHandler()
 	/// from event handlers.
+	///
+	/// If one-shot mode has been enabled with setOneShot(), run()
+	/// can also be called by multiple threads at the same time,
+	/// which then share the sockets of the SocketReactor. A socket
+	/// that has become ready is dispatched by only one thread,
+	/// and is polled again only after all notifications for it have
+	/// been dispatched. Timeout, idle and shutdown notifications,
+	/// however, are dispatched by every thread. While more than one
+	/// thread is running the SocketReactor, every dispatch uses its
+	/// own notification object, so that each handler sees the
+	/// socket the notification is for.
+	///
+	/// In addition to the global timeout, timers can be scheduled
+	/// with addTimer(). Timers are executed by the thread running
+	/// the SocketReactor, so that, as long as only one thread runs
+	/// the SocketReactor, a timer callback can safely access the
+	/// state of event handlers without additional synchronization.
+	/// If run() is called by multiple threads, timer callbacks are
+	/// executed by all of them, and may run at the same time as
+	/// event handlers and other timer callbacks, so that state
+	/// shared with them must be synchronized.
+	/// Timers are kept in a TimingWheel, and the timeout passed to
+	/// PollSet::poll() is shortened so that the reactor wakes up
+	/// when the nearest timer expires. A timer added or restarted
+	/// with a deadline earlier than that wakes up the reactor.
+	/// A timer can be bound to a socket, in which case it is
+	/// cancelled when the last event handler for the socket is
+	/// removed. This makes timers well suited for per-connection
+	/// idle timeouts and write deadlines.
 {
 public:
+	typedef std::function<void()> TimerCallback;
+		/// The callback executed when a timer expires.
+
+	typedef Poco::UInt64 TimerId;
+		/// Identifies a timer scheduled with addTimer().
+		/// A valid TimerId is never 0.
+
 	SocketReactor();
 		/// Creates the SocketReactor.
 
@@ -134,7 +175,10 @@ public:
 		/// (including a timeout event) occurs.
 
 	void wakeUp();
-		/// Wakes up idle reactor.
+		/// Wakes up idle reactor. If several threads
+		/// are running the reactor, all of them are woken up.
+		/// A reactor waiting in PollSet::poll() is woken up
+		/// as well.
 
 	void setTimeout(const Poco::Timespan& timeout);
 		/// Sets the timeout. 
@@ -150,6 +194,34 @@ public:
 	const Poco::Timespan& getTimeout() const;
 		/// Returns the timeout.
 
+	void setEdgeTriggered(bool flag);
+		/// Enables or disables edge-triggered polling.
+		///
+		/// If enabled, sockets are registered with the
+		/// PollSet::POLL_EDGE_TRIGGERED flag, and a ReadableNotification
+		/// or WritableNotification is only dispatched when the state
+		/// of a socket changes. Event handlers must therefore read or
+		/// write until the operation would block.
+		///
+		/// Must be called before any event handlers are added.
+
+	bool getEdgeTriggered() const;
+		/// Returns true if edge-triggered polling is enabled.
+
+	void setOneShot(bool flag);
+		/// Enables or disables one-shot polling.
+		///
+		/// If enabled, sockets are registered with the
+		/// PollSet::POLL_ONE_SHOT flag, and are only polled again
+		/// after all notifications for a ready socket have been
+		/// dispatched. This allows running the SocketReactor in
+		/// multiple threads.
+		///
+		/// Must be called before any event handlers are added.
+
+	bool getOneShot() const;
+		/// Returns true if one-shot polling is enabled.
+
 	void addEventHandler(const Socket& socket, const Poco::AbstractObserver& observer);
 		/// Registers an event handler with the SocketReactor.
 		///
@@ -170,6 +242,61 @@ public:
 	bool has(const Socket& socket) const;
 		/// Returns true if socket is registered with this rector.
 
+	std::size_t socketCount() const;
+		/// Returns the number of sockets for which event
+		/// handlers are registered.
+
+	double load() const;
+		/// Returns the fraction of time (0.0 to 1.0) the reactor
+		/// has recently spent dispatching socket notifications.
+		///
+		/// The value is an exponentially weighted moving average
+		/// over the recent iterations of run(), and can be used
+		/// to distribute sockets over multiple reactors
+		/// (see SocketReactorBalancer).
+
+	TimerId addTimer(const Poco::Timespan& delay, const TimerCallback& callback, const Poco::Timespan& interval = Poco::Timespan());
+		/// Schedules a timer that executes the given callback
+		/// after delay, and then repeatedly every interval,
+		/// if interval is greater than 0.
+		///
+		/// The callback is executed by the thread running the
+		/// SocketReactor. It must not block, as no sockets are
+		/// polled while it runs. A timer expires at most about
+		/// one millisecond after its deadline, but never before it.
+		///
+		/// Can be called from any thread. If the reactor is waiting
+		/// for events beyond the deadline of the timer, it is woken up.
+		///
+		/// Returns the TimerId, which can be used to restart
+		/// or cancel the timer.
+
+	TimerId addTimer(const Socket& socket, const Poco::Timespan& delay, const TimerCallback& callback, const Poco::Timespan& interval = Poco::Timespan());
+		/// Schedules a timer bound to the given socket. The timer
+		/// behaves like a timer scheduled with addTimer() without a socket,
+		/// but it is automatically cancelled when the last event handler
+		/// for the socket is removed.
+
+	bool restartTimer(TimerId id, const Poco::Timespan& delay);
+		/// Changes the time of the next expiration of the given
+		/// timer to delay from now, which is useful for implementing
+		/// idle timeouts. The interval of the timer is not changed.
+		///
+		/// Returns false if no such timer exists, either because it
+		/// has been cancelled, or because it was not periodic and
+		/// its callback has already been executed. A timer that is
+		/// not periodic can be restarted from within its callback.
+
+	bool cancelTimer(TimerId id);
+		/// Cancels the given timer. If the timer has already
+		/// expired, but the callback has not been executed yet,
+		/// it is not executed.
+		///
+		/// Returns false if no such timer exists.
+
+	std::size_t timerCount() const;
+		/// Returns the number of scheduled timers.
+
 protected:
 	virtual void onTimeout();
 		/// Called if the timeout expires and no other events are available.
@@ -213,27 +340,64 @@ private:
 	typedef Poco::FastMutex                   MutexType;
 	typedef MutexType::ScopedLock             ScopedLock;
 
+	class Timer: public Poco::TimingWheel::Entry, public Poco::RefCountedObject
+	{
+	public:
+		Timer(const TimerCallback& callback, const Poco::Timespan& interval);
+
+		TimerId           id;
+		TimerCallback     callback;
+		Poco::Timespan    interval;
+		Socket            socket;
+		bool              hasSocket;
+		std::atomic<bool> cancelled;
+	};
+
+	typedef Poco::AutoPtr<Timer>           TimerPtr;
+	typedef std::map<TimerId, TimerPtr>    TimerMap;
+	typedef std::multimap<Socket, TimerId> SocketTimerMap;
+	typedef std::vector<TimerPtr>          TimerVec;
+
 	bool hasSocketHandlers();
+	SocketNotification* notificationFor(SocketNotification* pNotification);
 	void dispatch(NotifierPtr& pNotifier, SocketNotification* pNotification);
 	NotifierPtr getNotifier(const Socket& socket, bool makeNew = false);
+	int pollMode(NotifierPtr& pNotifier);
+	void rearm(const Socket& socket);
+	void updateLoad(Poco::Timestamp::TimeDiff busy, Poco::Timestamp::TimeDiff total);
+	TimerId scheduleTimer(TimerPtr pTimer, const Poco::Timespan& delay);
+	void removeTimer(TimerMap::iterator it);
+	void cancelTimers(const Socket& socket);
+	Poco::Timespan nextTimeout(const Poco::Clock& timeoutStart);
+	void processTimers(TimerVec& expired);
 
 	enum
 	{
-		DEFAULT_TIMEOUT = 250000
+		DEFAULT_TIMEOUT = 250000,
+		LOAD_SCALE      = 1000000
 	};
 
 	std::atomic<bool> _stop;
 	Poco::Timespan    _timeout;
 	EventHandlerMap   _handlers;
 	PollSet           _pollSet;
+	int               _pollFlags;
+	std::atomic<int>  _load;
 	NotificationPtr   _pReadableNotification;
 	NotificationPtr   _pWritableNotification;
 	NotificationPtr   _pErrorNotification;
 	NotificationPtr   _pTimeoutNotification;
 	NotificationPtr   _pIdleNotification;
 	NotificationPtr   _pShutdownNotification;
-	MutexType         _mutex;
-	Poco::Thread*     _pThread;
+	mutable MutexType _mutex;
+	std::vector<Poco::Thread*> _threads;
+	std::atomic<int>  _runners;
+	Poco::TimingWheel _timerWheel;
+	TimerMap          _timers;
+	SocketTimerMap    _socketTimers;
+	TimerId           _nextTimerId;
+	Poco::Clock       _pollDeadline;
+	mutable MutexType _timerMutex;
 
 	friend class SocketNotifier;
 };
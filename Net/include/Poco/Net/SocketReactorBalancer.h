@@ -0,0 +1,124 @@
+//
+// SocketReactorBalancer.h
+//
+// Library: Net
+// Package: Reactor
+// Module:  SocketReactorBalancer
+//
+// Definition of the SocketReactorBalancer class and its subclasses.
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_SocketReactorBalancer_INCLUDED
+#define Net_SocketReactorBalancer_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/StreamSocket.h"
+#include "Poco/SharedPtr.h"
+#include <vector>
+#include <atomic>
+
+
+namespace Poco {
+namespace Net {
+
+
+class SocketReactor;
+
+
+class Net_API SocketReactorBalancer
+	/// A SocketReactorBalancer selects the SocketReactor a newly
+	/// accepted connection is assigned to, from a set of SocketReactor
+	/// objects running in different threads.
+	///
+	/// SocketReactorBalancer is used by ParallelSocketAcceptor, and
+	/// must be safe for use by multiple threads.
+{
+public:
+	using Ptr = Poco::SharedPtr<SocketReactorBalancer>;
+	using ReactorVec = std::vector<SocketReactor*>;
+
+	SocketReactorBalancer();
+		/// Creates the SocketReactorBalancer.
+
+	virtual ~SocketReactorBalancer();
+		/// Destroys the SocketReactorBalancer.
+
+	virtual std::size_t select(const ReactorVec& reactors, const StreamSocket& socket) = 0;
+		/// Returns the index of the reactor the given socket
+		/// is assigned to. The reactors vector is never empty.
+
+private:
+	SocketReactorBalancer(const SocketReactorBalancer&);
+	SocketReactorBalancer& operator = (const SocketReactorBalancer&);
+};
+
+
+class Net_API RoundRobinBalancer: public SocketReactorBalancer
+	/// Assigns connections to the reactors in turn.
+{
+public:
+	RoundRobinBalancer();
+	~RoundRobinBalancer();
+
+	std::size_t select(const ReactorVec& reactors, const StreamSocket& socket);
+
+private:
+	std::atomic<std::size_t> _next;
+};
+
+
+class Net_API LeastConnectionsBalancer: public SocketReactorBalancer
+	/// Assigns a connection to the reactor with the smallest
+	/// number of registered sockets (see SocketReactor::socketCount()).
+{
+public:
+	LeastConnectionsBalancer();
+	~LeastConnectionsBalancer();
+
+	std::size_t select(const ReactorVec& reactors, const StreamSocket& socket);
+};
+
+
+class Net_API LeastLoadBalancer: public SocketReactorBalancer
+	/// Assigns a connection to the reactor that has recently
+	/// spent the least time dispatching notifications (see
+	/// SocketReactor::load()). If several reactors have a load
+	/// below the given threshold, the one with the smallest number
+	/// of registered sockets is chosen among them, so that
+	/// connections are still spread over idle reactors.
+{
+public:
+	explicit LeastLoadBalancer(double threshold = 0.05);
+	~LeastLoadBalancer();
+
+	std::size_t select(const ReactorVec& reactors, const StreamSocket& socket);
+
+private:
+	double _threshold;
+};
+
+
+class Net_API PeerHashBalancer: public SocketReactorBalancer
+	/// Assigns a connection to a reactor determined by a hash
+	/// of the peer's IP address, so that all connections from
+	/// the same host are handled by the same reactor.
+{
+public:
+	PeerHashBalancer();
+	~PeerHashBalancer();
+
+	std::size_t select(const ReactorVec& reactors, const StreamSocket& socket);
+};
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_SocketReactorBalancer_INCLUDED
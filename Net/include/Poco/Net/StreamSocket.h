@@ -21,6 +21,7 @@
 #include "Poco/Net/Net.h"
 #include "Poco/Net/Socket.h"
 #include "Poco/FIFOBuffer.h"
+#include "Poco/FileStream.h"
 
 
 namespace Poco {
@@ -136,6 +137,19 @@ public:
 		/// The flags parameter can be used to pass system-defined flags
 		/// for send() like MSG_OOB.
 
+	Poco::Int64 sendFile(Poco::FileInputStream& fileInputStream, Poco::UInt64 offset, Poco::UInt64 count);
+		/// Sends count bytes of the given file, starting at offset,
+		/// through the socket.
+		///
+		/// Where supported (Linux), the file is sent without copying
+		/// its content to user space. Secure sockets send the file
+		/// content with sendBytes().
+		///
+		/// Returns the number of bytes sent, which is less than count
+		/// only if the end of the file has been reached.
+		///
+		/// The socket must be in blocking mode.
+
 	int receiveBytes(void* buffer, int length, int flags = 0);
 		/// Receives data from the socket and stores it
 		/// in buffer. Up to length bytes are received.
@@ -36,7 +36,8 @@ public:
 		Poco::Timespan timeout = 250000,
 		std::size_t handlerBufListSize = 1000,
 		bool notifySender = false,
-		int  backlogThreshold = 10);
+		int  backlogThreshold = 10,
+		int  batchSize = 16);
 		/// Creates UDPServerParams.
 
 	~UDPServerParams();
@@ -64,6 +65,11 @@ public:
 		/// reports backlogs back to the client. Only meaningful
 		/// if notifySender() is true.
 
+	int batchSize() const;
+		/// Returns the maximum number of datagrams received
+		/// with a single call to DatagramSocket::receiveMessages().
+		/// If 1, datagrams are received one by one.
+
 private:
 	UDPServerParams();
 
@@ -73,6 +79,7 @@ private:
 	std::size_t              _handlerBufListSize;
 	bool                     _notifySender;
 	int                      _backlogThreshold;
+	int                      _batchSize;
 };
 
 
@@ -116,6 +123,12 @@ inline int UDPServerParams::backlogThreshold() const
 }
 
 
+inline int UDPServerParams::batchSize() const
+{
+	return _batchSize;
+}
+
+
 } } // namespace Poco::Net
 
 
@@ -20,6 +20,7 @@
 
 #include "Poco/Net/Net.h"
 #include "Poco/Net/DatagramSocket.h"
+#include <vector>
 
 
 namespace Poco {
@@ -70,19 +71,32 @@ private:
 	};
 
 public:
-	UDPSocketReader(typename UDPHandlerImpl<S>::List& handlers, int backlogThreshold = 0):
+	enum
+	{
+		DEFAULT_BATCH_SIZE = 16
+	};
+
+	UDPSocketReader(typename UDPHandlerImpl<S>::List& handlers, int backlogThreshold = 0, int batchSize = DEFAULT_BATCH_SIZE):
 		_handlers(handlers),
 		_handler(_handlers.begin()),
-		_backlogThreshold(backlogThreshold)
+		_backlogThreshold(backlogThreshold),
+		_messages(batchSize),
+		_buffers(batchSize)
 		/// Creates the UDPSocketReader.
+		///
+		/// Up to batchSize datagrams are received with
+		/// a single system call.
 	{
 		poco_assert(_handler != _handlers.end());
+		poco_assert(batchSize > 0);
 	}
 
 	UDPSocketReader(typename UDPHandlerImpl<S>::List& handlers, const UDPServerParams& serverParams):
 		_handlers(handlers),
 		_handler(_handlers.begin()),
-		_backlogThreshold(serverParams.backlogThreshold())
+		_backlogThreshold(serverParams.backlogThreshold()),
+		_messages(serverParams.batchSize()),
+		_buffers(serverParams.batchSize())
 		/// Creates the UDPSocketReader.
 	{
 		poco_assert(_handler != _handlers.end());
@@ -98,6 +112,58 @@ public:
 		/// Errors are also passed to the handler. If object is configured
 		/// for replying to sender and data or error backlog threshold is
 		/// exceeded, sender is notified of the current backlog size.
+		///
+		/// If the batch size is greater than 1, all datagrams available
+		/// (up to the batch size) are received with a single call to
+		/// DatagramSocket::receiveMessages(), and passed to the same handler.
+	{
+		if (_buffers.size() > 1)
+			readMessages(sock);
+		else
+			readMessage(sock);
+	}
+
+	bool handlerStopped() const
+		/// Returns true if all handlers are stopped.
+	{
+		bool stopped = true;
+		typename UDPHandlerImpl<S>::List::iterator it = _handlers.begin();
+		typename UDPHandlerImpl<S>::List::iterator end = _handlers.end();
+		for (; it != end; ++it) stopped = stopped && (*it)->stopped();
+		return stopped;
+	}
+
+	void stopHandler()
+		/// Stops all handlers.
+	{
+		typename UDPHandlerImpl<S>::List::iterator it = _handlers.begin();
+		typename UDPHandlerImpl<S>::List::iterator end = _handlers.end();
+		for (; it != end; ++it) (*it)->stop();
+	}
+
+	bool handlerDone() const
+		/// Returns true if all handlers are done processing data.
+	{
+		bool done = true;
+		typename UDPHandlerImpl<S>::List::iterator it = _handlers.begin();
+		typename UDPHandlerImpl<S>::List::iterator end = _handlers.end();
+		for (; it != end; ++it) done = done && (*it)->done();
+		return done;
+	}
+
+	AtomicCounter::ValueType setError(poco_socket_t sock, char* buf = 0, const std::string& err = "")
+		/// Sets error to the provided buffer buf. If the buffer is null, a new buffer is obtained
+		/// from handler.
+		/// If successful, returns the handler's eror backlog size, otherwise returns zero.
+	{
+		if (!buf) buf = handler().next(sock);
+		if (buf) return handler().setError(buf, err.empty() ? Error::getMessage(Error::last()) : err);
+		return 0;
+	}
+
+private:
+	void readMessage(DatagramSocket& sock)
+		/// Reads a single datagram from the socket.
 	{
 		typedef typename UDPHandlerImpl<S>::MsgSizeT RT;
 		char* p = 0;
@@ -150,45 +216,61 @@ public:
 		handler().notify();
 	}
 
-	bool handlerStopped() const
-		/// Returns true if all handlers are stopped.
+	void readMessages(DatagramSocket& sock)
+		/// Reads up to batch size datagrams from the socket.
 	{
-		bool stopped = true;
-		typename UDPHandlerImpl<S>::List::iterator it = _handlers.begin();
-		typename UDPHandlerImpl<S>::List::iterator end = _handlers.end();
-		for (; it != end; ++it) stopped = stopped && (*it)->stopped();
-		return stopped;
-	}
-
-	void stopHandler()
-		/// Stops all handlers.
-	{
-		typename UDPHandlerImpl<S>::List::iterator it = _handlers.begin();
-		typename UDPHandlerImpl<S>::List::iterator end = _handlers.end();
-		for (; it != end; ++it) (*it)->stop();
-	}
-
-	bool handlerDone() const
-		/// Returns true if all handlers are done processing data.
-	{
-		bool done = true;
-		typename UDPHandlerImpl<S>::List::iterator it = _handlers.begin();
-		typename UDPHandlerImpl<S>::List::iterator end = _handlers.end();
-		for (; it != end; ++it) done = done && (*it)->done();
-		return done;
-	}
+		typedef typename UDPHandlerImpl<S>::MsgSizeT RT;
+		poco_socket_t sockfd = sock.impl()->sockfd();
+		nextHandler();
+		Poco::UInt16 off = handler().offset();
+		std::size_t count = 0;
+		for (; count < _buffers.size(); ++count)
+		{
+			char* p = handler().next(sockfd);
+			if (!p) break;
+			_buffers[count] = p;
+			SocketMessage& msg = _messages[count];
+			msg.pBuffer = p + off;
+			msg.bufferLength = static_cast<int>(S - off - 1);
+			msg.pAddress = reinterpret_cast<struct sockaddr*>(p + sizeof(RT) + sizeof(poco_socklen_t));
+			msg.addressLength = SocketAddress::MAX_ADDRESS_LENGTH;
+		}
+		if (count == 0) return;
 
-	AtomicCounter::ValueType setError(poco_socket_t sock, char* buf = 0, const std::string& err = "")
-		/// Sets error to the provided buffer buf. If the buffer is null, a new buffer is obtained
-		/// from handler.
-		/// If successful, returns the handler's eror backlog size, otherwise returns zero.
-	{
-		if (!buf) buf = handler().next(sock);
-		if (buf) return handler().setError(buf, err.empty() ? Error::getMessage(Error::last()) : err);
-		return 0;
+		_messages.resize(count);
+		int received = 0;
+		try
+		{
+			received = sock.receiveMessages(_messages);
+		}
+		catch (Poco::Exception& exc)
+		{
+			setError(sockfd, _buffers[0], exc.displayText());
+			for (std::size_t i = 1; i < count; ++i) handler().setIdle(_buffers[i]);
+			_messages.resize(_buffers.size());
+			handler().notify();
+			return;
+		}
+		for (int i = 0; i < received; ++i)
+		{
+			char* p = _buffers[i];
+			const SocketMessage& msg = _messages[i];
+			poco_socklen_t* pAL = reinterpret_cast<poco_socklen_t*>(p + sizeof(RT));
+			*pAL = msg.addressLength;
+			p[off + msg.length] = 0; // for ascii convenience, zero-terminate
+			AtomicCounter::ValueType data = handler().setData(p, msg.length);
+			if (_backlogThreshold > 0 && data > _backlogThreshold && data != _dataBacklog[sockfd])
+			{
+				Poco::Int32 d = static_cast<Poco::Int32>(data);
+				sock.sendTo(&d, sizeof(Poco::Int32), SocketAddress(msg.pAddress, msg.addressLength));
+				_dataBacklog[sockfd] = data;
+			}
+		}
+		for (std::size_t i = received; i < count; ++i) handler().setIdle(_buffers[i]);
+		_messages.resize(_buffers.size());
+		if (received > 0) handler().notify();
 	}
 
-private:
 	void nextHandler()
 		/// Re-points the handler iterator to the next handler in
 		/// round-robin fashion.
@@ -208,11 +290,13 @@ private:
 	typedef typename UDPHandlerImpl<S>::List::iterator HandlerIterator;
 	typedef std::map<poco_socket_t, Counter>           CounterMap;
 
-	HandlerList&    _handlers;
-	HandlerIterator _handler;
-	CounterMap      _dataBacklog;
-	CounterMap      _errorBacklog;
-	int             _backlogThreshold;
+	HandlerList&       _handlers;
+	HandlerIterator    _handler;
+	CounterMap         _dataBacklog;
+	CounterMap         _errorBacklog;
+	int                _backlogThreshold;
+	SocketMessageVec   _messages;
+	std::vector<char*> _buffers;
 };
 
 
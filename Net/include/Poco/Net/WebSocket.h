@@ -21,7 +21,9 @@
 #include "Poco/Net/Net.h"
 #include "Poco/Net/StreamSocket.h"
 #include "Poco/Net/HTTPCredentials.h"
+#include "Poco/Net/WebSocketDeflate.h"
 #include "Poco/Buffer.h"
+#include "Poco/FIFOBuffer.h"
 
 
 namespace Poco {
@@ -122,10 +124,14 @@ public:
 			/// No Sec-WebSocket-Accept header or wrong value.
 		WS_ERR_UNAUTHORIZED                   = 6,
 			/// The server rejected the username or password for authentication.
+		WS_ERR_HANDSHAKE_EXTENSION            = 7,
+			/// Invalid Sec-WebSocket-Extensions header in handshake response.
 		WS_ERR_PAYLOAD_TOO_BIG                = 10,
 			/// Payload too big for supplied buffer.
-		WS_ERR_INCOMPLETE_FRAME               = 11
+		WS_ERR_INCOMPLETE_FRAME               = 11,
 			/// Incomplete frame received.
+		WS_ERR_COMPRESSION                    = 12
+			/// Compressed payload cannot be decompressed.
 	};
 
 	WebSocket(HTTPServerRequest& request, HTTPServerResponse& response);
@@ -139,6 +145,19 @@ public:
 		/// Throws an exception if the request is not a proper WebSocket
 		/// upgrade request.
 
+	WebSocket(HTTPServerRequest& request, HTTPServerResponse& response, const WebSocketDeflate::Params& deflateParams);
+		/// Creates a server-side WebSocket from within a
+		/// HTTPRequestHandler, supporting the permessage-deflate
+		/// extension (RFC 7692).
+		///
+		/// If the client offers the extension, the parameters are
+		/// negotiated based on the given deflateParams, and all
+		/// TEXT and BINARY messages sent are compressed. Compressed
+		/// messages received are decompressed transparently.
+		///
+		/// Throws an exception if the request is not a proper WebSocket
+		/// upgrade request.
+
 	WebSocket(HTTPClientSession& cs, HTTPRequest& request, HTTPResponse& response);
 		/// Creates a client-side WebSocket, using the given
 		/// HTTPClientSession and HTTPRequest for the initial handshake
@@ -166,6 +185,29 @@ public:
 		/// The result of the handshake can be obtained from the response
 		/// object.
 
+	WebSocket(HTTPClientSession& cs, HTTPRequest& request, HTTPResponse& response, const WebSocketDeflate::Params& deflateParams);
+		/// Creates a client-side WebSocket, using the given
+		/// HTTPClientSession and HTTPRequest for the initial handshake
+		/// (HTTP Upgrade request), and offers the permessage-deflate
+		/// extension (RFC 7692) with the given parameters.
+		///
+		/// If the server accepts the extension, all TEXT and BINARY
+		/// messages sent are compressed, and compressed messages
+		/// received are decompressed transparently. Whether the
+		/// extension is in use can be checked with deflateEnabled().
+		///
+		/// Throws a WebSocketException (WS_ERR_HANDSHAKE_EXTENSION)
+		/// if the server responds with invalid extension parameters.
+
+	WebSocket(HTTPClientSession& cs, HTTPRequest& request, HTTPResponse& response, HTTPCredentials& credentials, const WebSocketDeflate::Params& deflateParams);
+		/// Creates a client-side WebSocket, using the given
+		/// HTTPClientSession and HTTPRequest for the initial handshake
+		/// (HTTP Upgrade request), and offers the permessage-deflate
+		/// extension (RFC 7692) with the given parameters.
+		///
+		/// The given credentials are used for authentication
+		/// if requested by the server.
+
 	WebSocket(const Socket& socket);
 		/// Creates a WebSocket from another Socket, which must be a WebSocket,
 		/// otherwise a Poco::InvalidArgumentException will be thrown.
@@ -201,6 +243,14 @@ public:
 		///
 		/// Certain socket implementations may also return a negative
 		/// value denoting a certain condition.
+		///
+		/// On a server-side WebSocket, the frame header and the
+		/// payload are sent with a single gather write, without
+		/// copying the payload. On a client-side WebSocket, the
+		/// payload is masked while being copied into the frame.
+		///
+		/// Frames can be sent from multiple threads; every frame
+		/// is sent completely before the next one.
 
 	int receiveFrame(void* buffer, int length, int& flags);
 		/// Receives a frame from the socket and stores it
@@ -248,6 +298,13 @@ public:
 		/// DoS attack (memory exhaustion) by sending a WebSocket frame
 		/// header with a huge payload size.
 		///
+		/// The payload is received directly into buffer. If the
+		/// buffer must be grown while appending, its capacity is
+		/// at least doubled, so that the fragments of a message can
+		/// be collected in the same buffer without reallocating it for
+		/// every frame. To reuse the buffer (and its capacity) for the
+		/// next message, call buffer.resize(0).
+		///
 		/// Returns the number of bytes received.
 		/// A return value of 0 means that the peer has
 		/// shut down or closed the connection.
@@ -259,6 +316,24 @@ public:
 		/// The frame flags and opcode (FrameFlags and FrameOpcodes)
 		/// is stored in flags.
 
+	int receiveFrame(Poco::FIFOBuffer& buffer, int& flags);
+		/// Receives a frame from the socket and stores its payload
+		/// directly in the available space of the given FIFOBuffer,
+		/// after any data already in it. The FIFOBuffer is advanced
+		/// by the number of bytes received.
+		///
+		/// If the frame's payload is larger than the available
+		/// space, a WebSocketException (WS_ERR_PAYLOAD_TOO_BIG)
+		/// is thrown and the WebSocket connection must be
+		/// terminated.
+		///
+		/// Returns the number of bytes received.
+		/// A return value of 0 means that the peer has
+		/// shut down or closed the connection.
+		///
+		/// The frame flags and opcode (FrameFlags and FrameOpcodes)
+		/// is stored in flags.
+
 	Mode mode() const;
 		/// Returns WS_SERVER if the WebSocket is a server-side
 		/// WebSocket, or WS_CLIENT otherwise.
@@ -273,13 +348,20 @@ public:
 		///
 		/// The default is std::numeric_limits<int>::max().
 
+	bool deflateEnabled() const;
+		/// Returns true if the permessage-deflate extension
+		/// has been negotiated for the connection.
+
 	static const std::string WEBSOCKET_VERSION;
 		/// The WebSocket protocol version supported (13).
 
 protected:
 	static WebSocketImpl* accept(HTTPServerRequest& request, HTTPServerResponse& response);
+	static WebSocketImpl* accept(HTTPServerRequest& request, HTTPServerResponse& response, const WebSocketDeflate::Params* pDeflateParams);
 	static WebSocketImpl* connect(HTTPClientSession& cs, HTTPRequest& request, HTTPResponse& response, HTTPCredentials& credentials);
+	static WebSocketImpl* connect(HTTPClientSession& cs, HTTPRequest& request, HTTPResponse& response, HTTPCredentials& credentials, const WebSocketDeflate::Params* pDeflateParams);
 	static WebSocketImpl* completeHandshake(HTTPClientSession& cs, HTTPResponse& response, const std::string& key);
+	static WebSocketImpl* completeHandshake(HTTPClientSession& cs, HTTPResponse& response, const std::string& key, const WebSocketDeflate::Params* pDeflateParams);
 	static std::string computeAccept(const std::string& key);
 	static std::string createKey();
 
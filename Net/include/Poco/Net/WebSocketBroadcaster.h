@@ -0,0 +1,273 @@
+//
+// WebSocketBroadcaster.h
+//
+// Library: Net
+// Package: WebSocket
+// Module:  WebSocketBroadcaster
+//
+// Definition of the WebSocketBroadcaster class.
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_WebSocketBroadcaster_INCLUDED
+#define Net_WebSocketBroadcaster_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Net/WebSocket.h"
+#include "Poco/Net/WebSocketDeflate.h"
+#include "Poco/Net/SocketReactor.h"
+#include "Poco/Net/SocketNotification.h"
+#include "Poco/RefCountedObject.h"
+#include "Poco/AutoPtr.h"
+#include "Poco/BasicEvent.h"
+#include "Poco/SharedPtr.h"
+#include "Poco/Buffer.h"
+#include "Poco/Mutex.h"
+#include <deque>
+#include <map>
+#include <vector>
+
+
+namespace Poco {
+namespace Net {
+
+
+class Net_API WebSocketBroadcaster
+	/// WebSocketBroadcaster sends (broadcasts) messages to a set of
+	/// server-side WebSocket connections, the subscribers.
+	///
+	/// A message is encoded into a WebSocket frame, and compressed
+	/// if compression has been enabled, only once. The resulting
+	/// immutable frame is shared by the send queues of all subscribers.
+	///
+	/// Frames are written to a subscriber without blocking. If the
+	/// queue of a subscriber is empty, broadcast() immediately writes
+	/// as much of the frame as the socket accepts. Everything else is
+	/// written by the SocketReactor thread when the socket becomes
+	/// writable. For this, the WebSocketBroadcaster registers a
+	/// WritableNotification handler for subscribers with queued frames.
+	///
+	/// The number of bytes queued for a subscriber is limited. If a
+	/// subscriber does not read its messages fast enough and a frame
+	/// would exceed the limit, the subscriber is dropped: its queue
+	/// is discarded, the connection is shut down, and the
+	/// subscriberDropped event is fired. The same happens if writing
+	/// to a subscriber fails. The application detects the shut down
+	/// connection when reading from it, and closes the WebSocket.
+	///
+	/// Subscribers remain blocking sockets, and the application
+	/// continues to receive frames from them, e.g. in a
+	/// ReadableNotification handler of the same SocketReactor.
+	/// While a WebSocket is subscribed, all frames to it (e.g., PONG
+	/// or CLOSE frames) must be sent with send(), never directly with
+	/// WebSocket::sendFrame(), as this could interleave with a partially
+	/// written frame.
+	///
+	/// If compression is enabled, messages are compressed without
+	/// context takeover, as a single compressed frame cannot depend on
+	/// the previous messages of every connection. A compressed frame is
+	/// sent to subscribers that have negotiated the permessage-deflate
+	/// extension with server_no_context_takeover and a sufficient
+	/// window size. All other subscribers get an uncompressed frame,
+	/// which is also encoded only once. Server-side WebSockets should
+	/// therefore be created with WebSocketDeflate::Params that have
+	/// serverNoContextTakeover set.
+	///
+	/// The SocketReactor must be stopped, or all subscribers removed,
+	/// before the WebSocketBroadcaster is destroyed.
+	///
+	/// All methods of WebSocketBroadcaster can be called from any thread.
+{
+public:
+	enum
+	{
+		DEFAULT_MAX_QUEUED_BYTES = 1024*1024
+	};
+
+	Poco::BasicEvent<WebSocket> subscriberDropped;
+		/// Fired after a subscriber has been dropped, either because
+		/// its queue limit has been exceeded, or because writing to it
+		/// has failed. The subscriber's connection has been shut down.
+
+	explicit WebSocketBroadcaster(SocketReactor& reactor, std::size_t maxQueuedBytes = DEFAULT_MAX_QUEUED_BYTES);
+		/// Creates the WebSocketBroadcaster, using the given SocketReactor
+		/// for writing queued frames. At most maxQueuedBytes are queued
+		/// for a subscriber.
+
+	~WebSocketBroadcaster();
+		/// Destroys the WebSocketBroadcaster and removes all subscribers.
+		/// The connections of subscribers with a partially written
+		/// frame are shut down.
+
+	void subscribe(const WebSocket& socket);
+		/// Adds a server-side WebSocket to the subscribers.
+		///
+		/// Throws an InvalidArgumentException if the socket is a
+		/// client-side WebSocket, as client frames must be masked
+		/// individually.
+
+	bool unsubscribe(const WebSocket& socket);
+		/// Removes the WebSocket from the subscribers and discards any
+		/// queued frames. Returns false if the socket is not subscribed.
+		///
+		/// If a frame has been partially written to the WebSocket,
+		/// its connection is shut down, as the rest of the frame
+		/// is discarded.
+
+	bool isSubscribed(const WebSocket& socket) const;
+		/// Returns true if the WebSocket is subscribed.
+
+	std::size_t subscribers() const;
+		/// Returns the number of subscribers.
+
+	std::size_t broadcast(const void* buffer, int length, int flags = WebSocket::FRAME_TEXT);
+		/// Queues a frame with the given payload and flags for all
+		/// subscribers, and writes it to the subscribers whose queue
+		/// is otherwise empty.
+		///
+		/// Values from the FrameFlags, FrameOpcodes and SendFlags enumerations
+		/// of WebSocket can be specified in flags. Only single-frame
+		/// messages (FRAME_TEXT or FRAME_BINARY) are compressed.
+		///
+		/// Returns the number of subscribers the frame has been queued for,
+		/// which does not include subscribers dropped by this call.
+
+	std::size_t broadcast(const std::string& message, int flags = WebSocket::FRAME_TEXT);
+		/// Queues a frame with the given message for all subscribers.
+		/// See broadcast(const void*, int, int).
+
+	bool send(const WebSocket& socket, const void* buffer, int length, int flags = WebSocket::FRAME_TEXT);
+		/// Queues an uncompressed frame for a single subscriber.
+		///
+		/// Returns false if the socket is not subscribed, or has
+		/// been dropped by this call.
+
+	std::size_t queuedBytes(const WebSocket& socket) const;
+		/// Returns the number of bytes queued for the given subscriber.
+
+	void setMaxQueuedBytes(std::size_t maxQueuedBytes);
+		/// Sets the maximum number of bytes queued for a subscriber.
+		///
+		/// A frame is always queued for a subscriber with an empty
+		/// queue, even if it is larger than the limit.
+
+	std::size_t getMaxQueuedBytes() const;
+		/// Returns the maximum number of bytes queued for a subscriber.
+
+	void enableCompression(const WebSocketDeflate::Params& params = WebSocketDeflate::Params());
+		/// Enables compression of broadcast messages, using the
+		/// compression level, memory level, minimum compression size
+		/// and server window size given in params.
+
+	void disableCompression();
+		/// Disables compression of broadcast messages.
+
+	bool compressionEnabled() const;
+		/// Returns true if compression of broadcast messages is enabled.
+
+protected:
+	class Frame: public Poco::RefCountedObject
+		/// An encoded WebSocket frame, shared by the
+		/// queues of the subscribers.
+	{
+	public:
+		Frame(std::size_t size);
+		~Frame();
+
+		Poco::Buffer<char> data;
+	};
+
+	typedef Poco::AutoPtr<Frame> FramePtr;
+
+	class Subscriber: public Poco::RefCountedObject
+		/// A subscriber and its send queue.
+	{
+	public:
+		Subscriber(const WebSocket& socket);
+		~Subscriber();
+
+		WebSocket socket;
+		int deflateWindowBits;
+		std::deque<FramePtr> queue;
+		std::size_t offset;
+		std::size_t queued;
+		bool writeHandler;
+	};
+
+	typedef Poco::AutoPtr<Subscriber> SubscriberPtr;
+
+	static FramePtr encode(const char* buffer, int length, int flags);
+		/// Encodes a server-side frame.
+
+	bool enqueue(Subscriber& subscriber, const FramePtr& pFrame);
+		/// Queues the frame for the subscriber and writes as much of
+		/// the queue as possible. Returns false if the subscriber
+		/// must be dropped.
+
+	bool flush(Subscriber& subscriber);
+		/// Writes as much of the subscriber's queue as possible.
+		/// Returns false if writing has failed.
+
+	static void shutdown(Subscriber& subscriber);
+		/// Shuts down the connection of the subscriber.
+
+	void drop(SubscriberPtr pSubscriber, std::vector<Socket>& handlers);
+		/// Removes the subscriber and shuts down its connection.
+
+	bool remove(SubscriberPtr pSubscriber, std::vector<Socket>& handlers);
+		/// Removes the subscriber. If a write handler has been
+		/// registered for it, its socket is added to handlers.
+		/// If a frame has been partially written to the subscriber,
+		/// its connection is shut down and true is returned.
+
+	void removeHandlers(std::vector<Socket>& handlers);
+		/// Removes the write handlers of the given sockets.
+		/// Must be called without holding the mutex.
+
+	void fireDropped(std::vector<WebSocket>& dropped);
+		/// Fires the subscriberDropped event for all dropped subscribers.
+
+	void onWritable(WritableNotification* pNotification);
+		/// Writes the queue of a subscriber.
+
+private:
+	WebSocketBroadcaster();
+	WebSocketBroadcaster(const WebSocketBroadcaster&);
+	WebSocketBroadcaster& operator = (const WebSocketBroadcaster&);
+
+	enum
+	{
+		MAX_WRITE_BUFFERS = 16
+	};
+
+	typedef std::map<Socket, SubscriberPtr> SubscriberMap;
+
+	SocketReactor& _reactor;
+	std::size_t _maxQueuedBytes;
+	SubscriberMap _subscribers;
+	WebSocketDeflate::Params _deflateParams;
+	Poco::SharedPtr<WebSocketDeflate> _pDeflate;
+	Poco::Buffer<char> _deflateBuffer;
+	mutable Poco::FastMutex _mutex;
+};
+
+
+//
+// inlines
+//
+inline std::size_t WebSocketBroadcaster::broadcast(const std::string& message, int flags)
+{
+	return broadcast(message.data(), static_cast<int>(message.size()), flags);
+}
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_WebSocketBroadcaster_INCLUDED
@@ -0,0 +1,180 @@
+//
+// WebSocketDeflate.h
+//
+// Library: Net
+// Package: WebSocket
+// Module:  WebSocketDeflate
+//
+// Definition of the WebSocketDeflate class.
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Net_WebSocketDeflate_INCLUDED
+#define Net_WebSocketDeflate_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "Poco/Buffer.h"
+#if defined(POCO_UNBUNDLED)
+#include <zlib.h>
+#else
+#include "Poco/zlib.h"
+#endif
+
+
+namespace Poco {
+namespace Net {
+
+
+class Net_API WebSocketDeflate
+	/// This class implements the permessage-deflate WebSocket
+	/// extension described in RFC 7692.
+	///
+	/// The static methods negotiate the extension parameters during
+	/// the WebSocket handshake. A WebSocketDeflate object holds the
+	/// compression and decompression state (the zlib streams) for
+	/// one WebSocket connection, and is used by WebSocketImpl to
+	/// compress outgoing and decompress incoming messages.
+	///
+	/// If context takeover is enabled, the LZ77 window is kept from
+	/// message to message, which results in much better compression
+	/// of small, similar messages (e.g., JSON) at the cost of keeping
+	/// the zlib streams (up to about 300 KB with the default parameters)
+	/// for the lifetime of the connection. The streams are only
+	/// allocated when the first message is compressed or decompressed.
+	///
+	/// Applications normally do not use this class directly, but pass
+	/// a Params object to the WebSocket constructor.
+{
+public:
+	struct Params
+		/// The permessage-deflate extension parameters.
+	{
+		Params():
+			serverNoContextTakeover(false),
+			clientNoContextTakeover(false),
+			serverMaxWindowBits(15),
+			clientMaxWindowBits(15),
+			compressionLevel(Z_DEFAULT_COMPRESSION),
+			memoryLevel(8),
+			minCompressSize(0)
+		{
+		}
+
+		bool serverNoContextTakeover;
+			/// The server resets its compression context after every message.
+		bool clientNoContextTakeover;
+			/// The client resets its compression context after every message.
+		int  serverMaxWindowBits;
+			/// The base-2 logarithm of the LZ77 window size used by the server (9 - 15).
+		int  clientMaxWindowBits;
+			/// The base-2 logarithm of the LZ77 window size used by the client (9 - 15).
+		int  compressionLevel;
+			/// The zlib compression level (0 - 9) used for sending.
+			/// Not negotiated.
+		int  memoryLevel;
+			/// The zlib memory level (1 - 9) used for sending.
+			/// Not negotiated.
+		int  minCompressSize;
+			/// Messages with a payload smaller than this
+			/// are sent uncompressed. Not negotiated.
+	};
+
+	WebSocketDeflate(const Params& params, bool server);
+		/// Creates the WebSocketDeflate for a connection, using the
+		/// given negotiated parameters. If server is true, the parameters
+		/// for the server side of the connection are used for compression,
+		/// otherwise the parameters for the client side.
+
+	~WebSocketDeflate();
+		/// Destroys the WebSocketDeflate.
+
+	const Params& params() const;
+		/// Returns the negotiated parameters.
+
+	bool deflate(const char* data, int length, bool first, bool final, Poco::Buffer<char>& out);
+		/// Compresses a fragment of a message and stores the compressed
+		/// payload in out, which is resized accordingly. first must be
+		/// true for the first fragment of the message, final for the last.
+		///
+		/// Returns false, leaving out unchanged, if the message
+		/// is not compressed because it is a single frame smaller than
+		/// the minimum compression size. In this case, the RSV1 bit must not
+		/// be set in the frame, and all subsequent fragments of the
+		/// message must not be compressed.
+
+	void inflate(const char* data, int length, bool final, Poco::Buffer<char>& out, std::size_t maxLength);
+		/// Decompresses a fragment of a compressed message and appends
+		/// the result to out. final must be true for the last fragment
+		/// of the message.
+		///
+		/// Throws a WebSocketException (WS_ERR_PAYLOAD_TOO_BIG) if
+		/// the size of out would exceed maxLength, and a
+		/// WebSocketException (WS_ERR_COMPRESSION) if the data
+		/// cannot be decompressed.
+
+	static std::string createOffer(const Params& params);
+		/// Returns the Sec-WebSocket-Extensions header value
+		/// for a client handshake request offering the extension
+		/// with the given parameters.
+
+	static bool negotiate(const std::string& offers, const Params& params, Params& agreed, std::string& response);
+		/// Negotiates the extension parameters on the server side.
+		///
+		/// offers is the value of the Sec-WebSocket-Extensions header
+		/// of the handshake request, and params the parameters
+		/// supported by the server. If one of the offers can be
+		/// accepted, the resulting parameters are stored in agreed,
+		/// the Sec-WebSocket-Extensions header value for the handshake
+		/// response is stored in response, and true is returned.
+		/// Otherwise, returns false.
+
+	static bool accept(const std::string& response, const Params& params, Params& agreed);
+		/// Evaluates the Sec-WebSocket-Extensions header value
+		/// of a handshake response on the client side, given the
+		/// parameters offered with createOffer().
+		///
+		/// Returns true and stores the resulting parameters in agreed
+		/// if the server has accepted the extension, or false if the
+		/// response does not contain the extension.
+		///
+		/// Throws a WebSocketException (WS_ERR_HANDSHAKE_EXTENSION)
+		/// if the response is not valid.
+
+	static const std::string EXTENSION_NAME;
+		/// The name of the extension ("permessage-deflate").
+
+private:
+	WebSocketDeflate();
+	WebSocketDeflate(const WebSocketDeflate&);
+	WebSocketDeflate& operator = (const WebSocketDeflate&);
+
+	Params   _params;
+	int      _deflateWindowBits;
+	bool     _deflateNoContextTakeover;
+	bool     _inflateNoContextTakeover;
+	bool     _deflateInitialized;
+	bool     _inflateInitialized;
+	z_stream _deflateStream;
+	z_stream _inflateStream;
+};
+
+
+//
+// inlines
+//
+inline const WebSocketDeflate::Params& WebSocketDeflate::params() const
+{
+	return _params;
+}
+
+
+} } // namespace Poco::Net
+
+
+#endif // Net_WebSocketDeflate_INCLUDED
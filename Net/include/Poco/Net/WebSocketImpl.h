@@ -21,7 +21,7 @@
 #include "Poco/Net/StreamSocketImpl.h"
 #include "Poco/Buffer.h"
 #include "Poco/Random.h"
-#include "Poco/Buffer.h"
+#include "Poco/Mutex.h"
 
 
 namespace Poco {
@@ -29,6 +29,7 @@ namespace Net {
 
 
 class HTTPSession;
+class WebSocketDeflate;
 
 
 class Net_API WebSocketImpl: public StreamSocketImpl
@@ -36,6 +37,12 @@ class Net_API WebSocketImpl: public StreamSocketImpl
 	/// to the WebSocket protocol described in RFC 6455.
 {
 public:
+	enum
+	{
+		FRAME_FLAG_MASK   = 0x80,
+		MAX_HEADER_LENGTH = 14
+	};
+
 	WebSocketImpl(StreamSocketImpl* pStreamSocketImpl, HTTPSession& session, bool mustMaskPayload);
 		/// Creates a WebSocketImpl.
 
@@ -62,6 +69,7 @@ public:
 	virtual void shutdownReceive();
 	virtual void shutdownSend();
 	virtual void shutdown();
+	virtual Poco::Int64 sendFile(FileInputStream& fileInputStream, Poco::UInt64 offset, Poco::UInt64 count);
 	virtual int sendTo(const void* buffer, int length, const SocketAddress& address, int flags = 0);
 	virtual int receiveFrom(void* buffer, int length, SocketAddress& address, int flags = 0);
 	virtual void sendUrgent(unsigned char data);
@@ -89,15 +97,41 @@ public:
 		///
 		/// The default is std::numeric_limits<int>::max().
 
-protected:
-	enum
-	{
-		FRAME_FLAG_MASK   = 0x80,
-		MAX_HEADER_LENGTH = 14
-	};
+	void setDeflate(WebSocketDeflate* pDeflate);
+		/// Enables the permessage-deflate extension, using the
+		/// given WebSocketDeflate, which is owned by the WebSocketImpl.
+		///
+		/// Must be called before the first frame is sent or received.
+
+	WebSocketDeflate* deflate() const;
+		/// Returns the WebSocketDeflate if the permessage-deflate
+		/// extension is enabled, otherwise null.
+
+	int sendSomeBytes(const SocketBuf* pBuffers, int count);
+		/// Sends already encoded frames, given as an array of
+		/// count buffers, without waiting for the socket to become
+		/// writable.
+		///
+		/// Returns the number of bytes sent, which is 0 if the
+		/// socket's send buffer is full.
+		///
+		/// On a non-secure socket on POSIX platforms, all buffers
+		/// are sent with a single non-blocking gather write. Otherwise,
+		/// the socket is polled for writability, and up to 16 KB of
+		/// the first buffer are sent.
+
+	static int writeHeader(char* header, int length, int flags, bool mask);
+		/// Writes the header (without the masking key) of a frame
+		/// with the given payload length and flags to header, which
+		/// must have room for MAX_HEADER_LENGTH bytes.
+		///
+		/// Returns the length of the header.
 
+protected:
+	int sendFrame(const void* buffer, int length, int flags);
 	int receiveHeader(char mask[4], bool& useMask);
 	int receivePayload(char *buffer, int payloadLength, char mask[4], bool useMask);
+	bool isCompressed();
 	int receiveNBytes(void* buffer, int bytes);
 	int receiveSomeBytes(char* buffer, int bytes);
 	virtual ~WebSocketImpl();
@@ -112,6 +146,15 @@ private:
 	int _frameFlags;
 	bool _mustMaskPayload;
 	Poco::Random _rnd;
+	WebSocketDeflate* _pDeflate;
+	Poco::Buffer<char> _deflateBuffer;
+	Poco::Buffer<char> _inflateBuffer;
+	Poco::Buffer<char> _inflatedBuffer;
+	bool _sendCompressed;
+	bool _receiveCompressed;
+	Poco::Buffer<char> _sendBuffer;
+	SocketBufVec _sendBufs;
+	Poco::FastMutex _sendMutex;
 };
 
 
@@ -136,6 +179,12 @@ inline int WebSocketImpl::getMaxPayloadSize() const
 }
 
 
+inline WebSocketDeflate* WebSocketImpl::deflate() const
+{
+	return _pDeflate;
+}
+
+
 } } // namespace Poco::Net
 
 
@@ -0,0 +1,406 @@
+//
+// DNSResolver.cpp
+//
+// Library: Net
+// Package: NetCore
+// Module:  DNSResolver
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/DNSResolver.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/Notification.h"
+#include "Poco/AutoPtr.h"
+#include "Poco/SingletonHolder.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/String.h"
+#include "Poco/Exception.h"
+
+
+using Poco::FastMutex;
+using Poco::Timespan;
+using Poco::Timestamp;
+using Poco::AutoPtr;
+
+
+namespace Poco {
+namespace Net {
+
+
+class DNSResolver::LookupNotification: public Poco::Notification
+{
+public:
+	LookupNotification(const std::string& key, const std::string& hostname, unsigned hintFlags, const Result& result, Poco::UInt64 serial):
+		_key(key),
+		_hostname(hostname),
+		_hintFlags(hintFlags),
+		_result(result),
+		_serial(serial)
+	{
+	}
+
+	const std::string& key() const
+	{
+		return _key;
+	}
+
+	const std::string& hostname() const
+	{
+		return _hostname;
+	}
+
+	unsigned hintFlags() const
+	{
+		return _hintFlags;
+	}
+
+	Result& result()
+	{
+		return _result;
+	}
+
+	Poco::UInt64 serial() const
+	{
+		return _serial;
+	}
+
+private:
+	std::string _key;
+	std::string _hostname;
+	unsigned _hintFlags;
+	Result _result;
+	Poco::UInt64 _serial;
+};
+
+
+class DNSResolver::StopNotification: public Poco::Notification
+{
+};
+
+
+DNSResolver::DNSResolver():
+	_ttl(60, 0),
+	_negativeTTL(5, 0),
+	_maxEntries(DEFAULT_MAX_ENTRIES),
+	_serial(0)
+{
+	init(DEFAULT_THREADS);
+}
+
+
+DNSResolver::DNSResolver(int threads, const Poco::Timespan& ttl, const Poco::Timespan& negativeTTL, std::size_t maxEntries):
+	_ttl(ttl),
+	_negativeTTL(negativeTTL),
+	_maxEntries(maxEntries),
+	_serial(0)
+{
+	poco_assert (threads > 0 && maxEntries > 0);
+
+	init(threads);
+}
+
+
+DNSResolver::~DNSResolver()
+{
+	try
+	{
+		stop();
+	}
+	catch (...)
+	{
+		poco_unexpected();
+	}
+}
+
+
+void DNSResolver::init(int threads)
+{
+	for (int i = 0; i < threads; i++)
+	{
+		std::string name("DNSResolver[#");
+		NumberFormatter::append(name, i + 1);
+		name += ']';
+		Poco::Thread* pThread = new Poco::Thread(name);
+		_threads.push_back(pThread);
+		pThread->start(*this);
+	}
+}
+
+
+void DNSResolver::stop()
+{
+	std::vector<Poco::Thread*> threads;
+	{
+		FastMutex::ScopedLock lock(_mutex);
+
+		threads.swap(_threads);
+	}
+
+	// Every resolver thread finishes its current lookup,
+	// then takes one of the urgent stop notifications.
+	for (std::size_t i = 0; i < threads.size(); i++)
+	{
+		_queue.enqueueUrgentNotification(new StopNotification);
+	}
+	for (std::vector<Poco::Thread*>::iterator it = threads.begin(); it != threads.end(); ++it)
+	{
+		(*it)->join();
+		delete *it;
+	}
+
+	for (;;)
+	{
+		AutoPtr<Poco::Notification> pNf(_queue.dequeueNotification());
+		if (!pNf) break;
+		LookupNotification* pLookup = dynamic_cast<LookupNotification*>(pNf.get());
+		if (pLookup)
+		{
+			pLookup->result().error(InvalidAccessException("DNSResolver has been stopped", pLookup->hostname()));
+			pLookup->result().notify();
+		}
+	}
+
+	FastMutex::ScopedLock lock(_mutex);
+
+	_entries.clear();
+	_lru.clear();
+}
+
+
+Poco::ActiveResult<HostEntry> DNSResolver::hostByNameAsync(const std::string& hostname, unsigned hintFlags)
+{
+	IPAddress address;
+	if (IPAddress::tryParse(hostname, address))
+	{
+		Result result(new Poco::ActiveResultHolder<HostEntry>);
+		result.data(new HostEntry(hostname, address));
+		result.notify();
+		return result;
+	}
+
+	std::string key = keyFor(hostname, hintFlags);
+
+	FastMutex::ScopedLock lock(_mutex);
+
+	if (_threads.empty()) throw InvalidAccessException("DNSResolver has been stopped");
+
+	EntryMap::iterator it = _entries.find(key);
+	if (it != _entries.end())
+	{
+		if (it->second.pending || it->second.expires > Timestamp())
+		{
+			_lru.splice(_lru.end(), _lru, it->second.lru);
+			return it->second.result;
+		}
+		remove(it);
+	}
+
+	Result result(new Poco::ActiveResultHolder<HostEntry>);
+	Poco::UInt64 serial = ++_serial;
+	it = _entries.insert(EntryMap::value_type(key, Entry(result, serial))).first;
+	it->second.lru = _lru.insert(_lru.end(), key);
+	if (_entries.size() > _maxEntries)
+	{
+		remove(_entries.find(_lru.front()));
+	}
+	_queue.enqueueNotification(new LookupNotification(key, hostname, hintFlags, result, serial));
+	return result;
+}
+
+
+HostEntry DNSResolver::hostByName(const std::string& hostname, unsigned hintFlags)
+{
+	Result result = hostByNameAsync(hostname, hintFlags);
+	result.wait();
+	if (result.failed())
+		result.exception()->rethrow();
+	return result.data();
+}
+
+
+IPAddress DNSResolver::resolveOne(const std::string& address)
+{
+	const HostEntry& entry = hostByName(address);
+	if (!entry.addresses().empty())
+		return entry.addresses()[0];
+	else
+		throw NoAddressFoundException(address);
+}
+
+
+void DNSResolver::setTTL(const Poco::Timespan& ttl)
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	_ttl = ttl;
+}
+
+
+Poco::Timespan DNSResolver::getTTL() const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	return _ttl;
+}
+
+
+void DNSResolver::setNegativeTTL(const Poco::Timespan& ttl)
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	_negativeTTL = ttl;
+}
+
+
+Poco::Timespan DNSResolver::getNegativeTTL() const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	return _negativeTTL;
+}
+
+
+std::size_t DNSResolver::size() const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	return _entries.size();
+}
+
+
+void DNSResolver::purge()
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	Timestamp now;
+	EntryMap::iterator it = _entries.begin();
+	while (it != _entries.end())
+	{
+		if (!it->second.pending && it->second.expires <= now)
+			remove(it++);
+		else
+			++it;
+	}
+}
+
+
+void DNSResolver::clear()
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	EntryMap::iterator it = _entries.begin();
+	while (it != _entries.end())
+	{
+		if (!it->second.pending)
+			remove(it++);
+		else
+			++it;
+	}
+}
+
+
+namespace
+{
+	static Poco::SingletonHolder<DNSResolver> sh;
+}
+
+
+DNSResolver& DNSResolver::defaultResolver()
+{
+	return *sh.get();
+}
+
+
+HostEntry DNSResolver::lookup(const std::string& hostname, unsigned hintFlags)
+{
+	return DNS::hostByName(hostname, hintFlags);
+}
+
+
+void DNSResolver::run()
+{
+	for (;;)
+	{
+		AutoPtr<Poco::Notification> pNf(_queue.waitDequeueNotification());
+		LookupNotification* pLookup = dynamic_cast<LookupNotification*>(pNf.get());
+		if (!pLookup) break;
+
+		Result& result = pLookup->result();
+		bool succeeded = false;
+		bool cacheable = false;
+		try
+		{
+			result.data(new HostEntry(lookup(pLookup->hostname(), pLookup->hintFlags())));
+			succeeded = true;
+			cacheable = true;
+		}
+		catch (HostNotFoundException& exc)
+		{
+			result.error(exc);
+			cacheable = true;
+		}
+		catch (NoAddressFoundException& exc)
+		{
+			result.error(exc);
+			cacheable = true;
+		}
+		catch (Poco::Exception& exc)
+		{
+			result.error(exc);
+		}
+		catch (std::exception& exc)
+		{
+			result.error(exc.what());
+		}
+		catch (...)
+		{
+			result.error("unknown exception");
+		}
+		complete(pLookup->key(), pLookup->serial(), succeeded, cacheable);
+		result.notify();
+	}
+}
+
+
+void DNSResolver::complete(const std::string& key, Poco::UInt64 serial, bool succeeded, bool cacheable)
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	// The entry may have been evicted, and possibly
+	// replaced by a newer lookup, in the meantime.
+	EntryMap::iterator it = _entries.find(key);
+	if (it == _entries.end() || it->second.serial != serial) return;
+
+	Timespan ttl = succeeded ? _ttl : _negativeTTL;
+	if (cacheable && ttl > 0)
+	{
+		it->second.pending = false;
+		it->second.expires = Timestamp() + ttl.totalMicroseconds();
+	}
+	else remove(it);
+}
+
+
+void DNSResolver::remove(EntryMap::iterator it)
+{
+	_lru.erase(it->second.lru);
+	_entries.erase(it);
+}
+
+
+std::string DNSResolver::keyFor(const std::string& hostname, unsigned hintFlags)
+{
+	std::string key;
+	NumberFormatter::appendHex(key, hintFlags);
+	key += ':';
+	key += Poco::toLower(hostname);
+	return key;
+}
+
+
+} } // namespace Poco::Net
@@ -15,6 +15,9 @@
 #include "Poco/Net/DatagramSocket.h"
 #include "Poco/Net/DatagramSocketImpl.h"
 #include "Poco/Exception.h"
+#if POCO_OS == POCO_OS_LINUX
+#include <netinet/udp.h>
+#endif
 
 
 using Poco::InvalidArgumentException;
@@ -153,4 +156,38 @@ int DatagramSocket::receiveFrom(SocketBufVec& buffers, struct sockaddr** ppSA, p
 }
 
 
+int DatagramSocket::sendMessages(SocketMessageVec& messages, int flags)
+{
+	return impl()->sendMessages(messages, flags);
+}
+
+
+int DatagramSocket::receiveMessages(SocketMessageVec& messages, int flags)
+{
+	return impl()->receiveMessages(messages, flags);
+}
+
+
+void DatagramSocket::setReceiveOffload(bool flag)
+{
+#if defined(UDP_GRO)
+	impl()->setOption(SOL_UDP, UDP_GRO, flag ? 1 : 0);
+#else
+	throw Poco::NotImplementedException("UDP receive offload");
+#endif
+}
+
+
+bool DatagramSocket::getReceiveOffload() const
+{
+#if defined(UDP_GRO)
+	int value = 0;
+	impl()->getOption(SOL_UDP, UDP_GRO, value);
+	return value != 0;
+#else
+	return false;
+#endif
+}
+
+
 } } // namespace Poco::Net
@@ -90,23 +90,13 @@ void HTTPBasicCredentials::setPassword(const std::string& password)
 
 void HTTPBasicCredentials::authenticate(HTTPRequest& request) const
 {
-	std::ostringstream ostr;
-	Base64Encoder encoder(ostr);
-	encoder.rdbuf()->setLineLength(0);
-	encoder << _username << ":" << _password;
-	encoder.close();
-	request.setCredentials(SCHEME, ostr.str());
+	request.setCredentials(SCHEME, Base64Encoder::encode(_username + ":" + _password));
 }
 
 
 void HTTPBasicCredentials::proxyAuthenticate(HTTPRequest& request) const
 {
-	std::ostringstream ostr;
-	Base64Encoder encoder(ostr);
-	encoder.rdbuf()->setLineLength(0);
-	encoder << _username << ":" << _password;
-	encoder.close();
-	request.setProxyCredentials(SCHEME, ostr.str());
+	request.setProxyCredentials(SCHEME, Base64Encoder::encode(_username + ":" + _password));
 }
 
 
@@ -0,0 +1,349 @@
+//
+// HTTPClientSessionPool.cpp
+//
+// Library: Net
+// Package: HTTPClient
+// Module:  HTTPClientSessionPool
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/HTTPClientSessionPool.h"
+#include "Poco/Net/Socket.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/Exception.h"
+
+
+using Poco::FastMutex;
+using Poco::Timespan;
+using Poco::Timestamp;
+
+
+namespace Poco {
+namespace Net {
+
+
+//
+// HTTPClientSessionPool::PooledSession
+//
+
+
+HTTPClientSessionPool::PooledSession::PooledSession():
+	_pPool(0),
+	_pSession(0)
+{
+}
+
+
+HTTPClientSessionPool::PooledSession::PooledSession(HTTPClientSessionPool* pPool, const std::string& key, HTTPClientSession* pSession):
+	_pPool(pPool),
+	_key(key),
+	_pSession(pSession)
+{
+}
+
+
+HTTPClientSessionPool::PooledSession::PooledSession(PooledSession&& other) noexcept:
+	_pPool(other._pPool),
+	_key(std::move(other._key)),
+	_pSession(other._pSession)
+{
+	other._pPool = 0;
+	other._pSession = 0;
+}
+
+
+HTTPClientSessionPool::PooledSession::~PooledSession()
+{
+	try
+	{
+		release();
+	}
+	catch (...)
+	{
+		poco_unexpected();
+	}
+}
+
+
+HTTPClientSessionPool::PooledSession& HTTPClientSessionPool::PooledSession::operator = (PooledSession&& other) noexcept
+{
+	if (&other != this)
+	{
+		try
+		{
+			release();
+		}
+		catch (...)
+		{
+			poco_unexpected();
+		}
+		_pPool = other._pPool;
+		_key = std::move(other._key);
+		_pSession = other._pSession;
+		other._pPool = 0;
+		other._pSession = 0;
+	}
+	return *this;
+}
+
+
+void HTTPClientSessionPool::PooledSession::release()
+{
+	if (_pSession)
+	{
+		HTTPClientSession* pSession = _pSession;
+		_pSession = 0;
+		_pPool->putBack(_key, pSession);
+	}
+}
+
+
+//
+// HTTPClientSessionPool
+//
+
+
+HTTPClientSessionPool::HTTPClientSessionPool(std::size_t maxPerHost, const Poco::Timespan& idleTimeout):
+	_factory(HTTPSessionFactory::defaultFactory()),
+	_maxPerHost(maxPerHost),
+	_idleTimeout(idleTimeout),
+	_waitTimeout(30, 0),
+	_used(0),
+	_idle(0),
+	_shutdown(false)
+{
+	poco_assert (maxPerHost > 0);
+}
+
+
+HTTPClientSessionPool::HTTPClientSessionPool(HTTPSessionFactory& factory, std::size_t maxPerHost, const Poco::Timespan& idleTimeout):
+	_factory(factory),
+	_maxPerHost(maxPerHost),
+	_idleTimeout(idleTimeout),
+	_waitTimeout(30, 0),
+	_used(0),
+	_idle(0),
+	_shutdown(false)
+{
+	poco_assert (maxPerHost > 0);
+}
+
+
+HTTPClientSessionPool::~HTTPClientSessionPool()
+{
+	try
+	{
+		shutdown();
+	}
+	catch (...)
+	{
+		poco_unexpected();
+	}
+}
+
+
+HTTPClientSessionPool::PooledSession HTTPClientSessionPool::get(const Poco::URI& uri)
+{
+	std::string key = keyFor(uri);
+
+	{
+		FastMutex::ScopedLock lock(_mutex);
+
+		Timestamp start;
+		for (;;)
+		{
+			if (_shutdown) throw InvalidAccessException("HTTPClientSessionPool has been shut down");
+
+			HostPool& host = _hosts[key];
+			Timestamp now;
+			purge(host, now);
+			if (!host.idle.empty())
+			{
+				// Most recently used session first; its connection
+				// is the least likely one to have been closed.
+				HTTPClientSession* pSession = host.idle.back().pSession;
+				host.idle.pop_back();
+				--_idle;
+				++host.used;
+				++_used;
+				if (!isReusable(*pSession)) pSession->reset();
+				return PooledSession(this, key, pSession);
+			}
+			if (host.used < _maxPerHost)
+			{
+				++host.used;
+				++_used;
+				break;
+			}
+
+			Timespan remaining = _waitTimeout - (now - start);
+			if (remaining <= 0 || !_available.tryWait(_mutex, static_cast<long>(remaining.totalMilliseconds())))
+				throw TimeoutException("No HTTPClientSession available", key);
+		}
+	}
+
+	try
+	{
+		HTTPClientSession* pSession = _factory.createClientSession(uri);
+		pSession->setKeepAlive(true);
+		return PooledSession(this, key, pSession);
+	}
+	catch (...)
+	{
+		FastMutex::ScopedLock lock(_mutex);
+		--_hosts[key].used;
+		--_used;
+		_available.broadcast();
+		throw;
+	}
+}
+
+
+void HTTPClientSessionPool::setWaitTimeout(const Poco::Timespan& timeout)
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	_waitTimeout = timeout;
+}
+
+
+Poco::Timespan HTTPClientSessionPool::getWaitTimeout() const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	return _waitTimeout;
+}
+
+
+std::size_t HTTPClientSessionPool::used() const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	return _used;
+}
+
+
+std::size_t HTTPClientSessionPool::idle() const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	return _idle;
+}
+
+
+void HTTPClientSessionPool::purge()
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	Timestamp now;
+	HostMap::iterator it = _hosts.begin();
+	while (it != _hosts.end())
+	{
+		purge(it->second, now);
+		if (it->second.idle.empty() && it->second.used == 0)
+			_hosts.erase(it++);
+		else
+			++it;
+	}
+}
+
+
+void HTTPClientSessionPool::shutdown()
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	_shutdown = true;
+	for (HostMap::iterator it = _hosts.begin(); it != _hosts.end(); ++it)
+	{
+		for (IdleVec::iterator itIdle = it->second.idle.begin(); itIdle != it->second.idle.end(); ++itIdle)
+		{
+			delete itIdle->pSession;
+		}
+		it->second.idle.clear();
+	}
+	_idle = 0;
+	_available.broadcast();
+}
+
+
+void HTTPClientSessionPool::putBack(const std::string& key, HTTPClientSession* pSession)
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	HostPool& host = _hosts[key];
+	poco_assert (host.used > 0);
+	--host.used;
+	--_used;
+	if (_shutdown)
+	{
+		delete pSession;
+	}
+	else
+	{
+		if (pSession->networkException()) pSession->reset();
+		IdleSession idleSession;
+		idleSession.pSession = pSession;
+		host.idle.push_back(idleSession);
+		++_idle;
+		purge(host, idleSession.lastUsed);
+	}
+	_available.broadcast();
+}
+
+
+std::string HTTPClientSessionPool::keyFor(const Poco::URI& uri) const
+{
+	std::string key(uri.getScheme());
+	key += "://";
+	key += uri.getHost();
+	key += ':';
+	NumberFormatter::append(key, uri.getPort());
+	if (!_factory.proxyHost().empty())
+	{
+		key += '|';
+		key += _factory.proxyHost();
+		key += ':';
+		NumberFormatter::append(key, _factory.proxyPort());
+	}
+	return key;
+}
+
+
+bool HTTPClientSessionPool::isReusable(HTTPClientSession& session)
+{
+	if (!session.connected()) return true;
+	if (session.buffered() > 0 || session.networkException()) return false;
+	try
+	{
+		// An idle connection must neither be readable (data or
+		// connection closed by the server) nor in an error state.
+		return !session.socket().poll(Timespan(0), Socket::SELECT_READ | Socket::SELECT_ERROR);
+	}
+	catch (Poco::Exception&)
+	{
+		return false;
+	}
+}
+
+
+void HTTPClientSessionPool::purge(HostPool& host, const Poco::Timestamp& now)
+{
+	// Idle sessions are kept in the order they were returned,
+	// so expired sessions are at the beginning.
+	IdleVec::iterator it = host.idle.begin();
+	while (it != host.idle.end() && now - it->lastUsed >= _idleTimeout.totalMicroseconds())
+	{
+		delete it->pSession;
+		--_idle;
+		++it;
+	}
+	host.idle.erase(host.idle.begin(), it);
+}
+
+
+} } // namespace Poco::Net
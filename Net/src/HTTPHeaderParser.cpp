@@ -0,0 +1,173 @@
+//
+// HTTPHeaderParser.cpp
+//
+// Library: Net
+// Package: HTTP
+// Module:  HTTPHeaderParser
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/HTTPHeaderParser.h"
+#include "Poco/Ascii.h"
+#include <cstring>
+
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define POCO_HTTP_HEADER_SSE2
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+
+namespace Poco {
+namespace Net {
+
+
+namespace
+{
+#if defined(POCO_HTTP_HEADER_SSE2)
+	inline unsigned firstBit(unsigned mask)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return static_cast<unsigned>(index);
+#else
+		return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+	}
+#endif
+
+	HTTPHeaderParser::Result nextLine(const char* begin, const char* end, const char*& lineEnd, const char*& next)
+		/// Finds the end of the line starting at begin.
+		/// A line is terminated by CRLF or by a single LF.
+		/// A CR not followed by LF is left to MessageHeader::read().
+	{
+		lineEnd = HTTPHeaderParser::findLineEnd(begin, end);
+		if (lineEnd == end) return HTTPHeaderParser::HEADER_INCOMPLETE;
+		if (*lineEnd == '\r')
+		{
+			if (lineEnd + 1 == end) return HTTPHeaderParser::HEADER_INCOMPLETE;
+			if (lineEnd[1] != '\n') return HTTPHeaderParser::HEADER_UNSUPPORTED;
+			next = lineEnd + 2;
+		}
+		else next = lineEnd + 1;
+		return HTTPHeaderParser::HEADER_COMPLETE;
+	}
+}
+
+
+HTTPHeaderParser::HTTPHeaderParser(int fieldLimit, bool fullStartLine):
+	_fieldLimit(fieldLimit),
+	_fullStartLine(fullStartLine),
+	_length(0)
+{
+	_fields.reserve(16);
+}
+
+
+HTTPHeaderParser::~HTTPHeaderParser()
+{
+}
+
+
+HTTPHeaderParser::Result HTTPHeaderParser::parse(const char* begin, const char* end)
+{
+	reset();
+
+	const char* it = begin;
+	while (it != end && Poco::Ascii::isSpace(*it)) ++it;
+	if (it == end) return HEADER_INCOMPLETE;
+
+	const char* lineEnd;
+	const char* next;
+	Result result = nextLine(it, end, lineEnd, next);
+	if (result != HEADER_COMPLETE) return result;
+
+	const char* tokenEnd = it;
+	while (tokenEnd != lineEnd && !Poco::Ascii::isSpace(*tokenEnd)) ++tokenEnd;
+	_tokens[0] = Slice(it, tokenEnd - it);
+	it = tokenEnd;
+	while (it != lineEnd && Poco::Ascii::isSpace(*it)) ++it;
+	tokenEnd = it;
+	while (tokenEnd != lineEnd && !Poco::Ascii::isSpace(*tokenEnd)) ++tokenEnd;
+	_tokens[1] = Slice(it, tokenEnd - it);
+	if (_tokens[1].empty()) return HEADER_UNSUPPORTED;
+	it = tokenEnd;
+	while (it != lineEnd && Poco::Ascii::isSpace(*it)) ++it;
+	_tokens[2] = Slice(it, lineEnd - it);
+	if (_tokens[2].empty() && _fullStartLine) return HEADER_UNSUPPORTED;
+
+	it = next;
+	for (;;)
+	{
+		result = nextLine(it, end, lineEnd, next);
+		if (result != HEADER_COMPLETE) return result;
+		if (lineEnd == it)
+		{
+			_length = next - begin;
+			return HEADER_COMPLETE;
+		}
+		if (*it == ' ' || *it == '\t') return HEADER_UNSUPPORTED; // folding
+		if (_fieldLimit > 0 && _fields.size() == static_cast<std::size_t>(_fieldLimit)) return HEADER_UNSUPPORTED;
+
+		const char* colon = static_cast<const char*>(std::memchr(it, ':', lineEnd - it));
+		if (!colon)
+		{
+			// MessageHeader::read() ignores short lines without a colon
+			if (next - 1 - it > MAX_NAME_LENGTH) return HEADER_UNSUPPORTED;
+			it = next;
+			continue;
+		}
+		if (colon - it > MAX_NAME_LENGTH) return HEADER_UNSUPPORTED;
+
+		const char* value = colon + 1;
+		while (value != lineEnd && Poco::Ascii::isSpace(*value)) ++value;
+		if (lineEnd - value > MAX_VALUE_LENGTH) return HEADER_UNSUPPORTED;
+		const char* valueEnd = lineEnd;
+		while (valueEnd != value && Poco::Ascii::isSpace(valueEnd[-1])) --valueEnd;
+
+		Field field;
+		field.name  = Slice(it, colon - it);
+		field.value = Slice(value, valueEnd - value);
+		_fields.push_back(field);
+		it = next;
+	}
+}
+
+
+void HTTPHeaderParser::reset()
+{
+	for (int i = 0; i < 3; i++) _tokens[i] = Slice();
+	_fields.clear();
+	_length = 0;
+}
+
+
+const char* HTTPHeaderParser::findLineEnd(const char* begin, const char* end)
+{
+	const char* it = begin;
+#if defined(POCO_HTTP_HEADER_SSE2)
+	const __m128i cr = _mm_set1_epi8('\r');
+	const __m128i lf = _mm_set1_epi8('\n');
+	while (end - it >= 16)
+	{
+		__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+		unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, cr), _mm_cmpeq_epi8(chunk, lf))));
+		if (mask) return it + firstBit(mask);
+		it += 16;
+	}
+#endif
+	while (it != end && *it != '\r' && *it != '\n') ++it;
+	return it;
+}
+
+
+} } // namespace Poco::Net
@@ -14,6 +14,9 @@
 
 #include "Poco/Net/HTTPHeaderStream.h"
 #include "Poco/Net/HTTPSession.h"
+#include "Poco/Net/HTTPHeaderParser.h"
+#include "Poco/Net/HTTPBufferAllocator.h"
+#include <cstring>
 
 
 namespace Poco {
@@ -38,6 +41,44 @@ HTTPHeaderStreamBuf::~HTTPHeaderStreamBuf()
 }
 
 
+bool HTTPHeaderStreamBuf::readHeader(HTTPHeaderParser& parser)
+{
+	if (_end || gptr() != egptr()) return false;
+
+	if (_session._pCurrent == _session._pEnd)
+		_session.refill();
+
+	for (;;)
+	{
+		HTTPHeaderParser::Result result = parser.parse(_session._pCurrent, _session._pEnd);
+		if (result == HTTPHeaderParser::HEADER_COMPLETE)
+		{
+			_session._pCurrent += parser.length();
+			_end = true;
+			return true;
+		}
+		else if (result == HTTPHeaderParser::HEADER_UNSUPPORTED)
+		{
+			return false;
+		}
+
+		// Header incomplete: move the partial header to the
+		// beginning of the buffer and receive the rest.
+		std::size_t n = static_cast<std::size_t>(_session._pEnd - _session._pCurrent);
+		if (n == 0 || n == HTTPBufferAllocator::BUFFER_SIZE) return false;
+		if (_session._pCurrent != _session._pBuffer)
+		{
+			std::memmove(_session._pBuffer, _session._pCurrent, n);
+			_session._pCurrent = _session._pBuffer;
+			_session._pEnd = _session._pBuffer + n;
+		}
+		int rc = _session.receive(_session._pEnd, static_cast<int>(HTTPBufferAllocator::BUFFER_SIZE - n));
+		if (rc <= 0) return false;
+		_session._pEnd += rc;
+	}
+}
+
+
 int HTTPHeaderStreamBuf::readFromDevice(char* buffer, std::streamsize length)
 {
 	// read line-by-line; an empty line denotes the end of the headers.
@@ -14,6 +14,7 @@
 
 #include "Poco/Net/HTTPMessage.h"
 #include "Poco/Net/MediaType.h"
+#include "Poco/Net/HTTPHeaderParser.h"
 #include "Poco/NumberFormatter.h"
 #include "Poco/NumberParser.h"
 #include "Poco/String.h"
@@ -200,4 +201,18 @@ bool HTTPMessage::getKeepAlive() const
 }
 
 
+void HTTPMessage::addFields(const HTTPHeaderParser& parser)
+{
+	const HTTPHeaderParser::FieldVec& fields = parser.fields();
+	for (HTTPHeaderParser::FieldVec::const_iterator it = fields.begin(); it != fields.end(); ++it)
+	{
+		std::string value(it->value.data(), it->value.size());
+		if (value.find("=?") != std::string::npos)
+			add(it->name.str(), decodeWord(value));
+		else
+			add(it->name.str(), std::move(value));
+	}
+}
+
+
 } } // namespace Poco::Net
@@ -0,0 +1,632 @@
+//
+// HTTPReactorServer.cpp
+//
+// Library: Net
+// Package: HTTPServer
+// Module:  HTTPReactorServer
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/HTTPReactorServer.h"
+#include "Poco/Net/HTTPServerSession.h"
+#include "Poco/Net/HTTPServerRequestImpl.h"
+#include "Poco/Net/HTTPServerResponseImpl.h"
+#include "Poco/Net/HTTPRequestHandler.h"
+#include "Poco/Net/HTTPBufferAllocator.h"
+#include "Poco/Net/SocketReactor.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/NObserver.h"
+#include "Poco/Observer.h"
+#include "Poco/RefCountedObject.h"
+#include "Poco/ErrorHandler.h"
+#include "Poco/Timestamp.h"
+#include "Poco/Clock.h"
+#include <memory>
+#include <vector>
+#include <cstring>
+
+
+using Poco::ErrorHandler;
+
+
+namespace Poco {
+namespace Net {
+
+
+class HTTPReactorServerConnection: public Poco::RefCountedObject, public Poco::TimingWheel::Entry
+	/// The state of a connection accepted by a HTTPReactorServer.
+	///
+	/// While the connection is idle, it is registered with the
+	/// reactor, which reads the next request header into the
+	/// connection's buffer. The buffer is only allocated while
+	/// a partial request header has been received.
+{
+public:
+	typedef Poco::AutoPtr<HTTPReactorServerConnection> Ptr;
+
+	HTTPReactorServerConnection(HTTPReactorServer& server, const StreamSocket& socket):
+		_server(server),
+		_socket(socket),
+		_pBuffer(0),
+		_length(0),
+		_requests(0),
+		_idle(false)
+	{
+	}
+
+	~HTTPReactorServerConnection()
+	{
+		releaseBuffer();
+	}
+
+	void onReadable(const Poco::AutoPtr<ReadableNotification>&)
+	{
+		Ptr pThis(this, true);
+		int n = 0;
+		try
+		{
+			if (!_pBuffer) _pBuffer = HTTPBufferAllocator::allocate(HTTPBufferAllocator::BUFFER_SIZE);
+			n = _socket.receiveBytes(_pBuffer + _length, static_cast<int>(HTTPBufferAllocator::BUFFER_SIZE - _length));
+		}
+		catch (Poco::Exception&)
+		{
+		}
+		if (n > 0)
+		{
+			std::size_t offset = _length;
+			_length += n;
+			if (hasRequest(offset)) _server.dispatch(this);
+		}
+		else _server.close(this);
+	}
+
+	bool hasRequest(std::size_t offset = 0) const
+		/// Returns true if the buffer contains a complete
+		/// request header, or if the buffer is full.
+		/// Only data after the given offset, minus the
+		/// length of the terminating sequence, is searched.
+	{
+		if (_length == HTTPBufferAllocator::BUFFER_SIZE) return true;
+
+		std::size_t pos = offset > 2 ? offset - 2 : 0;
+		while (pos < _length)
+		{
+			const char* p = static_cast<const char*>(std::memchr(_pBuffer + pos, '\n', _length - pos));
+			if (!p) break;
+			pos = p - _pBuffer + 1;
+			if (pos < _length && _pBuffer[pos] == '\n') return true;
+			if (pos + 1 < _length && _pBuffer[pos] == '\r' && _pBuffer[pos + 1] == '\n') return true;
+		}
+		return false;
+	}
+
+	void transferTo(HTTPSession& session)
+		/// Moves the buffered data to the session.
+	{
+		if (_length > 0) session.fillBuffer(_pBuffer, _length);
+		releaseBuffer();
+	}
+
+	void transferFrom(const Poco::Buffer<char>& buffer)
+		/// Takes over the data left in the session's buffer.
+	{
+		if (buffer.size() > 0)
+		{
+			if (!_pBuffer) _pBuffer = HTTPBufferAllocator::allocate(HTTPBufferAllocator::BUFFER_SIZE);
+			std::memcpy(_pBuffer, buffer.begin(), buffer.size());
+			_length = buffer.size();
+		}
+		else releaseBuffer();
+	}
+
+	int nextRequest()
+		/// Increments and returns the number of requests
+		/// received on the connection.
+	{
+		return ++_requests;
+	}
+
+	StreamSocket& socket()
+	{
+		return _socket;
+	}
+
+private:
+	void releaseBuffer()
+	{
+		if (_pBuffer)
+		{
+			HTTPBufferAllocator::deallocate(_pBuffer, HTTPBufferAllocator::BUFFER_SIZE);
+			_pBuffer = 0;
+		}
+		_length = 0;
+	}
+
+	HTTPReactorServer& _server;
+	StreamSocket _socket;
+	char* _pBuffer;
+	std::size_t _length;
+	int _requests;
+	bool _idle;
+
+	friend class HTTPReactorServer;
+};
+
+
+typedef Poco::NObserver<HTTPReactorServerConnection, ReadableNotification> ConnectionObserver;
+typedef Poco::Observer<HTTPReactorServer, ReadableNotification> AcceptObserver;
+
+
+class HTTPReactorServerReactor: public SocketReactor
+	/// The SocketReactor used by HTTPReactorServer. Gives the
+	/// server the opportunity to close expired connections
+	/// in every iteration of the reactor loop.
+{
+public:
+	HTTPReactorServerReactor(HTTPReactorServer& server):
+		SocketReactor(Poco::Timespan(0, 100000)),
+		_server(server)
+	{
+	}
+
+protected:
+	void onBusy()
+	{
+		_server.onTick();
+	}
+
+	void onTimeout()
+	{
+		// Do not dispatch TimeoutNotifications to all connections.
+		_server.onTick();
+	}
+
+private:
+	HTTPReactorServer& _server;
+};
+
+
+class HTTPReactorConnectionNotification: public Poco::Notification
+{
+public:
+	HTTPReactorConnectionNotification(HTTPReactorServerConnection* pConnection):
+		_pConnection(pConnection, true)
+	{
+	}
+
+	HTTPReactorServerConnection* connection()
+	{
+		return _pConnection.get();
+	}
+
+private:
+	HTTPReactorServerConnection::Ptr _pConnection;
+};
+
+
+HTTPReactorServer::HTTPReactorServer(HTTPRequestHandlerFactory::Ptr pFactory, const ServerSocket& socket, HTTPServerParams::Ptr pParams):
+	_pFactory(pFactory),
+	_pParams(pParams),
+	_socket(socket),
+	_threadPool(Poco::ThreadPool::defaultPool()),
+	_pReactor(new HTTPReactorServerReactor(*this)),
+	_timeouts(100000),
+	_idleConnections(0),
+	_totalConnections(0),
+	_threads(0),
+	_activeThreads(0),
+	_started(false),
+	_stopped(false)
+{
+	poco_check_ptr (pFactory);
+	poco_check_ptr (pParams);
+}
+
+
+HTTPReactorServer::HTTPReactorServer(HTTPRequestHandlerFactory::Ptr pFactory, Poco::ThreadPool& threadPool, const ServerSocket& socket, HTTPServerParams::Ptr pParams):
+	_pFactory(pFactory),
+	_pParams(pParams),
+	_socket(socket),
+	_threadPool(threadPool),
+	_pReactor(new HTTPReactorServerReactor(*this)),
+	_timeouts(100000),
+	_idleConnections(0),
+	_totalConnections(0),
+	_threads(0),
+	_activeThreads(0),
+	_started(false),
+	_stopped(false)
+{
+	poco_check_ptr (pFactory);
+	poco_check_ptr (pParams);
+}
+
+
+HTTPReactorServer::~HTTPReactorServer()
+{
+	try
+	{
+		stop();
+	}
+	catch (...)
+	{
+		poco_unexpected();
+	}
+	delete _pReactor;
+}
+
+
+void HTTPReactorServer::start()
+{
+	poco_assert (!_started);
+
+	int threads = _pParams->getMaxThreads();
+	if (threads == 0) threads = _threadPool.capacity();
+	if (threads > _threadPool.available()) threads = _threadPool.available();
+	if (threads < 1) throw Poco::NoThreadAvailableException("No thread available for HTTPReactorServer");
+
+	_started = true;
+	_pReactor->addEventHandler(_socket, AcceptObserver(*this, &HTTPReactorServer::onAccept));
+	_reactorThread.start(*_pReactor);
+	for (int i = 0; i < threads; i++)
+	{
+		++_activeThreads;
+		try
+		{
+			_threadPool.start(*this);
+			++_threads;
+		}
+		catch (Poco::Exception&)
+		{
+			// The thread pool has been exhausted in the meantime.
+			--_activeThreads;
+			if (_threads > 0) break;
+			stop();
+			throw;
+		}
+	}
+}
+
+
+void HTTPReactorServer::stop()
+{
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		if (!_started || _stopped) return;
+		_stopped = true;
+	}
+
+	_pReactor->stop();
+	_reactorThread.join();
+	_pReactor->removeEventHandler(_socket, AcceptObserver(*this, &HTTPReactorServer::onAccept));
+
+	std::vector<ConnectionPtr> idle;
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		for (ConnectionMap::iterator it = _connections.begin(); it != _connections.end(); ++it)
+		{
+			if (it->first->_idle) idle.push_back(it->second);
+		}
+	}
+	for (std::vector<ConnectionPtr>::iterator it = idle.begin(); it != idle.end(); ++it)
+	{
+		close(*it);
+	}
+
+	for (int i = 0; i < _threads; i++)
+	{
+		// Any other kind of notification stops a worker thread.
+		_queue.enqueueNotification(new Poco::Notification);
+	}
+	if (_threads > 0) _threadsDone.wait();
+}
+
+
+void HTTPReactorServer::stopAll(bool abortCurrent)
+{
+	if (abortCurrent)
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		for (ConnectionMap::iterator it = _connections.begin(); it != _connections.end(); ++it)
+		{
+			if (!it->first->_idle)
+			{
+				try
+				{
+					// Note: On Windows, select() will not return if one of its socket is being
+					// shut down. Therefore we have to call close(), which works better.
+					// On other platforms, we do the more graceful thing.
+#if defined(_WIN32)
+					it->first->socket().close();
+#else
+					it->first->socket().shutdown();
+#endif
+				}
+				catch (...)
+				{
+				}
+			}
+		}
+	}
+	_pFactory->serverStopped(this, abortCurrent);
+	stop();
+}
+
+
+Poco::UInt16 HTTPReactorServer::port() const
+{
+	return _socket.address().port();
+}
+
+
+int HTTPReactorServer::currentConnections() const
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+
+	return static_cast<int>(_connections.size());
+}
+
+
+int HTTPReactorServer::idleConnections() const
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+
+	return _idleConnections;
+}
+
+
+int HTTPReactorServer::totalConnections() const
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+
+	return _totalConnections;
+}
+
+
+int HTTPReactorServer::currentThreads() const
+{
+	return _threads;
+}
+
+
+void HTTPReactorServer::run()
+{
+	Poco::Buffer<char> buffer(0);
+	for (;;)
+	{
+		Poco::AutoPtr<Poco::Notification> pNf = _queue.waitDequeueNotification();
+		HTTPReactorConnectionNotification* pCNf = dynamic_cast<HTTPReactorConnectionNotification*>(pNf.get());
+		if (!pCNf) break;
+		handleConnection(pCNf->connection(), buffer);
+	}
+	if (--_activeThreads == 0) _threadsDone.set();
+}
+
+
+void HTTPReactorServer::onAccept(ReadableNotification* pNotification)
+{
+	pNotification->release();
+
+	StreamSocket socket = _socket.acceptConnection();
+	ConnectionPtr pConnection = new HTTPReactorServerConnection(*this, socket);
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		if (_stopped) return;
+		_connections[pConnection.get()] = pConnection;
+		++_totalConnections;
+	}
+	park(pConnection, _pParams->getTimeout());
+}
+
+
+void HTTPReactorServer::onTick()
+{
+	Poco::TimingWheel::EntryVec expired;
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		_timeouts.advance(Poco::Clock(), expired);
+	}
+	for (Poco::TimingWheel::EntryVec::iterator it = expired.begin(); it != expired.end(); ++it)
+	{
+		close(static_cast<HTTPReactorServerConnection*>(*it));
+	}
+}
+
+
+void HTTPReactorServer::park(HTTPReactorServerConnection* pConnection, const Poco::Timespan& timeout)
+{
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		if (!_stopped)
+		{
+			try
+			{
+				_pReactor->addEventHandler(pConnection->socket(), ConnectionObserver(*pConnection, &HTTPReactorServerConnection::onReadable));
+				Poco::Clock deadline;
+				deadline += timeout.totalMicroseconds();
+				_timeouts.schedule(*pConnection, deadline);
+				pConnection->_idle = true;
+				++_idleConnections;
+				return;
+			}
+			catch (Poco::Exception& exc)
+			{
+				ErrorHandler::handle(exc);
+			}
+		}
+	}
+	close(pConnection);
+}
+
+
+void HTTPReactorServer::dispatch(HTTPReactorServerConnection* pConnection)
+{
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		_timeouts.cancel(*pConnection);
+		pConnection->_idle = false;
+		--_idleConnections;
+	}
+	_pReactor->removeEventHandler(pConnection->socket(), ConnectionObserver(*pConnection, &HTTPReactorServerConnection::onReadable));
+	_queue.enqueueNotification(new HTTPReactorConnectionNotification(pConnection));
+}
+
+
+void HTTPReactorServer::close(HTTPReactorServerConnection* pConnection)
+{
+	ConnectionPtr pKeepAlive(pConnection, true);
+	bool idle = false;
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		if (pConnection->_idle)
+		{
+			_timeouts.cancel(*pConnection);
+			pConnection->_idle = false;
+			--_idleConnections;
+			idle = true;
+		}
+		_connections.erase(pConnection);
+	}
+	if (idle)
+	{
+		_pReactor->removeEventHandler(pConnection->socket(), ConnectionObserver(*pConnection, &HTTPReactorServerConnection::onReadable));
+	}
+	try
+	{
+		pConnection->socket().close();
+	}
+	catch (...)
+	{
+	}
+}
+
+
+void HTTPReactorServer::handleConnection(HTTPReactorServerConnection* pConnection, Poco::Buffer<char>& buffer)
+{
+	bool keepAlive = false;
+	if (!_stopped)
+	{
+		try
+		{
+			HTTPServerSession session(pConnection->socket(), _pParams);
+			do
+			{
+				pConnection->transferTo(session);
+				keepAlive = handleRequest(session, *pConnection);
+				session.drainBuffer(buffer);
+				pConnection->transferFrom(buffer);
+			}
+			while (keepAlive && !_stopped && pConnection->hasRequest());
+			session.detachSocket();
+		}
+		catch (Poco::Exception& exc)
+		{
+			keepAlive = false;
+			ErrorHandler::handle(exc);
+		}
+		catch (std::exception& exc)
+		{
+			keepAlive = false;
+			ErrorHandler::handle(exc);
+		}
+		catch (...)
+		{
+			keepAlive = false;
+			ErrorHandler::handle();
+		}
+	}
+	if (keepAlive && !_stopped)
+		park(pConnection, _pParams->getKeepAliveTimeout());
+	else
+		close(pConnection);
+}
+
+
+bool HTTPReactorServer::handleRequest(HTTPServerSession& session, HTTPReactorServerConnection& connection)
+{
+	int maxRequests = _pParams->getMaxKeepAliveRequests();
+	bool canKeepAlive = maxRequests <= 0 || connection.nextRequest() < maxRequests;
+	try
+	{
+		HTTPServerResponseImpl response(session);
+		HTTPServerRequestImpl request(response, session, _pParams);
+
+		Poco::Timestamp now;
+		response.setDate(now);
+		response.setVersion(request.getVersion());
+		response.setKeepAlive(_pParams->getKeepAlive() && request.getKeepAlive() && canKeepAlive);
+		const std::string& server = _pParams->getSoftwareVersion();
+		if (!server.empty())
+			response.set("Server", server);
+		try
+		{
+			std::unique_ptr<HTTPRequestHandler> pHandler(_pFactory->createRequestHandler(request));
+			if (pHandler.get())
+			{
+				if (request.getExpectContinue() && response.getStatus() == HTTPResponse::HTTP_OK)
+					response.sendContinue();
+
+				pHandler->handleRequest(request, response);
+				return _pParams->getKeepAlive() && response.getKeepAlive() && canKeepAlive;
+			}
+			else sendErrorResponse(session, HTTPResponse::HTTP_NOT_IMPLEMENTED);
+		}
+		catch (Poco::Exception&)
+		{
+			if (!response.sent())
+			{
+				try
+				{
+					sendErrorResponse(session, HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
+				}
+				catch (...)
+				{
+				}
+			}
+			throw;
+		}
+	}
+	catch (NoMessageException&)
+	{
+	}
+	catch (MessageException&)
+	{
+		sendErrorResponse(session, HTTPResponse::HTTP_BAD_REQUEST);
+	}
+	catch (Poco::Exception&)
+	{
+		if (session.networkException())
+		{
+			session.networkException()->rethrow();
+		}
+		else throw;
+	}
+	return false;
+}
+
+
+void HTTPReactorServer::sendErrorResponse(HTTPServerSession& session, HTTPResponse::HTTPStatus status)
+{
+	HTTPServerResponseImpl response(session);
+	response.setVersion(HTTPMessage::HTTP_1_1);
+	response.setStatusAndReason(status);
+	response.setKeepAlive(false);
+	response.send();
+	session.setKeepAlive(false);
+}
+
+
+} } // namespace Poco::Net
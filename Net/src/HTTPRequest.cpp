@@ -13,6 +13,8 @@
 
 
 #include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPHeaderParser.h"
+#include "Poco/Net/HTTPHeaderStream.h"
 #include "Poco/Net/NetException.h"
 #include "Poco/Net/NameValueCollection.h"
 #include "Poco/NumberFormatter.h"
@@ -234,6 +236,17 @@ void HTTPRequest::read(std::istream& istr)
 {
 	static const int eof = std::char_traits<char>::eof();
 
+	HTTPHeaderStreamBuf* pBuf = dynamic_cast<HTTPHeaderStreamBuf*>(istr.rdbuf());
+	if (pBuf)
+	{
+		HTTPHeaderParser parser(getFieldLimit(), true);
+		if (pBuf->readHeader(parser))
+		{
+			read(parser);
+			return;
+		}
+	}
+
 	std::string method;
 	std::string uri;
 	std::string version;
@@ -263,6 +276,23 @@ void HTTPRequest::read(std::istream& istr)
 }
 
 
+void HTTPRequest::read(const HTTPHeaderParser& parser)
+{
+	const HTTPHeaderParser::Slice& method = parser.token(0);
+	const HTTPHeaderParser::Slice& uri = parser.token(1);
+	const HTTPHeaderParser::Slice& rest = parser.token(2);
+	if (method.empty() || method.size() > MAX_METHOD_LENGTH) throw MessageException("HTTP request method invalid or too long");
+	if (uri.size() > MAX_URI_LENGTH) throw MessageException("HTTP request URI invalid or too long");
+	std::size_t versionLength = 0;
+	while (versionLength < rest.size() && !Poco::Ascii::isSpace(rest.data()[versionLength])) ++versionLength;
+	if (versionLength == 0 || versionLength > MAX_VERSION_LENGTH) throw MessageException("Invalid HTTP version string");
+	addFields(parser);
+	setMethod(method.str());
+	setURI(uri.str());
+	setVersion(std::string(rest.data(), versionLength));
+}
+
+
 void HTTPRequest::getCredentials(const std::string& header, std::string& scheme, std::string& authInfo) const
 {
 	scheme.clear();
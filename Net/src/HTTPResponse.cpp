@@ -13,6 +13,8 @@
 
 
 #include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/HTTPHeaderParser.h"
+#include "Poco/Net/HTTPHeaderStream.h"
 #include "Poco/Net/NetException.h"
 #include "Poco/NumberFormatter.h"
 #include "Poco/NumberParser.h"
@@ -242,6 +244,17 @@ void HTTPResponse::read(std::istream& istr)
 {
 	static const int eof = std::char_traits<char>::eof();
 
+	HTTPHeaderStreamBuf* pBuf = dynamic_cast<HTTPHeaderStreamBuf*>(istr.rdbuf());
+	if (pBuf)
+	{
+		HTTPHeaderParser parser(getFieldLimit());
+		if (pBuf->readHeader(parser))
+		{
+			read(parser);
+			return;
+		}
+	}
+
 	std::string version;
 	std::string status;
 	std::string reason;
@@ -271,6 +284,21 @@ void HTTPResponse::read(std::istream& istr)
 }
 
 
+void HTTPResponse::read(const HTTPHeaderParser& parser)
+{
+	const HTTPHeaderParser::Slice& version = parser.token(0);
+	const HTTPHeaderParser::Slice& status = parser.token(1);
+	const HTTPHeaderParser::Slice& reason = parser.token(2);
+	if (version.empty() || version.size() > MAX_VERSION_LENGTH) throw MessageException("Invalid HTTP version string");
+	if (status.size() > MAX_STATUS_LENGTH) throw MessageException("Invalid HTTP status code");
+	if (reason.size() > MAX_REASON_LENGTH) throw MessageException("HTTP reason string too long");
+	addFields(parser);
+	setVersion(version.str());
+	setStatus(status.str());
+	setReason(reason.str());
+}
+
+
 const std::string& HTTPResponse::getReasonForStatus(HTTPStatus status)
 {
 	switch (status)
@@ -13,6 +13,22 @@
 
 
 #include "Poco/Net/HTTPServerResponse.h"
+#include "Poco/File.h"
+#include "Poco/FileStream.h"
+#include "Poco/Buffer.h"
+#include "Poco/DateTimeFormatter.h"
+#include "Poco/DateTimeFormat.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/Exception.h"
+
+
+using Poco::File;
+using Poco::Timestamp;
+using Poco::DateTimeFormatter;
+using Poco::DateTimeFormat;
+using Poco::NumberFormatter;
+using Poco::RangeException;
+using Poco::OpenFileException;
 
 
 namespace Poco {
@@ -29,4 +45,56 @@ HTTPServerResponse::~HTTPServerResponse()
 }
 
 
+void HTTPServerResponse::sendFile(const std::string& path, const std::string& mediaType, Poco::UInt64 offset, Poco::UInt64 length)
+{
+	poco_assert (!sent());
+
+	File f(path);
+	Timestamp dateTime    = f.getLastModified();
+	File::FileSize size   = f.getSize();
+	if (length == 0 || offset >= size || length > size - offset)
+		throw RangeException("Invalid range for file", path);
+
+	std::string range("bytes ");
+	NumberFormatter::append(range, offset);
+	range += '-';
+	NumberFormatter::append(range, offset + length - 1);
+	range += '/';
+	NumberFormatter::append(range, size);
+
+	setStatusAndReason(HTTP_PARTIAL_CONTENT);
+	set("Content-Range", range);
+	set("Last-Modified", DateTimeFormatter::format(dateTime, DateTimeFormat::HTTP_FORMAT));
+#if defined(POCO_HAVE_INT64)
+	setContentLength64(length);
+#else
+	setContentLength(static_cast<int>(length));
+#endif
+	setContentType(mediaType);
+	setChunkedTransferEncoding(false);
+
+	sendFileContent(path, offset, length);
+}
+
+
+void HTTPServerResponse::sendFileContent(const std::string& path, Poco::UInt64 offset, Poco::UInt64 length)
+{
+	Poco::FileInputStream istr(path);
+	if (!istr.good()) throw OpenFileException(path);
+	istr.seekg(static_cast<std::streamoff>(offset));
+
+	std::ostream& ostr = send();
+	Poco::Buffer<char> buffer(8192);
+	while (length > 0 && istr.good())
+	{
+		std::streamsize n = static_cast<std::streamsize>(length < buffer.size() ? length : buffer.size());
+		istr.read(buffer.begin(), n);
+		n = istr.gcount();
+		if (n <= 0) break;
+		ostr.write(buffer.begin(), n);
+		length -= static_cast<Poco::UInt64>(n);
+	}
+}
+
+
 } } // namespace Poco::Net
@@ -22,7 +22,6 @@
 #include "Poco/File.h"
 #include "Poco/Timestamp.h"
 #include "Poco/NumberFormatter.h"
-#include "Poco/StreamCopier.h"
 #include "Poco/CountingStream.h"
 #include "Poco/Exception.h"
 #include "Poco/FileStream.h"
@@ -33,7 +32,6 @@
 using Poco::File;
 using Poco::Timestamp;
 using Poco::NumberFormatter;
-using Poco::StreamCopier;
 using Poco::OpenFileException;
 using Poco::DateTimeFormatter;
 using Poco::DateTimeFormat;
@@ -121,6 +119,12 @@ void HTTPServerResponseImpl::sendFile(const std::string& path, const std::string
 	setContentType(mediaType);
 	setChunkedTransferEncoding(false);
 
+	sendFileContent(path, 0, length);
+}
+
+
+void HTTPServerResponseImpl::sendFileContent(const std::string& path, Poco::UInt64 offset, Poco::UInt64 length)
+{
 	Poco::FileInputStream istr(path);
 	if (istr.good())
 	{
@@ -128,7 +132,16 @@ void HTTPServerResponseImpl::sendFile(const std::string& path, const std::string
 		write(*_pStream);
 		if (_pRequest && _pRequest->getMethod() != HTTPRequest::HTTP_HEAD)
 		{
-			StreamCopier::copyStream(istr, *_pStream);
+			_pStream->flush();
+			// The Content-Length promises the whole range, so a
+			// short send must not silently truncate the body.
+			Poco::UInt64 sent = 0;
+			while (sent < length)
+			{
+				Poco::Int64 n = _session.socket().sendFile(istr, offset + sent, length - sent);
+				if (n <= 0) throw IOException("Cannot send file", path);
+				sent += static_cast<Poco::UInt64>(n);
+			}
 		}
 	}
 	else throw OpenFileException(path);
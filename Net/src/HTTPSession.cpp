@@ -258,4 +258,18 @@ void HTTPSession::drainBuffer(Poco::Buffer<char>& buffer)
 }
 
 
+void HTTPSession::fillBuffer(const char* buffer, std::size_t length)
+{
+	poco_assert (_pCurrent == _pEnd && length <= HTTPBufferAllocator::BUFFER_SIZE);
+
+	if (!_pBuffer)
+	{
+		_pBuffer = HTTPBufferAllocator::allocate(HTTPBufferAllocator::BUFFER_SIZE);
+	}
+	std::memcpy(_pBuffer, buffer, length);
+	_pCurrent = _pBuffer;
+	_pEnd = _pBuffer + length;
+}
+
+
 } } // namespace Poco::Net
@@ -86,9 +86,6 @@ HostEntry::HostEntry(struct addrinfo* ainfo)
 #endif // POCO_HAVE_IPv6
 
 
-#if defined(POCO_VXWORKS)
-
-
 HostEntry::HostEntry(const std::string& name, const IPAddress& addr):
 	_name(name)
 {
@@ -96,9 +93,6 @@ HostEntry::HostEntry(const std::string& name, const IPAddress& addr):
 }
 
 
-#endif // POCO_VXWORKS
-
-
 HostEntry::HostEntry(const HostEntry& entry):
 	_name(entry._name),
 	_aliases(entry._aliases),
@@ -14,6 +14,7 @@
 
 #include "Poco/Net/NameValueCollection.h"
 #include "Poco/Exception.h"
+#include "Poco/Ascii.h"
 #include <algorithm>
 
 
@@ -30,13 +31,15 @@ NameValueCollection::NameValueCollection()
 
 
 NameValueCollection::NameValueCollection(const NameValueCollection& nvc):
-	_map(nvc._map)
+	_entries(nvc._entries),
+	_hashes(nvc._hashes)
 {
 }
 
 
 NameValueCollection::NameValueCollection(NameValueCollection&& nvc) noexcept:
-	_map(std::move(nvc._map))
+	_entries(std::move(nvc._entries)),
+	_hashes(std::move(nvc._hashes))
 {
 }
 
@@ -57,7 +60,8 @@ NameValueCollection& NameValueCollection::operator = (const NameValueCollection&
 
 NameValueCollection& NameValueCollection::operator = (NameValueCollection&& nvc) noexcept
 {
-	_map = std::move(nvc._map);
+	_entries = std::move(nvc._entries);
+	_hashes = std::move(nvc._hashes);
 
 	return *this;
 }
@@ -65,15 +69,16 @@ NameValueCollection& NameValueCollection::operator = (NameValueCollection&& nvc)
 
 void NameValueCollection::swap(NameValueCollection& nvc)
 {
-	std::swap(_map, nvc._map);
+	std::swap(_entries, nvc._entries);
+	std::swap(_hashes, nvc._hashes);
 }
 
 	
 const std::string& NameValueCollection::operator [] (const std::string& name) const
 {
-	ConstIterator it = _map.find(name);
-	if (it != _map.end())
-		return it->second;
+	std::size_t i = indexOf(name);
+	if (i < _entries.size())
+		return _entries[i].second;
 	else
 		throw NotFoundException(name);
 }
@@ -81,25 +86,33 @@ const std::string& NameValueCollection::operator [] (const std::string& name) co
 	
 void NameValueCollection::set(const std::string& name, const std::string& value)	
 {
-	Iterator it = _map.find(name);
-	if (it != _map.end())
-		it->second = value;
+	Poco::UInt32 h = hash(name);
+	std::size_t i = indexOf(name, h);
+	if (i < _entries.size())
+		_entries[i].second = value;
 	else
-		_map.insert(HeaderMap::ValueType(name, value));
+		insert(h, HeaderMap::ValueType(name, value));
 }
 
 	
 void NameValueCollection::add(const std::string& name, const std::string& value)
 {
-	_map.insert(HeaderMap::ValueType(name, value));
+	insert(hash(name), HeaderMap::ValueType(name, value));
+}
+
+
+void NameValueCollection::add(std::string&& name, std::string&& value)
+{
+	Poco::UInt32 h = hash(name);
+	insert(h, HeaderMap::ValueType(std::move(name), std::move(value)));
 }
 
 	
 const std::string& NameValueCollection::get(const std::string& name) const
 {
-	ConstIterator it = _map.find(name);
-	if (it != _map.end())
-		return it->second;
+	std::size_t i = indexOf(name);
+	if (i < _entries.size())
+		return _entries[i].second;
 	else
 		throw NotFoundException(name);
 }
@@ -107,9 +120,9 @@ const std::string& NameValueCollection::get(const std::string& name) const
 
 const std::string& NameValueCollection::get(const std::string& name, const std::string& defaultValue) const
 {
-	ConstIterator it = _map.find(name);
-	if (it != _map.end())
-		return it->second;
+	std::size_t i = indexOf(name);
+	if (i < _entries.size())
+		return _entries[i].second;
 	else
 		return defaultValue;
 }
@@ -117,49 +130,101 @@ const std::string& NameValueCollection::get(const std::string& name, const std::
 
 bool NameValueCollection::has(const std::string& name) const
 {
-	return _map.find(name) != _map.end();
+	return indexOf(name) < _entries.size();
 }
 
 
 NameValueCollection::ConstIterator NameValueCollection::find(const std::string& name) const
 {
-	return _map.find(name);
+	return _entries.begin() + indexOf(name);
 }
 
 	
 NameValueCollection::ConstIterator NameValueCollection::begin() const
 {
-	return _map.begin();
+	return _entries.begin();
 }
 
 	
 NameValueCollection::ConstIterator NameValueCollection::end() const
 {
-	return _map.end();
+	return _entries.end();
 }
 
 	
 bool NameValueCollection::empty() const
 {
-	return _map.empty();
+	return _entries.empty();
 }
 
 
 std::size_t NameValueCollection::size() const
 {
-	return _map.size();
+	return _entries.size();
 }
 
 
 void NameValueCollection::erase(const std::string& name)
 {
-	_map.erase(name);
+	Poco::UInt32 h = hash(name);
+	std::size_t i = indexOf(name, h);
+	std::size_t n = i;
+	while (n < _entries.size() && _hashes[n] == h && Poco::icompare(_entries[n].first, name) == 0) ++n;
+	_entries.erase(_entries.begin() + i, _entries.begin() + n);
+	_hashes.erase(_hashes.begin() + i, _hashes.begin() + n);
 }
 
 
 void NameValueCollection::clear()
 {
-	_map.clear();
+	_entries.clear();
+	_hashes.clear();
+}
+
+
+Poco::UInt32 NameValueCollection::hash(const std::string& name)
+{
+	// FNV-1a of the lower case name
+	Poco::UInt32 h = 2166136261U;
+	for (std::string::const_iterator it = name.begin(); it != name.end(); ++it)
+	{
+		h ^= static_cast<unsigned char>(Poco::Ascii::toLower(*it));
+		h *= 16777619U;
+	}
+	return h;
+}
+
+
+std::size_t NameValueCollection::indexOf(const std::string& name) const
+{
+	return indexOf(name, hash(name));
+}
+
+
+std::size_t NameValueCollection::indexOf(const std::string& name, Poco::UInt32 h) const
+{
+	const std::size_t n = _hashes.size();
+	const Poco::UInt32* pHashes = _hashes.data();
+	for (std::size_t i = 0; i < n; i++)
+	{
+		if (pHashes[i] == h && Poco::icompare(_entries[i].first, name) == 0) return i;
+	}
+	return n;
+}
+
+
+void NameValueCollection::insert(Poco::UInt32 h, HeaderMap::ValueType&& value)
+{
+	// Keep pairs with equal names together, as ListMap does.
+	std::size_t i = indexOf(value.first, h);
+	while (i < _entries.size() && _hashes[i] == h && Poco::icompare(_entries[i].first, value.first) == 0) ++i;
+	if (_entries.capacity() == 0)
+	{
+		_entries.reserve(INITIAL_RESERVE);
+		_hashes.reserve(INITIAL_RESERVE);
+	}
+	_entries.insert(_entries.begin() + i, std::move(value));
+	_hashes.insert(_hashes.begin() + i, h);
 }
 
 
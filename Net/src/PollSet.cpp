@@ -29,20 +29,557 @@
 #endif
 
 
-#if defined(POCO_HAVE_FD_EPOLL)
+#if defined(POCO_HAVE_FD_IO_URING)
+#include "Poco/Condition.h"
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#elif defined(POCO_HAVE_FD_EPOLL)
 #include <sys/epoll.h>
-#elif defined(POCO_HAVE_FD_POLL)
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+#else
+#include "Poco/Net/DatagramSocket.h"
+#include "Poco/Net/SocketAddress.h"
+#if defined(POCO_HAVE_FD_POLL)
 #ifndef _WIN32
 #include <poll.h>
 #endif
 #endif
+#endif
 
 
 namespace Poco {
 namespace Net {
 
 
-#if defined(POCO_HAVE_FD_EPOLL)
+#if defined(POCO_HAVE_FD_IO_URING)
+
+
+//
+// Linux implementation using io_uring
+//
+class PollSetImpl
+	/// Every socket in the set has at most one one-shot
+	/// IORING_OP_POLL_ADD request in flight. When a request
+	/// completes, the socket is reported, and a new request is
+	/// queued by the next call to poll(), which submits all
+	/// queued requests and waits for completions with a single
+	/// io_uring_enter() call. Completions that are already
+	/// available are reaped without a system call. This keeps
+	/// the level-triggered semantics of the other implementations.
+	///
+	/// Sockets registered with POLL_EDGE_TRIGGERED use a multishot
+	/// request instead, which remains armed after completing.
+	/// Sockets registered with POLL_ONE_SHOT are not re-armed
+	/// before update() is called.
+	///
+	/// The user_data of a request contains the index of the
+	/// socket's slot and the generation of the slot, so that
+	/// completions of requests that have been cancelled by
+	/// remove() or update() can be recognized and ignored.
+	///
+	/// poll() accesses the rings without holding the mutex while
+	/// it waits, so clear() wakes up all threads in poll() and
+	/// waits until they are done before it replaces the ring.
+{
+public:
+	PollSetImpl():
+		_ringfd(-1),
+		_pending(0),
+		_pollCount(0),
+		_polling(0),
+		_clearing(false)
+	{
+		open();
+	}
+
+	~PollSetImpl()
+	{
+		close();
+	}
+
+	void add(const Socket& socket, int mode)
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		SocketImpl* sockImpl = socket.impl();
+		SlotMap::iterator it = _slotMap.find(sockImpl);
+		if (it != _slotMap.end())
+		{
+			updateSlot(it->second, mode);
+		}
+		else
+		{
+			Poco::UInt32 index;
+			if (_freeSlots.empty())
+			{
+				index = static_cast<Poco::UInt32>(_slots.size());
+				_slots.push_back(Slot());
+			}
+			else
+			{
+				index = _freeSlots.back();
+				_freeSlots.pop_back();
+			}
+			Slot& slot = _slots[index];
+			slot.socket = socket;
+			slot.mode = mode;
+			slot.used = true;
+			_slotMap[sockImpl] = index;
+			arm(index);
+		}
+		submit();
+	}
+
+	void remove(const Socket& socket)
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		SlotMap::iterator it = _slotMap.find(socket.impl());
+		if (it != _slotMap.end())
+		{
+			Poco::UInt32 index = it->second;
+			disarm(index);
+			Slot& slot = _slots[index];
+			slot.socket = Socket();
+			slot.mode = 0;
+			slot.used = false;
+			_freeSlots.push_back(index);
+			_slotMap.erase(it);
+			submit();
+		}
+	}
+
+	bool has(const Socket& socket) const
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		SocketImpl* sockImpl = socket.impl();
+		return sockImpl &&
+			(_slotMap.find(sockImpl) != _slotMap.end());
+	}
+
+	bool empty() const
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		return _slotMap.empty();
+	}
+
+	void update(const Socket& socket, int mode)
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		SlotMap::iterator it = _slotMap.find(socket.impl());
+		if (it == _slotMap.end()) throw InvalidArgumentException("Socket not in PollSet");
+		updateSlot(it->second, mode);
+		submit();
+	}
+
+	void clear()
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		while (_clearing) _pollDone.wait(_mutex);
+		if (_polling > 0)
+		{
+			_clearing = true;
+			queueWakeUp();
+			submit();
+			while (_polling > 0) _pollDone.wait(_mutex);
+			_clearing = false;
+			_pollDone.broadcast();
+		}
+		close();
+		_slotMap.clear();
+		_slots.clear();
+		_freeSlots.clear();
+		_rearm.clear();
+		open();
+	}
+
+	void wakeUp()
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		queueWakeUp();
+		submit();
+	}
+
+	void poll(const Poco::Timespan& timeout, PollSet::SocketModeList& result)
+	{
+		unsigned toSubmit;
+		{
+			Poco::FastMutex::ScopedLock lock(_mutex);
+			// clear() is about to replace the ring
+			while (_clearing) _pollDone.wait(_mutex);
+			if (_slotMap.empty()) return;
+
+			for (std::vector<Poco::UInt32>::const_iterator it = _rearm.begin(); it != _rearm.end(); ++it)
+			{
+				if (_slots[*it].used && !_slots[*it].armed) arm(*it);
+			}
+			_rearm.clear();
+			toSubmit = _pending;
+			_pending = 0;
+			++_polling;
+		}
+
+		int err = 0;
+		bool ready = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE) != *_cqHead;
+		if (toSubmit > 0 || !ready)
+		{
+			Poco::Timespan remainingTime(timeout);
+			int rc;
+			do
+			{
+				Poco::Timestamp start;
+				struct __kernel_timespec ts;
+				ts.tv_sec = remainingTime.totalSeconds();
+				ts.tv_nsec = remainingTime.useconds()*1000;
+				struct io_uring_getevents_arg arg;
+				std::memset(&arg, 0, sizeof(arg));
+				arg.ts = reinterpret_cast<Poco::UInt64>(&ts);
+				rc = enter(toSubmit, ready ? 0 : 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+				// not all requests may have been submitted
+				if (rc >= 0) toSubmit -= std::min(static_cast<unsigned>(rc), toSubmit);
+				if (rc < 0 && errno == EINTR)
+				{
+					Poco::Timestamp end;
+					Poco::Timespan waited = end - start;
+					if (waited < remainingTime)
+						remainingTime -= waited;
+					else
+						remainingTime = 0;
+				}
+			}
+			while (rc < 0 && errno == EINTR);
+			if (rc < 0 && errno != ETIME && errno != EBUSY && errno != EAGAIN) err = errno;
+		}
+
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		// requests that io_uring_enter() has not submitted
+		if (toSubmit > 0) _pending += toSubmit;
+		if (--_polling == 0 && _clearing) _pollDone.broadcast();
+		if (err) SocketImpl::error(err);
+
+		++_pollCount;
+		unsigned head = *_cqHead;
+		unsigned tail = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE);
+		while (head != tail)
+		{
+			const struct io_uring_cqe& cqe = _cqes[head & _cqMask];
+			Poco::UInt32 index = static_cast<Poco::UInt32>(cqe.user_data);
+			Poco::UInt32 generation = static_cast<Poco::UInt32>(cqe.user_data >> 32);
+			if (cqe.user_data != CANCEL_USER_DATA && cqe.user_data != WAKEUP_USER_DATA && index < _slots.size())
+			{
+				Slot& slot = _slots[index];
+				if (slot.used && slot.armed && slot.generation == generation)
+				{
+					// a multishot request remains armed as long as
+					// IORING_CQE_F_MORE is set
+					if (!(cqe.flags & IORING_CQE_F_MORE))
+					{
+						slot.armed = false;
+						if (!(slot.mode & PollSet::POLL_ONE_SHOT)) _rearm.push_back(index);
+					}
+					int mode = 0;
+					if (cqe.res < 0)
+					{
+						// a multishot request terminated by the kernel
+						// is re-armed and not reported as an error
+						if (cqe.res != -ECANCELED) mode = PollSet::POLL_ERROR;
+					}
+					else
+					{
+						if (cqe.res & POLLIN)
+							mode |= PollSet::POLL_READ;
+						if (cqe.res & POLLOUT)
+							mode |= PollSet::POLL_WRITE;
+						if (cqe.res & POLLERR)
+							mode |= PollSet::POLL_ERROR;
+						if (cqe.res & POLLHUP)
+							mode |= slot.mode & PollSet::POLL_READ;
+					}
+					mode &= slot.mode | PollSet::POLL_ERROR;
+					if (mode)
+					{
+						// a multishot request can complete more than once
+						if (slot.reported == _pollCount)
+						{
+							result[slot.resultIndex].second |= mode;
+						}
+						else
+						{
+							slot.reported = _pollCount;
+							slot.resultIndex = result.size();
+							result.push_back(PollSet::SocketMode(slot.socket, mode));
+						}
+					}
+				}
+			}
+			++head;
+		}
+		__atomic_store_n(_cqHead, head, __ATOMIC_RELEASE);
+	}
+
+private:
+	enum
+	{
+		RING_ENTRIES = 1024
+	};
+
+	static const Poco::UInt64 CANCEL_USER_DATA = ~Poco::UInt64(0);
+	static const Poco::UInt64 WAKEUP_USER_DATA = ~Poco::UInt64(1);
+
+	struct Slot
+	{
+		Slot():
+			mode(0),
+			generation(0),
+			reported(0),
+			resultIndex(0),
+			armed(false),
+			used(false)
+		{
+		}
+
+		Socket        socket;
+		int           mode;
+		Poco::UInt32  generation;
+		Poco::UInt32  reported;
+		std::size_t   resultIndex;
+		bool          armed;
+		bool          used;
+	};
+
+	typedef std::map<void*, Poco::UInt32> SlotMap;
+
+	void open()
+	{
+		struct io_uring_params params;
+		std::memset(&params, 0, sizeof(params));
+		_ringfd = static_cast<int>(syscall(__NR_io_uring_setup, RING_ENTRIES, &params));
+		if (_ringfd < 0) SocketImpl::error();
+		if (!(params.features & IORING_FEAT_EXT_ARG))
+		{
+			::close(_ringfd);
+			_ringfd = -1;
+			throw NotImplementedException("io_uring does not support IORING_FEAT_EXT_ARG");
+		}
+
+		_sqRingSize = params.sq_off.array + params.sq_entries*sizeof(unsigned);
+		_cqRingSize = params.cq_off.cqes + params.cq_entries*sizeof(struct io_uring_cqe);
+		_singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if (_singleMmap)
+		{
+			if (_cqRingSize > _sqRingSize) _sqRingSize = _cqRingSize;
+			_cqRingSize = _sqRingSize;
+		}
+		_pSQRing = mmap(0, _sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringfd, IORING_OFF_SQ_RING);
+		if (_pSQRing == MAP_FAILED)
+		{
+			int err = errno;
+			::close(_ringfd);
+			_ringfd = -1;
+			SocketImpl::error(err);
+		}
+		if (_singleMmap)
+		{
+			_pCQRing = _pSQRing;
+		}
+		else
+		{
+			_pCQRing = mmap(0, _cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringfd, IORING_OFF_CQ_RING);
+			if (_pCQRing == MAP_FAILED)
+			{
+				int err = errno;
+				munmap(_pSQRing, _sqRingSize);
+				::close(_ringfd);
+				_ringfd = -1;
+				SocketImpl::error(err);
+			}
+		}
+		_sqesSize = params.sq_entries*sizeof(struct io_uring_sqe);
+		void* pSQEs = mmap(0, _sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringfd, IORING_OFF_SQES);
+		if (pSQEs == MAP_FAILED)
+		{
+			int err = errno;
+			if (!_singleMmap) munmap(_pCQRing, _cqRingSize);
+			munmap(_pSQRing, _sqRingSize);
+			::close(_ringfd);
+			_ringfd = -1;
+			SocketImpl::error(err);
+		}
+		_sqes = static_cast<struct io_uring_sqe*>(pSQEs);
+
+		char* pSQ = static_cast<char*>(_pSQRing);
+		_sqHead  = reinterpret_cast<unsigned*>(pSQ + params.sq_off.head);
+		_sqTail  = reinterpret_cast<unsigned*>(pSQ + params.sq_off.tail);
+		_sqMask  = *reinterpret_cast<unsigned*>(pSQ + params.sq_off.ring_mask);
+		_sqArray = reinterpret_cast<unsigned*>(pSQ + params.sq_off.array);
+		_sqEntries = params.sq_entries;
+
+		char* pCQ = static_cast<char*>(_pCQRing);
+		_cqHead = reinterpret_cast<unsigned*>(pCQ + params.cq_off.head);
+		_cqTail = reinterpret_cast<unsigned*>(pCQ + params.cq_off.tail);
+		_cqMask = *reinterpret_cast<unsigned*>(pCQ + params.cq_off.ring_mask);
+		_cqes   = reinterpret_cast<struct io_uring_cqe*>(pCQ + params.cq_off.cqes);
+
+		_pending = 0;
+	}
+
+	void close()
+	{
+		if (_ringfd >= 0)
+		{
+			munmap(_sqes, _sqesSize);
+			if (!_singleMmap) munmap(_pCQRing, _cqRingSize);
+			munmap(_pSQRing, _sqRingSize);
+			::close(_ringfd);
+			_ringfd = -1;
+		}
+	}
+
+	int enter(unsigned toSubmit, unsigned minComplete, unsigned flags, void* pArg = 0, std::size_t argSize = 0)
+	{
+		return static_cast<int>(syscall(__NR_io_uring_enter, _ringfd, toSubmit, minComplete, flags, pArg, argSize));
+	}
+
+	void submit()
+		/// Submits all queued requests.
+	{
+		while (_pending > 0)
+		{
+			int rc = enter(_pending, 0, 0);
+			if (rc > 0)
+				_pending -= std::min(static_cast<unsigned>(rc), _pending);
+			else if (rc == 0)
+				break; // nothing left in the submission queue
+			else if (errno != EINTR)
+				SocketImpl::error();
+		}
+	}
+
+	void queueWakeUp()
+		/// Queues a no-op request, whose completion
+		/// ends a wait in io_uring_enter().
+	{
+		struct io_uring_sqe* pSQE = nextSQE();
+		pSQE->opcode = IORING_OP_NOP;
+		pSQE->fd = -1;
+		pSQE->user_data = WAKEUP_USER_DATA;
+		push();
+	}
+
+	struct io_uring_sqe* nextSQE()
+		/// Returns the next free submission queue entry.
+		/// The entry is queued by calling push().
+	{
+		unsigned tail = *_sqTail;
+		if (tail - __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE) >= _sqEntries)
+		{
+			submit();
+		}
+		struct io_uring_sqe* pSQE = &_sqes[tail & _sqMask];
+		std::memset(pSQE, 0, sizeof(*pSQE));
+		return pSQE;
+	}
+
+	void push()
+	{
+		unsigned tail = *_sqTail;
+		_sqArray[tail & _sqMask] = tail & _sqMask;
+		__atomic_store_n(_sqTail, tail + 1, __ATOMIC_RELEASE);
+		++_pending;
+	}
+
+	void arm(Poco::UInt32 index)
+	{
+		Slot& slot = _slots[index];
+		if (slot.mode == 0) return;
+
+		Poco::UInt32 events = 0;
+		if (slot.mode & PollSet::POLL_READ)
+			events |= POLLIN;
+		if (slot.mode & PollSet::POLL_WRITE)
+			events |= POLLOUT;
+		if (slot.mode & PollSet::POLL_ERROR)
+			events |= POLLERR;
+#if defined(POCO_ARCH_BIG_ENDIAN)
+		events = (events << 16) | (events >> 16);
+#endif
+		struct io_uring_sqe* pSQE = nextSQE();
+		pSQE->opcode = IORING_OP_POLL_ADD;
+		pSQE->fd = slot.socket.impl()->sockfd();
+		pSQE->poll32_events = events;
+		if ((slot.mode & PollSet::POLL_EDGE_TRIGGERED) && !(slot.mode & PollSet::POLL_ONE_SHOT))
+			pSQE->len = IORING_POLL_ADD_MULTI;
+		pSQE->user_data = (static_cast<Poco::UInt64>(slot.generation) << 32) | index;
+		push();
+		slot.armed = true;
+	}
+
+	void disarm(Poco::UInt32 index)
+	{
+		Slot& slot = _slots[index];
+		if (slot.armed)
+		{
+			struct io_uring_sqe* pSQE = nextSQE();
+			pSQE->opcode = IORING_OP_POLL_REMOVE;
+			pSQE->fd = -1;
+			pSQE->addr = (static_cast<Poco::UInt64>(slot.generation) << 32) | index;
+			pSQE->user_data = CANCEL_USER_DATA;
+			push();
+			slot.armed = false;
+		}
+		++slot.generation;
+	}
+
+	void updateSlot(Poco::UInt32 index, int mode)
+	{
+		disarm(index);
+		_slots[index].mode = mode;
+		arm(index);
+	}
+
+	mutable Poco::FastMutex     _mutex;
+	int                         _ringfd;
+	void*                       _pSQRing;
+	void*                       _pCQRing;
+	std::size_t                 _sqRingSize;
+	std::size_t                 _cqRingSize;
+	std::size_t                 _sqesSize;
+	bool                        _singleMmap;
+	unsigned*                   _sqHead;
+	unsigned*                   _sqTail;
+	unsigned*                   _sqArray;
+	unsigned                    _sqMask;
+	unsigned                    _sqEntries;
+	struct io_uring_sqe*        _sqes;
+	unsigned*                   _cqHead;
+	unsigned*                   _cqTail;
+	unsigned                    _cqMask;
+	struct io_uring_cqe*        _cqes;
+	unsigned                    _pending;
+	Poco::UInt32                _pollCount;
+	unsigned                    _polling;
+	bool                        _clearing;
+	Poco::Condition             _pollDone;
+	std::vector<Slot>           _slots;
+	std::vector<Poco::UInt32>   _freeSlots;
+	std::vector<Poco::UInt32>   _rearm;
+	SlotMap                     _slotMap;
+};
+
+
+#elif defined(POCO_HAVE_FD_EPOLL)
 
 
 //
@@ -53,19 +590,29 @@ class PollSetImpl
 public:
 	PollSetImpl():
 		_epollfd(-1),
-		_events(1024)
+		_eventfd(-1)
 	{
+		_eventfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (_eventfd < 0)
+		{
+			SocketImpl::error();
+		}
 		_epollfd = epoll_create(1);
 		if (_epollfd < 0)
 		{
-			SocketImpl::error();
+			int err = errno;
+			::close(_eventfd);
+			SocketImpl::error(err);
 		}
+		addEventFD();
 	}
 
 	~PollSetImpl()
 	{
 		if (_epollfd >= 0)
 			::close(_epollfd);
+		if (_eventfd >= 0)
+			::close(_eventfd);
 	}
 
 	void add(const Socket& socket, int mode)
@@ -82,6 +629,10 @@ public:
 			ev.events |= EPOLLOUT;
 		if (mode & PollSet::POLL_ERROR)
 			ev.events |= EPOLLERR;
+		if (mode & PollSet::POLL_EDGE_TRIGGERED)
+			ev.events |= EPOLLET;
+		if (mode & PollSet::POLL_ONE_SHOT)
+			ev.events |= EPOLLONESHOT;
 		ev.data.ptr = socket.impl();
 		int err = epoll_ctl(_epollfd, EPOLL_CTL_ADD, fd, &ev);
 
@@ -134,6 +685,10 @@ public:
 			ev.events |= EPOLLOUT;
 		if (mode & PollSet::POLL_ERROR)
 			ev.events |= EPOLLERR;
+		if (mode & PollSet::POLL_EDGE_TRIGGERED)
+			ev.events |= EPOLLET;
+		if (mode & PollSet::POLL_ONE_SHOT)
+			ev.events |= EPOLLONESHOT;
 		ev.data.ptr = socket.impl();
 		int err = epoll_ctl(_epollfd, EPOLL_CTL_MOD, fd, &ev);
 		if (err)
@@ -153,23 +708,34 @@ public:
 		{
 			SocketImpl::error();
 		}
+		addEventFD();
+	}
+
+	void wakeUp()
+	{
+		Poco::UInt64 value = 1;
+		while (::write(_eventfd, &value, sizeof(value)) < 0 && errno == EINTR)
+		{
+		}
 	}
 
-	PollSet::SocketModeMap poll(const Poco::Timespan& timeout)
+	void poll(const Poco::Timespan& timeout, PollSet::SocketModeList& result)
 	{
-		PollSet::SocketModeMap result;
 
 		{
 			Poco::FastMutex::ScopedLock lock(_mutex);
-			if(_socketMap.empty()) return result;
+			if(_socketMap.empty()) return;
 		}
 
+		// Each call has its own event buffer, as several
+		// threads may poll the same PollSet at the same time.
+		struct epoll_event events[MAX_EVENTS];
 		Poco::Timespan remainingTime(timeout);
 		int rc;
 		do
 		{
 			Poco::Timestamp start;
-			rc = epoll_wait(_epollfd, &_events[0], _events.size(), remainingTime.totalMilliseconds());
+			rc = epoll_wait(_epollfd, events, MAX_EVENTS, remainingTime.totalMilliseconds());
 			if (rc < 0 && SocketImpl::lastError() == POCO_EINTR)
 			{
 				Poco::Timestamp end;
@@ -187,26 +753,54 @@ public:
 
 		for (int i = 0; i < rc; i++)
 		{
-			std::map<void*, Socket>::iterator it = _socketMap.find(_events[i].data.ptr);
+			if (events[i].data.ptr == &_eventfd)
+			{
+				// reset the eventfd written by wakeUp()
+				Poco::UInt64 value;
+				while (::read(_eventfd, &value, sizeof(value)) < 0 && errno == EINTR)
+				{
+				}
+				continue;
+			}
+			std::map<void*, Socket>::iterator it = _socketMap.find(events[i].data.ptr);
 			if (it != _socketMap.end())
 			{
-				if (_events[i].events & EPOLLIN)
-					result[it->second] |= PollSet::POLL_READ;
-				if (_events[i].events & EPOLLOUT)
-					result[it->second] |= PollSet::POLL_WRITE;
-				if (_events[i].events & EPOLLERR)
-					result[it->second] |= PollSet::POLL_ERROR;
+				int mode = 0;
+				if (events[i].events & EPOLLIN)
+					mode |= PollSet::POLL_READ;
+				if (events[i].events & EPOLLOUT)
+					mode |= PollSet::POLL_WRITE;
+				if (events[i].events & EPOLLERR)
+					mode |= PollSet::POLL_ERROR;
+				if (mode) result.push_back(PollSet::SocketMode(it->second, mode));
 			}
 		}
-
-		return result;
 	}
 
 private:
+	enum
+	{
+		MAX_EVENTS = 1024
+	};
+
+	void addEventFD()
+		/// Adds the eventfd used by wakeUp() to the epoll set.
+		/// Its event is recognized by the address of _eventfd,
+		/// which cannot be the address of a SocketImpl.
+	{
+		struct epoll_event ev;
+		ev.events = EPOLLIN;
+		ev.data.ptr = &_eventfd;
+		if (epoll_ctl(_epollfd, EPOLL_CTL_ADD, _eventfd, &ev))
+		{
+			SocketImpl::error();
+		}
+	}
+
 	mutable Poco::FastMutex         _mutex;
 	int                             _epollfd;
+	int                             _eventfd;
 	std::map<void*, Socket>         _socketMap;
-	std::vector<struct epoll_event> _events;
 };
 
 
@@ -219,13 +813,25 @@ private:
 class PollSetImpl
 {
 public:
+	PollSetImpl():
+		_wakeUpSocket(SocketAddress("127.0.0.1", 0)),
+		_generation(0)
+	{
+		// wakeUp() sends a datagram to this socket
+		_wakeUpSocket.connect(_wakeUpSocket.address());
+		_wakeUpSocket.setBlocking(false);
+	}
+
 	void add(const Socket& socket, int mode)
 	{
 		Poco::FastMutex::ScopedLock lock(_mutex);
 
 		poco_socket_t fd = socket.impl()->sockfd();
 		_addMap[fd] = mode;
+		_modeMap[fd] = mode;
+		_armMap[fd] = ++_generation;
 		_removeSet.erase(fd);
+		_disabledSet.erase(fd);
 		_socketMap[fd] = socket;
 	}
 
@@ -236,6 +842,9 @@ public:
 		poco_socket_t fd = socket.impl()->sockfd();
 		_removeSet.insert(fd);
 		_addMap.erase(fd);
+		_modeMap.erase(fd);
+		_armMap.erase(fd);
+		_disabledSet.erase(fd);
 		_socketMap.erase(fd);
 	}
 
@@ -258,6 +867,11 @@ public:
 		Poco::FastMutex::ScopedLock lock(_mutex);
 
 		poco_socket_t fd = socket.impl()->sockfd();
+		_modeMap[fd] = mode;
+		_armMap[fd] = ++_generation;
+		_disabledSet.erase(fd);
+		std::map<poco_socket_t, int>::iterator itAdd = _addMap.find(fd);
+		if (itAdd != _addMap.end()) itAdd->second = mode;
 		for (auto it = _pollfds.begin(); it != _pollfds.end(); ++it)
 		{
 			if (it->fd == fd)
@@ -277,13 +891,35 @@ public:
 
 		_socketMap.clear();
 		_addMap.clear();
+		_modeMap.clear();
+		_armMap.clear();
 		_removeSet.clear();
+		_disabledSet.clear();
 		_pollfds.clear();
 	}
 
-	PollSet::SocketModeMap poll(const Poco::Timespan& timeout)
+	void wakeUp()
+	{
+		char c = 1;
+		try
+		{
+			_wakeUpSocket.sendBytes(&c, 1);
+		}
+		catch (Poco::Exception&)
+		{
+			// a full buffer still wakes up poll()
+		}
+	}
+
+	void poll(const Poco::Timespan& timeout, PollSet::SocketModeList& result)
 	{
-		PollSet::SocketModeMap result;
+		// Several threads may poll at the same time, so every call
+		// polls its own copy of _pollfds. A socket that has been
+		// disabled, or armed again, since the copy has been taken
+		// is not reported, as its readiness has already been
+		// reported to another thread.
+		std::vector<pollfd> pollfds;
+		Poco::UInt64 generation;
 		{
 			Poco::FastMutex::ScopedLock lock(_mutex);
 
@@ -315,9 +951,18 @@ public:
 				_pollfds.push_back(pfd);
 			}
 			_addMap.clear();
+			pollfds = _pollfds;
+			generation = _generation;
 		}
 
-		if (_pollfds.empty()) return result;
+		if (pollfds.empty()) return;
+
+		// the last entry is the socket written by wakeUp()
+		pollfd wakeUpPfd;
+		wakeUpPfd.fd = _wakeUpSocket.impl()->sockfd();
+		wakeUpPfd.events = POLLIN;
+		wakeUpPfd.revents = 0;
+		pollfds.push_back(wakeUpPfd);
 
 		Poco::Timespan remainingTime(timeout);
 		int rc;
@@ -325,9 +970,9 @@ public:
 		{
 			Poco::Timestamp start;
 #ifdef _WIN32
-			rc = WSAPoll(&_pollfds[0], static_cast<ULONG>(_pollfds.size()), static_cast<INT>(timeout.totalMilliseconds()));
+			rc = WSAPoll(&pollfds[0], static_cast<ULONG>(pollfds.size()), static_cast<INT>(timeout.totalMilliseconds()));
 #else
-			rc = ::poll(&_pollfds[0], _pollfds.size(), timeout.totalMilliseconds());
+			rc = ::poll(&pollfds[0], pollfds.size(), timeout.totalMilliseconds());
 #endif
 			if (rc < 0 && SocketImpl::lastError() == POCO_EINTR)
 			{
@@ -342,41 +987,74 @@ public:
 		while (rc < 0 && SocketImpl::lastError() == POCO_EINTR);
 		if (rc < 0) SocketImpl::error();
 
+		if (pollfds.back().revents) drainWakeUpSocket();
+		pollfds.pop_back();
+
 		{
 			Poco::FastMutex::ScopedLock lock(_mutex);
 
 			if (!_socketMap.empty())
 			{
-				for (auto it = _pollfds.begin(); it != _pollfds.end(); ++it)
+				for (std::size_t i = 0; i < pollfds.size(); ++i)
 				{
-					std::map<poco_socket_t, Socket>::const_iterator its = _socketMap.find(it->fd);
-					if (its != _socketMap.end())
+					const pollfd* pPollfd = &pollfds[i];
+					std::map<poco_socket_t, Socket>::const_iterator its = _socketMap.find(pPollfd->fd);
+					if (its != _socketMap.end() && _disabledSet.find(pPollfd->fd) == _disabledSet.end() && _armMap[pPollfd->fd] <= generation)
 					{
-						if (it->revents & POLLIN)
-							result[its->second] |= PollSet::POLL_READ;
-						if (it->revents & POLLOUT)
-							result[its->second] |= PollSet::POLL_WRITE;
-						if (it->revents & POLLERR)
-							result[its->second] |= PollSet::POLL_ERROR;
+						int mode = 0;
+						if (pPollfd->revents & POLLIN)
+							mode |= PollSet::POLL_READ;
+						if (pPollfd->revents & POLLOUT)
+							mode |= PollSet::POLL_WRITE;
+						if (pPollfd->revents & POLLERR)
+							mode |= PollSet::POLL_ERROR;
 #ifdef _WIN32
-						if (it->revents & POLLHUP)
-							result[its->second] |= PollSet::POLL_READ;
+						if (pPollfd->revents & POLLHUP)
+							mode |= PollSet::POLL_READ;
 #endif
+						if (mode)
+						{
+							result.push_back(PollSet::SocketMode(its->second, mode));
+							if (_modeMap[pPollfd->fd] & PollSet::POLL_ONE_SHOT)
+							{
+								// disabled until update() is called
+								if (i < _pollfds.size() && _pollfds[i].fd == pPollfd->fd)
+									_pollfds[i].events = 0;
+								_disabledSet.insert(pPollfd->fd);
+							}
+						}
 					}
-					it->revents = 0;
 				}
 			}
 		}
-
-		return result;
 	}
 
 private:
+	void drainWakeUpSocket()
+		/// Receives the datagrams sent by wakeUp().
+	{
+		char buffer[64];
+		try
+		{
+			while (_wakeUpSocket.receiveBytes(buffer, sizeof(buffer)) > 0)
+			{
+			}
+		}
+		catch (Poco::Exception&)
+		{
+		}
+	}
+
 	mutable Poco::FastMutex         _mutex;
+	DatagramSocket                  _wakeUpSocket;
 	std::map<poco_socket_t, Socket> _socketMap;
 	std::map<poco_socket_t, int>    _addMap;
+	std::map<poco_socket_t, int>    _modeMap;
+	std::map<poco_socket_t, Poco::UInt64> _armMap;
 	std::set<poco_socket_t>         _removeSet;
+	std::set<poco_socket_t>         _disabledSet;
 	std::vector<pollfd>             _pollfds;
+	Poco::UInt64                    _generation;
 };
 
 
@@ -389,16 +1067,27 @@ private:
 class PollSetImpl
 {
 public:
+	PollSetImpl():
+		_wakeUpSocket(SocketAddress("127.0.0.1", 0)),
+		_generation(0)
+	{
+		// wakeUp() sends a datagram to this socket
+		_wakeUpSocket.connect(_wakeUpSocket.address());
+		_wakeUpSocket.setBlocking(false);
+	}
+
 	void add(const Socket& socket, int mode)
 	{
 		Poco::FastMutex::ScopedLock lock(_mutex);
 		_map[socket] = mode;
+		_armMap[socket] = ++_generation;
 	}
 
 	void remove(const Socket& socket)
 	{
 		Poco::FastMutex::ScopedLock lock(_mutex);
 		_map.erase(socket);
+		_armMap.erase(socket);
 	}
 
 	bool has(const Socket& socket) const
@@ -417,15 +1106,30 @@ public:
 	{
 		Poco::FastMutex::ScopedLock lock(_mutex);
 		_map[socket] = mode;
+		_armMap[socket] = ++_generation;
 	}
 
 	void clear()
 	{
 		Poco::FastMutex::ScopedLock lock(_mutex);
 		_map.clear();
+		_armMap.clear();
 	}
 
-	PollSet::SocketModeMap poll(const Poco::Timespan& timeout)
+	void wakeUp()
+	{
+		char c = 1;
+		try
+		{
+			_wakeUpSocket.sendBytes(&c, 1);
+		}
+		catch (Poco::Exception&)
+		{
+			// a full buffer still wakes up select()
+		}
+	}
+
+	void poll(const Poco::Timespan& timeout, PollSet::SocketModeList& result)
 	{
 		fd_set fdRead;
 		fd_set fdWrite;
@@ -436,9 +1140,15 @@ public:
 		FD_ZERO(&fdWrite);
 		FD_ZERO(&fdExcept);
 
+		// Several threads may poll at the same time. A socket that
+		// has been disabled, or armed again, since the fd_sets have
+		// been filled is not reported, as its readiness has already
+		// been reported to another thread.
+		Poco::UInt64 generation;
 		{
 			Poco::FastMutex::ScopedLock lock(_mutex);
 
+			generation = _generation;
 			for (auto it = _map.begin(); it != _map.end(); ++it)
 			{
 				poco_socket_t fd = it->first.impl()->sockfd();
@@ -462,8 +1172,11 @@ public:
 			}
 		}
 
-		PollSet::SocketModeMap result;
-		if (nfd == 0) return result;
+		if (nfd == 0) return;
+
+		poco_socket_t wakeUpFd = _wakeUpSocket.impl()->sockfd();
+		if (int(wakeUpFd) > nfd) nfd = int(wakeUpFd);
+		FD_SET(wakeUpFd, &fdRead);
 
 		Poco::Timespan remainingTime(timeout);
 		int rc;
@@ -487,36 +1200,64 @@ public:
 		while (rc < 0 && SocketImpl::lastError() == POCO_EINTR);
 		if (rc < 0) SocketImpl::error();
 
+		if (FD_ISSET(wakeUpFd, &fdRead)) drainWakeUpSocket();
+
 		{
 			Poco::FastMutex::ScopedLock lock(_mutex);
 
 			for (auto it = _map.begin(); it != _map.end(); ++it)
 			{
 				poco_socket_t fd = it->first.impl()->sockfd();
-				if (fd != POCO_INVALID_SOCKET)
+				if (fd != POCO_INVALID_SOCKET && it->second && _armMap[it->first] <= generation)
 				{
+					int mode = 0;
 					if (FD_ISSET(fd, &fdRead))
 					{
-						result[it->first] |= PollSet::POLL_READ;
+						mode |= PollSet::POLL_READ;
 					}
 					if (FD_ISSET(fd, &fdWrite))
 					{
-						result[it->first] |= PollSet::POLL_WRITE;
+						mode |= PollSet::POLL_WRITE;
 					}
 					if (FD_ISSET(fd, &fdExcept))
 					{
-						result[it->first] |= PollSet::POLL_ERROR;
+						mode |= PollSet::POLL_ERROR;
+					}
+					if (mode)
+					{
+						result.push_back(PollSet::SocketMode(it->first, mode));
+						if (it->second & PollSet::POLL_ONE_SHOT)
+						{
+							// disabled until update() is called
+							it->second = 0;
+						}
 					}
 				}
 			}
 		}
-
-		return result;
 	}
 
 private:
+	void drainWakeUpSocket()
+		/// Receives the datagrams sent by wakeUp().
+	{
+		char buffer[64];
+		try
+		{
+			while (_wakeUpSocket.receiveBytes(buffer, sizeof(buffer)) > 0)
+			{
+			}
+		}
+		catch (Poco::Exception&)
+		{
+		}
+	}
+
 	mutable Poco::FastMutex _mutex;
+	DatagramSocket          _wakeUpSocket;
 	PollSet::SocketModeMap  _map;
+	std::map<Socket, Poco::UInt64> _armMap;
+	Poco::UInt64            _generation;
 };
 
 
@@ -571,9 +1312,30 @@ void PollSet::clear()
 }
 
 
+void PollSet::wakeUp()
+{
+	_pImpl->wakeUp();
+}
+
+
 PollSet::SocketModeMap PollSet::poll(const Poco::Timespan& timeout)
 {
-	return _pImpl->poll(timeout);
+	SocketModeList list;
+	_pImpl->poll(timeout, list);
+	SocketModeMap result;
+	for (SocketModeList::const_iterator it = list.begin(); it != list.end(); ++it)
+	{
+		result[it->first] |= it->second;
+	}
+	return result;
+}
+
+
+int PollSet::poll(const Poco::Timespan& timeout, SocketModeList& result)
+{
+	result.clear();
+	_pImpl->poll(timeout, result);
+	return static_cast<int>(result.size());
 }
 
 
@@ -0,0 +1,283 @@
+//
+// ShardedTCPServer.cpp
+//
+// Library: Net
+// Package: TCPServer
+// Module:  ShardedTCPServer
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/ShardedTCPServer.h"
+#include "Poco/Net/ServerSocket.h"
+#include "Poco/Environment.h"
+#include "Poco/NumberFormatter.h"
+#if POCO_OS == POCO_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+namespace Poco {
+namespace Net {
+
+
+class ShardedTCPServer::Shard: public TCPServer
+	/// A TCPServer that optionally binds its
+	/// accept thread to a CPU.
+{
+public:
+	Shard(ShardedTCPServer& owner, int index, TCPServerConnectionFactory::Ptr pFactory, Poco::ThreadPool& threadPool, const ServerSocket& socket, TCPServerParams::Ptr pParams):
+		TCPServer(pFactory, threadPool, socket, pParams),
+		_owner(owner),
+		_index(index)
+	{
+	}
+
+protected:
+	void run()
+	{
+		if (_owner._cpuAffinity)
+		{
+			ShardedTCPServer::bindToCPU(_index % static_cast<int>(Poco::Environment::processorCount()));
+		}
+		TCPServer::run();
+	}
+
+private:
+	ShardedTCPServer& _owner;
+	int _index;
+};
+
+
+ShardedTCPServer::ShardedTCPServer(TCPServerConnectionFactory::Ptr pFactory, const SocketAddress& address, int shardCount, TCPServerParams::Ptr pParams):
+	_cpuAffinity(false),
+	_started(false)
+{
+	init(pFactory, address, shardCount, pParams);
+}
+
+
+ShardedTCPServer::ShardedTCPServer(TCPServerConnectionFactory::Ptr pFactory, Poco::UInt16 portNumber, int shardCount, TCPServerParams::Ptr pParams):
+	_cpuAffinity(false),
+	_started(false)
+{
+	init(pFactory, SocketAddress(portNumber), shardCount, pParams);
+}
+
+
+ShardedTCPServer::~ShardedTCPServer()
+{
+	try
+	{
+		stop();
+	}
+	catch (...)
+	{
+		poco_unexpected();
+	}
+	for (ShardVec::iterator it = _shards.begin(); it != _shards.end(); ++it)
+	{
+		delete *it;
+	}
+	for (PoolVec::iterator it = _pools.begin(); it != _pools.end(); ++it)
+	{
+		delete *it;
+	}
+}
+
+
+void ShardedTCPServer::init(TCPServerConnectionFactory::Ptr pFactory, const SocketAddress& address, int shardCount, TCPServerParams::Ptr pParams)
+{
+	poco_check_ptr (pFactory);
+	poco_assert (shardCount >= 0);
+
+	if (shardCount == 0) shardCount = static_cast<int>(Poco::Environment::processorCount());
+	if (shardCount == 0) shardCount = 1;
+
+	_pParams = pParams;
+	if (!_pParams) _pParams = new TCPServerParams;
+	if (_pParams->getMaxThreads() == 0) _pParams->setMaxThreads(DEFAULT_MAX_THREADS);
+	int maxThreads = _pParams->getMaxThreads();
+
+	SocketAddress bindAddress(address);
+	try
+	{
+		for (int i = 0; i < shardCount; i++)
+		{
+			ServerSocket socket;
+			socket.bind(bindAddress, true, true);
+			socket.listen();
+			if (i == 0) bindAddress = SocketAddress(bindAddress.host(), socket.address().port());
+
+			std::string name("ShardedTCPServer[");
+			NumberFormatter::append(name, i);
+			name += ']';
+			_pools.push_back(new Poco::ThreadPool(name, maxThreads < 2 ? maxThreads : 2, maxThreads));
+			_shards.push_back(new Shard(*this, i, pFactory, *_pools.back(), socket, _pParams));
+		}
+	}
+	catch (...)
+	{
+		for (ShardVec::iterator it = _shards.begin(); it != _shards.end(); ++it)
+		{
+			delete *it;
+		}
+		_shards.clear();
+		for (PoolVec::iterator it = _pools.begin(); it != _pools.end(); ++it)
+		{
+			delete *it;
+		}
+		_pools.clear();
+		throw;
+	}
+}
+
+
+void ShardedTCPServer::setCPUAffinity(bool enable)
+{
+	poco_assert (!_started);
+
+	_cpuAffinity = enable;
+}
+
+
+void ShardedTCPServer::setConnectionFilter(const TCPServerConnectionFilter::Ptr& pFilter)
+{
+	poco_assert (!_started);
+
+	for (ShardVec::iterator it = _shards.begin(); it != _shards.end(); ++it)
+	{
+		(*it)->setConnectionFilter(pFilter);
+	}
+}
+
+
+void ShardedTCPServer::start()
+{
+	poco_assert (!_started);
+
+	_started = true;
+	for (ShardVec::iterator it = _shards.begin(); it != _shards.end(); ++it)
+	{
+		(*it)->start();
+	}
+}
+
+
+void ShardedTCPServer::stop()
+{
+	for (ShardVec::iterator it = _shards.begin(); it != _shards.end(); ++it)
+	{
+		(*it)->stop();
+	}
+}
+
+
+TCPServer& ShardedTCPServer::shard(int index) const
+{
+	poco_assert (index >= 0 && index < static_cast<int>(_shards.size()));
+
+	return *_shards[index];
+}
+
+
+Poco::UInt16 ShardedTCPServer::port() const
+{
+	return _shards.front()->port();
+}
+
+
+int ShardedTCPServer::currentThreads() const
+{
+	int result = 0;
+	for (ShardVec::const_iterator it = _shards.begin(); it != _shards.end(); ++it)
+	{
+		result += (*it)->currentThreads();
+	}
+	return result;
+}
+
+
+int ShardedTCPServer::maxThreads() const
+{
+	int result = 0;
+	for (ShardVec::const_iterator it = _shards.begin(); it != _shards.end(); ++it)
+	{
+		result += (*it)->maxThreads();
+	}
+	return result;
+}
+
+
+int ShardedTCPServer::totalConnections() const
+{
+	int result = 0;
+	for (ShardVec::const_iterator it = _shards.begin(); it != _shards.end(); ++it)
+	{
+		result += (*it)->totalConnections();
+	}
+	return result;
+}
+
+
+int ShardedTCPServer::currentConnections() const
+{
+	int result = 0;
+	for (ShardVec::const_iterator it = _shards.begin(); it != _shards.end(); ++it)
+	{
+		result += (*it)->currentConnections();
+	}
+	return result;
+}
+
+
+int ShardedTCPServer::maxConcurrentConnections() const
+{
+	int result = 0;
+	for (ShardVec::const_iterator it = _shards.begin(); it != _shards.end(); ++it)
+	{
+		result += (*it)->maxConcurrentConnections();
+	}
+	return result;
+}
+
+
+int ShardedTCPServer::queuedConnections() const
+{
+	int result = 0;
+	for (ShardVec::const_iterator it = _shards.begin(); it != _shards.end(); ++it)
+	{
+		result += (*it)->queuedConnections();
+	}
+	return result;
+}
+
+
+int ShardedTCPServer::refusedConnections() const
+{
+	int result = 0;
+	for (ShardVec::const_iterator it = _shards.begin(); it != _shards.end(); ++it)
+	{
+		result += (*it)->refusedConnections();
+	}
+	return result;
+}
+
+
+void ShardedTCPServer::bindToCPU(int cpu)
+{
+#if POCO_OS == POCO_OS_LINUX
+	cpu_set_t cpuset;
+	CPU_ZERO(&cpuset);
+	CPU_SET(cpu, &cpuset);
+	pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+#endif
+}
+
+
+} } // namespace Poco::Net
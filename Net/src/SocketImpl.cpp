@@ -17,6 +17,8 @@
 #include "Poco/Net/StreamSocketImpl.h"
 #include "Poco/NumberFormatter.h"
 #include "Poco/Timestamp.h"
+#include "Poco/FileStream.h"
+#include "Poco/Buffer.h"
 #include <string.h> // FD_SET needs memset on some platforms, so we can't use <cstring>
 
 
@@ -51,6 +53,18 @@
 #endif
 
 
+#if POCO_OS == POCO_OS_LINUX && !defined(POCO_NO_SENDFILE)
+#define POCO_HAVE_SENDFILE
+#include <sys/sendfile.h>
+#endif
+
+
+#if POCO_OS == POCO_OS_LINUX && !defined(POCO_NO_MMSG)
+#define POCO_HAVE_MMSG
+#include <netinet/udp.h>
+#endif
+
+
 using Poco::IOException;
 using Poco::TimeoutException;
 using Poco::InvalidArgumentException;
@@ -62,6 +76,19 @@ namespace Poco {
 namespace Net {
 
 
+#if defined(POCO_HAVE_MMSG)
+namespace
+{
+	enum
+	{
+		MMSG_BATCH_SIZE = 64
+			/// Maximum number of datagrams passed to a
+			/// single sendmmsg() or recvmmsg() call.
+	};
+}
+#endif
+
+
 bool checkIsBrokenTimeout()
 {
 #if defined(POCO_BROKEN_TIMEOUTS)
@@ -361,6 +388,60 @@ int SocketImpl::sendBytes(const SocketBufVec& buffers, int flags)
 }
 
 
+Poco::Int64 SocketImpl::sendFile(FileInputStream& fileInputStream, Poco::UInt64 offset, Poco::UInt64 count)
+{
+	poco_assert_dbg (_blocking);
+
+	Poco::UInt64 sent = 0;
+#if defined(POCO_HAVE_SENDFILE)
+	if (!secure())
+	{
+		checkBrokenTimeout(SELECT_WRITE);
+
+		const Poco::UInt64 MAX_CHUNK = 0x40000000;
+		off_t pos = static_cast<off_t>(offset);
+		while (sent < count)
+		{
+			Poco::UInt64 chunk = count - sent;
+			if (chunk > MAX_CHUNK) chunk = MAX_CHUNK;
+			ssize_t rc;
+			do
+			{
+				if (_sockfd == POCO_INVALID_SOCKET) throw InvalidSocketException();
+				rc = ::sendfile(_sockfd, fileInputStream.nativeHandle(), &pos, static_cast<std::size_t>(chunk));
+			}
+			while (rc < 0 && lastError() == POCO_EINTR);
+			if (rc < 0) error();
+			if (rc == 0) break;
+			sent += rc;
+		}
+		return static_cast<Poco::Int64>(sent);
+	}
+#endif
+	const std::streamsize BLOCK_SIZE = 65536;
+	Poco::Buffer<char> buffer(BLOCK_SIZE);
+	fileInputStream.clear();
+	fileInputStream.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+	while (sent < count && fileInputStream.good())
+	{
+		std::streamsize n = count - sent < static_cast<Poco::UInt64>(BLOCK_SIZE) ? static_cast<std::streamsize>(count - sent) : BLOCK_SIZE;
+		fileInputStream.read(buffer.begin(), n);
+		n = fileInputStream.gcount();
+		if (n == 0) break;
+		const char* p = buffer.begin();
+		while (n > 0)
+		{
+			int rc = sendBytes(p, static_cast<int>(n));
+			if (rc <= 0) throw IOException("Cannot send file");
+			p += rc;
+			n -= rc;
+			sent += rc;
+		}
+	}
+	return static_cast<Poco::Int64>(sent);
+}
+
+
 int SocketImpl::receiveBytes(void* buffer, int length, int flags)
 {
 	checkBrokenTimeout(SELECT_READ);
@@ -596,6 +677,184 @@ int SocketImpl::receiveFrom(SocketBufVec& buffers, struct sockaddr** pSA, poco_s
 }
 
 
+int SocketImpl::sendMessages(SocketMessageVec& messages, int flags)
+{
+	int count = static_cast<int>(messages.size());
+	if (count == 0) return 0;
+	if (_sockfd == POCO_INVALID_SOCKET)
+	{
+		if (!messages[0].pAddress) throw InvalidSocketException();
+		init(messages[0].pAddress->sa_family);
+	}
+	int sent = 0;
+#if defined(POCO_HAVE_MMSG)
+	struct mmsghdr hdrs[MMSG_BATCH_SIZE];
+	struct iovec iovs[MMSG_BATCH_SIZE];
+	union
+	{
+		char buffer[CMSG_SPACE(sizeof(Poco::UInt16))];
+		struct cmsghdr align;
+	} control[MMSG_BATCH_SIZE];
+	while (sent < count)
+	{
+		int n = count - sent < MMSG_BATCH_SIZE ? count - sent : MMSG_BATCH_SIZE;
+		for (int i = 0; i < n; i++)
+		{
+			SocketMessage& msg = messages[sent + i];
+			iovs[i].iov_base = msg.pBuffer;
+			iovs[i].iov_len = msg.bufferLength;
+			std::memset(&hdrs[i], 0, sizeof(hdrs[i]));
+			hdrs[i].msg_hdr.msg_name = msg.pAddress;
+			hdrs[i].msg_hdr.msg_namelen = msg.pAddress ? msg.addressLength : 0;
+			hdrs[i].msg_hdr.msg_iov = &iovs[i];
+			hdrs[i].msg_hdr.msg_iovlen = 1;
+			if (msg.segmentSize > 0)
+			{
+#if defined(UDP_SEGMENT)
+				hdrs[i].msg_hdr.msg_control = control[i].buffer;
+				hdrs[i].msg_hdr.msg_controllen = sizeof(control[i].buffer);
+				struct cmsghdr* pCmsg = CMSG_FIRSTHDR(&hdrs[i].msg_hdr);
+				pCmsg->cmsg_level = SOL_UDP;
+				pCmsg->cmsg_type = UDP_SEGMENT;
+				pCmsg->cmsg_len = CMSG_LEN(sizeof(Poco::UInt16));
+				Poco::UInt16 segmentSize = static_cast<Poco::UInt16>(msg.segmentSize);
+				std::memcpy(CMSG_DATA(pCmsg), &segmentSize, sizeof(segmentSize));
+#else
+				throw Poco::NotImplementedException("UDP segmentation offload");
+#endif
+			}
+		}
+		int rc;
+		do
+		{
+			rc = ::sendmmsg(_sockfd, hdrs, n, flags);
+		}
+		while (_blocking && rc < 0 && lastError() == POCO_EINTR);
+		if (rc < 0)
+		{
+			if (sent > 0) break;
+			error();
+		}
+		for (int i = 0; i < rc; i++)
+		{
+			messages[sent + i].length = static_cast<int>(hdrs[i].msg_len);
+		}
+		sent += rc;
+		if (rc < n) break;
+	}
+#else
+	for (; sent < count; ++sent)
+	{
+		SocketMessage& msg = messages[sent];
+		if (msg.segmentSize > 0) throw Poco::NotImplementedException("UDP segmentation offload");
+		int rc;
+		do
+		{
+			if (msg.pAddress)
+				rc = ::sendto(_sockfd, reinterpret_cast<const char*>(msg.pBuffer), msg.bufferLength, flags, msg.pAddress, msg.addressLength);
+			else
+				rc = ::send(_sockfd, reinterpret_cast<const char*>(msg.pBuffer), msg.bufferLength, flags);
+		}
+		while (_blocking && rc < 0 && lastError() == POCO_EINTR);
+		if (rc < 0)
+		{
+			if (sent > 0) break;
+			error();
+		}
+		msg.length = rc;
+	}
+#endif
+	return sent;
+}
+
+
+int SocketImpl::receiveMessages(SocketMessageVec& messages, int flags)
+{
+	checkBrokenTimeout(SELECT_READ);
+	if (_sockfd == POCO_INVALID_SOCKET) throw InvalidSocketException();
+	int count = static_cast<int>(messages.size());
+	if (count == 0) return 0;
+	int received = 0;
+#if defined(POCO_HAVE_MMSG)
+	struct mmsghdr hdrs[MMSG_BATCH_SIZE];
+	struct iovec iovs[MMSG_BATCH_SIZE];
+	union
+	{
+		char buffer[CMSG_SPACE(sizeof(int))];
+		struct cmsghdr align;
+	} control[MMSG_BATCH_SIZE];
+	while (received < count)
+	{
+		int n = count - received < MMSG_BATCH_SIZE ? count - received : MMSG_BATCH_SIZE;
+		for (int i = 0; i < n; i++)
+		{
+			SocketMessage& msg = messages[received + i];
+			iovs[i].iov_base = msg.pBuffer;
+			iovs[i].iov_len = msg.bufferLength;
+			std::memset(&hdrs[i], 0, sizeof(hdrs[i]));
+			hdrs[i].msg_hdr.msg_name = msg.pAddress;
+			hdrs[i].msg_hdr.msg_namelen = msg.pAddress ? msg.addressLength : 0;
+			hdrs[i].msg_hdr.msg_iov = &iovs[i];
+			hdrs[i].msg_hdr.msg_iovlen = 1;
+			hdrs[i].msg_hdr.msg_control = control[i].buffer;
+			hdrs[i].msg_hdr.msg_controllen = sizeof(control[i].buffer);
+		}
+		// Only wait for the first datagram; further batches
+		// only take what is already available.
+		int batchFlags = flags | (received == 0 ? MSG_WAITFORONE : MSG_DONTWAIT);
+		int rc;
+		do
+		{
+			rc = ::recvmmsg(_sockfd, hdrs, n, batchFlags, 0);
+		}
+		while (_blocking && rc < 0 && lastError() == POCO_EINTR);
+		if (rc < 0)
+		{
+			if (received > 0) break;
+			int err = lastError();
+			if (err == POCO_EAGAIN && !_blocking)
+				return 0;
+			else if (err == POCO_EAGAIN || err == POCO_ETIMEDOUT)
+				throw TimeoutException(err);
+			else
+				error(err);
+		}
+		for (int i = 0; i < rc; i++)
+		{
+			SocketMessage& msg = messages[received + i];
+			msg.length = static_cast<int>(hdrs[i].msg_len);
+			if (msg.pAddress) msg.addressLength = hdrs[i].msg_hdr.msg_namelen;
+			msg.segmentSize = 0;
+#if defined(UDP_GRO)
+			for (struct cmsghdr* pCmsg = CMSG_FIRSTHDR(&hdrs[i].msg_hdr); pCmsg; pCmsg = CMSG_NXTHDR(&hdrs[i].msg_hdr, pCmsg))
+			{
+				if (pCmsg->cmsg_level == SOL_UDP && pCmsg->cmsg_type == UDP_GRO)
+				{
+					std::memcpy(&msg.segmentSize, CMSG_DATA(pCmsg), sizeof(int));
+				}
+			}
+#endif
+		}
+		received += rc;
+		if (rc < n) break;
+	}
+#else
+	SocketMessage& msg = messages[0];
+	sockaddr_storage abuffer;
+	struct sockaddr* pSA = msg.pAddress ? msg.pAddress : reinterpret_cast<struct sockaddr*>(&abuffer);
+	poco_socklen_t saLen = msg.pAddress ? msg.addressLength : sizeof(abuffer);
+	poco_socklen_t* pSALen = &saLen;
+	int rc = receiveFrom(msg.pBuffer, msg.bufferLength, &pSA, &pSALen, flags);
+	if (rc < 0) return 0;
+	msg.length = rc;
+	if (msg.pAddress) msg.addressLength = saLen;
+	msg.segmentSize = 0;
+	received = 1;
+#endif
+	return received;
+}
+
+
 void SocketImpl::sendUrgent(unsigned char data)
 {
 	if (_sockfd == POCO_INVALID_SOCKET) throw InvalidSocketException();
@@ -18,10 +18,13 @@
 #include "Poco/ErrorHandler.h"
 #include "Poco/Thread.h"
 #include "Poco/Exception.h"
+#include <algorithm>
 
 
 using Poco::Exception;
 using Poco::ErrorHandler;
+using Poco::Clock;
+using Poco::TimingWheel;
 
 
 namespace Poco {
@@ -31,13 +34,16 @@ namespace Net {
 SocketReactor::SocketReactor():
 	_stop(false),
 	_timeout(DEFAULT_TIMEOUT),
+	_pollFlags(0),
+	_load(0),
 	_pReadableNotification(new ReadableNotification(this)),
 	_pWritableNotification(new WritableNotification(this)),
 	_pErrorNotification(new ErrorNotification(this)),
 	_pTimeoutNotification(new TimeoutNotification(this)),
 	_pIdleNotification(new IdleNotification(this)),
 	_pShutdownNotification(new ShutdownNotification(this)),
-	_pThread(0)
+	_runners(0),
+	_nextTimerId(0)
 {
 }
 
@@ -45,13 +51,16 @@ SocketReactor::SocketReactor():
 SocketReactor::SocketReactor(const Poco::Timespan& timeout):
 	_stop(false),
 	_timeout(timeout),
+	_pollFlags(0),
+	_load(0),
 	_pReadableNotification(new ReadableNotification(this)),
 	_pWritableNotification(new WritableNotification(this)),
 	_pErrorNotification(new ErrorNotification(this)),
 	_pTimeoutNotification(new TimeoutNotification(this)),
 	_pIdleNotification(new IdleNotification(this)),
 	_pShutdownNotification(new ShutdownNotification(this)),
-	_pThread(0)
+	_runners(0),
+	_nextTimerId(0)
 {
 }
 
@@ -63,25 +72,38 @@ SocketReactor::~SocketReactor()
 
 void SocketReactor::run()
 {
-	_pThread = Thread::current();
+	Thread* pThread = Thread::current();
+	{
+		ScopedLock lock(_mutex);
+		if (pThread) _threads.push_back(pThread);
+	}
+	++_runners;
+	PollSet::SocketModeList events;
+	TimerVec expired;
+	Clock timeoutStart;
 	while (!_stop)
 	{
+		Poco::Timestamp iterationStart;
+		Poco::Timestamp::TimeDiff busy = 0;
 		try
 		{
+			Poco::Timespan timeout = nextTimeout(timeoutStart);
 			if (!hasSocketHandlers())
 			{
 				onIdle();
-				Thread::trySleep(static_cast<long>(_timeout.totalMilliseconds()));
+				Thread::trySleep(static_cast<long>(timeout.totalMilliseconds()));
+				timeoutStart.update();
 			}
 			else
 			{
 				bool readable = false;
-				PollSet::SocketModeMap sm = _pollSet.poll(_timeout);
-				if (sm.size() > 0)
+				int n = _pollSet.poll(timeout, events);
+				if (n > 0)
 				{
+					Poco::Timestamp busyStart;
 					onBusy();
-					PollSet::SocketModeMap::iterator it = sm.begin();
-					PollSet::SocketModeMap::iterator end = sm.end();
+					PollSet::SocketModeList::iterator it = events.begin();
+					PollSet::SocketModeList::iterator end = events.end();
 					for (; it != end; ++it)
 					{
 						if (it->second & PollSet::POLL_READ)
@@ -91,10 +113,26 @@ void SocketReactor::run()
 						}
 						if (it->second & PollSet::POLL_WRITE) dispatch(it->first, _pWritableNotification);
 						if (it->second & PollSet::POLL_ERROR) dispatch(it->first, _pErrorNotification);
+						if (_pollFlags & PollSet::POLL_ONE_SHOT) rearm(it->first);
 					}
+					events.clear();
+					busy = busyStart.elapsed();
+				}
+				// A poll that has been shortened by a timer must not
+				// cause a TimeoutNotification before the timeout expires.
+				if (readable)
+				{
+					timeoutStart.update();
+				}
+				else if (n > 0 || timeoutStart.isElapsed(_timeout.totalMicroseconds()))
+				{
+					onTimeout();
+					timeoutStart.update();
 				}
-				if (!readable) onTimeout();
 			}
+			Poco::Timestamp timerStart;
+			processTimers(expired);
+			busy += timerStart.elapsed();
 		}
 		catch (Exception& exc)
 		{
@@ -108,8 +146,16 @@ void SocketReactor::run()
 		{
 			ErrorHandler::handle();
 		}
+		updateLoad(busy, iterationStart.elapsed());
 	}
 	onShutdown();
+	--_runners;
+	if (pThread)
+	{
+		ScopedLock lock(_mutex);
+		std::vector<Thread*>::iterator it = std::find(_threads.begin(), _threads.end(), pThread);
+		if (it != _threads.end()) _threads.erase(it);
+	}
 }
 
 
@@ -130,6 +176,229 @@ bool SocketReactor::hasSocketHandlers()
 }
 
 
+std::size_t SocketReactor::socketCount() const
+{
+	ScopedLock lock(_mutex);
+
+	return _handlers.size();
+}
+
+
+double SocketReactor::load() const
+{
+	return _load.load(std::memory_order_relaxed)/double(LOAD_SCALE);
+}
+
+
+void SocketReactor::updateLoad(Poco::Timestamp::TimeDiff busy, Poco::Timestamp::TimeDiff total)
+{
+	// exponentially weighted moving average, with a weight
+	// of 1/8 for the most recent iteration
+	Poco::Int64 current = total > 0 ? busy*LOAD_SCALE/total : 0;
+	if (current > LOAD_SCALE) current = LOAD_SCALE;
+	Poco::Int64 load = _load.load(std::memory_order_relaxed);
+	_load.store(static_cast<int>(load + (current - load)/8), std::memory_order_relaxed);
+}
+
+
+SocketReactor::Timer::Timer(const TimerCallback& callback, const Poco::Timespan& interval):
+	id(0),
+	callback(callback),
+	interval(interval),
+	hasSocket(false),
+	cancelled(false)
+{
+}
+
+
+SocketReactor::TimerId SocketReactor::addTimer(const Poco::Timespan& delay, const TimerCallback& callback, const Poco::Timespan& interval)
+{
+	TimerPtr pTimer = new Timer(callback, interval);
+	return scheduleTimer(pTimer, delay);
+}
+
+
+SocketReactor::TimerId SocketReactor::addTimer(const Socket& socket, const Poco::Timespan& delay, const TimerCallback& callback, const Poco::Timespan& interval)
+{
+	TimerPtr pTimer = new Timer(callback, interval);
+	pTimer->socket = socket;
+	pTimer->hasSocket = true;
+	return scheduleTimer(pTimer, delay);
+}
+
+
+bool SocketReactor::restartTimer(TimerId id, const Poco::Timespan& delay)
+{
+	Clock deadline = Clock() + delay.totalMicroseconds();
+	{
+		ScopedLock lock(_timerMutex);
+
+		TimerMap::iterator it = _timers.find(id);
+		if (it == _timers.end()) return false;
+		_timerWheel.schedule(*it->second, deadline);
+		if (!(deadline < _pollDeadline)) return true;
+	}
+	wakeUp();
+	return true;
+}
+
+
+bool SocketReactor::cancelTimer(TimerId id)
+{
+	ScopedLock lock(_timerMutex);
+
+	TimerMap::iterator it = _timers.find(id);
+	if (it == _timers.end()) return false;
+	it->second->cancelled = true;
+	removeTimer(it);
+	return true;
+}
+
+
+std::size_t SocketReactor::timerCount() const
+{
+	ScopedLock lock(_timerMutex);
+
+	return _timers.size();
+}
+
+
+SocketReactor::TimerId SocketReactor::scheduleTimer(TimerPtr pTimer, const Poco::Timespan& delay)
+{
+	Clock deadline = Clock() + delay.totalMicroseconds();
+	{
+		ScopedLock lock(_timerMutex);
+
+		pTimer->id = ++_nextTimerId;
+		_timers[pTimer->id] = pTimer;
+		if (pTimer->hasSocket) _socketTimers.insert(SocketTimerMap::value_type(pTimer->socket, pTimer->id));
+		_timerWheel.schedule(*pTimer, deadline);
+		if (!(deadline < _pollDeadline)) return pTimer->id;
+	}
+	// the reactor is waiting beyond the new deadline
+	wakeUp();
+	return pTimer->id;
+}
+
+
+void SocketReactor::removeTimer(TimerMap::iterator it)
+{
+	TimerPtr pTimer = it->second;
+	_timerWheel.cancel(*pTimer);
+	if (pTimer->hasSocket)
+	{
+		std::pair<SocketTimerMap::iterator, SocketTimerMap::iterator> range = _socketTimers.equal_range(pTimer->socket);
+		for (SocketTimerMap::iterator itSocket = range.first; itSocket != range.second; ++itSocket)
+		{
+			if (itSocket->second == pTimer->id)
+			{
+				_socketTimers.erase(itSocket);
+				break;
+			}
+		}
+	}
+	_timers.erase(it);
+}
+
+
+void SocketReactor::cancelTimers(const Socket& socket)
+{
+	ScopedLock lock(_timerMutex);
+
+	std::pair<SocketTimerMap::iterator, SocketTimerMap::iterator> range = _socketTimers.equal_range(socket);
+	for (SocketTimerMap::iterator it = range.first; it != range.second; ++it)
+	{
+		TimerMap::iterator itTimer = _timers.find(it->second);
+		if (itTimer != _timers.end())
+		{
+			itTimer->second->cancelled = true;
+			_timerWheel.cancel(*itTimer->second);
+			_timers.erase(itTimer);
+		}
+	}
+	_socketTimers.erase(range.first, range.second);
+}
+
+
+Poco::Timespan SocketReactor::nextTimeout(const Poco::Clock& timeoutStart)
+{
+	Clock::ClockDiff timeout = _timeout.totalMicroseconds() - timeoutStart.elapsed();
+	if (timeout < 0) timeout = 0;
+	{
+		ScopedLock lock(_timerMutex);
+
+		Clock now;
+		if (!_timerWheel.empty())
+		{
+			Clock::ClockDiff timerTimeout = _timerWheel.timeout(now);
+			if (timerTimeout >= 0 && timerTimeout < timeout) timeout = timerTimeout;
+		}
+		// PollSet::poll() and Thread::trySleep() truncate
+		// the timeout to milliseconds, so round it up.
+		timeout = ((timeout + 999)/1000)*1000;
+		// A timer scheduled from now on with an earlier
+		// deadline wakes up the reactor.
+		_pollDeadline = now + timeout;
+	}
+	return Poco::Timespan(timeout);
+}
+
+
+void SocketReactor::processTimers(TimerVec& expired)
+{
+	{
+		ScopedLock lock(_timerMutex);
+
+		if (_timerWheel.empty()) return;
+		Clock now;
+		TimingWheel::EntryVec entries;
+		_timerWheel.advance(now, entries);
+		for (TimingWheel::EntryVec::iterator it = entries.begin(); it != entries.end(); ++it)
+		{
+			Timer* pTimer = static_cast<Timer*>(*it);
+			expired.push_back(TimerPtr(pTimer, true));
+			// A one-shot timer stays in _timers until its callback
+			// has been executed, so that it can still be cancelled.
+			if (pTimer->interval > 0)
+				_timerWheel.schedule(*pTimer, now + pTimer->interval.totalMicroseconds());
+		}
+	}
+	for (TimerVec::iterator it = expired.begin(); it != expired.end(); ++it)
+	{
+		// The timer may have been cancelled by a callback executed before.
+		if (!(*it)->cancelled)
+		{
+			try
+			{
+				(*it)->callback();
+			}
+			catch (Exception& exc)
+			{
+				ErrorHandler::handle(exc);
+			}
+			catch (std::exception& exc)
+			{
+				ErrorHandler::handle(exc);
+			}
+			catch (...)
+			{
+				ErrorHandler::handle();
+			}
+		}
+		if ((*it)->interval <= 0)
+		{
+			ScopedLock lock(_timerMutex);
+
+			// Keep the timer if its callback has restarted it.
+			TimerMap::iterator itTimer = _timers.find((*it)->id);
+			if (itTimer != _timers.end() && itTimer->second == *it && !(*it)->isScheduled())
+				removeTimer(itTimer);
+		}
+	}
+	expired.clear();
+}
+
+
 void SocketReactor::stop()
 {
 	_stop = true;
@@ -138,7 +407,14 @@ void SocketReactor::stop()
 
 void SocketReactor::wakeUp()
 {
-	if (_pThread) _pThread->wakeUp();
+	{
+		ScopedLock lock(_mutex);
+		for (std::vector<Thread*>::iterator it = _threads.begin(); it != _threads.end(); ++it)
+		{
+			(*it)->wakeUp();
+		}
+	}
+	_pollSet.wakeUp();
 }
 
 
@@ -154,17 +430,70 @@ const Poco::Timespan& SocketReactor::getTimeout() const
 }
 
 
+void SocketReactor::setEdgeTriggered(bool flag)
+{
+	if (flag)
+		_pollFlags |= PollSet::POLL_EDGE_TRIGGERED;
+	else
+		_pollFlags &= ~PollSet::POLL_EDGE_TRIGGERED;
+}
+
+
+bool SocketReactor::getEdgeTriggered() const
+{
+	return (_pollFlags & PollSet::POLL_EDGE_TRIGGERED) != 0;
+}
+
+
+void SocketReactor::setOneShot(bool flag)
+{
+	if (flag)
+		_pollFlags |= PollSet::POLL_ONE_SHOT;
+	else
+		_pollFlags &= ~PollSet::POLL_ONE_SHOT;
+}
+
+
+bool SocketReactor::getOneShot() const
+{
+	return (_pollFlags & PollSet::POLL_ONE_SHOT) != 0;
+}
+
+
 void SocketReactor::addEventHandler(const Socket& socket, const Poco::AbstractObserver& observer)
 {
 	NotifierPtr pNotifier = getNotifier(socket, true);
 
 	if (!pNotifier->hasObserver(observer)) pNotifier->addObserver(this, observer);
 
+	int mode = pollMode(pNotifier);
+	if (mode) _pollSet.add(socket, mode);
+}
+
+
+int SocketReactor::pollMode(NotifierPtr& pNotifier)
+{
 	int mode = 0;
 	if (pNotifier->accepts(_pReadableNotification)) mode |= PollSet::POLL_READ;
 	if (pNotifier->accepts(_pWritableNotification)) mode |= PollSet::POLL_WRITE;
 	if (pNotifier->accepts(_pErrorNotification))    mode |= PollSet::POLL_ERROR;
-	if (mode) _pollSet.add(socket, mode);
+	if (mode) mode |= _pollFlags;
+	return mode;
+}
+
+
+void SocketReactor::rearm(const Socket& socket)
+{
+	// The lock ensures that the socket is not removed
+	// from the PollSet between the check and the update.
+	ScopedLock lock(_mutex);
+
+	EventHandlerMap::iterator it = _handlers.find(socket);
+	if (it != _handlers.end())
+	{
+		int mode = pollMode(it->second);
+		if (mode) _pollSet.update(socket, mode);
+	}
 }
 
 
@@ -201,6 +530,7 @@ void SocketReactor::removeEventHandler(const Socket& socket, const Poco::Abstrac
 				_handlers.erase(socket);
 			}
 			_pollSet.remove(socket);
+			cancelTimers(socket);
 		}
 		pNotifier->removeObserver(this, observer);
 	}
@@ -236,16 +566,37 @@ void SocketReactor::onBusy()
 }
 
 
+SocketNotification* SocketReactor::notificationFor(SocketNotification* pNotification)
+{
+	// SocketNotifier::dispatch() sets the socket of the notification,
+	// so threads running the reactor at the same time must not share
+	// the notification objects.
+	if (_runners.load() > 1)
+	{
+		if (pNotification == _pReadableNotification) return new ReadableNotification(this);
+		if (pNotification == _pWritableNotification) return new WritableNotification(this);
+		if (pNotification == _pErrorNotification) return new ErrorNotification(this);
+		if (pNotification == _pTimeoutNotification) return new TimeoutNotification(this);
+		if (pNotification == _pIdleNotification) return new IdleNotification(this);
+		if (pNotification == _pShutdownNotification) return new ShutdownNotification(this);
+	}
+	pNotification->duplicate();
+	return pNotification;
+}
+
+
 void SocketReactor::dispatch(const Socket& socket, SocketNotification* pNotification)
 {
 	NotifierPtr pNotifier = getNotifier(socket);
 	if (!pNotifier) return;
-	dispatch(pNotifier, pNotification);
+	NotificationPtr pNf = notificationFor(pNotification);
+	dispatch(pNotifier, pNf);
 }
 
 
 void SocketReactor::dispatch(SocketNotification* pNotification)
 {
+	NotificationPtr pNf = notificationFor(pNotification);
 	std::vector<NotifierPtr> delegates;
 	{
 		ScopedLock lock(_mutex);
@@ -255,7 +606,7 @@ void SocketReactor::dispatch(SocketNotification* pNotification)
 	}
 	for (std::vector<NotifierPtr>::iterator it = delegates.begin(); it != delegates.end(); ++it)
 	{
-		dispatch(*it, pNotification);
+		dispatch(*it, pNf);
 	}
 }
 
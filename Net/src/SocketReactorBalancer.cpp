@@ -0,0 +1,166 @@
+//
+// SocketReactorBalancer.cpp
+//
+// Library: Net
+// Package: Reactor
+// Module:  SocketReactorBalancer
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/SocketReactorBalancer.h"
+#include "Poco/Net/SocketReactor.h"
+#include "Poco/Net/IPAddress.h"
+
+
+namespace Poco {
+namespace Net {
+
+
+//
+// SocketReactorBalancer
+//
+
+
+SocketReactorBalancer::SocketReactorBalancer()
+{
+}
+
+
+SocketReactorBalancer::~SocketReactorBalancer()
+{
+}
+
+
+//
+// RoundRobinBalancer
+//
+
+
+RoundRobinBalancer::RoundRobinBalancer():
+	_next(0)
+{
+}
+
+
+RoundRobinBalancer::~RoundRobinBalancer()
+{
+}
+
+
+std::size_t RoundRobinBalancer::select(const ReactorVec& reactors, const StreamSocket&)
+{
+	return _next++ % reactors.size();
+}
+
+
+//
+// LeastConnectionsBalancer
+//
+
+
+LeastConnectionsBalancer::LeastConnectionsBalancer()
+{
+}
+
+
+LeastConnectionsBalancer::~LeastConnectionsBalancer()
+{
+}
+
+
+std::size_t LeastConnectionsBalancer::select(const ReactorVec& reactors, const StreamSocket&)
+{
+	std::size_t result = 0;
+	std::size_t minCount = reactors[0]->socketCount();
+	for (std::size_t i = 1; i < reactors.size() && minCount > 0; i++)
+	{
+		std::size_t count = reactors[i]->socketCount();
+		if (count < minCount)
+		{
+			minCount = count;
+			result = i;
+		}
+	}
+	return result;
+}
+
+
+//
+// LeastLoadBalancer
+//
+
+
+LeastLoadBalancer::LeastLoadBalancer(double threshold):
+	_threshold(threshold)
+{
+}
+
+
+LeastLoadBalancer::~LeastLoadBalancer()
+{
+}
+
+
+std::size_t LeastLoadBalancer::select(const ReactorVec& reactors, const StreamSocket&)
+{
+	std::size_t result = 0;
+	double minLoad = reactors[0]->load();
+	std::size_t minCount = reactors[0]->socketCount();
+	for (std::size_t i = 1; i < reactors.size(); i++)
+	{
+		double load = reactors[i]->load();
+		std::size_t count = reactors[i]->socketCount();
+		bool better;
+		if (load < _threshold && minLoad < _threshold)
+			better = count < minCount;
+		else
+			better = load < minLoad;
+		if (better)
+		{
+			minLoad = load;
+			minCount = count;
+			result = i;
+		}
+	}
+	return result;
+}
+
+
+//
+// PeerHashBalancer
+//
+
+
+PeerHashBalancer::PeerHashBalancer()
+{
+}
+
+
+PeerHashBalancer::~PeerHashBalancer()
+{
+}
+
+
+std::size_t PeerHashBalancer::select(const ReactorVec& reactors, const StreamSocket& socket)
+{
+	IPAddress host = socket.peerAddress().host();
+	const unsigned char* it = static_cast<const unsigned char*>(host.addr());
+	const unsigned char* end = it + host.length();
+
+	// FNV-1a
+	Poco::UInt32 hash = 2166136261U;
+	for (; it != end; ++it)
+	{
+		hash ^= *it;
+		hash *= 16777619U;
+	}
+	return hash % reactors.size();
+}
+
+
+} } // namespace Poco::Net
@@ -131,6 +131,12 @@ int StreamSocket::sendBytes(FIFOBuffer& fifoBuf)
 }
 
 
+Poco::Int64 StreamSocket::sendFile(FileInputStream& fileInputStream, Poco::UInt64 offset, Poco::UInt64 count)
+{
+	return impl()->sendFile(fileInputStream, offset, count);
+}
+
+
 int StreamSocket::receiveBytes(void* buffer, int length, int flags)
 {
 	return impl()->receiveBytes(buffer, length, flags);
@@ -45,6 +45,12 @@ WebSocket::WebSocket(HTTPServerRequest& request, HTTPServerResponse& response):
 }
 
 
+WebSocket::WebSocket(HTTPServerRequest& request, HTTPServerResponse& response, const WebSocketDeflate::Params& deflateParams):
+	StreamSocket(accept(request, response, &deflateParams))
+{
+}
+
+
 WebSocket::WebSocket(HTTPClientSession& cs, HTTPRequest& request, HTTPResponse& response):
 	StreamSocket(connect(cs, request, response, _defaultCreds))
 {
@@ -57,6 +63,18 @@ WebSocket::WebSocket(HTTPClientSession& cs, HTTPRequest& request, HTTPResponse&
 }
 
 
+WebSocket::WebSocket(HTTPClientSession& cs, HTTPRequest& request, HTTPResponse& response, const WebSocketDeflate::Params& deflateParams):
+	StreamSocket(connect(cs, request, response, _defaultCreds, &deflateParams))
+{
+}
+
+
+WebSocket::WebSocket(HTTPClientSession& cs, HTTPRequest& request, HTTPResponse& response, HTTPCredentials& credentials, const WebSocketDeflate::Params& deflateParams):
+	StreamSocket(connect(cs, request, response, credentials, &deflateParams))
+{
+}
+
+
 WebSocket::WebSocket(const Socket& socket):
 	StreamSocket(socket)
 {
@@ -120,6 +138,17 @@ int WebSocket::receiveFrame(Poco::Buffer<char>& buffer, int& flags)
 }
 
 
+int WebSocket::receiveFrame(Poco::FIFOBuffer& buffer, int& flags)
+{
+	Poco::Mutex::ScopedLock lock(buffer.mutex());
+
+	int n = static_cast<WebSocketImpl*>(impl())->receiveBytes(buffer.next(), static_cast<int>(buffer.available()), 0);
+	flags = static_cast<WebSocketImpl*>(impl())->frameFlags();
+	if (n > 0) buffer.advance(n);
+	return n;
+}
+
+
 WebSocket::Mode WebSocket::mode() const
 {
 	return static_cast<WebSocketImpl*>(impl())->mustMaskPayload() ? WS_CLIENT : WS_SERVER;
@@ -138,7 +167,19 @@ int WebSocket::getMaxPayloadSize() const
 }
 
 
+bool WebSocket::deflateEnabled() const
+{
+	return static_cast<WebSocketImpl*>(impl())->deflate() != 0;
+}
+
+
 WebSocketImpl* WebSocket::accept(HTTPServerRequest& request, HTTPServerResponse& response)
+{
+	return accept(request, response, 0);
+}
+
+
+WebSocketImpl* WebSocket::accept(HTTPServerRequest& request, HTTPServerResponse& response, const WebSocketDeflate::Params* pDeflateParams)
 {
 	if (request.hasToken("Connection", "upgrade") && icompare(request.get("Upgrade", ""), "websocket") == 0)
 	{
@@ -153,17 +194,33 @@ WebSocketImpl* WebSocket::accept(HTTPServerRequest& request, HTTPServerResponse&
 		response.set("Upgrade", "websocket");
 		response.set("Connection", "Upgrade");
 		response.set("Sec-WebSocket-Accept", computeAccept(key));
+		WebSocketDeflate::Params agreed;
+		bool deflate = false;
+		if (pDeflateParams && request.has("Sec-WebSocket-Extensions"))
+		{
+			std::string extensions;
+			deflate = WebSocketDeflate::negotiate(request.get("Sec-WebSocket-Extensions"), *pDeflateParams, agreed, extensions);
+			if (deflate) response.set("Sec-WebSocket-Extensions", extensions);
+		}
 		response.setContentLength(HTTPResponse::UNKNOWN_CONTENT_LENGTH);
 		response.send().flush();
 
 		HTTPServerRequestImpl& requestImpl = static_cast<HTTPServerRequestImpl&>(request);
-		return new WebSocketImpl(static_cast<StreamSocketImpl*>(requestImpl.detachSocket().impl()), requestImpl.session(), false);
+		WebSocketImpl* pImpl = new WebSocketImpl(static_cast<StreamSocketImpl*>(requestImpl.detachSocket().impl()), requestImpl.session(), false);
+		if (deflate) pImpl->setDeflate(new WebSocketDeflate(agreed, true));
+		return pImpl;
 	}
 	else throw WebSocketException("No WebSocket handshake", WS_ERR_NO_HANDSHAKE);
 }
 
 
 WebSocketImpl* WebSocket::connect(HTTPClientSession& cs, HTTPRequest& request, HTTPResponse& response, HTTPCredentials& credentials)
+{
+	return connect(cs, request, response, credentials, 0);
+}
+
+
+WebSocketImpl* WebSocket::connect(HTTPClientSession& cs, HTTPRequest& request, HTTPResponse& response, HTTPCredentials& credentials, const WebSocketDeflate::Params* pDeflateParams)
 {
 	if (!cs.getProxyHost().empty() && !cs.secure())
 	{
@@ -174,13 +231,14 @@ WebSocketImpl* WebSocket::connect(HTTPClientSession& cs, HTTPRequest& request, H
 	request.set("Upgrade", "websocket");
 	request.set("Sec-WebSocket-Version", WEBSOCKET_VERSION);
 	request.set("Sec-WebSocket-Key", key);
+	if (pDeflateParams) request.set("Sec-WebSocket-Extensions", WebSocketDeflate::createOffer(*pDeflateParams));
 	request.setChunkedTransferEncoding(false);
 	cs.setKeepAlive(true);
 	cs.sendRequest(request);
 	std::istream& istr = cs.receiveResponse(response);
 	if (response.getStatus() == HTTPResponse::HTTP_SWITCHING_PROTOCOLS)
 	{
-		return completeHandshake(cs, response, key);
+		return completeHandshake(cs, response, key, pDeflateParams);
 	}
 	else if (response.getStatus() == HTTPResponse::HTTP_UNAUTHORIZED)
 	{
@@ -198,7 +256,7 @@ WebSocketImpl* WebSocket::connect(HTTPClientSession& cs, HTTPRequest& request, H
 			cs.receiveResponse(response);
 			if (response.getStatus() == HTTPResponse::HTTP_SWITCHING_PROTOCOLS)
 			{
-				return completeHandshake(cs, response, key);
+				return completeHandshake(cs, response, key, pDeflateParams);
 			}
 			else if (response.getStatus() == HTTPResponse::HTTP_UNAUTHORIZED)
 			{
@@ -219,6 +277,12 @@ WebSocketImpl* WebSocket::connect(HTTPClientSession& cs, HTTPRequest& request, H
 
 
 WebSocketImpl* WebSocket::completeHandshake(HTTPClientSession& cs, HTTPResponse& response, const std::string& key)
+{
+	return completeHandshake(cs, response, key, 0);
+}
+
+
+WebSocketImpl* WebSocket::completeHandshake(HTTPClientSession& cs, HTTPResponse& response, const std::string& key, const WebSocketDeflate::Params* pDeflateParams)
 {
 	std::string connection = response.get("Connection", "");
 	if (Poco::icompare(connection, "Upgrade") != 0)
@@ -229,7 +293,15 @@ WebSocketImpl* WebSocket::completeHandshake(HTTPClientSession& cs, HTTPResponse&
 	std::string accept = response.get("Sec-WebSocket-Accept", "");
 	if (accept != computeAccept(key))
 		throw WebSocketException("Invalid or missing Sec-WebSocket-Accept header in handshake response", WS_ERR_HANDSHAKE_ACCEPT);
-	return new WebSocketImpl(static_cast<StreamSocketImpl*>(cs.detachSocket().impl()), cs, true);
+	WebSocketDeflate::Params agreed;
+	bool deflate = false;
+	if (pDeflateParams && response.has("Sec-WebSocket-Extensions"))
+	{
+		deflate = WebSocketDeflate::accept(response.get("Sec-WebSocket-Extensions"), *pDeflateParams, agreed);
+	}
+	WebSocketImpl* pImpl = new WebSocketImpl(static_cast<StreamSocketImpl*>(cs.detachSocket().impl()), cs, true);
+	if (deflate) pImpl->setDeflate(new WebSocketDeflate(agreed, false));
+	return pImpl;
 }
 
 
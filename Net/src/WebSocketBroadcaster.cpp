@@ -0,0 +1,456 @@
+//
+// WebSocketBroadcaster.cpp
+//
+// Library: Net
+// Package: WebSocket
+// Module:  WebSocketBroadcaster
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/WebSocketBroadcaster.h"
+#include "Poco/Net/WebSocketImpl.h"
+#include "Poco/Observer.h"
+#include "Poco/Exception.h"
+#include <cstring>
+
+
+using Poco::FastMutex;
+
+
+namespace Poco {
+namespace Net {
+
+
+//
+// WebSocketBroadcaster::Frame
+//
+
+
+WebSocketBroadcaster::Frame::Frame(std::size_t size):
+	data(size)
+{
+}
+
+
+WebSocketBroadcaster::Frame::~Frame()
+{
+}
+
+
+//
+// WebSocketBroadcaster::Subscriber
+//
+
+
+WebSocketBroadcaster::Subscriber::Subscriber(const WebSocket& ws):
+	socket(ws),
+	deflateWindowBits(0),
+	offset(0),
+	queued(0),
+	writeHandler(false)
+{
+	// Shared compressed frames can only be sent if the
+	// server does not use context takeover anyway.
+	WebSocketDeflate* pDeflate = static_cast<WebSocketImpl*>(socket.impl())->deflate();
+	if (pDeflate && pDeflate->params().serverNoContextTakeover)
+		deflateWindowBits = pDeflate->params().serverMaxWindowBits;
+}
+
+
+WebSocketBroadcaster::Subscriber::~Subscriber()
+{
+}
+
+
+//
+// WebSocketBroadcaster
+//
+
+
+WebSocketBroadcaster::WebSocketBroadcaster(SocketReactor& reactor, std::size_t maxQueuedBytes):
+	_reactor(reactor),
+	_maxQueuedBytes(maxQueuedBytes),
+	_deflateBuffer(0)
+{
+}
+
+
+WebSocketBroadcaster::~WebSocketBroadcaster()
+{
+	try
+	{
+		std::vector<Socket> handlers;
+		{
+			FastMutex::ScopedLock lock(_mutex);
+
+			for (SubscriberMap::iterator it = _subscribers.begin(); it != _subscribers.end(); ++it)
+			{
+				if (it->second->writeHandler) handlers.push_back(it->second->socket);
+				if (it->second->offset != 0) shutdown(*it->second);
+			}
+			_subscribers.clear();
+		}
+		removeHandlers(handlers);
+	}
+	catch (...)
+	{
+		poco_unexpected();
+	}
+}
+
+
+void WebSocketBroadcaster::subscribe(const WebSocket& socket)
+{
+	if (socket.mode() != WebSocket::WS_SERVER)
+		throw InvalidArgumentException("Cannot subscribe a client-side WebSocket");
+
+	FastMutex::ScopedLock lock(_mutex);
+
+	if (_subscribers.find(socket) == _subscribers.end())
+	{
+		_subscribers[socket] = new Subscriber(socket);
+	}
+}
+
+
+bool WebSocketBroadcaster::unsubscribe(const WebSocket& socket)
+{
+	std::vector<Socket> handlers;
+	{
+		FastMutex::ScopedLock lock(_mutex);
+
+		SubscriberMap::iterator it = _subscribers.find(socket);
+		if (it == _subscribers.end()) return false;
+		remove(it->second, handlers);
+	}
+	removeHandlers(handlers);
+	return true;
+}
+
+
+bool WebSocketBroadcaster::isSubscribed(const WebSocket& socket) const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	return _subscribers.find(socket) != _subscribers.end();
+}
+
+
+std::size_t WebSocketBroadcaster::subscribers() const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	return _subscribers.size();
+}
+
+
+std::size_t WebSocketBroadcaster::broadcast(const void* buffer, int length, int flags)
+{
+	poco_assert (length >= 0);
+
+	if (flags == 0) flags = WebSocket::FRAME_BINARY;
+	const char* payload = reinterpret_cast<const char*>(buffer);
+	std::size_t count = 0;
+	std::vector<WebSocket> dropped;
+	std::vector<Socket> handlers;
+	{
+		FastMutex::ScopedLock lock(_mutex);
+
+		bool compress = _pDeflate && ((flags & 0xff) == WebSocket::FRAME_TEXT || (flags & 0xff) == WebSocket::FRAME_BINARY);
+		FramePtr pFrame;
+		FramePtr pCompressedFrame;
+		SubscriberMap::iterator it = _subscribers.begin();
+		while (it != _subscribers.end())
+		{
+			// The subscriber may be removed from the map if it is dropped.
+			SubscriberPtr pSubscriber = it->second;
+			++it;
+			const FramePtr* ppFrame = &pFrame;
+			if (compress && pSubscriber->deflateWindowBits >= _deflateParams.serverMaxWindowBits)
+			{
+				if (!pCompressedFrame)
+				{
+					if (_pDeflate->deflate(payload, length, true, true, _deflateBuffer))
+						pCompressedFrame = encode(_deflateBuffer.begin(), static_cast<int>(_deflateBuffer.size()), flags | WebSocket::FRAME_FLAG_RSV1);
+					else
+						compress = false;
+				}
+				if (pCompressedFrame) ppFrame = &pCompressedFrame;
+			}
+			if (ppFrame == &pFrame && !pFrame) pFrame = encode(payload, length, flags);
+			if (enqueue(*pSubscriber, *ppFrame))
+			{
+				++count;
+			}
+			else
+			{
+				drop(pSubscriber, handlers);
+				dropped.push_back(pSubscriber->socket);
+			}
+		}
+	}
+	removeHandlers(handlers);
+	fireDropped(dropped);
+	return count;
+}
+
+
+bool WebSocketBroadcaster::send(const WebSocket& socket, const void* buffer, int length, int flags)
+{
+	poco_assert (length >= 0);
+
+	if (flags == 0) flags = WebSocket::FRAME_BINARY;
+	std::vector<WebSocket> dropped;
+	std::vector<Socket> handlers;
+	{
+		FastMutex::ScopedLock lock(_mutex);
+
+		SubscriberMap::iterator it = _subscribers.find(socket);
+		if (it == _subscribers.end()) return false;
+		SubscriberPtr pSubscriber = it->second;
+		if (!enqueue(*pSubscriber, encode(reinterpret_cast<const char*>(buffer), length, flags)))
+		{
+			drop(pSubscriber, handlers);
+			dropped.push_back(pSubscriber->socket);
+		}
+	}
+	removeHandlers(handlers);
+	fireDropped(dropped);
+	return dropped.empty();
+}
+
+
+std::size_t WebSocketBroadcaster::queuedBytes(const WebSocket& socket) const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	SubscriberMap::const_iterator it = _subscribers.find(socket);
+	return it != _subscribers.end() ? it->second->queued : 0;
+}
+
+
+void WebSocketBroadcaster::setMaxQueuedBytes(std::size_t maxQueuedBytes)
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	_maxQueuedBytes = maxQueuedBytes;
+}
+
+
+std::size_t WebSocketBroadcaster::getMaxQueuedBytes() const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	return _maxQueuedBytes;
+}
+
+
+void WebSocketBroadcaster::enableCompression(const WebSocketDeflate::Params& params)
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	_deflateParams = params;
+	_deflateParams.serverNoContextTakeover = true;
+	_pDeflate = new WebSocketDeflate(_deflateParams, true);
+}
+
+
+void WebSocketBroadcaster::disableCompression()
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	_pDeflate = 0;
+}
+
+
+bool WebSocketBroadcaster::compressionEnabled() const
+{
+	FastMutex::ScopedLock lock(_mutex);
+
+	return !_pDeflate.isNull();
+}
+
+
+WebSocketBroadcaster::FramePtr WebSocketBroadcaster::encode(const char* buffer, int length, int flags)
+{
+	char header[WebSocketImpl::MAX_HEADER_LENGTH];
+	int headerLength = WebSocketImpl::writeHeader(header, length, flags, false);
+	FramePtr pFrame = new Frame(headerLength + length);
+	std::memcpy(pFrame->data.begin(), header, headerLength);
+	if (length > 0) std::memcpy(pFrame->data.begin() + headerLength, buffer, length);
+	return pFrame;
+}
+
+
+bool WebSocketBroadcaster::enqueue(Subscriber& subscriber, const FramePtr& pFrame)
+{
+	std::size_t size = pFrame->data.size();
+	if (!subscriber.queue.empty() && subscriber.queued + size > _maxQueuedBytes) return false;
+
+	subscriber.queue.push_back(pFrame);
+	subscriber.queued += size;
+	if (!subscriber.writeHandler)
+	{
+		// The queue was empty, so try to send the frame right away.
+		if (!flush(subscriber)) return false;
+		if (!subscriber.queue.empty())
+		{
+			_reactor.addEventHandler(subscriber.socket, Observer<WebSocketBroadcaster, WritableNotification>(*this, &WebSocketBroadcaster::onWritable));
+			subscriber.writeHandler = true;
+		}
+	}
+	return true;
+}
+
+
+bool WebSocketBroadcaster::flush(Subscriber& subscriber)
+{
+	WebSocketImpl* pImpl = static_cast<WebSocketImpl*>(subscriber.socket.impl());
+	SocketBuf buffers[MAX_WRITE_BUFFERS];
+	try
+	{
+		while (!subscriber.queue.empty())
+		{
+			int count = 0;
+			std::size_t total = 0;
+			std::size_t offset = subscriber.offset;
+			for (std::deque<FramePtr>::iterator it = subscriber.queue.begin(); it != subscriber.queue.end() && count < MAX_WRITE_BUFFERS; ++it)
+			{
+				std::size_t size = (*it)->data.size() - offset;
+				buffers[count++] = Socket::makeBuffer((*it)->data.begin() + offset, size);
+				total += size;
+				offset = 0;
+			}
+
+			std::size_t sent = static_cast<std::size_t>(pImpl->sendSomeBytes(buffers, count));
+			subscriber.queued -= sent;
+			std::size_t remaining = sent;
+			while (remaining > 0)
+			{
+				std::size_t size = subscriber.queue.front()->data.size() - subscriber.offset;
+				if (remaining < size)
+				{
+					subscriber.offset += remaining;
+					break;
+				}
+				remaining -= size;
+				subscriber.offset = 0;
+				subscriber.queue.pop_front();
+			}
+			if (sent < total) break;
+		}
+	}
+	catch (Poco::Exception&)
+	{
+		return false;
+	}
+	return true;
+}
+
+
+void WebSocketBroadcaster::shutdown(Subscriber& subscriber)
+{
+	try
+	{
+		// WebSocketImpl::shutdown() shuts down the TCP connection
+		// without sending a CLOSE frame, which could block.
+		subscriber.socket.impl()->shutdown();
+	}
+	catch (Poco::Exception&)
+	{
+	}
+}
+
+
+void WebSocketBroadcaster::drop(SubscriberPtr pSubscriber, std::vector<Socket>& handlers)
+{
+	if (!remove(pSubscriber, handlers)) shutdown(*pSubscriber);
+}
+
+
+bool WebSocketBroadcaster::remove(SubscriberPtr pSubscriber, std::vector<Socket>& handlers)
+{
+	if (pSubscriber->writeHandler)
+	{
+		handlers.push_back(pSubscriber->socket);
+		pSubscriber->writeHandler = false;
+	}
+	// The rest of a partially written frame is discarded
+	// with the queue, so the connection cannot be used anymore.
+	bool partial = pSubscriber->offset != 0;
+	if (partial) shutdown(*pSubscriber);
+	pSubscriber->queue.clear();
+	pSubscriber->queued = 0;
+	pSubscriber->offset = 0;
+	_subscribers.erase(pSubscriber->socket);
+	return partial;
+}
+
+
+void WebSocketBroadcaster::removeHandlers(std::vector<Socket>& handlers)
+{
+	// Removing an event handler must not be done while holding
+	// the mutex, as it waits for a running onWritable() call,
+	// which in turn may wait for the mutex.
+	Observer<WebSocketBroadcaster, WritableNotification> observer(*this, &WebSocketBroadcaster::onWritable);
+	for (std::vector<Socket>::iterator it = handlers.begin(); it != handlers.end(); ++it)
+	{
+		_reactor.removeEventHandler(*it, observer);
+
+		// The socket may have been subscribed again in the meantime.
+		FastMutex::ScopedLock lock(_mutex);
+		SubscriberMap::iterator itSub = _subscribers.find(*it);
+		if (itSub != _subscribers.end() && itSub->second->writeHandler)
+			_reactor.addEventHandler(*it, observer);
+	}
+}
+
+
+void WebSocketBroadcaster::fireDropped(std::vector<WebSocket>& dropped)
+{
+	for (std::vector<WebSocket>::iterator it = dropped.begin(); it != dropped.end(); ++it)
+	{
+		subscriberDropped.notify(this, *it);
+	}
+}
+
+
+void WebSocketBroadcaster::onWritable(WritableNotification* pNotification)
+{
+	Socket socket = pNotification->socket();
+	pNotification->release();
+
+	std::vector<WebSocket> dropped;
+	std::vector<Socket> handlers;
+	{
+		FastMutex::ScopedLock lock(_mutex);
+
+		SubscriberMap::iterator it = _subscribers.find(socket);
+		if (it == _subscribers.end())
+		{
+			// The subscriber has been removed, but its handler not yet.
+			return;
+		}
+		SubscriberPtr pSubscriber = it->second;
+		if (!flush(*pSubscriber))
+		{
+			drop(pSubscriber, handlers);
+			dropped.push_back(pSubscriber->socket);
+		}
+		else if (pSubscriber->queue.empty() && pSubscriber->writeHandler)
+		{
+			handlers.push_back(pSubscriber->socket);
+			pSubscriber->writeHandler = false;
+		}
+	}
+	removeHandlers(handlers);
+	fireDropped(dropped);
+}
+
+
+} } // namespace Poco::Net
@@ -0,0 +1,374 @@
+//
+// WebSocketDeflate.cpp
+//
+// Library: Net
+// Package: WebSocket
+// Module:  WebSocketDeflate
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Net/WebSocketDeflate.h"
+#include "Poco/Net/WebSocket.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/StringTokenizer.h"
+#include "Poco/NumberFormatter.h"
+#include "Poco/NumberParser.h"
+#include "Poco/String.h"
+#include <vector>
+#include <cstring>
+
+
+namespace Poco {
+namespace Net {
+
+
+namespace
+{
+	const char DEFLATE_TAIL[4] = {0x00, 0x00, static_cast<char>(0xff), static_cast<char>(0xff)};
+
+	struct ExtensionParams
+		/// The parameters of a single permessage-deflate offer or response.
+	{
+		ExtensionParams():
+			serverNoContextTakeover(false),
+			clientNoContextTakeover(false),
+			serverMaxWindowBits(0),
+			clientMaxWindowBits(0),
+			hasClientMaxWindowBits(false)
+		{
+		}
+
+		bool serverNoContextTakeover;
+		bool clientNoContextTakeover;
+		int  serverMaxWindowBits;    // 0 if not given
+		int  clientMaxWindowBits;    // 0 if given without value
+		bool hasClientMaxWindowBits;
+	};
+
+	bool parseWindowBits(const std::string& value, int& bits)
+	{
+		std::string v(value);
+		if (v.size() >= 2 && v[0] == '"' && v[v.size() - 1] == '"') v = v.substr(1, v.size() - 2);
+		unsigned n;
+		if (v.empty() || v.size() > 2 || !NumberParser::tryParseUnsigned(v, n)) return false;
+		if (n < 8 || n > 15) return false;
+		bits = static_cast<int>(n);
+		return true;
+	}
+
+	bool parseExtension(const std::string& extension, std::string& name, ExtensionParams& params)
+		/// Parses a single extension (name and parameters, separated by
+		/// semicolons). Returns false if the extension is a permessage-deflate
+		/// extension with invalid parameters.
+	{
+		StringTokenizer tok(extension, ";", StringTokenizer::TOK_TRIM);
+		if (tok.count() == 0) return false;
+		name = tok[0];
+		if (icompare(name, WebSocketDeflate::EXTENSION_NAME) != 0) return true;
+
+		bool seen[4] = {false, false, false, false};
+		for (std::size_t i = 1; i < tok.count(); i++)
+		{
+			std::string param = tok[i];
+			std::string value;
+			std::string::size_type pos = param.find('=');
+			bool hasValue = pos != std::string::npos;
+			if (hasValue)
+			{
+				value = trim(param.substr(pos + 1));
+				param = trim(param.substr(0, pos));
+			}
+			int index;
+			if (icompare(param, "server_no_context_takeover") == 0)
+			{
+				if (hasValue) return false;
+				params.serverNoContextTakeover = true;
+				index = 0;
+			}
+			else if (icompare(param, "client_no_context_takeover") == 0)
+			{
+				if (hasValue) return false;
+				params.clientNoContextTakeover = true;
+				index = 1;
+			}
+			else if (icompare(param, "server_max_window_bits") == 0)
+			{
+				if (!hasValue || !parseWindowBits(value, params.serverMaxWindowBits)) return false;
+				index = 2;
+			}
+			else if (icompare(param, "client_max_window_bits") == 0)
+			{
+				if (hasValue && !parseWindowBits(value, params.clientMaxWindowBits)) return false;
+				params.hasClientMaxWindowBits = true;
+				index = 3;
+			}
+			else return false;
+			if (seen[index]) return false;
+			seen[index] = true;
+		}
+		return true;
+	}
+}
+
+
+const std::string WebSocketDeflate::EXTENSION_NAME("permessage-deflate");
+
+
+WebSocketDeflate::WebSocketDeflate(const Params& params, bool server):
+	_params(params),
+	_deflateWindowBits(server ? params.serverMaxWindowBits : params.clientMaxWindowBits),
+	_deflateNoContextTakeover(server ? params.serverNoContextTakeover : params.clientNoContextTakeover),
+	_inflateNoContextTakeover(server ? params.clientNoContextTakeover : params.serverNoContextTakeover),
+	_deflateInitialized(false),
+	_inflateInitialized(false)
+{
+	poco_assert (_deflateWindowBits >= 9 && _deflateWindowBits <= 15);
+
+	std::memset(&_deflateStream, 0, sizeof(_deflateStream));
+	std::memset(&_inflateStream, 0, sizeof(_inflateStream));
+}
+
+
+WebSocketDeflate::~WebSocketDeflate()
+{
+	if (_deflateInitialized) deflateEnd(&_deflateStream);
+	if (_inflateInitialized) inflateEnd(&_inflateStream);
+}
+
+
+bool WebSocketDeflate::deflate(const char* data, int length, bool first, bool final, Poco::Buffer<char>& out)
+{
+	if (first && final && length < _params.minCompressSize) return false;
+
+	if (!_deflateInitialized)
+	{
+		int rc = deflateInit2(&_deflateStream, _params.compressionLevel, Z_DEFLATED, -_deflateWindowBits, _params.memoryLevel, Z_DEFAULT_STRATEGY);
+		if (rc != Z_OK) throw IOException(zError(rc));
+		_deflateInitialized = true;
+	}
+
+	_deflateStream.next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+	_deflateStream.avail_in = static_cast<uInt>(length);
+	out.resize(length + length/8 + 64, false);
+	std::size_t written = 0;
+	for (;;)
+	{
+		_deflateStream.next_out  = reinterpret_cast<Bytef*>(out.begin() + written);
+		_deflateStream.avail_out = static_cast<uInt>(out.size() - written);
+		int rc = ::deflate(&_deflateStream, Z_SYNC_FLUSH);
+		if (rc != Z_OK && rc != Z_BUF_ERROR) throw IOException(zError(rc));
+		written = out.size() - _deflateStream.avail_out;
+		// With Z_SYNC_FLUSH, all pending output has been written
+		// if there is space left in the output buffer.
+		if (_deflateStream.avail_out > 0) break;
+		out.resize(2*out.size());
+	}
+
+	if (final)
+	{
+		// Remove the empty stored block generated by Z_SYNC_FLUSH (RFC 7692, 7.2.1).
+		if (written >= 4 && std::memcmp(out.begin() + written - 4, DEFLATE_TAIL, 4) == 0) written -= 4;
+		// An empty message is sent as a single 0x00 byte (RFC 7692, 7.2.3.6).
+		if (written == 0) out[written++] = 0;
+		if (_deflateNoContextTakeover) deflateReset(&_deflateStream);
+	}
+	out.resize(written);
+	return true;
+}
+
+
+void WebSocketDeflate::inflate(const char* data, int length, bool final, Poco::Buffer<char>& out, std::size_t maxLength)
+{
+	if (!_inflateInitialized)
+	{
+		// A window size of 15 works for any window size used by the peer.
+		int rc = inflateInit2(&_inflateStream, -15);
+		if (rc != Z_OK) throw IOException(zError(rc));
+		_inflateInitialized = true;
+	}
+
+	std::size_t written = out.size();
+	for (int pass = 0; pass < 2; pass++)
+	{
+		if (pass == 0)
+		{
+			_inflateStream.next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+			_inflateStream.avail_in = static_cast<uInt>(length);
+		}
+		else if (final)
+		{
+			// Append the empty stored block removed by the sender (RFC 7692, 7.2.2).
+			_inflateStream.next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(DEFLATE_TAIL));
+			_inflateStream.avail_in = 4;
+		}
+		else break;
+
+		for (;;)
+		{
+			char probe;
+			bool probing = false;
+			if (written == out.size())
+			{
+				if (written < maxLength)
+				{
+					std::size_t size = written < 512 ? 1024 : 2*written;
+					out.resize(size < maxLength ? size : maxLength);
+				}
+				else probing = true;
+			}
+			if (probing)
+			{
+				// The output limit has been reached; only
+				// continue if no more output is pending.
+				_inflateStream.next_out  = reinterpret_cast<Bytef*>(&probe);
+				_inflateStream.avail_out = 1;
+			}
+			else
+			{
+				_inflateStream.next_out  = reinterpret_cast<Bytef*>(out.begin() + written);
+				_inflateStream.avail_out = static_cast<uInt>(out.size() - written);
+			}
+			int rc = ::inflate(&_inflateStream, Z_SYNC_FLUSH);
+			if (probing)
+			{
+				if (_inflateStream.avail_out == 0) throw WebSocketException("Decompressed payload too big", WebSocket::WS_ERR_PAYLOAD_TOO_BIG);
+			}
+			else written = out.size() - _inflateStream.avail_out;
+			if (rc == Z_STREAM_END)
+			{
+				// The peer has ended the deflate stream with a final
+				// block (BFINAL), so the next message starts a new stream.
+				inflateReset(&_inflateStream);
+				if (pass == 1) _inflateStream.avail_in = 0;
+			}
+			else if (rc != Z_OK && rc != Z_BUF_ERROR)
+			{
+				throw WebSocketException("Invalid compressed payload received", WebSocket::WS_ERR_COMPRESSION);
+			}
+			if (_inflateStream.avail_in == 0 && _inflateStream.avail_out > 0) break;
+		}
+	}
+	out.resize(written);
+
+	if (final && _inflateNoContextTakeover) inflateReset(&_inflateStream);
+}
+
+
+std::string WebSocketDeflate::createOffer(const Params& params)
+{
+	poco_assert (params.clientMaxWindowBits >= 9 && params.clientMaxWindowBits <= 15);
+	poco_assert (params.serverMaxWindowBits >= 9 && params.serverMaxWindowBits <= 15);
+
+	std::string offer(EXTENSION_NAME);
+	if (params.serverNoContextTakeover) offer += "; server_no_context_takeover";
+	if (params.clientNoContextTakeover) offer += "; client_no_context_takeover";
+	if (params.serverMaxWindowBits < 15)
+	{
+		offer += "; server_max_window_bits=";
+		NumberFormatter::append(offer, params.serverMaxWindowBits);
+	}
+	offer += "; client_max_window_bits";
+	if (params.clientMaxWindowBits < 15)
+	{
+		offer += '=';
+		NumberFormatter::append(offer, params.clientMaxWindowBits);
+	}
+	return offer;
+}
+
+
+bool WebSocketDeflate::negotiate(const std::string& offers, const Params& params, Params& agreed, std::string& response)
+{
+	StringTokenizer tok(offers, ",", StringTokenizer::TOK_TRIM | StringTokenizer::TOK_IGNORE_EMPTY);
+	for (StringTokenizer::Iterator it = tok.begin(); it != tok.end(); ++it)
+	{
+		std::string name;
+		ExtensionParams offer;
+		if (!parseExtension(*it, name, offer) || icompare(name, EXTENSION_NAME) != 0) continue;
+
+		Params result(params);
+		result.serverNoContextTakeover = params.serverNoContextTakeover || offer.serverNoContextTakeover;
+		result.clientNoContextTakeover = params.clientNoContextTakeover || offer.clientNoContextTakeover;
+		if (offer.serverMaxWindowBits > 0 && offer.serverMaxWindowBits < result.serverMaxWindowBits)
+		{
+			// zlib cannot compress with a window size of 256 bytes
+			if (offer.serverMaxWindowBits < 9) continue;
+			result.serverMaxWindowBits = offer.serverMaxWindowBits;
+		}
+		if (offer.hasClientMaxWindowBits)
+		{
+			if (offer.clientMaxWindowBits > 0 && offer.clientMaxWindowBits < result.clientMaxWindowBits)
+				result.clientMaxWindowBits = offer.clientMaxWindowBits;
+		}
+		else result.clientMaxWindowBits = 15;
+
+		response = EXTENSION_NAME;
+		if (result.serverNoContextTakeover) response += "; server_no_context_takeover";
+		if (result.clientNoContextTakeover) response += "; client_no_context_takeover";
+		if (result.serverMaxWindowBits < 15 || offer.serverMaxWindowBits > 0)
+		{
+			response += "; server_max_window_bits=";
+			NumberFormatter::append(response, result.serverMaxWindowBits);
+		}
+		if (result.clientMaxWindowBits < 15)
+		{
+			response += "; client_max_window_bits=";
+			NumberFormatter::append(response, result.clientMaxWindowBits);
+		}
+		agreed = result;
+		return true;
+	}
+	return false;
+}
+
+
+bool WebSocketDeflate::accept(const std::string& response, const Params& params, Params& agreed)
+{
+	StringTokenizer tok(response, ",", StringTokenizer::TOK_TRIM | StringTokenizer::TOK_IGNORE_EMPTY);
+	bool accepted = false;
+	for (StringTokenizer::Iterator it = tok.begin(); it != tok.end(); ++it)
+	{
+		std::string name;
+		ExtensionParams ext;
+		if (!parseExtension(*it, name, ext))
+			throw WebSocketException("Invalid permessage-deflate parameters in handshake response", *it, WebSocket::WS_ERR_HANDSHAKE_EXTENSION);
+		if (icompare(name, EXTENSION_NAME) != 0)
+			throw WebSocketException("Unexpected extension in handshake response", name, WebSocket::WS_ERR_HANDSHAKE_EXTENSION);
+		if (accepted)
+			throw WebSocketException("Duplicate permessage-deflate extension in handshake response", WebSocket::WS_ERR_HANDSHAKE_EXTENSION);
+
+		Params result(params);
+		result.serverNoContextTakeover = ext.serverNoContextTakeover;
+		result.clientNoContextTakeover = params.clientNoContextTakeover || ext.clientNoContextTakeover;
+		if (params.serverNoContextTakeover && !ext.serverNoContextTakeover)
+			throw WebSocketException("Missing server_no_context_takeover in handshake response", WebSocket::WS_ERR_HANDSHAKE_EXTENSION);
+		if (ext.serverMaxWindowBits > 0)
+		{
+			if (ext.serverMaxWindowBits > params.serverMaxWindowBits)
+				throw WebSocketException("Invalid server_max_window_bits in handshake response", WebSocket::WS_ERR_HANDSHAKE_EXTENSION);
+			result.serverMaxWindowBits = ext.serverMaxWindowBits;
+		}
+		else if (params.serverMaxWindowBits < 15)
+		{
+			throw WebSocketException("Missing server_max_window_bits in handshake response", WebSocket::WS_ERR_HANDSHAKE_EXTENSION);
+		}
+		if (ext.hasClientMaxWindowBits)
+		{
+			// zlib cannot compress with a window size of 256 bytes
+			if (ext.clientMaxWindowBits < 9)
+				throw WebSocketException("Unsupported client_max_window_bits in handshake response", WebSocket::WS_ERR_HANDSHAKE_EXTENSION);
+			if (ext.clientMaxWindowBits < result.clientMaxWindowBits) result.clientMaxWindowBits = ext.clientMaxWindowBits;
+		}
+		agreed = result;
+		accepted = true;
+	}
+	return accepted;
+}
+
+
+} } // namespace Poco::Net
@@ -16,20 +16,81 @@
 #include "Poco/Net/WebSocketImpl.h"
 #include "Poco/Net/NetException.h"
 #include "Poco/Net/WebSocket.h"
+#include "Poco/Net/WebSocketDeflate.h"
 #include "Poco/Net/HTTPSession.h"
+#include "Poco/Net/Socket.h"
 #include "Poco/Buffer.h"
-#include "Poco/BinaryWriter.h"
-#include "Poco/BinaryReader.h"
-#include "Poco/MemoryStream.h"
 #include "Poco/Format.h"
 #include <limits>
+#include <algorithm>
 #include <cstring>
 
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define POCO_WEBSOCKET_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define POCO_WEBSOCKET_NEON
+#include <arm_neon.h>
+#endif
+
+
 namespace Poco {
 namespace Net {
 
 
+namespace
+{
+	void maskPayload(char* dst, const char* src, std::size_t length, const char mask[4])
+		/// XORs length bytes from src with the 4-byte masking key
+		/// and stores the result in dst, which may be equal to src.
+	{
+		std::size_t i = 0;
+		Poco::UInt32 m32;
+		std::memcpy(&m32, mask, 4);
+#if defined(POCO_WEBSOCKET_SSE2)
+		const __m128i m128 = _mm_set1_epi32(static_cast<int>(m32));
+		for (; i + 64 <= length; i += 64)
+		{
+			__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+			__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 32));
+			__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 48));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(a, m128));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 16), _mm_xor_si128(b, m128));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 32), _mm_xor_si128(c, m128));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 48), _mm_xor_si128(d, m128));
+		}
+		for (; i + 16 <= length; i += 16)
+		{
+			__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(a, m128));
+		}
+#elif defined(POCO_WEBSOCKET_NEON)
+		const uint8x16_t m128 = vreinterpretq_u8_u32(vdupq_n_u32(m32));
+		for (; i + 16 <= length; i += 16)
+		{
+			uint8x16_t a = vld1q_u8(reinterpret_cast<const uint8_t*>(src + i));
+			vst1q_u8(reinterpret_cast<uint8_t*>(dst + i), veorq_u8(a, m128));
+		}
+#endif
+		// i is a multiple of 4 here, so the key starts at mask[0].
+		const Poco::UInt64 m64 = (static_cast<Poco::UInt64>(m32) << 32) | m32;
+		for (; i + 8 <= length; i += 8)
+		{
+			Poco::UInt64 w;
+			std::memcpy(&w, src + i, 8);
+			w ^= m64;
+			std::memcpy(dst + i, &w, 8);
+		}
+		for (; i < length; i++)
+		{
+			dst[i] = src[i] ^ mask[i % 4];
+		}
+	}
+}
+
+
 WebSocketImpl::WebSocketImpl(StreamSocketImpl* pStreamSocketImpl, HTTPSession& session, bool mustMaskPayload):
 	StreamSocketImpl(pStreamSocketImpl->sockfd()),
 	_pStreamSocketImpl(pStreamSocketImpl),
@@ -37,7 +98,15 @@ WebSocketImpl::WebSocketImpl(StreamSocketImpl* pStreamSocketImpl, HTTPSession& s
 	_buffer(0),
 	_bufferOffset(0),
 	_frameFlags(0),
-	_mustMaskPayload(mustMaskPayload)
+	_mustMaskPayload(mustMaskPayload),
+	_pDeflate(0),
+	_deflateBuffer(0),
+	_inflateBuffer(0),
+	_inflatedBuffer(0),
+	_sendCompressed(false),
+	_receiveCompressed(false),
+	_sendBuffer(0),
+	_sendBufs(2)
 {
 	poco_check_ptr(pStreamSocketImpl);
 	_pStreamSocketImpl->duplicate();
@@ -51,6 +120,7 @@ WebSocketImpl::~WebSocketImpl()
 	{
 		_pStreamSocketImpl->release();
 		reset();
+		delete _pDeflate;
 	}
 	catch (...)
 	{
@@ -61,51 +131,162 @@ WebSocketImpl::~WebSocketImpl()
 
 int WebSocketImpl::sendBytes(const void* buffer, int length, int flags)
 {
-	Poco::Buffer<char> frame(length + MAX_HEADER_LENGTH);
-	Poco::MemoryOutputStream ostr(frame.begin(), frame.size());
-	Poco::BinaryWriter writer(ostr, Poco::BinaryWriter::NETWORK_BYTE_ORDER);
+	Poco::FastMutex::ScopedLock lock(_sendMutex);
 
-	if (flags == 0) flags = WebSocket::FRAME_BINARY;
-	flags &= 0xff;
-	writer << static_cast<Poco::UInt8>(flags);
-	Poco::UInt8 lengthByte(0);
-	if (_mustMaskPayload)
+	if (_pDeflate)
 	{
-		lengthByte |= FRAME_FLAG_MASK;
+		int normalizedFlags = flags == 0 ? WebSocket::FRAME_BINARY : flags & 0xff;
+		int opcode = normalizedFlags & WebSocket::FRAME_OP_BITMASK;
+		bool final = (normalizedFlags & WebSocket::FRAME_FLAG_FIN) != 0;
+		bool compress = false;
+		if (opcode == WebSocket::FRAME_OP_TEXT || opcode == WebSocket::FRAME_OP_BINARY)
+		{
+			compress = _pDeflate->deflate(reinterpret_cast<const char*>(buffer), length, true, final, _deflateBuffer);
+			if (compress) normalizedFlags |= WebSocket::FRAME_FLAG_RSV1;
+			_sendCompressed = compress && !final;
+		}
+		else if (opcode == WebSocket::FRAME_OP_CONT && _sendCompressed)
+		{
+			// The RSV1 bit is only set in the first frame of a compressed message.
+			compress = _pDeflate->deflate(reinterpret_cast<const char*>(buffer), length, false, final, _deflateBuffer);
+			_sendCompressed = !final;
+		}
+		if (compress)
+		{
+			sendFrame(_deflateBuffer.begin(), static_cast<int>(_deflateBuffer.size()), normalizedFlags);
+			return length;
+		}
 	}
-	if (length < 126)
+	return sendFrame(buffer, length, flags);
+}
+
+
+int WebSocketImpl::sendFrame(const void* buffer, int length, int flags)
+{
+	char header[MAX_HEADER_LENGTH];
+	if (flags == 0) flags = WebSocket::FRAME_BINARY;
+	int headerLength = writeHeader(header, length, flags, _mustMaskPayload);
+
+	const char* payload = reinterpret_cast<const char*>(buffer);
+	if (_mustMaskPayload)
 	{
-		lengthByte |= static_cast<Poco::UInt8>(length);
-		writer << lengthByte;
+		const Poco::UInt32 mask = _rnd.next();
+		std::memcpy(header + headerLength, &mask, 4);
+		headerLength += 4;
+		// The payload must be copied anyway, so header and
+		// masked payload are sent with a single send().
+		_sendBuffer.resize(headerLength + length, false);
+		std::memcpy(_sendBuffer.begin(), header, headerLength);
+		maskPayload(_sendBuffer.begin() + headerLength, payload, length, header + headerLength - 4);
+		_pStreamSocketImpl->sendBytes(_sendBuffer.begin(), headerLength + length);
 	}
-	else if (length < 65536)
+	else if (length > 0 && !_pStreamSocketImpl->secure())
 	{
-		lengthByte |= 126;
-		writer << lengthByte << static_cast<Poco::UInt16>(length);
+		// Gather write of header and the caller's payload. A secure
+		// socket must not be written to directly, as this would bypass TLS.
+		_sendBufs[0] = Socket::makeBuffer(header, headerLength);
+		_sendBufs[1] = Socket::makeBuffer(const_cast<char*>(payload), length);
+		int sent = static_cast<SocketImpl*>(_pStreamSocketImpl)->sendBytes(_sendBufs);
+		if (sent >= 0 && sent < headerLength)
+		{
+			_pStreamSocketImpl->sendBytes(header + sent, headerLength - sent);
+			sent = headerLength;
+		}
+		if (sent >= headerLength && sent < headerLength + length)
+		{
+			_pStreamSocketImpl->sendBytes(payload + sent - headerLength, headerLength + length - sent);
+		}
 	}
 	else
 	{
-		lengthByte |= 127;
-		writer << lengthByte << static_cast<Poco::UInt64>(length);
+		_sendBuffer.resize(headerLength + length, false);
+		std::memcpy(_sendBuffer.begin(), header, headerLength);
+		if (length > 0) std::memcpy(_sendBuffer.begin() + headerLength, payload, length);
+		_pStreamSocketImpl->sendBytes(_sendBuffer.begin(), headerLength + length);
 	}
-	if (_mustMaskPayload)
+	return length;
+}
+
+
+int WebSocketImpl::sendSomeBytes(const SocketBuf* pBuffers, int count)
+{
+	Poco::FastMutex::ScopedLock lock(_sendMutex);
+
+#if defined(POCO_OS_FAMILY_UNIX)
+	if (!_pStreamSocketImpl->secure())
 	{
-		const Poco::UInt32 mask = _rnd.next();
-		const char* m = reinterpret_cast<const char*>(&mask);
-		const char* b = reinterpret_cast<const char*>(buffer);
-		writer.writeRaw(m, 4);
-		char* p = frame.begin() + ostr.charsWritten();
-		for (int i = 0; i < length; i++)
+		struct msghdr msg;
+		std::memset(&msg, 0, sizeof(msg));
+		msg.msg_iov    = const_cast<SocketBuf*>(pBuffers);
+		msg.msg_iovlen = count;
+		int flags = MSG_DONTWAIT;
+#if defined(MSG_NOSIGNAL)
+		flags |= MSG_NOSIGNAL;
+#endif
+		ssize_t rc;
+		do
+		{
+			if (_pStreamSocketImpl->sockfd() == POCO_INVALID_SOCKET) throw InvalidSocketException();
+			rc = ::sendmsg(_pStreamSocketImpl->sockfd(), &msg, flags);
+		}
+		while (rc < 0 && lastError() == POCO_EINTR);
+		if (rc < 0)
 		{
-			p[i] = b[i] ^ m[i % 4];
+			int err = lastError();
+			if (err == POCO_EAGAIN || err == POCO_EWOULDBLOCK) return 0;
+			error(err);
 		}
+		return static_cast<int>(rc);
+	}
+#endif
+	if (count == 0 || !_pStreamSocketImpl->poll(Poco::Timespan(0), SELECT_WRITE)) return 0;
+#if defined(POCO_OS_FAMILY_WINDOWS)
+	const char* p = pBuffers[0].buf;
+	int length = static_cast<int>(pBuffers[0].len);
+#else
+	const char* p = reinterpret_cast<const char*>(pBuffers[0].iov_base);
+	int length = static_cast<int>(pBuffers[0].iov_len);
+#endif
+	// Limit the amount of data written to a socket that has
+	// become writable, so that the call is unlikely to block.
+	if (length > 16384) length = 16384;
+	int n = _pStreamSocketImpl->sendBytes(p, length);
+	return n > 0 ? n : 0;
+}
+
+
+int WebSocketImpl::writeHeader(char* header, int length, int flags, bool mask)
+{
+	int headerLength = 2;
+	header[0] = static_cast<char>(flags & 0xff);
+	Poco::UInt8 lengthByte(0);
+	if (mask)
+	{
+		lengthByte |= FRAME_FLAG_MASK;
+	}
+	if (length < 126)
+	{
+		header[1] = static_cast<char>(lengthByte | length);
+	}
+	else if (length < 65536)
+	{
+		header[1] = static_cast<char>(lengthByte | 126);
+		header[2] = static_cast<char>(length >> 8);
+		header[3] = static_cast<char>(length);
+		headerLength = 4;
 	}
 	else
 	{
-		std::memcpy(frame.begin() + ostr.charsWritten(), buffer, length);
+		header[1] = static_cast<char>(lengthByte | 127);
+		Poco::UInt64 l = static_cast<Poco::UInt64>(length);
+		for (int i = 9; i >= 2; i--)
+		{
+			header[i] = static_cast<char>(l);
+			l >>= 8;
+		}
+		headerLength = 10;
 	}
-	_pStreamSocketImpl->sendBytes(frame.begin(), length + static_cast<int>(ostr.charsWritten()));
-	return length;
+	return headerLength;
 }
 
 
@@ -125,33 +306,32 @@ int WebSocketImpl::receiveHeader(char mask[4], bool& useMask)
 	useMask = ((lengthByte & FRAME_FLAG_MASK) != 0);
 	int payloadLength;
 	lengthByte &= 0x7f;
-	if (lengthByte == 127)
+	// Receive the extended payload length and the
+	// masking key (if present) with a single call.
+	int extLength = lengthByte == 127 ? 8 : (lengthByte == 126 ? 2 : 0);
+	int rest = extLength + (useMask ? 4 : 0);
+	if (rest > 0)
 	{
-		n = receiveNBytes(header + 2, 8);
+		n = receiveNBytes(header + 2, rest);
 		if (n <= 0)
 		{
 			_frameFlags = 0;
 			return n;
 		}
-		Poco::MemoryInputStream istr(header + 2, 8);
-		Poco::BinaryReader reader(istr, Poco::BinaryReader::NETWORK_BYTE_ORDER);
-		Poco::UInt64 l;
-		reader >> l;
+	}
+	if (lengthByte == 127)
+	{
+		Poco::UInt64 l = 0;
+		for (int i = 2; i < 10; i++)
+		{
+			l = (l << 8) | static_cast<Poco::UInt8>(header[i]);
+		}
 		if (l > _maxPayloadSize) throw WebSocketException("Payload too big", WebSocket::WS_ERR_PAYLOAD_TOO_BIG);
 		payloadLength = static_cast<int>(l);
 	}
 	else if (lengthByte == 126)
 	{
-		n = receiveNBytes(header + 2, 2);
-		if (n <= 0)
-		{
-			_frameFlags = 0;
-			return n;
-		}
-		Poco::MemoryInputStream istr(header + 2, 2);
-		Poco::BinaryReader reader(istr, Poco::BinaryReader::NETWORK_BYTE_ORDER);
-		Poco::UInt16 l;
-		reader >> l;
+		Poco::UInt16 l = static_cast<Poco::UInt16>((static_cast<Poco::UInt8>(header[2]) << 8) | static_cast<Poco::UInt8>(header[3]));
 		if (l > _maxPayloadSize) throw WebSocketException("Payload too big", WebSocket::WS_ERR_PAYLOAD_TOO_BIG);
 		payloadLength = static_cast<int>(l);
 	}
@@ -163,12 +343,7 @@ int WebSocketImpl::receiveHeader(char mask[4], bool& useMask)
 
 	if (useMask)
 	{
-		n = receiveNBytes(mask, 4);
-		if (n <= 0)
-		{
-			_frameFlags = 0;
-			return n;
-		}
+		std::memcpy(mask, header + 2 + extLength, 4);
 	}
 
 	return payloadLength;
@@ -183,6 +358,32 @@ void WebSocketImpl::setMaxPayloadSize(int maxPayloadSize)
 }
 
 
+void WebSocketImpl::setDeflate(WebSocketDeflate* pDeflate)
+{
+	delete _pDeflate;
+	_pDeflate = pDeflate;
+}
+
+
+bool WebSocketImpl::isCompressed()
+{
+	if (!_pDeflate) return false;
+
+	int opcode = _frameFlags & WebSocket::FRAME_OP_BITMASK;
+	bool compressed;
+	if (opcode == WebSocket::FRAME_OP_TEXT || opcode == WebSocket::FRAME_OP_BINARY)
+		compressed = (_frameFlags & WebSocket::FRAME_FLAG_RSV1) != 0;
+	else if (opcode == WebSocket::FRAME_OP_CONT)
+		compressed = _receiveCompressed;
+	else
+		return false;
+	_receiveCompressed = compressed && (_frameFlags & WebSocket::FRAME_FLAG_FIN) == 0;
+	// The extension is transparent to the application.
+	_frameFlags &= ~WebSocket::FRAME_FLAG_RSV1;
+	return compressed;
+}
+
+
 int WebSocketImpl::receivePayload(char *buffer, int payloadLength, char mask[4], bool useMask)
 {
 	int received = receiveNBytes(reinterpret_cast<char*>(buffer), payloadLength);
@@ -190,10 +391,7 @@ int WebSocketImpl::receivePayload(char *buffer, int payloadLength, char mask[4],
 
 	if (useMask)
 	{
-		for (int i = 0; i < received; i++)
-		{
-			buffer[i] ^= mask[i % 4];
-		}
+		maskPayload(buffer, buffer, received, mask);
 	}
 	return received;
 }
@@ -204,7 +402,18 @@ int WebSocketImpl::receiveBytes(void* buffer, int length, int)
 	char mask[4];
 	bool useMask;
 	int payloadLength = receiveHeader(mask, useMask);
-	if (payloadLength <= 0)
+	if (payloadLength < 0 || (payloadLength == 0 && _frameFlags == 0))
+		return payloadLength;
+	if (isCompressed())
+	{
+		_inflateBuffer.resize(payloadLength, false);
+		if (payloadLength > 0) receivePayload(_inflateBuffer.begin(), payloadLength, mask, useMask);
+		_inflatedBuffer.resize(0);
+		_pDeflate->inflate(_inflateBuffer.begin(), payloadLength, (_frameFlags & WebSocket::FRAME_FLAG_FIN) != 0, _inflatedBuffer, length);
+		if (_inflatedBuffer.size() > 0) std::memcpy(buffer, _inflatedBuffer.begin(), _inflatedBuffer.size());
+		return static_cast<int>(_inflatedBuffer.size());
+	}
+	if (payloadLength == 0)
 		return payloadLength;
 	if (payloadLength > length)
 		throw WebSocketException(Poco::format("Insufficient buffer for payload size %d", payloadLength), WebSocket::WS_ERR_PAYLOAD_TOO_BIG);
@@ -217,10 +426,26 @@ int WebSocketImpl::receiveBytes(Poco::Buffer<char>& buffer, int, const Poco::Tim
 	char mask[4];
 	bool useMask;
 	int payloadLength = receiveHeader(mask, useMask);
-	if (payloadLength <= 0)
+	if (payloadLength < 0 || (payloadLength == 0 && _frameFlags == 0))
 		return payloadLength;
 	std::size_t oldSize = buffer.size();
-	buffer.resize(oldSize + payloadLength);
+	if (isCompressed())
+	{
+		_inflateBuffer.resize(payloadLength, false);
+		if (payloadLength > 0) receivePayload(_inflateBuffer.begin(), payloadLength, mask, useMask);
+		_pDeflate->inflate(_inflateBuffer.begin(), payloadLength, (_frameFlags & WebSocket::FRAME_FLAG_FIN) != 0, buffer, oldSize + _maxPayloadSize);
+		return static_cast<int>(buffer.size() - oldSize);
+	}
+	if (payloadLength == 0)
+		return payloadLength;
+	std::size_t newSize = oldSize + payloadLength;
+	if (newSize > buffer.capacity() && oldSize > 0)
+	{
+		// Grow exponentially, so that reassembling a fragmented
+		// message does not reallocate the buffer for every frame.
+		buffer.setCapacity(std::max(newSize, 2*buffer.capacity()));
+	}
+	buffer.resize(newSize);
 	return receivePayload(buffer.begin() + oldSize, payloadLength, mask, useMask);
 }
 
@@ -339,6 +564,12 @@ void WebSocketImpl::shutdown()
 }
 
 
+Poco::Int64 WebSocketImpl::sendFile(FileInputStream& fileInputStream, Poco::UInt64 offset, Poco::UInt64 count)
+{
+	throw Poco::InvalidAccessException("Cannot sendFile() on a WebSocketImpl");
+}
+
+
 int WebSocketImpl::sendTo(const void* buffer, int length, const SocketAddress& address, int flags)
 {
 	throw Poco::InvalidAccessException("Cannot sendTo() on a WebSocketImpl");
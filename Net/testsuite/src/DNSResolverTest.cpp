@@ -0,0 +1,361 @@
+//
+// DNSResolverTest.cpp
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "DNSResolverTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+#include "Poco/Net/DNSResolver.h"
+#include "Poco/Net/HostEntry.h"
+#include "Poco/Net/NetException.h"
+#include "Poco/AtomicCounter.h"
+#include "Poco/Runnable.h"
+#include "Poco/Thread.h"
+#include "Poco/Event.h"
+
+
+using Poco::Net::DNSResolver;
+using Poco::Net::HostEntry;
+using Poco::Net::IPAddress;
+using Poco::Net::DNSException;
+using Poco::Net::HostNotFoundException;
+using Poco::ActiveResult;
+using Poco::AtomicCounter;
+using Poco::Event;
+using Poco::Thread;
+using Poco::Timespan;
+
+
+namespace
+{
+	class TestResolver: public DNSResolver
+	{
+	public:
+		TestResolver(int threads, const Timespan& ttl, const Timespan& negativeTTL, std::size_t maxEntries = 16):
+			DNSResolver(threads, ttl, negativeTTL, maxEntries),
+			_gate(Event::EVENT_MANUALRESET)
+		{
+			_gate.set();
+		}
+
+		~TestResolver()
+		{
+			stop();
+		}
+
+		int lookups() const
+		{
+			return _lookups.value();
+		}
+
+		void closeGate()
+		{
+			_gate.reset();
+		}
+
+		void openGate()
+		{
+			_gate.set();
+		}
+
+		using DNSResolver::stop;
+
+	protected:
+		HostEntry lookup(const std::string& hostname, unsigned hintFlags)
+		{
+			++_lookups;
+			_gate.wait();
+			if (hostname == "missing.test")
+				throw HostNotFoundException(hostname);
+			if (hostname == "tempfail.test")
+				throw DNSException("Temporary DNS error while resolving", hostname);
+			return HostEntry(hostname, IPAddress("10.0.0.1"));
+		}
+
+	private:
+		AtomicCounter _lookups;
+		Event _gate;
+	};
+
+	class GateOpener: public Poco::Runnable
+	{
+	public:
+		GateOpener(TestResolver& resolver):
+			_resolver(resolver)
+		{
+		}
+
+		void run()
+		{
+			Thread::sleep(100);
+			_resolver.openGate();
+		}
+
+	private:
+		TestResolver& _resolver;
+	};
+}
+
+
+DNSResolverTest::DNSResolverTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+DNSResolverTest::~DNSResolverTest()
+{
+}
+
+
+void DNSResolverTest::testCache()
+{
+	TestResolver resolver(2, Timespan(60, 0), Timespan(5, 0));
+
+	HostEntry he1 = resolver.hostByName("www.example.test");
+	assertTrue (he1.name() == "www.example.test");
+	assertTrue (he1.addresses().size() == 1);
+	assertTrue (he1.addresses()[0].toString() == "10.0.0.1");
+	assertTrue (resolver.lookups() == 1);
+	assertTrue (resolver.size() == 1);
+
+	HostEntry he2 = resolver.hostByName("WWW.Example.Test");
+	assertTrue (he2.name() == "www.example.test");
+	assertTrue (resolver.lookups() == 1);
+
+	ActiveResult<HostEntry> result = resolver.hostByNameAsync("www.example.test");
+	assertTrue (result.available());
+	assertTrue (!result.failed());
+	assertTrue (resolver.lookups() == 1);
+
+	assertTrue (resolver.resolveOne("www.example.test").toString() == "10.0.0.1");
+	assertTrue (resolver.lookups() == 1);
+
+	resolver.hostByName("www.example.test", Poco::Net::DNS::DNS_HINT_NONE);
+	assertTrue (resolver.lookups() == 2);
+	assertTrue (resolver.size() == 2);
+
+	resolver.clear();
+	assertTrue (resolver.size() == 0);
+	resolver.hostByName("www.example.test");
+	assertTrue (resolver.lookups() == 3);
+}
+
+
+void DNSResolverTest::testNegativeCache()
+{
+	TestResolver resolver(2, Timespan(60, 0), Timespan(5, 0));
+
+	for (int i = 0; i < 2; i++)
+	{
+		try
+		{
+			resolver.hostByName("missing.test");
+			fail("host not found - must throw");
+		}
+		catch (HostNotFoundException&)
+		{
+		}
+	}
+	assertTrue (resolver.lookups() == 1);
+	assertTrue (resolver.size() == 1);
+
+	ActiveResult<HostEntry> result = resolver.hostByNameAsync("missing.test");
+	assertTrue (result.available());
+	assertTrue (result.failed());
+	assertTrue (dynamic_cast<HostNotFoundException*>(result.exception()) != 0);
+
+	resolver.clear();
+	resolver.setNegativeTTL(0);
+	for (int i = 0; i < 2; i++)
+	{
+		try
+		{
+			resolver.hostByName("missing.test");
+			fail("host not found - must throw");
+		}
+		catch (HostNotFoundException&)
+		{
+		}
+	}
+	assertTrue (resolver.lookups() == 3);
+	assertTrue (resolver.size() == 0);
+}
+
+
+void DNSResolverTest::testTemporaryFailure()
+{
+	TestResolver resolver(2, Timespan(60, 0), Timespan(5, 0));
+
+	for (int i = 0; i < 2; i++)
+	{
+		try
+		{
+			resolver.hostByName("tempfail.test");
+			fail("temporary failure - must throw");
+		}
+		catch (DNSException&)
+		{
+		}
+	}
+	assertTrue (resolver.lookups() == 2);
+	assertTrue (resolver.size() == 0);
+}
+
+
+void DNSResolverTest::testCoalesce()
+{
+	TestResolver resolver(2, Timespan(60, 0), Timespan(5, 0));
+
+	resolver.closeGate();
+	ActiveResult<HostEntry> result1 = resolver.hostByNameAsync("www.example.test");
+	ActiveResult<HostEntry> result2 = resolver.hostByNameAsync("www.example.test");
+	ActiveResult<HostEntry> result3 = resolver.hostByNameAsync("mail.example.test");
+	assertTrue (!result1.available());
+	assertTrue (!result2.available());
+	assertTrue (resolver.size() == 2);
+	resolver.openGate();
+
+	result1.wait();
+	result2.wait();
+	result3.wait();
+	assertTrue (&result1.data() == &result2.data());
+	assertTrue (result1.data().name() == "www.example.test");
+	assertTrue (result3.data().name() == "mail.example.test");
+	assertTrue (resolver.lookups() == 2);
+}
+
+
+void DNSResolverTest::testExpire()
+{
+	TestResolver resolver(1, Timespan(0, 100000), Timespan(5, 0));
+
+	resolver.hostByName("www.example.test");
+	resolver.hostByName("www.example.test");
+	assertTrue (resolver.lookups() == 1);
+
+	Thread::sleep(200);
+	resolver.hostByName("www.example.test");
+	assertTrue (resolver.lookups() == 2);
+	assertTrue (resolver.size() == 1);
+
+	Thread::sleep(200);
+	resolver.purge();
+	assertTrue (resolver.size() == 0);
+}
+
+
+void DNSResolverTest::testEvict()
+{
+	TestResolver resolver(1, Timespan(60, 0), Timespan(5, 0), 2);
+
+	resolver.hostByName("a.test");
+	resolver.hostByName("b.test");
+	resolver.hostByName("a.test");
+	assertTrue (resolver.lookups() == 2);
+
+	resolver.hostByName("c.test");
+	assertTrue (resolver.lookups() == 3);
+	assertTrue (resolver.size() == 2);
+
+	// b.test has been least recently used
+	resolver.hostByName("a.test");
+	assertTrue (resolver.lookups() == 3);
+	resolver.hostByName("b.test");
+	assertTrue (resolver.lookups() == 4);
+	assertTrue (resolver.size() == 2);
+}
+
+
+void DNSResolverTest::testNumericAddress()
+{
+	TestResolver resolver(1, Timespan(60, 0), Timespan(5, 0));
+
+	ActiveResult<HostEntry> result = resolver.hostByNameAsync("192.168.1.1");
+	assertTrue (result.available());
+	assertTrue (result.data().addresses().size() == 1);
+	assertTrue (result.data().addresses()[0].toString() == "192.168.1.1");
+
+	assertTrue (resolver.resolveOne("::1").toString() == "::1");
+	assertTrue (resolver.lookups() == 0);
+	assertTrue (resolver.size() == 0);
+}
+
+
+void DNSResolverTest::testStop()
+{
+	TestResolver resolver(1, Timespan(60, 0), Timespan(5, 0));
+
+	resolver.closeGate();
+	ActiveResult<HostEntry> result1 = resolver.hostByNameAsync("a.test");
+	ActiveResult<HostEntry> result2 = resolver.hostByNameAsync("b.test");
+	while (resolver.lookups() == 0) Thread::sleep(10);
+
+	GateOpener opener(resolver);
+	Thread thread;
+	thread.start(opener);
+	resolver.stop();
+	thread.join();
+
+	assertTrue (result1.available());
+	assertTrue (!result1.failed());
+	assertTrue (result2.available());
+	assertTrue (result2.failed());
+	assertTrue (resolver.lookups() == 1);
+	assertTrue (resolver.size() == 0);
+
+	try
+	{
+		resolver.hostByName("a.test");
+		fail("stopped - must throw");
+	}
+	catch (Poco::InvalidAccessException&)
+	{
+	}
+}
+
+
+void DNSResolverTest::testLocalhost()
+{
+	DNSResolver resolver;
+	HostEntry he1 = resolver.hostByName("localhost");
+	assertTrue (!he1.addresses().empty());
+	assertTrue (resolver.size() == 1);
+
+	HostEntry he2 = resolver.hostByName("localhost");
+	assertTrue (he2.addresses().size() == he1.addresses().size());
+	assertTrue (resolver.size() == 1);
+}
+
+
+void DNSResolverTest::setUp()
+{
+}
+
+
+void DNSResolverTest::tearDown()
+{
+}
+
+
+CppUnit::Test* DNSResolverTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("DNSResolverTest");
+
+	CppUnit_addTest(pSuite, DNSResolverTest, testCache);
+	CppUnit_addTest(pSuite, DNSResolverTest, testNegativeCache);
+	CppUnit_addTest(pSuite, DNSResolverTest, testTemporaryFailure);
+	CppUnit_addTest(pSuite, DNSResolverTest, testCoalesce);
+	CppUnit_addTest(pSuite, DNSResolverTest, testExpire);
+	CppUnit_addTest(pSuite, DNSResolverTest, testEvict);
+	CppUnit_addTest(pSuite, DNSResolverTest, testNumericAddress);
+	CppUnit_addTest(pSuite, DNSResolverTest, testStop);
+	CppUnit_addTest(pSuite, DNSResolverTest, testLocalhost);
+
+	return pSuite;
+}
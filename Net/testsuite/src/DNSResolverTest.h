@@ -0,0 +1,46 @@
+//
+// DNSResolverTest.h
+//
+// Definition of the DNSResolverTest class.
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef DNSResolverTest_INCLUDED
+#define DNSResolverTest_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "CppUnit/TestCase.h"
+
+
+class DNSResolverTest: public CppUnit::TestCase
+{
+public:
+	DNSResolverTest(const std::string& name);
+	~DNSResolverTest();
+
+	void testCache();
+	void testNegativeCache();
+	void testTemporaryFailure();
+	void testCoalesce();
+	void testExpire();
+	void testEvict();
+	void testNumericAddress();
+	void testStop();
+	void testLocalhost();
+
+	void setUp();
+	void tearDown();
+
+	static CppUnit::Test* suite();
+
+private:
+};
+
+
+#endif // DNSResolverTest_INCLUDED
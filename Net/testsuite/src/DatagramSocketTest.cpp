@@ -25,6 +25,8 @@
 using Poco::Net::Socket;
 using Poco::Net::DatagramSocket;
 using Poco::Net::SocketAddress;
+using Poco::Net::SocketMessage;
+using Poco::Net::SocketMessageVec;
 using Poco::Net::IPAddress;
 #ifdef POCO_NET_HAS_INTERFACE
 	using Poco::Net::NetworkInterface;
@@ -98,6 +100,63 @@ void DatagramSocketTest::testSendToReceiveFrom()
 }
 
 
+void DatagramSocketTest::testSendReceiveMessages()
+{
+	DatagramSocket receiver(SocketAddress("127.0.0.1", 0), true);
+	receiver.setReceiveTimeout(Timespan(5, 0));
+	DatagramSocket sender(SocketAddress("127.0.0.1", 0), true);
+	SocketAddress dest = receiver.address();
+
+	const int count = 100;
+	std::vector<std::string> payloads;
+	for (int i = 0; i < count; i++)
+	{
+		payloads.push_back("message " + std::to_string(i));
+	}
+	SocketMessageVec out(count);
+	for (int i = 0; i < count; i++)
+	{
+		out[i].pBuffer = const_cast<char*>(payloads[i].data());
+		out[i].bufferLength = static_cast<int>(payloads[i].size());
+		out[i].pAddress = const_cast<struct sockaddr*>(dest.addr());
+		out[i].addressLength = dest.length();
+	}
+	int sent = sender.sendMessages(out);
+	assertTrue (sent == count);
+	for (int i = 0; i < count; i++)
+	{
+		assertTrue (out[i].length == out[i].bufferLength);
+	}
+
+	char buffers[16][64];
+	struct sockaddr_storage addresses[16];
+	SocketMessageVec in(16);
+	int received = 0;
+	while (received < count)
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			in[i].pBuffer = buffers[i];
+			in[i].bufferLength = sizeof(buffers[i]);
+			in[i].pAddress = reinterpret_cast<struct sockaddr*>(&addresses[i]);
+			in[i].addressLength = sizeof(addresses[i]);
+		}
+		int n = receiver.receiveMessages(in);
+		assertTrue (n > 0 && n <= 16);
+		for (int i = 0; i < n; i++)
+		{
+			assertTrue (std::string(buffers[i], in[i].length) == payloads[received + i]);
+			assertTrue (SocketAddress(in[i].pAddress, in[i].addressLength) == sender.address());
+			assertTrue (in[i].segmentSize == 0);
+		}
+		received += n;
+	}
+
+	receiver.setBlocking(false);
+	assertTrue (receiver.receiveMessages(in) == 0);
+}
+
+
 void DatagramSocketTest::testUnbound()
 {
 	UDPEchoServer echoServer;
@@ -609,6 +668,7 @@ CppUnit::Test* DatagramSocketTest::suite()
 	CppUnit_addTest(pSuite, DatagramSocketTest, testEcho);
 	CppUnit_addTest(pSuite, DatagramSocketTest, testEchoBuffer);
 	CppUnit_addTest(pSuite, DatagramSocketTest, testSendToReceiveFrom);
+	CppUnit_addTest(pSuite, DatagramSocketTest, testSendReceiveMessages);
 	CppUnit_addTest(pSuite, DatagramSocketTest, testUnbound);
 #if (POCO_OS != POCO_OS_FREE_BSD) // works only with local net bcast and very randomly
 	CppUnit_addTest(pSuite, DatagramSocketTest, testBroadcast);
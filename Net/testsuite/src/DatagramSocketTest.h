@@ -27,6 +27,7 @@ public:
 	void testEcho();
 	void testEchoBuffer();
 	void testSendToReceiveFrom();
+	void testSendReceiveMessages();
 	void testUnbound();
 	void testBroadcast();
 	void testGatherScatterFixed();
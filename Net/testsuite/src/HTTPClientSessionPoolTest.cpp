@@ -0,0 +1,404 @@
+//
+// HTTPClientSessionPoolTest.cpp
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "HTTPClientSessionPoolTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+#include "Poco/Net/HTTPClientSessionPool.h"
+#include "Poco/Net/HTTPSessionFactory.h"
+#include "Poco/Net/HTTPSessionInstantiator.h"
+#include "Poco/Net/HTTPServer.h"
+#include "Poco/Net/HTTPServerParams.h"
+#include "Poco/Net/HTTPRequestHandler.h"
+#include "Poco/Net/HTTPRequestHandlerFactory.h"
+#include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/HTTPServerResponse.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/ServerSocket.h"
+#include "Poco/StreamCopier.h"
+#include "Poco/Thread.h"
+#include "Poco/Runnable.h"
+#include "Poco/Stopwatch.h"
+#include "Poco/URI.h"
+#include "Poco/Exception.h"
+#include <sstream>
+
+
+using Poco::Net::HTTPClientSessionPool;
+using Poco::Net::HTTPClientSession;
+using Poco::Net::HTTPSessionFactory;
+using Poco::Net::HTTPSessionInstantiator;
+using Poco::Net::HTTPServer;
+using Poco::Net::HTTPServerParams;
+using Poco::Net::HTTPRequestHandler;
+using Poco::Net::HTTPRequestHandlerFactory;
+using Poco::Net::HTTPServerRequest;
+using Poco::Net::HTTPServerResponse;
+using Poco::Net::HTTPRequest;
+using Poco::Net::HTTPResponse;
+using Poco::Net::HTTPMessage;
+using Poco::Net::ServerSocket;
+using Poco::StreamCopier;
+using Poco::Thread;
+using Poco::URI;
+
+
+namespace
+{
+	class HelloRequestHandler: public HTTPRequestHandler
+	{
+	public:
+		void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+		{
+			response.sendBuffer("hello", 5);
+		}
+	};
+
+	class HelloRequestHandlerFactory: public HTTPRequestHandlerFactory
+	{
+	public:
+		HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request)
+		{
+			return new HelloRequestHandler;
+		}
+	};
+
+	std::string get(HTTPClientSession& session)
+	{
+		HTTPRequest request(HTTPRequest::HTTP_GET, "/", HTTPMessage::HTTP_1_1);
+		session.sendRequest(request);
+		HTTPResponse response;
+		std::istream& rs = session.receiveResponse(response);
+		std::ostringstream ostr;
+		StreamCopier::copyStream(rs, ostr);
+		return ostr.str();
+	}
+
+	class SessionWaiter: public Poco::Runnable
+	{
+	public:
+		SessionWaiter(HTTPClientSessionPool& pool, const URI& uri): _pool(pool), _uri(uri), _ok(false)
+		{
+		}
+
+		void run()
+		{
+			try
+			{
+				HTTPClientSessionPool::PooledSession pSession = _pool.get(_uri);
+				_ok = true;
+				_stopwatch.stop();
+			}
+			catch (Poco::Exception&)
+			{
+			}
+		}
+
+		void start()
+		{
+			_stopwatch.start();
+			_thread.start(*this);
+		}
+
+		void join()
+		{
+			_thread.join();
+		}
+
+		bool ok() const
+		{
+			return _ok;
+		}
+
+		Poco::Timestamp::TimeDiff elapsed() const
+		{
+			return _stopwatch.elapsed();
+		}
+
+	private:
+		HTTPClientSessionPool& _pool;
+		URI _uri;
+		bool _ok;
+		Poco::Stopwatch _stopwatch;
+		Thread _thread;
+	};
+
+	URI uriFor(const ServerSocket& socket)
+	{
+		URI uri;
+		uri.setScheme("http");
+		uri.setHost("127.0.0.1");
+		uri.setPort(socket.address().port());
+		uri.setPath("/");
+		return uri;
+	}
+}
+
+
+HTTPClientSessionPoolTest::HTTPClientSessionPoolTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+HTTPClientSessionPoolTest::~HTTPClientSessionPoolTest()
+{
+}
+
+
+void HTTPClientSessionPoolTest::testReuse()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new HelloRequestHandlerFactory, svs, new HTTPServerParams);
+	srv.start();
+
+	HTTPSessionFactory factory;
+	factory.registerProtocol("http", new HTTPSessionInstantiator);
+	HTTPClientSessionPool pool(factory);
+	URI uri = uriFor(svs);
+
+	HTTPClientSession* pFirst = 0;
+	{
+		HTTPClientSessionPool::PooledSession pSession = pool.get(uri);
+		assertTrue (pool.used() == 1);
+		assertTrue (pSession->getKeepAlive());
+		assertTrue (get(*pSession) == "hello");
+		pFirst = pSession.get();
+	}
+	assertTrue (pool.used() == 0);
+	assertTrue (pool.idle() == 1);
+
+	for (int i = 0; i < 5; i++)
+	{
+		HTTPClientSessionPool::PooledSession pSession = pool.get(uri);
+		assertTrue (pSession.get() == pFirst);
+		assertTrue (get(*pSession) == "hello");
+	}
+	assertTrue (srv.totalConnections() == 1);
+}
+
+
+void HTTPClientSessionPoolTest::testSeparateHosts()
+{
+	ServerSocket svs1(0);
+	HTTPServer srv1(new HelloRequestHandlerFactory, svs1, new HTTPServerParams);
+	srv1.start();
+	ServerSocket svs2(0);
+	HTTPServer srv2(new HelloRequestHandlerFactory, svs2, new HTTPServerParams);
+	srv2.start();
+
+	HTTPSessionFactory factory;
+	factory.registerProtocol("http", new HTTPSessionInstantiator);
+	HTTPClientSessionPool pool(factory);
+
+	HTTPClientSessionPool::PooledSession pSession1 = pool.get(uriFor(svs1));
+	HTTPClientSessionPool::PooledSession pSession2 = pool.get(uriFor(svs2));
+	assertTrue (pSession1.get() != pSession2.get());
+	assertTrue (pSession1->getPort() == svs1.address().port());
+	assertTrue (pSession2->getPort() == svs2.address().port());
+	assertTrue (get(*pSession1) == "hello");
+	assertTrue (get(*pSession2) == "hello");
+	pSession1.release();
+	assertTrue (pSession1.isNull());
+	pSession2.release();
+	assertTrue (pool.idle() == 2);
+
+	HTTPClientSessionPool::PooledSession pSession3 = pool.get(uriFor(svs2));
+	assertTrue (pSession3->getPort() == svs2.address().port());
+	assertTrue (pool.idle() == 1);
+}
+
+
+void HTTPClientSessionPoolTest::testMaxPerHost()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new HelloRequestHandlerFactory, svs, new HTTPServerParams);
+	srv.start();
+
+	HTTPSessionFactory factory;
+	factory.registerProtocol("http", new HTTPSessionInstantiator);
+	HTTPClientSessionPool pool(factory, 2);
+	pool.setWaitTimeout(Poco::Timespan(0, 100000));
+	URI uri = uriFor(svs);
+
+	HTTPClientSessionPool::PooledSession pSession1 = pool.get(uri);
+	HTTPClientSessionPool::PooledSession pSession2 = pool.get(uri);
+	assertTrue (pool.used() == 2);
+	try
+	{
+		HTTPClientSessionPool::PooledSession pSession3 = pool.get(uri);
+		fail("no session available - must throw");
+	}
+	catch (Poco::TimeoutException&)
+	{
+	}
+
+	HTTPClientSession* pReleased = pSession2.get();
+	pSession2.release();
+	HTTPClientSessionPool::PooledSession pSession3 = pool.get(uri);
+	assertTrue (pSession3.get() == pReleased);
+
+	HTTPClientSessionPool::PooledSession pSession4 = std::move(pSession3);
+	assertTrue (pSession3.isNull());
+	assertTrue (pSession4.get() == pReleased);
+	assertTrue (pool.used() == 2);
+}
+
+
+void HTTPClientSessionPoolTest::testWaitSeparateHosts()
+{
+	ServerSocket svs1(0);
+	ServerSocket svs2(0);
+
+	HTTPSessionFactory factory;
+	factory.registerProtocol("http", new HTTPSessionInstantiator);
+	HTTPClientSessionPool pool(factory, 1);
+	pool.setWaitTimeout(Poco::Timespan(10, 0));
+	URI uri1 = uriFor(svs1);
+	URI uri2 = uriFor(svs2);
+
+	HTTPClientSessionPool::PooledSession pSession1 = pool.get(uri1);
+	HTTPClientSessionPool::PooledSession pSession2 = pool.get(uri2);
+
+	// waiters for both hosts block on the pool; returning a session
+	// for one host must wake up the waiter for that host
+	SessionWaiter waiter1(pool, uri1);
+	SessionWaiter waiter2(pool, uri2);
+	waiter1.start();
+	waiter2.start();
+	Thread::sleep(200);
+	pSession2.release();
+	waiter2.join();
+	assertTrue (waiter2.ok());
+	assertTrue (waiter2.elapsed() < 5000000);
+
+	pSession1.release();
+	waiter1.join();
+	assertTrue (waiter1.ok());
+	assertTrue (waiter1.elapsed() < 5000000);
+}
+
+
+void HTTPClientSessionPoolTest::testIdleTimeout()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new HelloRequestHandlerFactory, svs, new HTTPServerParams);
+	srv.start();
+
+	HTTPSessionFactory factory;
+	factory.registerProtocol("http", new HTTPSessionInstantiator);
+	HTTPClientSessionPool pool(factory, 4, Poco::Timespan(0, 200000));
+	URI uri = uriFor(svs);
+
+	{
+		HTTPClientSessionPool::PooledSession pSession = pool.get(uri);
+		assertTrue (get(*pSession) == "hello");
+	}
+	assertTrue (pool.idle() == 1);
+	pool.purge();
+	assertTrue (pool.idle() == 1);
+	Thread::sleep(300);
+	pool.purge();
+	assertTrue (pool.idle() == 0);
+
+	HTTPClientSessionPool::PooledSession pSession = pool.get(uri);
+	assertTrue (get(*pSession) == "hello");
+	assertTrue (srv.totalConnections() == 2);
+}
+
+
+void HTTPClientSessionPoolTest::testServerClose()
+{
+	ServerSocket svs(0);
+	HTTPServerParams* pParams = new HTTPServerParams;
+	pParams->setKeepAliveTimeout(Poco::Timespan(0, 100000));
+	HTTPServer srv(new HelloRequestHandlerFactory, svs, pParams);
+	srv.start();
+
+	HTTPSessionFactory factory;
+	factory.registerProtocol("http", new HTTPSessionInstantiator);
+	HTTPClientSessionPool pool(factory);
+	URI uri = uriFor(svs);
+
+	HTTPClientSession* pFirst = 0;
+	{
+		HTTPClientSessionPool::PooledSession pSession = pool.get(uri);
+		assertTrue (get(*pSession) == "hello");
+		pFirst = pSession.get();
+	}
+
+	// the server closes the idle connection after its keep-alive timeout
+	Thread::sleep(500);
+
+	HTTPClientSessionPool::PooledSession pSession = pool.get(uri);
+	assertTrue (pSession.get() == pFirst);
+	assertTrue (!pSession->connected());
+	assertTrue (get(*pSession) == "hello");
+	assertTrue (srv.totalConnections() == 2);
+}
+
+
+void HTTPClientSessionPoolTest::testShutdown()
+{
+	ServerSocket svs(0);
+	HTTPServer srv(new HelloRequestHandlerFactory, svs, new HTTPServerParams);
+	srv.start();
+
+	HTTPSessionFactory factory;
+	factory.registerProtocol("http", new HTTPSessionInstantiator);
+	HTTPClientSessionPool pool(factory);
+	URI uri = uriFor(svs);
+
+	HTTPClientSessionPool::PooledSession pSession1 = pool.get(uri);
+	{
+		HTTPClientSessionPool::PooledSession pSession2 = pool.get(uri);
+	}
+	assertTrue (pool.idle() == 1);
+	pool.shutdown();
+	assertTrue (pool.idle() == 0);
+	assertTrue (pool.used() == 1);
+	try
+	{
+		pool.get(uri);
+		fail("pool shut down - must throw");
+	}
+	catch (Poco::InvalidAccessException&)
+	{
+	}
+	pSession1.release();
+	assertTrue (pool.used() == 0);
+	assertTrue (pool.idle() == 0);
+}
+
+
+void HTTPClientSessionPoolTest::setUp()
+{
+}
+
+
+void HTTPClientSessionPoolTest::tearDown()
+{
+}
+
+
+CppUnit::Test* HTTPClientSessionPoolTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("HTTPClientSessionPoolTest");
+
+	CppUnit_addTest(pSuite, HTTPClientSessionPoolTest, testReuse);
+	CppUnit_addTest(pSuite, HTTPClientSessionPoolTest, testSeparateHosts);
+	CppUnit_addTest(pSuite, HTTPClientSessionPoolTest, testMaxPerHost);
+	CppUnit_addTest(pSuite, HTTPClientSessionPoolTest, testWaitSeparateHosts);
+	CppUnit_addTest(pSuite, HTTPClientSessionPoolTest, testIdleTimeout);
+	CppUnit_addTest(pSuite, HTTPClientSessionPoolTest, testServerClose);
+	CppUnit_addTest(pSuite, HTTPClientSessionPoolTest, testShutdown);
+
+	return pSuite;
+}
@@ -0,0 +1,266 @@
+//
+// HTTPHeaderParserTest.cpp
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "HTTPHeaderParserTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+#include "Poco/Net/HTTPHeaderParser.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/HTTPClientSession.h"
+#include "Poco/Net/HTTPHeaderStream.h"
+#include "Poco/Net/ServerSocket.h"
+#include "Poco/Net/StreamSocket.h"
+#include "Poco/Net/SocketAddress.h"
+#include "Poco/Net/NetException.h"
+#include <sstream>
+
+
+using Poco::Net::HTTPHeaderParser;
+using Poco::Net::HTTPRequest;
+using Poco::Net::HTTPResponse;
+using Poco::Net::HTTPClientSession;
+using Poco::Net::HTTPHeaderInputStream;
+using Poco::Net::ServerSocket;
+using Poco::Net::StreamSocket;
+using Poco::Net::SocketAddress;
+using Poco::Net::MessageException;
+
+
+namespace
+{
+	HTTPHeaderParser::Result parse(HTTPHeaderParser& parser, const std::string& s)
+	{
+		return parser.parse(s.data(), s.data() + s.size());
+	}
+}
+
+
+HTTPHeaderParserTest::HTTPHeaderParserTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+HTTPHeaderParserTest::~HTTPHeaderParserTest()
+{
+}
+
+
+void HTTPHeaderParserTest::testRequest()
+{
+	std::string s("\r\nGET /index.html HTTP/1.1\r\nHost: localhost\r\nConnection:   Keep-Alive  \r\nX-Empty:\r\n\r\nbody");
+	HTTPHeaderParser parser;
+	assertTrue (parse(parser, s) == HTTPHeaderParser::HEADER_COMPLETE);
+	assertTrue (parser.length() == s.size() - 4);
+	assertTrue (parser.token(0).str() == "GET");
+	assertTrue (parser.token(1).str() == "/index.html");
+	assertTrue (parser.token(2).str() == "HTTP/1.1");
+	assertTrue (parser.fields().size() == 3);
+	assertTrue (parser.fields()[0].name.str() == "Host");
+	assertTrue (parser.fields()[0].value.str() == "localhost");
+	assertTrue (parser.fields()[1].name.str() == "Connection");
+	assertTrue (parser.fields()[1].value.str() == "Keep-Alive");
+	assertTrue (parser.fields()[2].name.str() == "X-Empty");
+	assertTrue (parser.fields()[2].value.empty());
+	assertTrue (parser.fields()[0].value.data() == s.data() + s.find("localhost"));
+
+	std::string lf("POST /upload HTTP/1.0\nContent-Length: 42\nnot a field\n\n");
+	assertTrue (parse(parser, lf) == HTTPHeaderParser::HEADER_COMPLETE);
+	assertTrue (parser.length() == lf.size());
+	assertTrue (parser.fields().size() == 1);
+	assertTrue (parser.fields()[0].name.str() == "Content-Length");
+	assertTrue (parser.fields()[0].value.str() == "42");
+}
+
+
+void HTTPHeaderParserTest::testResponse()
+{
+	std::string s("HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\n\r\n");
+	HTTPHeaderParser parser;
+	assertTrue (parse(parser, s) == HTTPHeaderParser::HEADER_COMPLETE);
+	assertTrue (parser.length() == s.size());
+	assertTrue (parser.token(0).str() == "HTTP/1.1");
+	assertTrue (parser.token(1).str() == "404");
+	assertTrue (parser.token(2).str() == "Not Found");
+	assertTrue (parser.fields().size() == 1);
+
+	std::string noReason("HTTP/1.1 200\r\n\r\n");
+	assertTrue (parse(parser, noReason) == HTTPHeaderParser::HEADER_COMPLETE);
+	assertTrue (parser.token(1).str() == "200");
+	assertTrue (parser.token(2).empty());
+	assertTrue (parser.fields().empty());
+}
+
+
+void HTTPHeaderParserTest::testIncomplete()
+{
+	std::string s("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+	HTTPHeaderParser parser;
+	for (std::size_t n = 0; n < s.size(); n++)
+	{
+		assertTrue (parser.parse(s.data(), s.data() + n) == HTTPHeaderParser::HEADER_INCOMPLETE);
+	}
+	assertTrue (parse(parser, s) == HTTPHeaderParser::HEADER_COMPLETE);
+	assertTrue (parse(parser, "  \r\n") == HTTPHeaderParser::HEADER_INCOMPLETE);
+}
+
+
+void HTTPHeaderParserTest::testUnsupported()
+{
+	HTTPHeaderParser parser;
+	assertTrue (parse(parser, "GET / HTTP/1.1\r\nX-Folded: a\r\n b\r\n\r\n") == HTTPHeaderParser::HEADER_UNSUPPORTED);
+	assertTrue (parse(parser, "GET / HTTP/1.1\r\nX-Bad: a\rb\r\n\r\n") == HTTPHeaderParser::HEADER_UNSUPPORTED);
+	assertTrue (parse(parser, "GET\r\n/ HTTP/1.1\r\n\r\n") == HTTPHeaderParser::HEADER_UNSUPPORTED);
+}
+
+
+void HTTPHeaderParserTest::testFieldLimit()
+{
+	std::string s("GET / HTTP/1.1\r\nA: 1\r\nB: 2\r\nC: 3\r\n\r\n");
+	HTTPHeaderParser parser3(3);
+	assertTrue (parse(parser3, s) == HTTPHeaderParser::HEADER_COMPLETE);
+	HTTPHeaderParser parser2(2);
+	assertTrue (parse(parser2, s) == HTTPHeaderParser::HEADER_UNSUPPORTED);
+}
+
+
+void HTTPHeaderParserTest::testLongLines()
+{
+	HTTPHeaderParser parser;
+	std::string value(HTTPHeaderParser::MAX_VALUE_LENGTH, 'v');
+	std::string s("GET / HTTP/1.1\r\nX-Long: ");
+	s += value;
+	s += "\r\n\r\n";
+	assertTrue (parse(parser, s) == HTTPHeaderParser::HEADER_COMPLETE);
+	assertTrue (parser.fields()[0].value.size() == value.size());
+
+	s = "GET / HTTP/1.1\r\nX-Long: ";
+	s += value;
+	s += "v\r\n\r\n";
+	assertTrue (parse(parser, s) == HTTPHeaderParser::HEADER_UNSUPPORTED);
+
+	s = "GET / HTTP/1.1\r\n";
+	s += std::string(HTTPHeaderParser::MAX_NAME_LENGTH + 1, 'n');
+	s += ": value\r\n\r\n";
+	assertTrue (parse(parser, s) == HTTPHeaderParser::HEADER_UNSUPPORTED);
+}
+
+
+void HTTPHeaderParserTest::testReadRequest()
+{
+	std::string s("PUT /resource?query=1 HTTP/1.1 trailing\r\nHost: localhost\r\nX-Encoded: =?UTF-8?Q?caf=C3=A9?=\r\n\r\n");
+	HTTPHeaderParser parser;
+	assertTrue (parse(parser, s) == HTTPHeaderParser::HEADER_COMPLETE);
+	HTTPRequest request;
+	request.read(parser);
+	assertTrue (request.getMethod() == HTTPRequest::HTTP_PUT);
+	assertTrue (request.getURI() == "/resource?query=1");
+	assertTrue (request.getVersion() == HTTPRequest::HTTP_1_1);
+	assertTrue (request.getHost() == "localhost");
+	assertTrue (request.get("X-Encoded") == "caf\xC3\xA9");
+}
+
+
+void HTTPHeaderParserTest::testReadResponse()
+{
+	std::string s("HTTP/1.0 301 Moved Permanently\r\nLocation: http://www.appinf.com/index.html\r\n\r\n");
+	HTTPHeaderParser parser;
+	assertTrue (parse(parser, s) == HTTPHeaderParser::HEADER_COMPLETE);
+	HTTPResponse response;
+	response.read(parser);
+	assertTrue (response.getVersion() == HTTPResponse::HTTP_1_0);
+	assertTrue (response.getStatus() == HTTPResponse::HTTP_MOVED_PERMANENTLY);
+	assertTrue (response.getReason() == "Moved Permanently");
+	assertTrue (response.get("Location") == "http://www.appinf.com/index.html");
+}
+
+
+void HTTPHeaderParserTest::testInvalid()
+{
+	HTTPHeaderParser parser;
+	HTTPRequest request;
+	assertTrue (parse(parser, "GET /index.html HTTP/1.1-invalid-version\r\n\r\n") == HTTPHeaderParser::HEADER_COMPLETE);
+	try
+	{
+		request.read(parser);
+		fail("invalid version - must throw");
+	}
+	catch (MessageException&)
+	{
+	}
+
+	HTTPResponse response;
+	assertTrue (parse(parser, "HTTP/1.1 2000 OK\r\n\r\n") == HTTPHeaderParser::HEADER_COMPLETE);
+	try
+	{
+		response.read(parser);
+		fail("invalid status - must throw");
+	}
+	catch (MessageException&)
+	{
+	}
+}
+
+
+void HTTPHeaderParserTest::testReadRequestWithoutVersion()
+{
+	std::string s("GET /index.html\r\nHost: localhost\r\nX-Field: value\r\n\r\n");
+	HTTPHeaderParser parser(0, true);
+	assertTrue (parse(parser, s) == HTTPHeaderParser::HEADER_UNSUPPORTED);
+
+	// A request read from the session buffer must be
+	// the same as a request read from any other stream.
+	std::istringstream istr(s);
+	HTTPRequest expected;
+	expected.read(istr);
+
+	ServerSocket ss(SocketAddress("127.0.0.1", 0));
+	StreamSocket client(ss.address());
+	StreamSocket server = ss.acceptConnection();
+	client.sendBytes(s.data(), static_cast<int>(s.size()));
+	HTTPClientSession session(server);
+	HTTPHeaderInputStream his(session);
+	HTTPRequest request;
+	request.read(his);
+	assertTrue (request.getMethod() == expected.getMethod());
+	assertTrue (request.getURI() == expected.getURI());
+	assertTrue (request.getVersion() == expected.getVersion());
+	assertTrue (request.size() == expected.size());
+	assertTrue (request.get("X-Field") == "value");
+}
+
+
+void HTTPHeaderParserTest::setUp()
+{
+}
+
+
+void HTTPHeaderParserTest::tearDown()
+{
+}
+
+
+CppUnit::Test* HTTPHeaderParserTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("HTTPHeaderParserTest");
+
+	CppUnit_addTest(pSuite, HTTPHeaderParserTest, testRequest);
+	CppUnit_addTest(pSuite, HTTPHeaderParserTest, testResponse);
+	CppUnit_addTest(pSuite, HTTPHeaderParserTest, testIncomplete);
+	CppUnit_addTest(pSuite, HTTPHeaderParserTest, testUnsupported);
+	CppUnit_addTest(pSuite, HTTPHeaderParserTest, testFieldLimit);
+	CppUnit_addTest(pSuite, HTTPHeaderParserTest, testLongLines);
+	CppUnit_addTest(pSuite, HTTPHeaderParserTest, testReadRequest);
+	CppUnit_addTest(pSuite, HTTPHeaderParserTest, testReadResponse);
+	CppUnit_addTest(pSuite, HTTPHeaderParserTest, testInvalid);
+	CppUnit_addTest(pSuite, HTTPHeaderParserTest, testReadRequestWithoutVersion);
+
+	return pSuite;
+}
@@ -0,0 +1,47 @@
+//
+// HTTPHeaderParserTest.h
+//
+// Definition of the HTTPHeaderParserTest class.
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef HTTPHeaderParserTest_INCLUDED
+#define HTTPHeaderParserTest_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "CppUnit/TestCase.h"
+
+
+class HTTPHeaderParserTest: public CppUnit::TestCase
+{
+public:
+	HTTPHeaderParserTest(const std::string& name);
+	~HTTPHeaderParserTest();
+
+	void testRequest();
+	void testResponse();
+	void testIncomplete();
+	void testUnsupported();
+	void testFieldLimit();
+	void testLongLines();
+	void testReadRequest();
+	void testReadResponse();
+	void testInvalid();
+	void testReadRequestWithoutVersion();
+
+	void setUp();
+	void tearDown();
+
+	static CppUnit::Test* suite();
+
+private:
+};
+
+
+#endif // HTTPHeaderParserTest_INCLUDED
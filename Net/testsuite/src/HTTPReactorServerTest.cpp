@@ -0,0 +1,353 @@
+//
+// HTTPReactorServerTest.cpp
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "HTTPReactorServerTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+#include "Poco/Net/HTTPReactorServer.h"
+#include "Poco/Net/HTTPServerParams.h"
+#include "Poco/Net/HTTPRequestHandler.h"
+#include "Poco/Net/HTTPRequestHandlerFactory.h"
+#include "Poco/Net/HTTPClientSession.h"
+#include "Poco/Net/HTTPRequest.h"
+#include "Poco/Net/HTTPServerRequest.h"
+#include "Poco/Net/HTTPResponse.h"
+#include "Poco/Net/HTTPServerResponse.h"
+#include "Poco/Net/ServerSocket.h"
+#include "Poco/Net/StreamSocket.h"
+#include "Poco/StreamCopier.h"
+#include "Poco/Thread.h"
+#include <memory>
+#include <vector>
+
+
+using Poco::Net::HTTPReactorServer;
+using Poco::Net::HTTPServerParams;
+using Poco::Net::HTTPRequestHandler;
+using Poco::Net::HTTPRequestHandlerFactory;
+using Poco::Net::HTTPClientSession;
+using Poco::Net::HTTPRequest;
+using Poco::Net::HTTPServerRequest;
+using Poco::Net::HTTPResponse;
+using Poco::Net::HTTPServerResponse;
+using Poco::Net::HTTPMessage;
+using Poco::Net::ServerSocket;
+using Poco::Net::StreamSocket;
+using Poco::Net::SocketAddress;
+using Poco::StreamCopier;
+
+
+namespace
+{
+	class EchoBodyRequestHandler: public HTTPRequestHandler
+	{
+	public:
+		void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+		{
+			if (request.getChunkedTransferEncoding())
+				response.setChunkedTransferEncoding(true);
+			else if (request.getContentLength() != HTTPMessage::UNKNOWN_CONTENT_LENGTH)
+				response.setContentLength(request.getContentLength());
+
+			response.setContentType(request.getContentType());
+
+			std::istream& istr = request.stream();
+			std::ostream& ostr = response.send();
+			StreamCopier::copyStream(istr, ostr);
+		}
+	};
+
+	class URIRequestHandler: public HTTPRequestHandler
+	{
+	public:
+		void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+		{
+			response.setContentLength(request.getURI().length());
+			response.send() << request.getURI();
+		}
+	};
+
+	class RequestHandlerFactory: public HTTPRequestHandlerFactory
+	{
+	public:
+		HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request)
+		{
+			if (request.getURI() == "/echoBody")
+				return new EchoBodyRequestHandler;
+			else if (request.getURI().compare(0, 5, "/uri/") == 0)
+				return new URIRequestHandler;
+			else
+				return 0;
+		}
+	};
+
+	int waitFor(HTTPReactorServer& srv, int idle)
+	{
+		for (int i = 0; i < 100 && srv.idleConnections() != idle; i++)
+		{
+			Poco::Thread::sleep(50);
+		}
+		return srv.idleConnections();
+	}
+}
+
+
+HTTPReactorServerTest::HTTPReactorServerTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+HTTPReactorServerTest::~HTTPReactorServerTest()
+{
+}
+
+
+void HTTPReactorServerTest::testIdentityRequest()
+{
+	ServerSocket svs(0);
+	HTTPServerParams* pParams = new HTTPServerParams;
+	pParams->setKeepAlive(false);
+	HTTPReactorServer srv(new RequestHandlerFactory, svs, pParams);
+	srv.start();
+
+	HTTPClientSession cs("127.0.0.1", svs.address().port());
+	std::string body(5000, 'x');
+	HTTPRequest request("POST", "/echoBody");
+	request.setContentLength((int) body.length());
+	request.setContentType("text/plain");
+	cs.sendRequest(request) << body;
+	HTTPResponse response;
+	std::string rbody;
+	cs.receiveResponse(response) >> rbody;
+	assertTrue (response.getContentLength() == body.size());
+	assertTrue (response.getContentType() == "text/plain");
+	assertTrue (rbody == body);
+}
+
+
+void HTTPReactorServerTest::testChunkedRequestKeepAlive()
+{
+	ServerSocket svs(0);
+	HTTPServerParams* pParams = new HTTPServerParams;
+	pParams->setKeepAlive(true);
+	pParams->setMaxThreads(2);
+	HTTPReactorServer srv(new RequestHandlerFactory, svs, pParams);
+	srv.start();
+	assertTrue (srv.currentThreads() == 2);
+
+	HTTPClientSession cs("127.0.0.1", svs.address().port());
+	cs.setKeepAlive(true);
+	HTTPRequest request("POST", "/echoBody", HTTPMessage::HTTP_1_1);
+	request.setContentType("text/plain");
+	request.setChunkedTransferEncoding(true);
+	for (int i = 0; i < 5; ++i)
+	{
+		std::string body(1000*(i + 1), 'x');
+		cs.sendRequest(request) << body;
+		HTTPResponse response;
+		std::string rbody;
+		cs.receiveResponse(response) >> rbody;
+		assertTrue (response.getChunkedTransferEncoding());
+		assertTrue (response.getKeepAlive());
+		assertTrue (rbody == body);
+	}
+	assertTrue (srv.totalConnections() == 1);
+	assertTrue (waitFor(srv, 1) == 1);
+}
+
+
+void HTTPReactorServerTest::testMaxKeepAlive()
+{
+	ServerSocket svs(0);
+	HTTPServerParams* pParams = new HTTPServerParams;
+	pParams->setKeepAlive(true);
+	pParams->setMaxKeepAliveRequests(4);
+	HTTPReactorServer srv(new RequestHandlerFactory, svs, pParams);
+	srv.start();
+
+	HTTPClientSession cs("127.0.0.1", svs.address().port());
+	cs.setKeepAlive(true);
+	HTTPRequest request("POST", "/echoBody", HTTPMessage::HTTP_1_1);
+	request.setContentType("text/plain");
+	request.setChunkedTransferEncoding(true);
+	std::string body(5000, 'x');
+	for (int i = 0; i < 3; ++i)
+	{
+		cs.sendRequest(request) << body;
+		HTTPResponse response;
+		std::string rbody;
+		cs.receiveResponse(response) >> rbody;
+		assertTrue (response.getKeepAlive());
+		assertTrue (rbody == body);
+	}
+
+	{
+		cs.sendRequest(request) << body;
+		HTTPResponse response;
+		std::string rbody;
+		cs.receiveResponse(response) >> rbody;
+		assertTrue (!response.getKeepAlive());
+		assertTrue (rbody == body);
+	}
+	assertTrue (srv.totalConnections() == 1);
+}
+
+
+void HTTPReactorServerTest::testKeepAliveTimeout()
+{
+	ServerSocket svs(0);
+	HTTPServerParams* pParams = new HTTPServerParams;
+	pParams->setKeepAlive(true);
+	pParams->setKeepAliveTimeout(Poco::Timespan(1, 0));
+	HTTPReactorServer srv(new RequestHandlerFactory, svs, pParams);
+	srv.start();
+
+	HTTPClientSession cs("127.0.0.1", svs.address().port());
+	cs.setKeepAlive(true);
+	HTTPRequest request("GET", "/uri/1", HTTPMessage::HTTP_1_1);
+	cs.sendRequest(request);
+	HTTPResponse response;
+	std::string rbody;
+	cs.receiveResponse(response) >> rbody;
+	assertTrue (response.getKeepAlive());
+	assertTrue (rbody == "/uri/1");
+	assertTrue (waitFor(srv, 1) == 1);
+
+	Poco::Thread::sleep(1500);
+	assertTrue (srv.idleConnections() == 0);
+	assertTrue (srv.currentConnections() == 0);
+
+	// the server has closed the connection
+	char c;
+	assertTrue (cs.socket().receiveBytes(&c, 1) == 0);
+}
+
+
+void HTTPReactorServerTest::testPipelinedRequests()
+{
+	ServerSocket svs(0);
+	HTTPServerParams* pParams = new HTTPServerParams;
+	pParams->setKeepAlive(true);
+	HTTPReactorServer srv(new RequestHandlerFactory, svs, pParams);
+	srv.start();
+
+	StreamSocket ss;
+	ss.connect(SocketAddress("127.0.0.1", svs.address().port()));
+	std::string requests(
+		"GET /uri/1 HTTP/1.1\r\nHost: localhost\r\n\r\n"
+		"GET /uri/2 HTTP/1.1\r\nHost: localhost\r\n\r\n"
+		"GET /uri/3 HTTP/1.1\r\nHost: loc");
+	ss.sendBytes(requests.data(), (int) requests.size());
+	Poco::Thread::sleep(200);
+	std::string rest("alhost\r\n\r\n");
+	ss.sendBytes(rest.data(), (int) rest.size());
+
+	std::string responses;
+	char buffer[1024];
+	while (responses.find("/uri/3") == std::string::npos)
+	{
+		int n = ss.receiveBytes(buffer, sizeof(buffer));
+		if (n <= 0) break;
+		responses.append(buffer, n);
+	}
+	std::string::size_type pos1 = responses.find("\r\n\r\n/uri/1");
+	std::string::size_type pos2 = responses.find("\r\n\r\n/uri/2");
+	std::string::size_type pos3 = responses.find("\r\n\r\n/uri/3");
+	assertTrue (pos1 != std::string::npos);
+	assertTrue (pos2 != std::string::npos);
+	assertTrue (pos3 != std::string::npos);
+	assertTrue (pos1 < pos2 && pos2 < pos3);
+}
+
+
+void HTTPReactorServerTest::testIdleConnections()
+{
+	ServerSocket svs(0);
+	HTTPServerParams* pParams = new HTTPServerParams;
+	pParams->setKeepAlive(true);
+	pParams->setMaxThreads(2);
+	HTTPReactorServer srv(new RequestHandlerFactory, svs, pParams);
+	srv.start();
+
+	// more persistent connections than worker threads
+	const int n = 50;
+	std::vector<std::shared_ptr<HTTPClientSession>> sessions;
+	for (int i = 0; i < n; i++)
+	{
+		std::shared_ptr<HTTPClientSession> pSession(new HTTPClientSession("127.0.0.1", svs.address().port()));
+		pSession->setKeepAlive(true);
+		sessions.push_back(pSession);
+	}
+	for (int round = 0; round < 2; round++)
+	{
+		for (int i = 0; i < n; i++)
+		{
+			HTTPRequest request("GET", "/uri/" + std::to_string(i), HTTPMessage::HTTP_1_1);
+			sessions[i]->sendRequest(request);
+			HTTPResponse response;
+			std::string rbody;
+			sessions[i]->receiveResponse(response) >> rbody;
+			assertTrue (response.getKeepAlive());
+			assertTrue (rbody == "/uri/" + std::to_string(i));
+		}
+	}
+	assertTrue (srv.totalConnections() == n);
+	assertTrue (srv.currentConnections() == n);
+	assertTrue (waitFor(srv, n) == n);
+	assertTrue (srv.currentThreads() == 2);
+
+	srv.stop();
+	assertTrue (srv.currentConnections() == 0);
+}
+
+
+void HTTPReactorServerTest::testNotImpl()
+{
+	ServerSocket svs(0);
+	HTTPServerParams* pParams = new HTTPServerParams;
+	pParams->setKeepAlive(false);
+	HTTPReactorServer srv(new RequestHandlerFactory, svs, pParams);
+	srv.start();
+
+	HTTPClientSession cs("127.0.0.1", svs.address().port());
+	HTTPRequest request("GET", "/notImpl");
+	cs.sendRequest(request);
+	HTTPResponse response;
+	std::string rbody;
+	cs.receiveResponse(response) >> rbody;
+	assertTrue (response.getStatus() == HTTPResponse::HTTP_NOT_IMPLEMENTED);
+	assertTrue (rbody.empty());
+}
+
+
+void HTTPReactorServerTest::setUp()
+{
+}
+
+
+void HTTPReactorServerTest::tearDown()
+{
+}
+
+
+CppUnit::Test* HTTPReactorServerTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("HTTPReactorServerTest");
+
+	CppUnit_addTest(pSuite, HTTPReactorServerTest, testIdentityRequest);
+	CppUnit_addTest(pSuite, HTTPReactorServerTest, testChunkedRequestKeepAlive);
+	CppUnit_addTest(pSuite, HTTPReactorServerTest, testMaxKeepAlive);
+	CppUnit_addTest(pSuite, HTTPReactorServerTest, testKeepAliveTimeout);
+	CppUnit_addTest(pSuite, HTTPReactorServerTest, testPipelinedRequests);
+	CppUnit_addTest(pSuite, HTTPReactorServerTest, testIdleConnections);
+	CppUnit_addTest(pSuite, HTTPReactorServerTest, testNotImpl);
+
+	return pSuite;
+}
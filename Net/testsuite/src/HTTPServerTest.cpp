@@ -22,6 +22,9 @@
 #include "Poco/Net/HTTPServerResponse.h"
 #include "Poco/Net/ServerSocket.h"
 #include "Poco/StreamCopier.h"
+#include "Poco/TemporaryFile.h"
+#include "Poco/FileStream.h"
+#include "Poco/NumberParser.h"
 #include <sstream>
 
 
@@ -38,10 +41,64 @@ using Poco::Net::HTTPServerResponse;
 using Poco::Net::HTTPMessage;
 using Poco::Net::ServerSocket;
 using Poco::StreamCopier;
+using Poco::TemporaryFile;
+using Poco::FileOutputStream;
+using Poco::NumberParser;
 
 
 namespace
 {
+	class StringServerResponse: public HTTPServerResponse
+		/// A minimal HTTPServerResponse that only implements the
+		/// pure virtual functions, writing everything to a string.
+	{
+	public:
+		StringServerResponse(): _sent(false)
+		{
+		}
+
+		void sendContinue()
+		{
+		}
+
+		std::ostream& send()
+		{
+			_sent = true;
+			write(_ostr);
+			return _ostr;
+		}
+
+		void sendFile(const std::string&, const std::string&)
+		{
+		}
+
+		void sendBuffer(const void*, std::size_t)
+		{
+		}
+
+		void redirect(const std::string&, HTTPStatus)
+		{
+		}
+
+		void requireAuthentication(const std::string&)
+		{
+		}
+
+		bool sent() const
+		{
+			return _sent;
+		}
+
+		std::string str() const
+		{
+			return _ostr.str();
+		}
+
+	private:
+		std::ostringstream _ostr;
+		bool _sent;
+	};
+
 	class EchoBodyRequestHandler: public HTTPRequestHandler
 	{
 	public:
@@ -104,6 +161,48 @@ namespace
 		}
 	};
 	
+	class FileRequestHandler: public HTTPRequestHandler
+	{
+	public:
+		FileRequestHandler(const std::string& path):
+			_path(path)
+		{
+		}
+
+		void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+		{
+			const std::string& range = request.get("Range", "");
+			if (range.compare(0, 6, "bytes=") == 0)
+			{
+				std::string::size_type pos = range.find('-');
+				Poco::UInt64 first = NumberParser::parseUnsigned64(range.substr(6, pos - 6));
+				Poco::UInt64 last = NumberParser::parseUnsigned64(range.substr(pos + 1));
+				response.sendFile(_path, "application/octet-stream", first, last - first + 1);
+			}
+			else response.sendFile(_path, "application/octet-stream");
+		}
+
+	private:
+		std::string _path;
+	};
+
+	class FileRequestHandlerFactory: public HTTPRequestHandlerFactory
+	{
+	public:
+		FileRequestHandlerFactory(const std::string& path):
+			_path(path)
+		{
+		}
+
+		HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request)
+		{
+			return new FileRequestHandler(_path);
+		}
+
+	private:
+		std::string _path;
+	};
+	
 	class RequestHandlerFactory: public HTTPRequestHandlerFactory
 	{
 	public:
@@ -516,6 +615,130 @@ void HTTPServerTest::testBuffer()
 }
 
 
+void HTTPServerTest::testFile()
+{
+	TemporaryFile tempFile;
+	std::string data;
+	for (int i = 0; i < 100000; i++) data += static_cast<char>('a' + i % 26);
+	{
+		FileOutputStream ostr(tempFile.path());
+		ostr << data;
+	}
+
+	ServerSocket svs(0);
+	HTTPServerParams* pParams = new HTTPServerParams;
+	HTTPServer srv(new FileRequestHandlerFactory(tempFile.path()), svs, pParams);
+	srv.start();
+
+	HTTPClientSession cs("127.0.0.1", svs.address().port());
+	cs.setKeepAlive(true);
+	HTTPRequest request("GET", "/file", HTTPMessage::HTTP_1_1);
+	cs.sendRequest(request);
+	HTTPResponse response;
+	std::istream& rs = cs.receiveResponse(response);
+	std::ostringstream ostr;
+	StreamCopier::copyStream(rs, ostr);
+	assertTrue (response.getStatus() == HTTPResponse::HTTP_OK);
+	assertTrue (response.getContentLength() == data.size());
+	assertTrue (response.has("Last-Modified"));
+	assertTrue (ostr.str() == data);
+
+	HTTPRequest headRequest("HEAD", "/file", HTTPMessage::HTTP_1_1);
+	cs.sendRequest(headRequest);
+	cs.receiveResponse(response);
+	assertTrue (response.getStatus() == HTTPResponse::HTTP_OK);
+	assertTrue (response.getContentLength() == data.size());
+
+	HTTPRequest getRequest("GET", "/file", HTTPMessage::HTTP_1_1);
+	cs.sendRequest(getRequest);
+	std::istream& rs2 = cs.receiveResponse(response);
+	std::ostringstream ostr2;
+	StreamCopier::copyStream(rs2, ostr2);
+	assertTrue (ostr2.str() == data);
+}
+
+
+void HTTPServerTest::testFileRange()
+{
+	TemporaryFile tempFile;
+	std::string data;
+	for (int i = 0; i < 100000; i++) data += static_cast<char>('a' + i % 26);
+	{
+		FileOutputStream ostr(tempFile.path());
+		ostr << data;
+	}
+
+	ServerSocket svs(0);
+	HTTPServerParams* pParams = new HTTPServerParams;
+	HTTPServer srv(new FileRequestHandlerFactory(tempFile.path()), svs, pParams);
+	srv.start();
+
+	HTTPClientSession cs("127.0.0.1", svs.address().port());
+	cs.setKeepAlive(true);
+	HTTPRequest request("GET", "/file", HTTPMessage::HTTP_1_1);
+	request.set("Range", "bytes=1000-50999");
+	cs.sendRequest(request);
+	HTTPResponse response;
+	std::istream& rs = cs.receiveResponse(response);
+	std::ostringstream ostr;
+	StreamCopier::copyStream(rs, ostr);
+	assertTrue (response.getStatus() == HTTPResponse::HTTP_PARTIAL_CONTENT);
+	assertTrue (response.get("Content-Range") == "bytes 1000-50999/100000");
+	assertTrue (response.getContentLength() == 50000);
+	assertTrue (ostr.str() == data.substr(1000, 50000));
+
+	HTTPRequest request2("GET", "/file", HTTPMessage::HTTP_1_1);
+	request2.set("Range", "bytes=99999-99999");
+	cs.sendRequest(request2);
+	std::istream& rs2 = cs.receiveResponse(response);
+	std::ostringstream ostr2;
+	StreamCopier::copyStream(rs2, ostr2);
+	assertTrue (response.getStatus() == HTTPResponse::HTTP_PARTIAL_CONTENT);
+	assertTrue (ostr2.str() == data.substr(99999));
+
+	HTTPRequest request3("GET", "/file", HTTPMessage::HTTP_1_1);
+	request3.set("Range", "bytes=99999-100000");
+	cs.sendRequest(request3);
+	cs.receiveResponse(response);
+	assertTrue (response.getStatus() == HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
+}
+
+
+void HTTPServerTest::testFileRangeDefault()
+{
+	TemporaryFile tempFile;
+	std::string data;
+	for (int i = 0; i < 20000; i++) data += static_cast<char>('a' + i % 26);
+	{
+		FileOutputStream ostr(tempFile.path());
+		ostr << data;
+	}
+
+	StringServerResponse response;
+	HTTPServerResponse& base = response;
+	base.sendFile(tempFile.path(), "text/plain", 1000, 10000);
+	assertTrue (response.sent());
+	assertTrue (response.getStatus() == HTTPResponse::HTTP_PARTIAL_CONTENT);
+	assertTrue (response.get("Content-Range") == "bytes 1000-10999/20000");
+	assertTrue (response.getContentLength() == 10000);
+	std::string out = response.str();
+	std::string::size_type pos = out.find("\r\n\r\n");
+	assertTrue (pos != std::string::npos);
+	assertTrue (out.substr(pos + 4) == data.substr(1000, 10000));
+
+	StringServerResponse response2;
+	try
+	{
+		response2.HTTPServerResponse::sendFile(tempFile.path(), "text/plain", 19999, 2);
+		fail("invalid range - must throw");
+	}
+	catch (Poco::RangeException&)
+	{
+	}
+	assertTrue (!response2.sent());
+}
+
+
 void HTTPServerTest::setUp()
 {
 }
@@ -544,6 +767,9 @@ CppUnit::Test* HTTPServerTest::suite()
 	CppUnit_addTest(pSuite, HTTPServerTest, testAuth);
 	CppUnit_addTest(pSuite, HTTPServerTest, testNotImpl);
 	CppUnit_addTest(pSuite, HTTPServerTest, testBuffer);
+	CppUnit_addTest(pSuite, HTTPServerTest, testFile);
+	CppUnit_addTest(pSuite, HTTPServerTest, testFileRange);
+	CppUnit_addTest(pSuite, HTTPServerTest, testFileRangeDefault);
 
 	return pSuite;
 }
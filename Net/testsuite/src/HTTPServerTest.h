@@ -38,6 +38,9 @@ public:
 	void testAuth();
 	void testNotImpl();
 	void testBuffer();
+	void testFile();
+	void testFileRange();
+	void testFileRangeDefault();
 
 	void setUp();
 	void tearDown();
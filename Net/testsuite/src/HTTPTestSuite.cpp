@@ -11,6 +11,7 @@
 #include "HTTPTestSuite.h"
 #include "HTTPRequestTest.h"
 #include "HTTPResponseTest.h"
+#include "HTTPHeaderParserTest.h"
 #include "HTTPCookieTest.h"
 #include "HTTPCredentialsTest.h"
 #include "NTLMCredentialsTest.h"
@@ -22,6 +23,7 @@ CppUnit::Test* HTTPTestSuite::suite()
 
 	pSuite->addTest(HTTPRequestTest::suite());
 	pSuite->addTest(HTTPResponseTest::suite());
+	pSuite->addTest(HTTPHeaderParserTest::suite());
 	pSuite->addTest(HTTPCookieTest::suite());
 	pSuite->addTest(HTTPCredentialsTest::suite());
 	pSuite->addTest(NTLMCredentialsTest::suite());
@@ -106,6 +106,63 @@ void NameValueCollectionTest::testNameValueCollection()
 }
 
 
+void NameValueCollectionTest::testOrder()
+{
+	NameValueCollection nvc;
+	nvc.add("Host", "localhost");
+	nvc.add("Accept", "text/html");
+	nvc.add("Cookie", "a=1");
+	nvc.add("Connection", "close");
+	nvc.add("cookie", "b=2");
+	std::string name("Accept");
+	std::string value("text/plain");
+	nvc.add(std::move(name), std::move(value));
+
+	assertTrue (nvc.size() == 6);
+	NameValueCollection::ConstIterator it = nvc.begin();
+	assertTrue (it->first == "Host");
+	++it;
+	assertTrue (it->first == "Accept" && it->second == "text/html");
+	++it;
+	assertTrue (it->first == "Accept" && it->second == "text/plain");
+	++it;
+	assertTrue (it->first == "Cookie" && it->second == "a=1");
+	++it;
+	assertTrue (it->first == "cookie" && it->second == "b=2");
+	++it;
+	assertTrue (it->first == "Connection");
+	++it;
+	assertTrue (it == nvc.end());
+
+	nvc.erase("COOKIE");
+	assertTrue (nvc.size() == 4);
+	assertTrue (!nvc.has("Cookie"));
+	assertTrue (nvc.get("connection") == "close");
+
+	nvc.set("accept", "*/*");
+	assertTrue (nvc.size() == 4);
+	assertTrue (nvc.get("Accept") == "*/*");
+
+	NameValueCollection nvc2(nvc);
+	assertTrue (nvc2.get("HOST") == "localhost");
+	NameValueCollection nvc3;
+	nvc3 = std::move(nvc2);
+	assertTrue (nvc3.get("Host") == "localhost");
+	nvc3.swap(nvc);
+	assertTrue (nvc3.size() == 4);
+	assertTrue (nvc3.get("Connection") == "close");
+}
+
+
+void NameValueCollectionTest::testHash()
+{
+	assertTrue (NameValueCollection::hash("Content-Length") == NameValueCollection::hash("content-length"));
+	assertTrue (NameValueCollection::hash("CONTENT-LENGTH") == NameValueCollection::hash("Content-Length"));
+	assertTrue (NameValueCollection::hash("Content-Length") != NameValueCollection::hash("Content-Type"));
+	assertTrue (NameValueCollection::hash("") != NameValueCollection::hash("a"));
+}
+
+
 void NameValueCollectionTest::setUp()
 {
 }
@@ -121,6 +178,8 @@ CppUnit::Test* NameValueCollectionTest::suite()
 	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("NameValueCollectionTest");
 
 	CppUnit_addTest(pSuite, NameValueCollectionTest, testNameValueCollection);
+	CppUnit_addTest(pSuite, NameValueCollectionTest, testOrder);
+	CppUnit_addTest(pSuite, NameValueCollectionTest, testHash);
 
 	return pSuite;
 }
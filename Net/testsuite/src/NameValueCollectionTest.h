@@ -25,6 +25,8 @@ public:
 	~NameValueCollectionTest();
 
 	void testNameValueCollection();
+	void testOrder();
+	void testHash();
 
 	void setUp();
 	void tearDown();
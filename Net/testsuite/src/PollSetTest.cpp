@@ -18,6 +18,7 @@
 #include "Poco/Net/NetException.h"
 #include "Poco/Net/PollSet.h"
 #include "Poco/Stopwatch.h"
+#include "Poco/Thread.h"
 
 
 using Poco::Net::Socket;
@@ -28,6 +29,7 @@ using Poco::Net::ConnectionRefusedException;
 using Poco::Net::PollSet;
 using Poco::Timespan;
 using Poco::Stopwatch;
+using Poco::Thread;
 
 
 PollSetTest::PollSetTest(const std::string& name): CppUnit::TestCase(name)
@@ -125,6 +127,254 @@ void PollSetTest::testPoll()
 }
 
 
+void PollSetTest::testPollLevelTriggered()
+{
+	EchoServer echoServer;
+	StreamSocket ss;
+	ss.connect(SocketAddress("127.0.0.1", echoServer.port()));
+
+	PollSet ps;
+	ps.add(ss, PollSet::POLL_READ);
+	ss.sendBytes("hello", 5);
+
+	// socket remains readable as long as data is available
+	Timespan timeout(1000000);
+	for (int i = 0; i < 3; i++)
+	{
+		PollSet::SocketModeMap sm = ps.poll(timeout);
+		assertTrue (sm.size() == 1);
+		assertTrue (sm.find(ss) != sm.end());
+		assertTrue (sm.find(ss)->second == PollSet::POLL_READ);
+	}
+
+	char buffer[256];
+	int n = ss.receiveBytes(buffer, sizeof(buffer));
+	assertTrue (n == 5);
+	assertTrue (ps.poll(Timespan(100000)).empty());
+
+	ps.update(ss, PollSet::POLL_READ | PollSet::POLL_WRITE);
+	for (int i = 0; i < 3; i++)
+	{
+		PollSet::SocketModeMap sm = ps.poll(timeout);
+		assertTrue (sm.find(ss) != sm.end());
+		assertTrue (sm.find(ss)->second == PollSet::POLL_WRITE);
+	}
+
+	ps.remove(ss);
+	assertTrue (ps.empty());
+	ps.add(ss, PollSet::POLL_WRITE);
+	PollSet::SocketModeMap sm = ps.poll(timeout);
+	assertTrue (sm.find(ss) != sm.end());
+	assertTrue (sm.find(ss)->second == PollSet::POLL_WRITE);
+
+	ps.clear();
+	assertTrue (ps.empty());
+	assertTrue (ps.poll(Timespan(100000)).empty());
+	ss.close();
+}
+
+
+void PollSetTest::testPollList()
+{
+	EchoServer echoServer1;
+	EchoServer echoServer2;
+	StreamSocket ss1;
+	StreamSocket ss2;
+
+	ss1.connect(SocketAddress("127.0.0.1", echoServer1.port()));
+	ss2.connect(SocketAddress("127.0.0.1", echoServer2.port()));
+
+	PollSet ps;
+	ps.add(ss1, PollSet::POLL_READ);
+	ps.add(ss2, PollSet::POLL_READ);
+
+	PollSet::SocketModeList sl;
+	Timespan timeout(100000);
+	assertTrue (ps.poll(timeout, sl) == 0);
+	assertTrue (sl.empty());
+
+	ss1.sendBytes("hello", 5);
+	ss2.sendBytes("HELLO", 5);
+	Thread::sleep(100);
+
+	timeout = Timespan(1000000);
+	assertTrue (ps.poll(timeout, sl) == 2);
+	assertTrue (sl.size() == 2);
+	for (PollSet::SocketModeList::const_iterator it = sl.begin(); it != sl.end(); ++it)
+	{
+		assertTrue (it->first == ss1 || it->first == ss2);
+		assertTrue (it->second == PollSet::POLL_READ);
+	}
+
+	char buffer[256];
+	int n = ss1.receiveBytes(buffer, sizeof(buffer));
+	assertTrue (n == 5);
+	std::size_t capacity = sl.capacity();
+	assertTrue (ps.poll(timeout, sl) == 1);
+	assertTrue (sl[0].first == ss2);
+	assertTrue (sl[0].second == PollSet::POLL_READ);
+	assertTrue (sl.capacity() == capacity);
+
+	n = ss2.receiveBytes(buffer, sizeof(buffer));
+	assertTrue (n == 5);
+	assertTrue (ps.poll(Timespan(100000), sl) == 0);
+	assertTrue (sl.empty());
+
+	ss1.close();
+	ss2.close();
+}
+
+
+void PollSetTest::testPollEdgeTriggered()
+{
+#if defined(POCO_HAVE_FD_EPOLL)
+	EchoServer echoServer;
+	StreamSocket ss;
+	ss.connect(SocketAddress("127.0.0.1", echoServer.port()));
+
+	PollSet ps;
+	ps.add(ss, PollSet::POLL_READ | PollSet::POLL_EDGE_TRIGGERED);
+	ss.sendBytes("hello", 5);
+
+	Timespan timeout(1000000);
+	PollSet::SocketModeList sl;
+	assertTrue (ps.poll(timeout, sl) == 1);
+	assertTrue (sl[0].first == ss);
+	assertTrue (sl[0].second == PollSet::POLL_READ);
+
+	// not reported again until more data arrives
+	assertTrue (ps.poll(Timespan(100000), sl) == 0);
+
+	ss.sendBytes("HELLO", 5);
+	assertTrue (ps.poll(timeout, sl) == 1);
+	assertTrue (sl[0].first == ss);
+
+	char buffer[256];
+	int n = 0;
+	while (n < 10)
+	{
+		n += ss.receiveBytes(buffer + n, sizeof(buffer) - n);
+	}
+	assertTrue (std::string(buffer, n) == "helloHELLO");
+	ss.close();
+#endif
+}
+
+
+void PollSetTest::testPollOneShot()
+{
+	EchoServer echoServer;
+	StreamSocket ss;
+	ss.connect(SocketAddress("127.0.0.1", echoServer.port()));
+
+	PollSet ps;
+	ps.add(ss, PollSet::POLL_READ | PollSet::POLL_ONE_SHOT);
+	ss.sendBytes("hello", 5);
+
+	Timespan timeout(1000000);
+	PollSet::SocketModeList sl;
+	assertTrue (ps.poll(timeout, sl) == 1);
+	assertTrue (sl[0].first == ss);
+	assertTrue (sl[0].second == PollSet::POLL_READ);
+
+	// disabled, although still readable
+	assertTrue (ps.poll(Timespan(100000), sl) == 0);
+	assertTrue (ps.has(ss));
+
+	ps.update(ss, PollSet::POLL_READ | PollSet::POLL_ONE_SHOT);
+	assertTrue (ps.poll(timeout, sl) == 1);
+	assertTrue (sl[0].first == ss);
+	assertTrue (ps.poll(Timespan(100000), sl) == 0);
+
+	char buffer[256];
+	int n = ss.receiveBytes(buffer, sizeof(buffer));
+	assertTrue (n == 5);
+
+	ps.update(ss, PollSet::POLL_READ | PollSet::POLL_ONE_SHOT);
+	assertTrue (ps.poll(Timespan(100000), sl) == 0);
+	ss.sendBytes("HELLO", 5);
+	assertTrue (ps.poll(timeout, sl) == 1);
+	assertTrue (sl[0].first == ss);
+
+	ps.remove(ss);
+	assertTrue (ps.empty());
+	ss.close();
+}
+
+
+void PollSetTest::testWakeUp()
+{
+	EchoServer echoServer;
+	StreamSocket ss;
+	ss.connect(SocketAddress("127.0.0.1", echoServer.port()));
+
+	PollSet ps;
+	ps.add(ss, PollSet::POLL_READ);
+
+	Thread thread;
+	thread.startFunc([&ps]()
+		{
+			Thread::sleep(100);
+			ps.wakeUp();
+		});
+	Stopwatch sw;
+	sw.start();
+	PollSet::SocketModeList sl;
+	assertTrue (ps.poll(Timespan(10, 0), sl) == 0);
+	sw.stop();
+	assertTrue (sw.elapsed() < 5000000);
+	thread.join();
+
+	// a wake up without a waiting thread ends the next poll()
+	ps.wakeUp();
+	sw.restart();
+	assertTrue (ps.poll(Timespan(10, 0), sl) == 0);
+	sw.stop();
+	assertTrue (sw.elapsed() < 5000000);
+
+	ss.sendBytes("hello", 5);
+	assertTrue (ps.poll(Timespan(1, 0), sl) == 1);
+	assertTrue (sl[0].first == ss);
+
+	ps.remove(ss);
+	ss.close();
+}
+
+
+void PollSetTest::testClearWhilePolling()
+{
+	EchoServer echoServer;
+	StreamSocket ss;
+	ss.connect(SocketAddress("127.0.0.1", echoServer.port()));
+
+	PollSet ps;
+	ps.add(ss, PollSet::POLL_READ);
+
+	int n = -1;
+	Thread thread;
+	thread.startFunc([&ps, &n]()
+		{
+			PollSet::SocketModeList sl;
+			n = ps.poll(Timespan(10, 0), sl);
+		});
+	Thread::sleep(100);
+	ps.clear();
+	assertTrue (ps.empty());
+	ps.wakeUp();
+	assertTrue (thread.tryJoin(5000));
+	assertTrue (n == 0);
+
+	ps.add(ss, PollSet::POLL_READ);
+	ss.sendBytes("hello", 5);
+	PollSet::SocketModeList sl;
+	assertTrue (ps.poll(Timespan(1, 0), sl) == 1);
+	assertTrue (sl[0].first == ss);
+
+	ps.remove(ss);
+	ss.close();
+}
+
+
 void PollSetTest::setUp()
 {
 }
@@ -140,6 +390,12 @@ CppUnit::Test* PollSetTest::suite()
 	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("PollSetTest");
 
 	CppUnit_addTest(pSuite, PollSetTest, testPoll);
+	CppUnit_addTest(pSuite, PollSetTest, testPollLevelTriggered);
+	CppUnit_addTest(pSuite, PollSetTest, testPollList);
+	CppUnit_addTest(pSuite, PollSetTest, testPollEdgeTriggered);
+	CppUnit_addTest(pSuite, PollSetTest, testPollOneShot);
+	CppUnit_addTest(pSuite, PollSetTest, testWakeUp);
+	CppUnit_addTest(pSuite, PollSetTest, testClearWhilePolling);
 
 	return pSuite;
 }
@@ -25,6 +25,12 @@ public:
 	~PollSetTest();
 
 	void testPoll();
+	void testPollLevelTriggered();
+	void testPollList();
+	void testPollEdgeTriggered();
+	void testPollOneShot();
+	void testWakeUp();
+	void testClearWhilePolling();
 
 	void setUp();
 	void tearDown();
@@ -0,0 +1,202 @@
+//
+// ShardedTCPServerTest.cpp
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "ShardedTCPServerTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+#include "Poco/Net/ShardedTCPServer.h"
+#include "Poco/Net/TCPServerConnection.h"
+#include "Poco/Net/TCPServerConnectionFactory.h"
+#include "Poco/Net/TCPServerParams.h"
+#include "Poco/Net/StreamSocket.h"
+#include "Poco/Thread.h"
+#include <iostream>
+#include <vector>
+
+
+using Poco::Net::ShardedTCPServer;
+using Poco::Net::TCPServerConnectionFilter;
+using Poco::Net::TCPServerConnection;
+using Poco::Net::TCPServerConnectionFactoryImpl;
+using Poco::Net::TCPServerParams;
+using Poco::Net::StreamSocket;
+using Poco::Net::SocketAddress;
+using Poco::Thread;
+
+
+namespace
+{
+	class EchoConnection: public TCPServerConnection
+	{
+	public:
+		EchoConnection(const StreamSocket& s): TCPServerConnection(s)
+		{
+		}
+
+		void run()
+		{
+			StreamSocket& ss = socket();
+			try
+			{
+				char buffer[256];
+				int n = ss.receiveBytes(buffer, sizeof(buffer));
+				while (n > 0)
+				{
+					ss.sendBytes(buffer, n);
+					n = ss.receiveBytes(buffer, sizeof(buffer));
+				}
+			}
+			catch (Poco::Exception& exc)
+			{
+				std::cerr << "EchoConnection: " << exc.displayText() << std::endl;
+			}
+		}
+	};
+
+	class RejectFilter: public TCPServerConnectionFilter
+	{
+	public:
+		bool accept(const StreamSocket&)
+		{
+			return false;
+		}
+	};
+
+	bool echo(StreamSocket& ss)
+	{
+		std::string data("hello, world");
+		ss.sendBytes(data.data(), (int) data.size());
+		char buffer[256];
+		int n = ss.receiveBytes(buffer, sizeof(buffer));
+		return n > 0 && std::string(buffer, n) == data;
+	}
+}
+
+
+ShardedTCPServerTest::ShardedTCPServerTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+ShardedTCPServerTest::~ShardedTCPServerTest()
+{
+}
+
+
+void ShardedTCPServerTest::testShards()
+{
+	ShardedTCPServer srv(new TCPServerConnectionFactoryImpl<EchoConnection>(), SocketAddress("127.0.0.1", 0), 4);
+	assertTrue (srv.shards() == 4);
+	assertTrue (srv.port() != 0);
+	for (int i = 0; i < srv.shards(); i++)
+	{
+		assertTrue (srv.shard(i).port() == srv.port());
+		assertTrue (srv.shard(i).maxThreads() == ShardedTCPServer::DEFAULT_MAX_THREADS);
+	}
+	assertTrue (srv.maxThreads() == 4*ShardedTCPServer::DEFAULT_MAX_THREADS);
+
+	ShardedTCPServer srvDefault(new TCPServerConnectionFactoryImpl<EchoConnection>());
+	assertTrue (srvDefault.shards() >= 1);
+}
+
+
+void ShardedTCPServerTest::testConnections()
+{
+	// The kernel decides which shard accepts a connection, so
+	// every shard must be able to serve all connections at once.
+	// Otherwise, a connection may be queued behind connections
+	// that are kept open, and echo() would never return.
+	TCPServerParams* pParams = new TCPServerParams;
+	pParams->setMaxThreads(20);
+	ShardedTCPServer srv(new TCPServerConnectionFactoryImpl<EchoConnection>(), SocketAddress("127.0.0.1", 0), 4, pParams);
+	srv.start();
+	assertTrue (srv.currentConnections() == 0);
+	assertTrue (srv.totalConnections() == 0);
+	assertTrue (srv.maxThreads() == 80);
+
+	SocketAddress sa("127.0.0.1", srv.port());
+	std::vector<StreamSocket> sockets;
+	for (int i = 0; i < 20; i++)
+	{
+		sockets.push_back(StreamSocket(sa));
+		assertTrue (echo(sockets.back()));
+	}
+	assertTrue (srv.totalConnections() == 20);
+	assertTrue (srv.currentConnections() == 20);
+	assertTrue (srv.queuedConnections() == 0);
+	assertTrue (srv.refusedConnections() == 0);
+
+	for (std::vector<StreamSocket>::iterator it = sockets.begin(); it != sockets.end(); ++it)
+	{
+		it->close();
+	}
+	Thread::sleep(1000);
+	assertTrue (srv.currentConnections() == 0);
+	srv.stop();
+}
+
+
+void ShardedTCPServerTest::testCPUAffinity()
+{
+	ShardedTCPServer srv(new TCPServerConnectionFactoryImpl<EchoConnection>(), SocketAddress("127.0.0.1", 0), 2);
+	assertTrue (!srv.getCPUAffinity());
+	srv.setCPUAffinity(true);
+	assertTrue (srv.getCPUAffinity());
+	srv.start();
+
+	SocketAddress sa("127.0.0.1", srv.port());
+	StreamSocket ss1(sa);
+	assertTrue (echo(ss1));
+	StreamSocket ss2(sa);
+	assertTrue (echo(ss2));
+	assertTrue (srv.totalConnections() == 2);
+}
+
+
+void ShardedTCPServerTest::testFilter()
+{
+	ShardedTCPServer srv(new TCPServerConnectionFactoryImpl<EchoConnection>(), SocketAddress("127.0.0.1", 0), 2);
+	srv.setConnectionFilter(new RejectFilter);
+	srv.start();
+
+	SocketAddress sa("127.0.0.1", srv.port());
+	for (int i = 0; i < 4; i++)
+	{
+		StreamSocket ss(sa);
+		char buffer[256];
+		int n = ss.receiveBytes(buffer, sizeof(buffer));
+		assertTrue (n == 0);
+	}
+	assertTrue (srv.currentConnections() == 0);
+	assertTrue (srv.totalConnections() == 0);
+}
+
+
+void ShardedTCPServerTest::setUp()
+{
+}
+
+
+void ShardedTCPServerTest::tearDown()
+{
+}
+
+
+CppUnit::Test* ShardedTCPServerTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("ShardedTCPServerTest");
+
+	CppUnit_addTest(pSuite, ShardedTCPServerTest, testShards);
+	CppUnit_addTest(pSuite, ShardedTCPServerTest, testConnections);
+	CppUnit_addTest(pSuite, ShardedTCPServerTest, testCPUAffinity);
+	CppUnit_addTest(pSuite, ShardedTCPServerTest, testFilter);
+
+	return pSuite;
+}
@@ -0,0 +1,41 @@
+//
+// ShardedTCPServerTest.h
+//
+// Definition of the ShardedTCPServerTest class.
+//
+// Copyright (c) 2005-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef ShardedTCPServerTest_INCLUDED
+#define ShardedTCPServerTest_INCLUDED
+
+
+#include "Poco/Net/Net.h"
+#include "CppUnit/TestCase.h"
+
+
+class ShardedTCPServerTest: public CppUnit::TestCase
+{
+public:
+	ShardedTCPServerTest(const std::string& name);
+	~ShardedTCPServerTest();
+
+	void testShards();
+	void testConnections();
+	void testCPUAffinity();
+	void testFilter();
+
+	void setUp();
+	void tearDown();
+
+	static CppUnit::Test* suite();
+
+private:
+};
+
+
+#endif // ShardedTCPServerTest_INCLUDED
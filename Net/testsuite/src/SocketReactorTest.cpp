@@ -16,19 +16,28 @@
 #include "Poco/Net/SocketConnector.h"
 #include "Poco/Net/SocketAcceptor.h"
 #include "Poco/Net/ParallelSocketAcceptor.h"
+#include "Poco/Net/SocketReactorBalancer.h"
 #include "Poco/Net/StreamSocket.h"
 #include "Poco/Net/ServerSocket.h"
 #include "Poco/Net/SocketAddress.h"
 #include "Poco/Observer.h"
 #include "Poco/Exception.h"
 #include "Poco/Thread.h"
+#include "Poco/Event.h"
+#include "Poco/Stopwatch.h"
 #include <sstream>
+#include <atomic>
 
 
 using Poco::Net::SocketReactor;
 using Poco::Net::SocketConnector;
 using Poco::Net::SocketAcceptor;
 using Poco::Net::ParallelSocketAcceptor;
+using Poco::Net::SocketReactorBalancer;
+using Poco::Net::RoundRobinBalancer;
+using Poco::Net::LeastConnectionsBalancer;
+using Poco::Net::LeastLoadBalancer;
+using Poco::Net::PeerHashBalancer;
 using Poco::Net::StreamSocket;
 using Poco::Net::ServerSocket;
 using Poco::Net::SocketAddress;
@@ -40,6 +49,8 @@ using Poco::Net::ShutdownNotification;
 using Poco::Observer;
 using Poco::IllegalStateException;
 using Poco::Thread;
+using Poco::Event;
+using Poco::Stopwatch;
 
 
 namespace
@@ -375,6 +386,62 @@ namespace
 	};
 
 	DataServiceHandler::Data DataServiceHandler::_data;
+
+	class OneShotServiceHandler
+	{
+	public:
+		OneShotServiceHandler(const StreamSocket& socket, SocketReactor& reactor):
+			_socket(socket),
+			_reactor(reactor),
+			_busy(false)
+		{
+			_reactor.addEventHandler(_socket, Observer<OneShotServiceHandler, ReadableNotification>(*this, &OneShotServiceHandler::onReadable));
+		}
+
+		void onReadable(ReadableNotification* pNf)
+		{
+			if (_busy.exchange(true)) _concurrent = true;
+			// give other reactor threads a chance to dispatch the socket again
+			if (_delay > 0) Thread::sleep(_delay);
+			// the notification must still refer to this handler's socket
+			if (!(pNf->socket() == _socket)) _wrongSocket = true;
+			pNf->release();
+			char buffer[8];
+			int n = _socket.receiveBytes(buffer, sizeof(buffer));
+			_busy = false;
+			if (n > 0)
+			{
+				_socket.sendBytes(buffer, n);
+			}
+			else
+			{
+				_reactor.removeEventHandler(_socket, Observer<OneShotServiceHandler, ReadableNotification>(*this, &OneShotServiceHandler::onReadable));
+				delete this;
+			}
+		}
+
+		static std::atomic<bool> _concurrent;
+		static std::atomic<bool> _wrongSocket;
+		static int _delay;
+
+	private:
+		StreamSocket      _socket;
+		SocketReactor&    _reactor;
+		std::atomic<bool> _busy;
+	};
+
+	std::atomic<bool> OneShotServiceHandler::_concurrent(false);
+	std::atomic<bool> OneShotServiceHandler::_wrongSocket(false);
+	int OneShotServiceHandler::_delay(5);
+
+	class NullHandler
+	{
+	public:
+		void onReadable(ReadableNotification* pNf)
+		{
+			pNf->release();
+		}
+	};
 }
 
 
@@ -570,6 +637,390 @@ void SocketReactorTest::testDataCollection()
 }
 
 
+void SocketReactorTest::testOneShot()
+{
+	SocketAddress ssa;
+	ServerSocket ss(ssa);
+	SocketReactor reactor;
+	reactor.setOneShot(true);
+	assertTrue (reactor.getOneShot());
+	assertTrue (!reactor.getEdgeTriggered());
+	SocketAcceptor<OneShotServiceHandler> acceptor(ss, reactor);
+	OneShotServiceHandler::_concurrent = false;
+
+	// several threads share the sockets of one reactor
+	Thread threads[4];
+	for (int i = 0; i < 4; i++) threads[i].start(reactor);
+
+	SocketAddress sa("127.0.0.1", ss.address().port());
+	StreamSocket sock1(sa);
+	StreamSocket sock2(sa);
+	std::string data(64, 'x');
+	sock1.sendBytes(data.data(), (int) data.size());
+	sock2.sendBytes(data.data(), (int) data.size());
+	char buffer[64];
+	int n = 0;
+	while (n < 64) n += sock1.receiveBytes(buffer + n, sizeof(buffer) - n);
+	assertTrue (std::string(buffer, n) == data);
+	n = 0;
+	while (n < 64) n += sock2.receiveBytes(buffer + n, sizeof(buffer) - n);
+	assertTrue (std::string(buffer, n) == data);
+	sock1.close();
+	sock2.close();
+
+	reactor.stop();
+	for (int i = 0; i < 4; i++) threads[i].join();
+	assertTrue (!OneShotServiceHandler::_concurrent);
+}
+
+
+void SocketReactorTest::testOneShotSocket()
+{
+	SocketAddress ssa;
+	ServerSocket ss(ssa);
+	SocketReactor reactor;
+	reactor.setOneShot(true);
+	SocketAcceptor<OneShotServiceHandler> acceptor(ss, reactor);
+	OneShotServiceHandler::_wrongSocket = false;
+
+	Thread threads[4];
+	for (int i = 0; i < 4; i++) threads[i].start(reactor);
+
+	// keep several sockets ready at the same time, so that
+	// the reactor threads dispatch them concurrently
+	SocketAddress sa("127.0.0.1", ss.address().port());
+	const int socketCount = 8;
+	StreamSocket socks[socketCount];
+	for (int i = 0; i < socketCount; i++) socks[i].connect(sa);
+	for (int round = 0; round < 16; round++)
+	{
+		for (int i = 0; i < socketCount; i++) socks[i].sendBytes("x", 1);
+		for (int i = 0; i < socketCount; i++)
+		{
+			char c = 0;
+			assertTrue (socks[i].receiveBytes(&c, 1) == 1);
+			assertTrue (c == 'x');
+		}
+	}
+	for (int i = 0; i < socketCount; i++) socks[i].close();
+
+	reactor.stop();
+	for (int i = 0; i < 4; i++) threads[i].join();
+	assertTrue (!OneShotServiceHandler::_wrongSocket);
+}
+
+
+void SocketReactorTest::testOneShotMany()
+{
+	SocketAddress ssa;
+	ServerSocket ss(ssa);
+	SocketReactor reactor;
+	reactor.setOneShot(true);
+	SocketAcceptor<OneShotServiceHandler> acceptor(ss, reactor);
+	OneShotServiceHandler::_concurrent = false;
+	OneShotServiceHandler::_wrongSocket = false;
+	OneShotServiceHandler::_delay = 0;
+
+	Thread threads[4];
+	for (int i = 0; i < 4; i++) threads[i].start(reactor);
+
+	// Many sockets become ready at the same time. An event lost
+	// by the PollSet is never re-armed, and the client would
+	// time out waiting for its echo.
+	SocketAddress sa("127.0.0.1", ss.address().port());
+	const int socketCount = 64;
+	StreamSocket socks[socketCount];
+	for (int i = 0; i < socketCount; i++)
+	{
+		socks[i].connect(sa);
+		socks[i].setReceiveTimeout(Poco::Timespan(10, 0));
+	}
+	for (int round = 0; round < 200; round++)
+	{
+		for (int i = 0; i < socketCount; i++) socks[i].sendBytes("x", 1);
+		for (int i = 0; i < socketCount; i++)
+		{
+			char c = 0;
+			assertTrue (socks[i].receiveBytes(&c, 1) == 1);
+			assertTrue (c == 'x');
+		}
+	}
+	for (int i = 0; i < socketCount; i++) socks[i].close();
+
+	reactor.stop();
+	for (int i = 0; i < 4; i++) threads[i].join();
+	OneShotServiceHandler::_delay = 5;
+	assertTrue (!OneShotServiceHandler::_concurrent);
+	assertTrue (!OneShotServiceHandler::_wrongSocket);
+}
+
+
+void SocketReactorTest::testBalancer()
+{
+	SocketAddress ssa;
+	ServerSocket ss(ssa);
+	SocketAddress sa("127.0.0.1", ss.address().port());
+	StreamSocket sock1(sa);
+	StreamSocket sock2(sa);
+	StreamSocket sock3(sa);
+
+	SocketReactor reactor1;
+	SocketReactor reactor2;
+	SocketReactor reactor3;
+	NullHandler handler;
+	Observer<NullHandler, ReadableNotification> observer(handler, &NullHandler::onReadable);
+	reactor1.addEventHandler(sock1, observer);
+	reactor1.addEventHandler(sock2, observer);
+	reactor3.addEventHandler(sock3, observer);
+	assertTrue (reactor1.socketCount() == 2);
+	assertTrue (reactor2.socketCount() == 0);
+	assertTrue (reactor3.socketCount() == 1);
+	assertTrue (reactor1.load() == 0);
+
+	SocketReactorBalancer::ReactorVec reactors;
+	reactors.push_back(&reactor1);
+	reactors.push_back(&reactor2);
+	reactors.push_back(&reactor3);
+
+	RoundRobinBalancer roundRobin;
+	assertTrue (roundRobin.select(reactors, sock1) == 0);
+	assertTrue (roundRobin.select(reactors, sock1) == 1);
+	assertTrue (roundRobin.select(reactors, sock1) == 2);
+	assertTrue (roundRobin.select(reactors, sock1) == 0);
+
+	LeastConnectionsBalancer leastConnections;
+	assertTrue (leastConnections.select(reactors, sock1) == 1);
+	reactor2.addEventHandler(sock1, observer);
+	reactor2.addEventHandler(sock3, observer);
+	assertTrue (leastConnections.select(reactors, sock1) == 2);
+
+	// all reactors are idle, so the number of sockets decides
+	LeastLoadBalancer leastLoad;
+	assertTrue (leastLoad.select(reactors, sock1) == 2);
+
+	PeerHashBalancer peerHash;
+	std::size_t index = peerHash.select(reactors, sock1);
+	assertTrue (index < reactors.size());
+	assertTrue (peerHash.select(reactors, sock2) == index);
+	assertTrue (peerHash.select(reactors, sock3) == index);
+
+	reactor1.removeEventHandler(sock1, observer);
+	reactor1.removeEventHandler(sock2, observer);
+	reactor2.removeEventHandler(sock1, observer);
+	reactor2.removeEventHandler(sock3, observer);
+	reactor3.removeEventHandler(sock3, observer);
+	assertTrue (reactor1.socketCount() == 0);
+}
+
+
+void SocketReactorTest::testParallelSocketReactorBalancer()
+{
+	SocketAddress ssa;
+	ServerSocket ss(ssa);
+	SocketReactor reactor;
+	ParallelSocketAcceptor<EchoServiceHandler, SocketReactor> acceptor(ss, reactor);
+	acceptor.setBalancer(new LeastConnectionsBalancer);
+	assertTrue (!acceptor.getBalancer().isNull());
+	SocketAddress sa("127.0.0.1", ss.address().port());
+	SocketConnector<ClientServiceHandler> connector1(sa, reactor);
+	SocketConnector<ClientServiceHandler> connector2(sa, reactor);
+	SocketConnector<ClientServiceHandler> connector3(sa, reactor);
+	SocketConnector<ClientServiceHandler> connector4(sa, reactor);
+	SocketConnector<ClientServiceHandler> connector5(sa, reactor);
+	SocketConnector<ClientServiceHandler> connector6(sa, reactor);
+	SocketConnector<ClientServiceHandler> connector7(sa, reactor);
+	SocketConnector<ClientServiceHandler> connector8(sa, reactor);
+	ClientServiceHandler::setOnce(false);
+	ClientServiceHandler::resetData();
+	reactor.run();
+	std::string data(ClientServiceHandler::data());
+	assertTrue (data.size() == 8192);
+	assertTrue (!ClientServiceHandler::readableError());
+	assertTrue (!ClientServiceHandler::writableError());
+	assertTrue (!ClientServiceHandler::timeoutError());
+}
+
+
+void SocketReactorTest::testTimer()
+{
+	SocketReactor reactor;
+	Thread thread;
+	std::atomic<int> periodic(0);
+	std::atomic<bool> onReactorThread(false);
+	std::atomic<bool> cancelledFired(false);
+	Event oneShotDone;
+
+	SocketReactor::TimerId oneShot = reactor.addTimer(Poco::Timespan(0, 20000), [&]()
+		{
+			onReactorThread = Thread::current() == &thread;
+			oneShotDone.set();
+		});
+	SocketReactor::TimerId repeat = reactor.addTimer(Poco::Timespan(0, 10000), [&]()
+		{
+			++periodic;
+		}, Poco::Timespan(0, 10000));
+	SocketReactor::TimerId cancelled = reactor.addTimer(Poco::Timespan(0, 10000), [&]()
+		{
+			cancelledFired = true;
+		});
+	assertTrue (oneShot != 0 && repeat != 0 && cancelled != 0);
+	assertTrue (reactor.timerCount() == 3);
+	assertTrue (reactor.cancelTimer(cancelled));
+	assertTrue (!reactor.cancelTimer(cancelled));
+	assertTrue (reactor.timerCount() == 2);
+
+	thread.start(reactor);
+	oneShotDone.wait(5000);
+	assertTrue (onReactorThread);
+	// the one-shot timer is removed after its callback has returned
+	while (reactor.timerCount() > 1) Thread::sleep(1);
+	assertTrue (!reactor.restartTimer(oneShot, Poco::Timespan(1, 0)));
+	while (periodic < 3) Thread::sleep(10);
+	assertTrue (reactor.timerCount() == 1);
+	assertTrue (reactor.cancelTimer(repeat));
+	assertTrue (reactor.timerCount() == 0);
+
+	reactor.stop();
+	thread.join();
+	assertTrue (!cancelledFired);
+}
+
+
+void SocketReactorTest::testTimerCancelExpired()
+{
+	SocketReactor reactor;
+	std::atomic<int> fired(0);
+	std::atomic<int> cancelled(0);
+	SocketReactor::TimerId first = 0;
+	SocketReactor::TimerId second = 0;
+
+	// each callback cancels the other timer, which
+	// has expired in the same tick and must not run
+	first = reactor.addTimer(Poco::Timespan(0, 10000), [&]()
+		{
+			++fired;
+			if (reactor.cancelTimer(second)) ++cancelled;
+		});
+	second = reactor.addTimer(Poco::Timespan(0, 10000), [&]()
+		{
+			++fired;
+			if (reactor.cancelTimer(first)) ++cancelled;
+		});
+	Thread::sleep(50);
+
+	Thread thread;
+	thread.start(reactor);
+	Stopwatch sw;
+	sw.start();
+	while (reactor.timerCount() > 0 && sw.elapsedSeconds() < 5) Thread::sleep(10);
+	reactor.stop();
+	thread.join();
+
+	assertTrue (reactor.timerCount() == 0);
+	assertTrue (fired == 1);
+	assertTrue (cancelled == 1);
+}
+
+
+void SocketReactorTest::testSocketTimer()
+{
+	SocketAddress ssa;
+	ServerSocket ss(ssa);
+	SocketAddress sa("127.0.0.1", ss.address().port());
+	StreamSocket sock(sa);
+
+	// The timer must wake up the reactor long before
+	// the global timeout expires.
+	SocketReactor reactor(Poco::Timespan(10, 0));
+	NullHandler handler;
+	Observer<NullHandler, ReadableNotification> observer(handler, &NullHandler::onReadable);
+	reactor.addEventHandler(sock, observer);
+
+	Event expired;
+	std::atomic<bool> idleFired(false);
+	Stopwatch sw;
+	sw.start();
+	reactor.addTimer(sock, Poco::Timespan(0, 50000), [&]()
+		{
+			expired.set();
+		});
+	SocketReactor::TimerId idle = reactor.addTimer(sock, Poco::Timespan(0, 50000), [&]()
+		{
+			idleFired = true;
+		});
+	Thread thread;
+	thread.start(reactor);
+	for (int i = 0; i < 5; i++)
+	{
+		Thread::sleep(20);
+		assertTrue (reactor.restartTimer(idle, Poco::Timespan(2, 0)));
+	}
+	expired.wait(5000);
+	sw.stop();
+	assertTrue (sw.elapsed() >= 50000);
+	assertTrue (sw.elapsed() < 5000000);
+	assertTrue (!idleFired);
+	assertTrue (reactor.timerCount() == 1);
+
+	reactor.removeEventHandler(sock, observer);
+	assertTrue (reactor.timerCount() == 0);
+
+	reactor.stop();
+	thread.join();
+	assertTrue (!idleFired);
+}
+
+
+void SocketReactorTest::testTimerWakeUp()
+{
+	SocketAddress ssa;
+	ServerSocket ss(ssa);
+	SocketAddress sa("127.0.0.1", ss.address().port());
+	StreamSocket sock(sa);
+
+	SocketReactor reactor(Poco::Timespan(10, 0));
+	NullHandler handler;
+	Observer<NullHandler, ReadableNotification> observer(handler, &NullHandler::onReadable);
+	reactor.addEventHandler(sock, observer);
+	Thread thread;
+	thread.start(reactor);
+	Thread::sleep(100);
+
+	// The reactor is now waiting for the global timeout,
+	// and must be woken up by the new timer.
+	Event expired;
+	Stopwatch sw;
+	sw.start();
+	reactor.addTimer(Poco::Timespan(0, 50000), [&]()
+		{
+			expired.set();
+		});
+	assertTrue (expired.tryWait(5000));
+	sw.stop();
+	assertTrue (sw.elapsed() >= 50000);
+	assertTrue (sw.elapsed() < 2000000);
+
+	// Restarting a timer with an earlier deadline
+	// must wake up the reactor as well.
+	Event restarted;
+	SocketReactor::TimerId id = reactor.addTimer(Poco::Timespan(5, 0), [&]()
+		{
+			restarted.set();
+		});
+	Thread::sleep(100);
+	sw.restart();
+	assertTrue (reactor.restartTimer(id, Poco::Timespan(0, 50000)));
+	assertTrue (restarted.tryWait(5000));
+	sw.stop();
+	assertTrue (sw.elapsed() < 2000000);
+
+	reactor.stop();
+	reactor.wakeUp();
+	thread.join();
+	reactor.removeEventHandler(sock, observer);
+}
+
+
 void SocketReactorTest::setUp()
 {
 	ClientServiceHandler::setCloseOnTimeout(false);
@@ -591,6 +1042,15 @@ CppUnit::Test* SocketReactorTest::suite()
 	CppUnit_addTest(pSuite, SocketReactorTest, testSocketConnectorFail);
 	CppUnit_addTest(pSuite, SocketReactorTest, testSocketConnectorTimeout);
 	CppUnit_addTest(pSuite, SocketReactorTest, testDataCollection);
+	CppUnit_addTest(pSuite, SocketReactorTest, testOneShot);
+	CppUnit_addTest(pSuite, SocketReactorTest, testOneShotSocket);
+	CppUnit_addTest(pSuite, SocketReactorTest, testOneShotMany);
+	CppUnit_addTest(pSuite, SocketReactorTest, testBalancer);
+	CppUnit_addTest(pSuite, SocketReactorTest, testParallelSocketReactorBalancer);
+	CppUnit_addTest(pSuite, SocketReactorTest, testTimer);
+	CppUnit_addTest(pSuite, SocketReactorTest, testTimerCancelExpired);
+	CppUnit_addTest(pSuite, SocketReactorTest, testSocketTimer);
+	CppUnit_addTest(pSuite, SocketReactorTest, testTimerWakeUp);
 
 	return pSuite;
 }
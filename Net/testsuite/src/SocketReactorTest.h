@@ -30,6 +30,15 @@ public:
 	void testSocketConnectorFail();
 	void testSocketConnectorTimeout();
 	void testDataCollection();
+	void testOneShot();
+	void testOneShotSocket();
+	void testOneShotMany();
+	void testBalancer();
+	void testParallelSocketReactorBalancer();
+	void testTimer();
+	void testTimerCancelExpired();
+	void testSocketTimer();
+	void testTimerWakeUp();
 
 	void setUp();
 	void tearDown();
@@ -22,6 +22,8 @@
 #include "Poco/FIFOBuffer.h"
 #include "Poco/Delegate.h"
 #include "Poco/File.h"
+#include "Poco/FileStream.h"
+#include "Poco/TemporaryFile.h"
 #include <iostream>
 
 
@@ -525,6 +527,45 @@ void SocketTest::testEchoUnixLocal()
 }
 
 
+void SocketTest::testSendFile()
+{
+	Poco::TemporaryFile tempFile;
+	std::string data;
+	for (int i = 0; i < 2000; i++) data += static_cast<char>('0' + i % 10);
+	{
+		Poco::FileOutputStream ostr(tempFile.path());
+		ostr << data;
+	}
+
+	EchoServer echoServer;
+	StreamSocket ss;
+	ss.connect(SocketAddress("127.0.0.1", echoServer.port()));
+	Poco::FileInputStream istr(tempFile.path());
+	Poco::Int64 n = ss.sendFile(istr, 100, 1000);
+	assertTrue (n == 1000);
+	std::string received;
+	char buffer[256];
+	while (received.size() < 1000)
+	{
+		int rc = ss.receiveBytes(buffer, sizeof(buffer));
+		assertTrue (rc > 0);
+		received.append(buffer, rc);
+	}
+	assertTrue (received == data.substr(100, 1000));
+
+	n = ss.sendFile(istr, 1990, 100);
+	assertTrue (n == 10);
+	received.clear();
+	while (received.size() < 10)
+	{
+		int rc = ss.receiveBytes(buffer, sizeof(buffer));
+		assertTrue (rc > 0);
+		received.append(buffer, rc);
+	}
+	assertTrue (received == data.substr(1990));
+	ss.close();
+}
+
 
 void SocketTest::onReadable(bool& b)
 {
@@ -575,6 +616,7 @@ CppUnit::Test* SocketTest::suite()
 	CppUnit_addTest(pSuite, SocketTest, testSelect2);
 	CppUnit_addTest(pSuite, SocketTest, testSelect3);
 	CppUnit_addTest(pSuite, SocketTest, testEchoUnixLocal);
+	CppUnit_addTest(pSuite, SocketTest, testSendFile);
 
 	return pSuite;
 }
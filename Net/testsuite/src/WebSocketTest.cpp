@@ -12,6 +12,9 @@
 #include "CppUnit/TestCaller.h"
 #include "CppUnit/TestSuite.h"
 #include "Poco/Net/WebSocket.h"
+#include "Poco/Net/WebSocketDeflate.h"
+#include "Poco/Net/WebSocketBroadcaster.h"
+#include "Poco/Net/SocketReactor.h"
 #include "Poco/Net/SocketStream.h"
 #include "Poco/Net/HTTPClientSession.h"
 #include "Poco/Net/HTTPServer.h"
@@ -23,7 +26,11 @@
 #include "Poco/Net/ServerSocket.h"
 #include "Poco/Net/NetException.h"
 #include "Poco/Thread.h"
+#include "Poco/Delegate.h"
+#include "Poco/Event.h"
+#include "Poco/SharedPtr.h"
 #include "Poco/Buffer.h"
+#include "Poco/FIFOBuffer.h"
 
 
 using Poco::Net::HTTPClientSession;
@@ -33,6 +40,8 @@ using Poco::Net::HTTPServerRequest;
 using Poco::Net::HTTPServerResponse;
 using Poco::Net::SocketStream;
 using Poco::Net::WebSocket;
+using Poco::Net::WebSocketDeflate;
+using Poco::Net::WebSocketBroadcaster;
 using Poco::Net::WebSocketException;
 
 
@@ -41,7 +50,7 @@ namespace
 	class WebSocketRequestHandler: public Poco::Net::HTTPRequestHandler
 	{
 	public:
-		WebSocketRequestHandler(std::size_t bufSize = 1024): _bufSize(bufSize)
+		WebSocketRequestHandler(std::size_t bufSize = 1024, bool deflate = false): _bufSize(bufSize), _deflate(deflate)
 		{
 		}
 
@@ -49,7 +58,7 @@ namespace
 		{
 			try
 			{
-				WebSocket ws(request, response);
+				WebSocket ws = _deflate ? WebSocket(request, response, WebSocketDeflate::Params()) : WebSocket(request, response);
 				Poco::Buffer<char> buffer(_bufSize);
 				int flags;
 				int n;
@@ -80,22 +89,120 @@ namespace
 
 	private:
 		std::size_t _bufSize;
+		bool _deflate;
 	};
 	
 	class WebSocketRequestHandlerFactory: public Poco::Net::HTTPRequestHandlerFactory
 	{
 	public:
-		WebSocketRequestHandlerFactory(std::size_t bufSize = 1024): _bufSize(bufSize)
+		WebSocketRequestHandlerFactory(std::size_t bufSize = 1024, bool deflate = false): _bufSize(bufSize), _deflate(deflate)
 		{
 		}
 
 		Poco::Net::HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request)
 		{
-			return new WebSocketRequestHandler(_bufSize);
+			return new WebSocketRequestHandler(_bufSize, _deflate);
 		}
 
 	private:
 		std::size_t _bufSize;
+		bool _deflate;
+	};
+
+	class SubscriberHolder
+		/// Makes the server-side WebSocket of a subscriber
+		/// available to the test.
+	{
+	public:
+		void set(const WebSocket& ws)
+		{
+			_pSocket = new WebSocket(ws);
+			_ready.set();
+		}
+
+		WebSocket get()
+		{
+			_ready.wait(5000);
+			return *_pSocket;
+		}
+
+	private:
+		Poco::SharedPtr<WebSocket> _pSocket;
+		Poco::Event _ready;
+	};
+
+	class BroadcastRequestHandler: public Poco::Net::HTTPRequestHandler
+	{
+	public:
+		BroadcastRequestHandler(WebSocketBroadcaster& broadcaster, SubscriberHolder* pHolder):
+			_broadcaster(broadcaster),
+			_pHolder(pHolder)
+		{
+		}
+
+		void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response)
+		{
+			WebSocketDeflate::Params params;
+			params.serverNoContextTakeover = true;
+			WebSocket ws(request, response, params);
+			_broadcaster.subscribe(ws);
+			if (_pHolder) _pHolder->set(ws);
+			try
+			{
+				char buffer[1024];
+				int flags;
+				int n;
+				do
+				{
+					n = ws.receiveFrame(buffer, sizeof(buffer), flags);
+					if ((flags & WebSocket::FRAME_OP_BITMASK) == WebSocket::FRAME_OP_PING)
+						_broadcaster.send(ws, buffer, n, WebSocket::FRAME_FLAG_FIN | WebSocket::FRAME_OP_PONG);
+				}
+				while (n > 0 && (flags & WebSocket::FRAME_OP_BITMASK) != WebSocket::FRAME_OP_CLOSE);
+			}
+			catch (Poco::Exception&)
+			{
+			}
+			_broadcaster.unsubscribe(ws);
+		}
+
+	private:
+		WebSocketBroadcaster& _broadcaster;
+		SubscriberHolder* _pHolder;
+	};
+
+	class BroadcastRequestHandlerFactory: public Poco::Net::HTTPRequestHandlerFactory
+	{
+	public:
+		BroadcastRequestHandlerFactory(WebSocketBroadcaster& broadcaster, SubscriberHolder* pHolder = 0):
+			_broadcaster(broadcaster),
+			_pHolder(pHolder)
+		{
+		}
+
+		Poco::Net::HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request)
+		{
+			return new BroadcastRequestHandler(_broadcaster, _pHolder);
+		}
+
+	private:
+		WebSocketBroadcaster& _broadcaster;
+		SubscriberHolder* _pHolder;
+	};
+
+	class DropCounter
+	{
+	public:
+		DropCounter(): dropped(0)
+		{
+		}
+
+		void onDropped(const void* pSender, WebSocket& ws)
+		{
+			++dropped;
+		}
+
+		int dropped;
 	};
 }
 
@@ -268,6 +375,495 @@ void WebSocketTest::testWebSocketLargeInOneFrame()
 }
 
 
+void WebSocketTest::testWebSocketFrameBuffers()
+{
+	const int msgSize = 70000;
+
+	Poco::Net::ServerSocket ss(0);
+	Poco::Net::HTTPServer server(new WebSocketRequestHandlerFactory(msgSize), ss, new Poco::Net::HTTPServerParams);
+	server.start();
+
+	Poco::Thread::sleep(200);
+
+	HTTPClientSession cs("127.0.0.1", ss.address().port());
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/ws", HTTPRequest::HTTP_1_1);
+	HTTPResponse response;
+	WebSocket ws(cs, request, response);
+
+	std::string payload;
+	for (int i = 0; i < msgSize + 32; i++) payload += static_cast<char>('a' + i % 26);
+
+	Poco::FIFOBuffer fifo(msgSize);
+	int flags;
+	const int sizes[] = {0, 1, 3, 7, 8, 15, 16, 17, 63, 64, 65, 125, 126, 127, 1000, 65535, 65536, msgSize};
+	for (std::size_t i = 0; i < sizeof(sizes)/sizeof(sizes[0]); i++)
+	{
+		// unaligned payloads
+		int size = sizes[i];
+		ws.sendFrame(payload.data() + i, size, WebSocket::FRAME_BINARY);
+		fifo.drain();
+		int n = ws.receiveFrame(fifo, flags);
+		assertTrue (n == size);
+		assertTrue (fifo.used() == size);
+		assertTrue (flags == WebSocket::FRAME_BINARY);
+		assertTrue (payload.compare(i, size, fifo.begin(), size) == 0);
+	}
+
+	try
+	{
+		fifo.drain();
+		fifo.advance(msgSize - 10);
+		ws.sendFrame(payload.data(), 11);
+		ws.receiveFrame(fifo, flags);
+		fail("insufficient space - must throw");
+	}
+	catch (WebSocketException& exc)
+	{
+		assertTrue (exc.code() == WebSocket::WS_ERR_PAYLOAD_TOO_BIG);
+	}
+
+	server.stop();
+}
+
+
+void WebSocketTest::testWebSocketFragments()
+{
+	Poco::Net::ServerSocket ss(0);
+	Poco::Net::HTTPServer server(new WebSocketRequestHandlerFactory(65536), ss, new Poco::Net::HTTPServerParams);
+	server.start();
+
+	Poco::Thread::sleep(200);
+
+	HTTPClientSession cs("127.0.0.1", ss.address().port());
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/ws", HTTPRequest::HTTP_1_1);
+	HTTPResponse response;
+	WebSocket ws(cs, request, response);
+
+	std::string payload;
+	for (int i = 0; i < 10000; i++) payload += static_cast<char>('0' + i % 10);
+
+	Poco::Buffer<char> buffer(0);
+	for (int round = 0; round < 2; round++)
+	{
+		const int fragments = 10;
+		const int fragmentSize = static_cast<int>(payload.size())/fragments;
+		for (int i = 0; i < fragments; i++)
+		{
+			int flags = (i == 0 ? WebSocket::FRAME_OP_TEXT : WebSocket::FRAME_OP_CONT) | (i == fragments - 1 ? WebSocket::FRAME_FLAG_FIN : 0);
+			ws.sendFrame(payload.data() + i*fragmentSize, fragmentSize, flags);
+		}
+
+		buffer.resize(0);
+		int flags;
+		do
+		{
+			int n = ws.receiveFrame(buffer, flags);
+			assertTrue (n == fragmentSize);
+		}
+		while ((flags & WebSocket::FRAME_FLAG_FIN) == 0);
+		assertTrue (buffer.size() == payload.size());
+		assertTrue (payload.compare(0, payload.size(), buffer.begin(), buffer.size()) == 0);
+		// exponential growth
+		assertTrue (buffer.capacity() < 4*payload.size());
+	}
+	ws.shutdown();
+
+	server.stop();
+}
+
+
+void WebSocketTest::testWebSocketDeflate()
+{
+	Poco::Net::ServerSocket ss(0);
+	Poco::Net::HTTPServer server(new WebSocketRequestHandlerFactory(65536, true), ss, new Poco::Net::HTTPServerParams);
+	server.start();
+
+	Poco::Thread::sleep(200);
+
+	HTTPClientSession cs("127.0.0.1", ss.address().port());
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/ws", HTTPRequest::HTTP_1_1);
+	HTTPResponse response;
+	WebSocketDeflate::Params params;
+	params.minCompressSize = 16;
+	WebSocket ws(cs, request, response, params);
+	assertTrue (ws.deflateEnabled());
+	assertTrue (response.get("Sec-WebSocket-Extensions") == "permessage-deflate");
+
+	std::string payload;
+	for (int i = 0; i < 500; i++)
+	{
+		payload += "{\"id\":";
+		payload += std::to_string(i);
+		payload += ",\"name\":\"instrument\",\"bid\":1.25,\"ask\":1.5},";
+	}
+	char buffer[65536];
+	int flags;
+	for (int i = 0; i < 3; i++)
+	{
+		ws.sendFrame(payload.data(), (int) payload.size());
+		int n = ws.receiveFrame(buffer, sizeof(buffer), flags);
+		assertTrue (n == payload.size());
+		assertTrue (payload.compare(0, payload.size(), buffer, n) == 0);
+		assertTrue (flags == WebSocket::FRAME_TEXT);
+
+		ws.sendFrame(payload.data(), (int) payload.size(), WebSocket::FRAME_BINARY);
+		Poco::Buffer<char> pocobuffer(0);
+		n = ws.receiveFrame(pocobuffer, flags);
+		assertTrue (n == payload.size());
+		assertTrue (payload.compare(0, payload.size(), pocobuffer.begin(), n) == 0);
+		assertTrue (flags == WebSocket::FRAME_BINARY);
+	}
+
+	// small, uncompressed message
+	std::string small("Hello");
+	ws.sendFrame(small.data(), (int) small.size());
+	int n = ws.receiveFrame(buffer, sizeof(buffer), flags);
+	assertTrue (n == small.size());
+	assertTrue (small.compare(0, small.size(), buffer, n) == 0);
+	assertTrue (flags == WebSocket::FRAME_TEXT);
+
+	// fragmented message, echoed frame by frame
+	std::string first = payload.substr(0, 1000);
+	std::string second = payload.substr(1000);
+	ws.sendFrame(first.data(), (int) first.size(), WebSocket::FRAME_OP_TEXT);
+	ws.sendFrame(second.data(), (int) second.size(), WebSocket::FRAME_FLAG_FIN | WebSocket::FRAME_OP_CONT);
+	n = ws.receiveFrame(buffer, sizeof(buffer), flags);
+	assertTrue (flags == WebSocket::FRAME_OP_TEXT);
+	int m = ws.receiveFrame(buffer + n, sizeof(buffer) - n, flags);
+	assertTrue (flags == (WebSocket::FRAME_FLAG_FIN | WebSocket::FRAME_OP_CONT));
+	assertTrue (n + m == payload.size());
+	assertTrue (payload.compare(0, payload.size(), buffer, n + m) == 0);
+
+	ws.shutdown();
+	n = ws.receiveFrame(buffer, sizeof(buffer), flags);
+	assertTrue (n == 2);
+	assertTrue ((flags & WebSocket::FRAME_OP_BITMASK) == WebSocket::FRAME_OP_CLOSE);
+
+	// client without extension
+	HTTPClientSession cs2("127.0.0.1", ss.address().port());
+	HTTPRequest request2(HTTPRequest::HTTP_GET, "/ws", HTTPRequest::HTTP_1_1);
+	WebSocket ws2(cs2, request2, response);
+	assertTrue (!ws2.deflateEnabled());
+	ws2.sendFrame(payload.data(), (int) payload.size());
+	n = ws2.receiveFrame(buffer, sizeof(buffer), flags);
+	assertTrue (n == payload.size());
+	assertTrue (payload.compare(0, payload.size(), buffer, n) == 0);
+	ws2.shutdown();
+	ws2.receiveFrame(buffer, sizeof(buffer), flags);
+
+	server.stop();
+}
+
+
+void WebSocketTest::testWebSocketDeflateNegotiation()
+{
+	WebSocketDeflate::Params params;
+	params.clientNoContextTakeover = true;
+	params.serverMaxWindowBits = 10;
+	std::string offer = WebSocketDeflate::createOffer(params);
+	assertTrue (offer == "permessage-deflate; client_no_context_takeover; server_max_window_bits=10; client_max_window_bits");
+
+	WebSocketDeflate::Params serverParams;
+	serverParams.clientMaxWindowBits = 12;
+	WebSocketDeflate::Params agreed;
+	std::string extensions;
+	assertTrue (WebSocketDeflate::negotiate("x-webkit-deflate-frame, " + offer, serverParams, agreed, extensions));
+	assertTrue (extensions == "permessage-deflate; client_no_context_takeover; server_max_window_bits=10; client_max_window_bits=12");
+	assertTrue (agreed.clientNoContextTakeover);
+	assertTrue (!agreed.serverNoContextTakeover);
+	assertTrue (agreed.serverMaxWindowBits == 10);
+	assertTrue (agreed.clientMaxWindowBits == 12);
+
+	WebSocketDeflate::Params clientAgreed;
+	assertTrue (WebSocketDeflate::accept(extensions, params, clientAgreed));
+	assertTrue (clientAgreed.clientNoContextTakeover);
+	assertTrue (clientAgreed.serverMaxWindowBits == 10);
+	assertTrue (clientAgreed.clientMaxWindowBits == 12);
+
+	// client_max_window_bits not offered: server must not restrict the client
+	assertTrue (WebSocketDeflate::negotiate("permessage-deflate", serverParams, agreed, extensions));
+	assertTrue (extensions == "permessage-deflate");
+	assertTrue (agreed.clientMaxWindowBits == 15);
+
+	// invalid offers are declined, the next one is accepted
+	assertTrue (!WebSocketDeflate::negotiate("permessage-deflate; server_max_window_bits=16", serverParams, agreed, extensions));
+	assertTrue (!WebSocketDeflate::negotiate("permessage-deflate; foo", serverParams, agreed, extensions));
+	assertTrue (!WebSocketDeflate::negotiate("permessage-deflate; server_max_window_bits=8", serverParams, agreed, extensions));
+	assertTrue (WebSocketDeflate::negotiate("permessage-deflate; server_max_window_bits=8, permessage-deflate", serverParams, agreed, extensions));
+	assertTrue (!WebSocketDeflate::negotiate("x-webkit-deflate-frame", serverParams, agreed, extensions));
+
+	assertTrue (!WebSocketDeflate::accept("", params, clientAgreed));
+	try
+	{
+		WebSocketDeflate::accept("permessage-deflate; server_max_window_bits=12", params, clientAgreed);
+		fail("server window larger than offered - must throw");
+	}
+	catch (WebSocketException& exc)
+	{
+		assertTrue (exc.code() == WebSocket::WS_ERR_HANDSHAKE_EXTENSION);
+	}
+	try
+	{
+		WebSocketDeflate::accept("x-webkit-deflate-frame", params, clientAgreed);
+		fail("extension not offered - must throw");
+	}
+	catch (WebSocketException& exc)
+	{
+		assertTrue (exc.code() == WebSocket::WS_ERR_HANDSHAKE_EXTENSION);
+	}
+}
+
+
+void WebSocketTest::testWebSocketDeflateStreams()
+{
+	std::string message;
+	for (int i = 0; i < 200; i++) message += "{\"type\":\"update\",\"value\":42}";
+
+	for (int takeover = 0; takeover < 2; takeover++)
+	{
+		WebSocketDeflate::Params params;
+		params.serverNoContextTakeover = takeover == 0;
+		params.serverMaxWindowBits = 9;
+		WebSocketDeflate server(params, true);
+		WebSocketDeflate client(params, false);
+
+		std::size_t firstSize = 0;
+		for (int i = 0; i < 3; i++)
+		{
+			Poco::Buffer<char> compressed(0);
+			assertTrue (server.deflate(message.data(), (int) message.size(), true, true, compressed));
+			assertTrue (compressed.size() < message.size()/10);
+			if (i == 0) firstSize = compressed.size();
+			else if (takeover) assertTrue (compressed.size() < firstSize);
+			else assertTrue (compressed.size() == firstSize);
+
+			Poco::Buffer<char> inflated(0);
+			client.inflate(compressed.begin(), (int) compressed.size(), true, inflated, message.size());
+			assertTrue (inflated.size() == message.size());
+			assertTrue (message.compare(0, message.size(), inflated.begin(), inflated.size()) == 0);
+		}
+
+		Poco::Buffer<char> compressed(0);
+		server.deflate(message.data(), (int) message.size(), true, true, compressed);
+		Poco::Buffer<char> inflated(0);
+		try
+		{
+			client.inflate(compressed.begin(), (int) compressed.size(), true, inflated, message.size() - 1);
+			fail("decompressed payload too big - must throw");
+		}
+		catch (WebSocketException& exc)
+		{
+			assertTrue (exc.code() == WebSocket::WS_ERR_PAYLOAD_TOO_BIG);
+		}
+	}
+
+	WebSocketDeflate::Params params;
+	WebSocketDeflate server(params, true);
+	Poco::Buffer<char> compressed(0);
+	assertTrue (server.deflate("", 0, true, true, compressed));
+	assertTrue (compressed.size() == 1 && compressed[0] == 0);
+
+	WebSocketDeflate client(params, false);
+	Poco::Buffer<char> inflated(0);
+	client.inflate(compressed.begin(), (int) compressed.size(), true, inflated, 0);
+	assertTrue (inflated.size() == 0);
+
+	try
+	{
+		client.inflate("\xff\xff\xff\xff", 4, true, inflated, 1024);
+		fail("invalid data - must throw");
+	}
+	catch (WebSocketException& exc)
+	{
+		assertTrue (exc.code() == WebSocket::WS_ERR_COMPRESSION);
+	}
+}
+
+
+void WebSocketTest::testWebSocketBroadcaster()
+{
+	Poco::Net::SocketReactor reactor(Poco::Timespan(0, 10000));
+	Poco::Thread reactorThread;
+	reactorThread.start(reactor);
+	WebSocketBroadcaster broadcaster(reactor);
+	WebSocketDeflate::Params compressionParams;
+	compressionParams.minCompressSize = 64;
+	broadcaster.enableCompression(compressionParams);
+
+	Poco::Net::ServerSocket ss(0);
+	Poco::Net::HTTPServer server(new BroadcastRequestHandlerFactory(broadcaster), ss, new Poco::Net::HTTPServerParams);
+	server.start();
+
+	Poco::Thread::sleep(200);
+
+	HTTPClientSession cs1("127.0.0.1", ss.address().port());
+	HTTPRequest request1(HTTPRequest::HTTP_GET, "/ws", HTTPRequest::HTTP_1_1);
+	HTTPResponse response1;
+	WebSocket ws1(cs1, request1, response1);
+
+	HTTPClientSession cs2("127.0.0.1", ss.address().port());
+	HTTPRequest request2(HTTPRequest::HTTP_GET, "/ws", HTTPRequest::HTTP_1_1);
+	HTTPResponse response2;
+	WebSocket ws2(cs2, request2, response2, WebSocketDeflate::Params());
+	assertTrue (ws2.deflateEnabled());
+
+	HTTPClientSession cs3("127.0.0.1", ss.address().port());
+	HTTPRequest request3(HTTPRequest::HTTP_GET, "/ws", HTTPRequest::HTTP_1_1);
+	HTTPResponse response3;
+	WebSocket ws3(cs3, request3, response3, WebSocketDeflate::Params());
+
+	for (int i = 0; i < 100 && broadcaster.subscribers() < 3; i++) Poco::Thread::sleep(20);
+	assertTrue (broadcaster.subscribers() == 3);
+
+	std::string message;
+	for (int i = 0; i < 1000; i++)
+	{
+		message += "{\"id\":";
+		message += std::to_string(i);
+		message += ",\"price\":100.25},";
+	}
+	const std::string small("hi");
+	WebSocket* sockets[] = {&ws1, &ws2, &ws3};
+	Poco::Buffer<char> buffer(0);
+	int flags;
+	for (int round = 0; round < 3; round++)
+	{
+		assertTrue (broadcaster.broadcast(message) == 3);
+		assertTrue (broadcaster.broadcast(small, WebSocket::FRAME_BINARY) == 3);
+		for (int i = 0; i < 3; i++)
+		{
+			buffer.resize(0);
+			int n = sockets[i]->receiveFrame(buffer, flags);
+			assertTrue (n == message.size());
+			assertTrue (flags == WebSocket::FRAME_TEXT);
+			assertTrue (message.compare(0, message.size(), buffer.begin(), n) == 0);
+
+			buffer.resize(0);
+			n = sockets[i]->receiveFrame(buffer, flags);
+			assertTrue (n == small.size());
+			assertTrue (flags == WebSocket::FRAME_BINARY);
+			assertTrue (small.compare(0, small.size(), buffer.begin(), n) == 0);
+		}
+	}
+
+	// frames sent to a single subscriber
+	ws2.sendFrame("ping", 4, WebSocket::FRAME_FLAG_FIN | WebSocket::FRAME_OP_PING);
+	buffer.resize(0);
+	int n = ws2.receiveFrame(buffer, flags);
+	assertTrue (n == 4);
+	assertTrue (flags == (WebSocket::FRAME_FLAG_FIN | WebSocket::FRAME_OP_PONG));
+
+	ws1.shutdown();
+	for (int i = 0; i < 100 && broadcaster.subscribers() > 2; i++) Poco::Thread::sleep(20);
+	assertTrue (broadcaster.subscribers() == 2);
+	assertTrue (broadcaster.broadcast(small) == 2);
+	buffer.resize(0);
+	n = ws3.receiveFrame(buffer, flags);
+	assertTrue (n == small.size());
+
+	ws2.shutdown();
+	ws3.shutdown();
+	for (int i = 0; i < 100 && broadcaster.subscribers() > 0; i++) Poco::Thread::sleep(20);
+	assertTrue (broadcaster.subscribers() == 0);
+
+	server.stop();
+	reactor.stop();
+	reactorThread.join();
+}
+
+
+void WebSocketTest::testWebSocketBroadcasterSlowConsumer()
+{
+	Poco::Net::SocketReactor reactor(Poco::Timespan(0, 10000));
+	Poco::Thread reactorThread;
+	reactorThread.start(reactor);
+	WebSocketBroadcaster broadcaster(reactor, 256*1024);
+	DropCounter counter;
+	broadcaster.subscriberDropped += Poco::delegate(&counter, &DropCounter::onDropped);
+
+	Poco::Net::ServerSocket ss(0);
+	Poco::Net::HTTPServer server(new BroadcastRequestHandlerFactory(broadcaster), ss, new Poco::Net::HTTPServerParams);
+	server.start();
+
+	Poco::Thread::sleep(200);
+
+	HTTPClientSession cs("127.0.0.1", ss.address().port());
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/ws", HTTPRequest::HTTP_1_1);
+	HTTPResponse response;
+	WebSocket ws(cs, request, response);
+	ws.setReceiveBufferSize(8192);
+
+	for (int i = 0; i < 100 && broadcaster.subscribers() < 1; i++) Poco::Thread::sleep(20);
+	assertTrue (broadcaster.subscribers() == 1);
+
+	// The client does not read, so its queue grows until it is dropped.
+	std::string message(64*1024, 'x');
+	int sent = 0;
+	while (broadcaster.broadcast(message) == 1 && sent < 10000) ++sent;
+	assertTrue (sent < 10000);
+	assertTrue (counter.dropped == 1);
+	assertTrue (broadcaster.subscribers() == 0);
+	assertTrue (broadcaster.broadcast(message) == 0);
+
+	broadcaster.subscriberDropped -= Poco::delegate(&counter, &DropCounter::onDropped);
+	server.stop();
+	reactor.stop();
+	reactorThread.join();
+}
+
+
+void WebSocketTest::testWebSocketBroadcasterUnsubscribePartial()
+{
+	Poco::Net::SocketReactor reactor(Poco::Timespan(0, 10000));
+	Poco::Thread reactorThread;
+	reactorThread.start(reactor);
+	WebSocketBroadcaster broadcaster(reactor);
+	SubscriberHolder holder;
+
+	Poco::Net::ServerSocket ss(0);
+	Poco::Net::HTTPServer server(new BroadcastRequestHandlerFactory(broadcaster, &holder), ss, new Poco::Net::HTTPServerParams);
+	server.start();
+
+	Poco::Thread::sleep(200);
+
+	HTTPClientSession cs("127.0.0.1", ss.address().port());
+	HTTPRequest request(HTTPRequest::HTTP_GET, "/ws", HTTPRequest::HTTP_1_1);
+	HTTPResponse response;
+	WebSocket ws(cs, request, response);
+	ws.setReceiveBufferSize(8192);
+	ws.setReceiveTimeout(Poco::Timespan(5, 0));
+	WebSocket subscriber = holder.get();
+	subscriber.setSendBufferSize(8192);
+
+	// The client does not read, so only a part of the frame can be written.
+	std::string message(4*1024*1024, 'x');
+	assertTrue (broadcaster.broadcast(message) == 1);
+	assertTrue (broadcaster.queuedBytes(subscriber) > 0);
+	assertTrue (broadcaster.unsubscribe(subscriber));
+
+	// The rest of the frame has been discarded, so the connection
+	// must have been shut down instead of being left open.
+	Poco::Buffer<char> buffer(0);
+	int flags;
+	try
+	{
+		int n = ws.receiveFrame(buffer, flags);
+		assertTrue (n == 0);
+	}
+	catch (Poco::TimeoutException&)
+	{
+		fail ("connection has not been shut down");
+	}
+	catch (WebSocketException&)
+	{
+	}
+
+	server.stop();
+	reactor.stop();
+	reactorThread.join();
+}
+
+
 void WebSocketTest::setUp()
 {
 }
@@ -285,6 +881,14 @@ CppUnit::Test* WebSocketTest::suite()
 	CppUnit_addTest(pSuite, WebSocketTest, testWebSocket);
 	CppUnit_addTest(pSuite, WebSocketTest, testWebSocketLarge);
 	CppUnit_addTest(pSuite, WebSocketTest, testWebSocketLargeInOneFrame);
+	CppUnit_addTest(pSuite, WebSocketTest, testWebSocketFrameBuffers);
+	CppUnit_addTest(pSuite, WebSocketTest, testWebSocketFragments);
+	CppUnit_addTest(pSuite, WebSocketTest, testWebSocketDeflate);
+	CppUnit_addTest(pSuite, WebSocketTest, testWebSocketDeflateNegotiation);
+	CppUnit_addTest(pSuite, WebSocketTest, testWebSocketDeflateStreams);
+	CppUnit_addTest(pSuite, WebSocketTest, testWebSocketBroadcaster);
+	CppUnit_addTest(pSuite, WebSocketTest, testWebSocketBroadcasterSlowConsumer);
+	CppUnit_addTest(pSuite, WebSocketTest, testWebSocketBroadcasterUnsubscribePartial);
 
 	return pSuite;
 }
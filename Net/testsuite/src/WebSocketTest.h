@@ -27,6 +27,14 @@ public:
 	void testWebSocket();
 	void testWebSocketLarge();
 	void testWebSocketLargeInOneFrame();
+	void testWebSocketFrameBuffers();
+	void testWebSocketFragments();
+	void testWebSocketDeflate();
+	void testWebSocketDeflateNegotiation();
+	void testWebSocketDeflateStreams();
+	void testWebSocketBroadcaster();
+	void testWebSocketBroadcasterSlowConsumer();
+	void testWebSocketBroadcasterUnsubscribePartial();
 
 	void setUp();
 	void tearDown();
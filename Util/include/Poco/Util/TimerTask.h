@@ -23,12 +23,17 @@
 #include "Poco/RefCountedObject.h"
 #include "Poco/AutoPtr.h"
 #include "Poco/Timestamp.h"
+#include <atomic>
 
 
 namespace Poco {
 namespace Util {
 
 
+class WheelTimer;
+class WheelTimerEntry;
+
+
 class Util_API TimerTask: public Poco::RefCountedObject, public Poco::Runnable
 	/// A task that can be scheduled for one-time or
 	/// repeated execution by a Timer.
@@ -50,6 +55,9 @@ public:
 		/// run again. If the task is running when this call occurs, the task
 		/// will run to completion, but will never run again.
 		///
+		/// If the task has been scheduled with a WheelTimer, it is
+		/// removed from the WheelTimer immediately.
+		///
 		/// Warning: A TimerTask that has been cancelled must not be scheduled again.
 		/// An attempt to do so results in a Poco::Util::IllegalStateException being thrown.
 
@@ -72,8 +80,11 @@ private:
 
 	Poco::Timestamp _lastExecution;
 	bool _isCancelled;
+	std::atomic<WheelTimer*> _pWheelTimer;
+	WheelTimerEntry* _pWheelEntry;
 
 	friend class TaskNotification;
+	friend class WheelTimer;
 };
 
 
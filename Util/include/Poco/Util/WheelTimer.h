@@ -0,0 +1,228 @@
+//
+// WheelTimer.h
+//
+// Library: Util
+// Package: Timer
+// Module:  WheelTimer
+//
+// Definition of the WheelTimer class.
+//
+// Copyright (c) 2009-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef Util_WheelTimer_INCLUDED
+#define Util_WheelTimer_INCLUDED
+
+
+#include "Poco/Util/Util.h"
+#include "Poco/Util/TimerTask.h"
+#include "Poco/TimingWheel.h"
+#include "Poco/Thread.h"
+#include "Poco/Runnable.h"
+#include "Poco/Mutex.h"
+#include "Poco/Event.h"
+#include "Poco/Clock.h"
+#include <vector>
+
+
+namespace Poco {
+namespace Util {
+
+
+class Util_API WheelTimer: protected Poco::Runnable
+	/// A WheelTimer allows to schedule tasks (TimerTask objects) for
+	/// future execution in a background thread, just like Timer.
+	///
+	/// Unlike Timer, which keeps scheduled tasks in a sorted queue,
+	/// a WheelTimer keeps them in a hierarchical timing wheel
+	/// (see Poco::TimingWheel) with a configurable resolution.
+	/// Scheduling and cancelling a task takes constant time,
+	/// and a cancelled task is removed from the WheelTimer
+	/// immediately. This makes the WheelTimer suitable for a large
+	/// number of timers that are frequently rescheduled or
+	/// cancelled and rarely fire, such as per-connection idle
+	/// timeouts.
+	///
+	/// The price for this is precision: tasks are executed up
+	/// to one tick (the resolution) after their scheduled time,
+	/// but never before.
+	///
+	/// A TimerTask can only be scheduled with one WheelTimer at
+	/// a time. Scheduling a task that has already been scheduled,
+	/// but not yet executed, changes its execution time and
+	/// interval. This can be used to implement idle timeouts, by
+	/// rescheduling a task whenever there is activity.
+	///
+	/// The WheelTimer object creates a thread that executes all
+	/// scheduled tasks sequentially. Therefore, tasks should complete
+	/// their work as quickly as possible, otherwise subsequent tasks
+	/// may be delayed.
+	///
+	/// WheelTimer is safe for multithreaded use - multiple threads
+	/// can schedule new tasks simultaneously.
+	///
+	/// A WheelTimer must not be destroyed while another thread calls
+	/// TimerTask::cancel() on one of its tasks.
+{
+public:
+	enum
+	{
+		DEFAULT_RESOLUTION = 10 /// Default resolution in milliseconds.
+	};
+
+	explicit WheelTimer(long resolution = DEFAULT_RESOLUTION);
+		/// Creates the WheelTimer, using the given resolution
+		/// (tick duration) in milliseconds.
+
+	WheelTimer(long resolution, Poco::Thread::Priority priority);
+		/// Creates the WheelTimer, using the given resolution
+		/// in milliseconds and a timer thread with the given
+		/// priority.
+
+	~WheelTimer();
+		/// Destroys the WheelTimer, cancelling all pending tasks.
+
+	void cancel(bool wait = false);
+		/// Cancels all pending tasks.
+		///
+		/// If a task is currently running, it is allowed to finish.
+		/// If wait is true, waits until the currently running
+		/// task (if any) has finished.
+
+	void schedule(TimerTask::Ptr pTask, Poco::Timestamp time);
+		/// Schedules a task for execution at the specified time.
+		///
+		/// If the time lies in the past, the task is executed
+		/// immediately.
+		///
+		/// Note: the relative time the task will be executed
+		/// won't change if the system's time changes. If the
+		/// given time is 10 seconds in the future at the point
+		/// schedule() is called, the task will be executed 10
+		/// seconds later, even if the system time changes in
+		/// between.
+
+	void schedule(TimerTask::Ptr pTask, Poco::Clock clock);
+		/// Schedules a task for execution at the specified time.
+		///
+		/// If the time lies in the past, the task is executed
+		/// immediately.
+
+	void schedule(TimerTask::Ptr pTask, long delay, long interval);
+		/// Schedules a task for periodic execution.
+		///
+		/// The task is first executed after the given delay.
+		/// Subsequently, the task is executed periodically with
+		/// the given interval in milliseconds between invocations.
+
+	void schedule(TimerTask::Ptr pTask, Poco::Timestamp time, long interval);
+		/// Schedules a task for periodic execution.
+		///
+		/// The task is first executed at the given time.
+		/// Subsequently, the task is executed periodically with
+		/// the given interval in milliseconds between invocations.
+
+	void schedule(TimerTask::Ptr pTask, Poco::Clock clock, long interval);
+		/// Schedules a task for periodic execution.
+		///
+		/// The task is first executed at the given time.
+		/// Subsequently, the task is executed periodically with
+		/// the given interval in milliseconds between invocations.
+
+	void scheduleAtFixedRate(TimerTask::Ptr pTask, long delay, long interval);
+		/// Schedules a task for periodic execution at a fixed rate.
+		///
+		/// The task is first executed after the given delay.
+		/// Subsequently, the task is executed periodically
+		/// every number of milliseconds specified by interval.
+		///
+		/// If task execution takes longer than the given interval,
+		/// further executions are delayed.
+
+	void scheduleAtFixedRate(TimerTask::Ptr pTask, Poco::Timestamp time, long interval);
+		/// Schedules a task for periodic execution at a fixed rate.
+		///
+		/// The task is first executed at the given time.
+		/// Subsequently, the task is executed periodically
+		/// every number of milliseconds specified by interval.
+		///
+		/// If task execution takes longer than the given interval,
+		/// further executions are delayed.
+
+	void scheduleAtFixedRate(TimerTask::Ptr pTask, Poco::Clock clock, long interval);
+		/// Schedules a task for periodic execution at a fixed rate.
+		///
+		/// The task is first executed at the given time.
+		/// Subsequently, the task is executed periodically
+		/// every number of milliseconds specified by interval.
+		///
+		/// If task execution takes longer than the given interval,
+		/// further executions are delayed.
+
+	long resolution() const;
+		/// Returns the resolution of the WheelTimer in milliseconds.
+
+	std::size_t size() const;
+		/// Returns the number of scheduled tasks.
+
+	template <typename Fn>
+	static TimerTask::Ptr func(const Fn& fn)
+		/// Helper function template to use a functor or lambda
+		/// with WheelTimer::schedule() and WheelTimer::scheduleAtFixedRate().
+	{
+		return new TimerFunc<Fn>(fn);
+	}
+
+	template <typename Fn>
+	static TimerTask::Ptr func(Fn&& fn)
+		/// Helper function template to use a functor or lambda
+		/// with WheelTimer::schedule() and WheelTimer::scheduleAtFixedRate().
+	{
+		return new TimerFunc<Fn>(std::move(fn));
+	}
+
+protected:
+	void run();
+	void scheduleTask(TimerTask::Ptr pTask, Poco::Clock clock, long interval, bool fixedRate);
+	void cancelTask(TimerTask& task);
+	void cancelAll(std::vector<TimerTask::Ptr>& tasks);
+	void release(WheelTimerEntry* pEntry);
+	static void validateTask(const TimerTask::Ptr& pTask);
+
+private:
+	WheelTimer(const WheelTimer&);
+	WheelTimer& operator = (const WheelTimer&);
+
+	typedef std::vector<WheelTimerEntry*> EntryVec;
+
+	long _resolution;
+	Poco::TimingWheel _wheel;
+	EntryVec _running;
+	Poco::Clock _nextWakeUp;
+	bool _stopped;
+	mutable Poco::FastMutex _mutex;
+	Poco::FastMutex _runMutex;
+	Poco::Event _wakeUp;
+	Poco::Thread _thread;
+
+	friend class TimerTask;
+};
+
+
+//
+// inlines
+//
+inline long WheelTimer::resolution() const
+{
+	return _resolution;
+}
+
+
+} } // namespace Poco::Util
+
+
+#endif // Util_WheelTimer_INCLUDED
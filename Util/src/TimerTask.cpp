@@ -13,6 +13,7 @@
 
 
 #include "Poco/Util/TimerTask.h"
+#include "Poco/Util/WheelTimer.h"
 
 
 namespace Poco {
@@ -21,7 +22,9 @@ namespace Util {
 
 TimerTask::TimerTask():
 	_lastExecution(0),
-	_isCancelled(false)
+	_isCancelled(false),
+	_pWheelTimer(0),
+	_pWheelEntry(0)
 {
 }
 
@@ -34,6 +37,8 @@ TimerTask::~TimerTask()
 void TimerTask::cancel()
 {
 	_isCancelled = true;
+	WheelTimer* pWheelTimer = _pWheelTimer.load();
+	if (pWheelTimer) pWheelTimer->cancelTask(*this);
 }
 
 
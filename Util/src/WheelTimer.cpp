@@ -0,0 +1,400 @@
+//
+// WheelTimer.cpp
+//
+// Library: Util
+// Package: Timer
+// Module:  WheelTimer
+//
+// Copyright (c) 2009-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "Poco/Util/WheelTimer.h"
+#include "Poco/ErrorHandler.h"
+#include "Poco/Exception.h"
+
+
+using Poco::ErrorHandler;
+
+
+namespace Poco {
+namespace Util {
+
+
+class WheelTimerEntry: public Poco::TimingWheel::Entry
+{
+public:
+	WheelTimerEntry(TimerTask::Ptr pTask):
+		pTask(pTask),
+		interval(0),
+		fixedRate(false),
+		running(false),
+		detached(false)
+	{
+	}
+
+	TimerTask::Ptr pTask;
+	long interval;
+	bool fixedRate;
+	bool running;
+	bool detached;
+	Poco::Clock nextExecution;
+};
+
+
+WheelTimer::WheelTimer(long resolution):
+	_resolution(resolution),
+	_wheel(static_cast<Poco::Clock::ClockDiff>(resolution)*1000),
+	_nextWakeUp(Poco::Clock::CLOCKVAL_MAX),
+	_stopped(false)
+{
+	_thread.start(*this);
+}
+
+
+WheelTimer::WheelTimer(long resolution, Poco::Thread::Priority priority):
+	_resolution(resolution),
+	_wheel(static_cast<Poco::Clock::ClockDiff>(resolution)*1000),
+	_nextWakeUp(Poco::Clock::CLOCKVAL_MAX),
+	_stopped(false)
+{
+	_thread.setPriority(priority);
+	_thread.start(*this);
+}
+
+
+WheelTimer::~WheelTimer()
+{
+	try
+	{
+		std::vector<TimerTask::Ptr> tasks;
+		{
+			Poco::FastMutex::ScopedLock lock(_mutex);
+			_stopped = true;
+			cancelAll(tasks);
+		}
+		_wakeUp.set();
+		_thread.join();
+		{
+			Poco::FastMutex::ScopedLock lock(_mutex);
+			cancelAll(tasks);
+		}
+	}
+	catch (...)
+	{
+		poco_unexpected();
+	}
+}
+
+
+void WheelTimer::cancel(bool wait)
+{
+	std::vector<TimerTask::Ptr> tasks;
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		cancelAll(tasks);
+	}
+	if (wait)
+	{
+		Poco::FastMutex::ScopedLock lock(_runMutex);
+	}
+}
+
+
+void WheelTimer::schedule(TimerTask::Ptr pTask, Poco::Timestamp time)
+{
+	schedule(pTask, time, 0);
+}
+
+
+void WheelTimer::schedule(TimerTask::Ptr pTask, Poco::Clock clock)
+{
+	scheduleTask(pTask, clock, 0, false);
+}
+
+
+void WheelTimer::schedule(TimerTask::Ptr pTask, long delay, long interval)
+{
+	Poco::Clock clock;
+	clock += static_cast<Poco::Clock::ClockDiff>(delay)*1000;
+	scheduleTask(pTask, clock, interval, false);
+}
+
+
+void WheelTimer::schedule(TimerTask::Ptr pTask, Poco::Timestamp time, long interval)
+{
+	Poco::Timestamp tsNow;
+	Poco::Clock clock;
+	Poco::Timestamp::TimeDiff diff = time - tsNow;
+	clock += diff;
+	scheduleTask(pTask, clock, interval, false);
+}
+
+
+void WheelTimer::schedule(TimerTask::Ptr pTask, Poco::Clock clock, long interval)
+{
+	scheduleTask(pTask, clock, interval, false);
+}
+
+
+void WheelTimer::scheduleAtFixedRate(TimerTask::Ptr pTask, long delay, long interval)
+{
+	Poco::Clock clock;
+	clock += static_cast<Poco::Clock::ClockDiff>(delay)*1000;
+	scheduleTask(pTask, clock, interval, true);
+}
+
+
+void WheelTimer::scheduleAtFixedRate(TimerTask::Ptr pTask, Poco::Timestamp time, long interval)
+{
+	Poco::Timestamp tsNow;
+	Poco::Clock clock;
+	Poco::Timestamp::TimeDiff diff = time - tsNow;
+	clock += diff;
+	scheduleTask(pTask, clock, interval, true);
+}
+
+
+void WheelTimer::scheduleAtFixedRate(TimerTask::Ptr pTask, Poco::Clock clock, long interval)
+{
+	scheduleTask(pTask, clock, interval, true);
+}
+
+
+std::size_t WheelTimer::size() const
+{
+	Poco::FastMutex::ScopedLock lock(_mutex);
+
+	return _wheel.size();
+}
+
+
+void WheelTimer::run()
+{
+	TimingWheel::EntryVec expired;
+	for (;;)
+	{
+		Poco::Clock::ClockDiff timeout = 0;
+		{
+			Poco::FastMutex::ScopedLock lock(_mutex);
+
+			if (_stopped) break;
+
+			Poco::Clock now;
+			expired.clear();
+			_wheel.advance(now, expired);
+			if (expired.empty())
+			{
+				timeout = _wheel.timeout(now);
+				if (timeout < 0)
+				{
+					_nextWakeUp = Poco::Clock(Poco::Clock::CLOCKVAL_MAX);
+				}
+				else
+				{
+					_nextWakeUp = now;
+					_nextWakeUp += timeout;
+				}
+			}
+			else
+			{
+				for (TimingWheel::EntryVec::iterator it = expired.begin(); it != expired.end(); ++it)
+				{
+					WheelTimerEntry* pEntry = static_cast<WheelTimerEntry*>(*it);
+					pEntry->running = true;
+					_running.push_back(pEntry);
+				}
+			}
+		}
+
+		if (_running.empty())
+		{
+			if (timeout < 0)
+			{
+				_wakeUp.wait();
+			}
+			else if (timeout > 0)
+			{
+				const Poco::Clock::ClockDiff MAX_WAIT = Poco::Clock::ClockDiff(8)*3600*1000;
+				Poco::Clock::ClockDiff ms = (timeout + 999)/1000;
+				if (ms > MAX_WAIT) ms = MAX_WAIT;
+				_wakeUp.tryWait(static_cast<long>(ms));
+			}
+			continue;
+		}
+
+		Poco::FastMutex::ScopedLock runLock(_runMutex);
+		for (std::size_t i = 0; i < _running.size(); i++)
+		{
+			TimerTask::Ptr pTask;
+			{
+				Poco::FastMutex::ScopedLock lock(_mutex);
+				WheelTimerEntry* pEntry = _running[i];
+				if (pEntry && !pEntry->detached) pTask = pEntry->pTask;
+			}
+			if (pTask && !pTask->isCancelled())
+			{
+				try
+				{
+					pTask->_lastExecution.update();
+					pTask->run();
+				}
+				catch (Exception& exc)
+				{
+					ErrorHandler::handle(exc);
+				}
+				catch (std::exception& exc)
+				{
+					ErrorHandler::handle(exc);
+				}
+				catch (...)
+				{
+					ErrorHandler::handle();
+				}
+			}
+
+			Poco::FastMutex::ScopedLock lock(_mutex);
+			WheelTimerEntry* pEntry = _running[i];
+			if (!pEntry) continue;
+			pEntry->running = false;
+			_running[i] = 0;
+			if (pEntry->detached)
+			{
+				delete pEntry;
+			}
+			else if (pTask->isCancelled() || _stopped)
+			{
+				_wheel.cancel(*pEntry);
+				release(pEntry);
+			}
+			else if (pEntry->isScheduled())
+			{
+				// The task has rescheduled itself while running.
+			}
+			else if (pEntry->interval > 0)
+			{
+				Poco::Clock now;
+				if (pEntry->fixedRate)
+				{
+					pEntry->nextExecution += static_cast<Poco::Clock::ClockDiff>(pEntry->interval)*1000;
+					if (pEntry->nextExecution < now) pEntry->nextExecution = now;
+				}
+				else
+				{
+					pEntry->nextExecution = now;
+					pEntry->nextExecution += static_cast<Poco::Clock::ClockDiff>(pEntry->interval)*1000;
+				}
+				_wheel.schedule(*pEntry, pEntry->nextExecution);
+			}
+			else
+			{
+				release(pEntry);
+			}
+		}
+		Poco::FastMutex::ScopedLock lock(_mutex);
+		_running.clear();
+	}
+}
+
+
+void WheelTimer::scheduleTask(TimerTask::Ptr pTask, Poco::Clock clock, long interval, bool fixedRate)
+{
+	validateTask(pTask);
+
+	bool wakeUp = false;
+	{
+		Poco::FastMutex::ScopedLock lock(_mutex);
+
+		WheelTimer* pOwner = pTask->_pWheelTimer.load();
+		if (pOwner && pOwner != this)
+			throw IllegalStateException("A TimerTask can only be scheduled with one WheelTimer at a time");
+
+		WheelTimerEntry* pEntry = pTask->_pWheelEntry;
+		if (!pEntry)
+		{
+			pEntry = new WheelTimerEntry(pTask);
+			pTask->_pWheelEntry = pEntry;
+			pTask->_pWheelTimer = this;
+		}
+		pEntry->interval = interval;
+		pEntry->fixedRate = fixedRate;
+		pEntry->nextExecution = clock;
+		_wheel.schedule(*pEntry, clock);
+
+		if (clock < _nextWakeUp)
+		{
+			_nextWakeUp = clock;
+			wakeUp = true;
+		}
+	}
+	if (wakeUp) _wakeUp.set();
+}
+
+
+void WheelTimer::cancelTask(TimerTask& task)
+{
+	TimerTask::Ptr pTask(&task, true);
+
+	Poco::FastMutex::ScopedLock lock(_mutex);
+
+	if (task._pWheelTimer.load() != this) return;
+
+	WheelTimerEntry* pEntry = task._pWheelEntry;
+	if (pEntry)
+	{
+		_wheel.cancel(*pEntry);
+		if (!pEntry->running) release(pEntry);
+	}
+}
+
+
+void WheelTimer::cancelAll(std::vector<TimerTask::Ptr>& tasks)
+{
+	TimingWheel::EntryVec entries;
+	_wheel.clear(entries);
+	for (TimingWheel::EntryVec::iterator it = entries.begin(); it != entries.end(); ++it)
+	{
+		WheelTimerEntry* pEntry = static_cast<WheelTimerEntry*>(*it);
+		if (!pEntry->running)
+		{
+			tasks.push_back(pEntry->pTask);
+			release(pEntry);
+		}
+	}
+	for (EntryVec::iterator it = _running.begin(); it != _running.end(); ++it)
+	{
+		WheelTimerEntry* pEntry = *it;
+		if (pEntry && !pEntry->detached)
+		{
+			tasks.push_back(pEntry->pTask);
+			pEntry->pTask->_pWheelEntry = 0;
+			pEntry->pTask->_pWheelTimer = 0;
+			pEntry->pTask = 0;
+			pEntry->detached = true;
+		}
+	}
+}
+
+
+void WheelTimer::release(WheelTimerEntry* pEntry)
+{
+	TimerTask::Ptr pTask = pEntry->pTask;
+	pTask->_pWheelEntry = 0;
+	pTask->_pWheelTimer = 0;
+	delete pEntry;
+}
+
+
+void WheelTimer::validateTask(const TimerTask::Ptr& pTask)
+{
+	if (pTask->isCancelled())
+	{
+		throw IllegalStateException("A cancelled task must not be rescheduled");
+	}
+}
+
+
+} } // namespace Poco::Util
@@ -0,0 +1,272 @@
+//
+// WheelTimerTest.cpp
+//
+// Copyright (c) 2009-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#include "WheelTimerTest.h"
+#include "CppUnit/TestCaller.h"
+#include "CppUnit/TestSuite.h"
+#include "Poco/Util/WheelTimer.h"
+#include "Poco/Util/TimerTaskAdapter.h"
+#include <vector>
+
+
+using Poco::Util::WheelTimer;
+using Poco::Util::TimerTask;
+using Poco::Util::TimerTaskAdapter;
+using Poco::Timestamp;
+using Poco::Clock;
+
+
+WheelTimerTest::WheelTimerTest(const std::string& name): CppUnit::TestCase(name)
+{
+}
+
+
+WheelTimerTest::~WheelTimerTest()
+{
+}
+
+
+void WheelTimerTest::testScheduleClock()
+{
+	WheelTimer timer;
+
+	// As reference
+	Timestamp time;
+	time += 500000;
+
+	Clock clock;
+	clock += 500000;
+
+	TimerTask::Ptr pTask = new TimerTaskAdapter<WheelTimerTest>(*this, &WheelTimerTest::onTimer);
+
+	assertTrue (pTask->lastExecution() == 0);
+
+	timer.schedule(pTask, clock);
+	assertTrue (timer.size() == 1);
+
+	_event.wait();
+	assertTrue (pTask->lastExecution() >= time);
+	assertTrue (timer.size() == 0);
+}
+
+
+void WheelTimerTest::testScheduleInterval()
+{
+	WheelTimer timer;
+
+	Timestamp time;
+
+	TimerTask::Ptr pTask = new TimerTaskAdapter<WheelTimerTest>(*this, &WheelTimerTest::onTimer);
+
+	timer.schedule(pTask, 500, 500);
+
+	_event.wait();
+	assertTrue (time.elapsed() >= 590000);
+	assertTrue (pTask->lastExecution().elapsed() < 130000);
+
+	_event.wait();
+	assertTrue (time.elapsed() >= 1190000);
+	assertTrue (pTask->lastExecution().elapsed() < 130000);
+
+	pTask->cancel();
+	assertTrue (pTask->isCancelled());
+	assertTrue (timer.size() == 0);
+}
+
+
+void WheelTimerTest::testScheduleAtFixedRate()
+{
+	WheelTimer timer;
+
+	Timestamp time;
+
+	TimerTask::Ptr pTask = new TimerTaskAdapter<WheelTimerTest>(*this, &WheelTimerTest::onTimer);
+
+	timer.scheduleAtFixedRate(pTask, 500, 500);
+
+	_event.wait();
+	assertTrue (time.elapsed() >= 500000);
+	assertTrue (pTask->lastExecution().elapsed() < 130000);
+
+	_event.wait();
+	assertTrue (time.elapsed() >= 1000000);
+	assertTrue (pTask->lastExecution().elapsed() < 130000);
+
+	_event.wait();
+	assertTrue (time.elapsed() >= 1500000);
+	assertTrue (pTask->lastExecution().elapsed() < 130000);
+
+	pTask->cancel();
+	assertTrue (pTask->isCancelled());
+}
+
+
+void WheelTimerTest::testReschedule()
+{
+	WheelTimer timer;
+
+	Timestamp time;
+
+	TimerTask::Ptr pTask = new TimerTaskAdapter<WheelTimerTest>(*this, &WheelTimerTest::onTimer);
+
+	// Rescheduling a pending task moves its deadline.
+	timer.schedule(pTask, 200, 0);
+	for (int i = 0; i < 5; i++)
+	{
+		Poco::Thread::sleep(100);
+		timer.schedule(pTask, 200, 0);
+	}
+	assertTrue (timer.size() == 1);
+	assertTrue (pTask->lastExecution() == 0);
+
+	_event.wait();
+	assertTrue (time.elapsed() >= 700000);
+	assertTrue (timer.size() == 0);
+}
+
+
+void WheelTimerTest::testCancel()
+{
+	WheelTimer timer;
+
+	TimerTask::Ptr pTask = new TimerTaskAdapter<WheelTimerTest>(*this, &WheelTimerTest::onTimer);
+
+	timer.scheduleAtFixedRate(pTask, 5000, 5000);
+	assertTrue (timer.size() == 1);
+
+	pTask->cancel();
+	assertTrue (pTask->isCancelled());
+	assertTrue (timer.size() == 0);
+
+	try
+	{
+		timer.scheduleAtFixedRate(pTask, 5000, 5000);
+		fail("must not reschedule a cancelled task");
+	}
+	catch (Poco::IllegalStateException&)
+	{
+	}
+	catch (Poco::Exception&)
+	{
+		fail("bad exception thrown");
+	}
+
+	TimerTask::Ptr pOther = new TimerTaskAdapter<WheelTimerTest>(*this, &WheelTimerTest::onTimer);
+	timer.schedule(pOther, 5000, 0);
+	WheelTimer otherTimer;
+	try
+	{
+		otherTimer.schedule(pOther, 5000, 0);
+		fail("must not schedule a task with two timers");
+	}
+	catch (Poco::IllegalStateException&)
+	{
+	}
+	assertTrue (timer.size() == 1);
+	assertTrue (otherTimer.size() == 0);
+}
+
+
+void WheelTimerTest::testCancelMany()
+{
+	WheelTimer timer;
+
+	const int n = 10000;
+	std::vector<TimerTask::Ptr> tasks;
+	for (int i = 0; i < n; i++)
+	{
+		TimerTask::Ptr pTask = new TimerTaskAdapter<WheelTimerTest>(*this, &WheelTimerTest::onTimer);
+		timer.schedule(pTask, 10000 + i, 0);
+		tasks.push_back(pTask);
+	}
+	assertTrue (timer.size() == n);
+
+	for (int i = 0; i < n; i += 2)
+	{
+		tasks[i]->cancel();
+	}
+	assertTrue (timer.size() == n/2);
+
+	timer.cancel(true);
+	assertTrue (timer.size() == 0);
+	for (int i = 0; i < n; i++)
+	{
+		assertTrue (tasks[i]->isCancelled() == (i % 2 == 0));
+	}
+}
+
+
+void WheelTimerTest::testCancelAllStop()
+{
+	{
+		WheelTimer timer;
+
+		TimerTask::Ptr pTask = new TimerTaskAdapter<WheelTimerTest>(*this, &WheelTimerTest::onTimer);
+
+		timer.scheduleAtFixedRate(pTask, 0, 5000);
+
+		Poco::Thread::sleep(50);
+
+		timer.cancel(true);
+		assertTrue (timer.size() == 0);
+	}
+
+	assertTrue (true); // don't hang
+}
+
+
+void WheelTimerTest::testFunc()
+{
+	WheelTimer timer;
+
+	int count = 0;
+	timer.schedule(WheelTimer::func([&count]()
+	{
+		count++;
+	}), Poco::Clock());
+	Poco::Thread::sleep(100);
+
+	assertTrue (count == 1);
+}
+
+
+void WheelTimerTest::setUp()
+{
+	_event.reset();
+}
+
+
+void WheelTimerTest::tearDown()
+{
+}
+
+
+void WheelTimerTest::onTimer(TimerTask&)
+{
+	Poco::Thread::sleep(100);
+	_event.set();
+}
+
+
+CppUnit::Test* WheelTimerTest::suite()
+{
+	CppUnit::TestSuite* pSuite = new CppUnit::TestSuite("WheelTimerTest");
+
+	CppUnit_addTest(pSuite, WheelTimerTest, testScheduleClock);
+	CppUnit_addTest(pSuite, WheelTimerTest, testScheduleInterval);
+	CppUnit_addTest(pSuite, WheelTimerTest, testScheduleAtFixedRate);
+	CppUnit_addTest(pSuite, WheelTimerTest, testReschedule);
+	CppUnit_addTest(pSuite, WheelTimerTest, testCancel);
+	CppUnit_addTest(pSuite, WheelTimerTest, testCancelMany);
+	CppUnit_addTest(pSuite, WheelTimerTest, testCancelAllStop);
+	CppUnit_addTest(pSuite, WheelTimerTest, testFunc);
+
+	return pSuite;
+}
@@ -0,0 +1,50 @@
+//
+// WheelTimerTest.h
+//
+// Definition of the WheelTimerTest class.
+//
+// Copyright (c) 2009-2020, Applied Informatics Software Engineering GmbH.
+// and Contributors.
+//
+// SPDX-License-Identifier:	BSL-1.0
+//
+
+
+#ifndef WheelTimerTest_INCLUDED
+#define WheelTimerTest_INCLUDED
+
+
+#include "Poco/Util/Util.h"
+#include "CppUnit/TestCase.h"
+#include "Poco/Util/TimerTask.h"
+#include "Poco/Event.h"
+
+
+class WheelTimerTest: public CppUnit::TestCase
+{
+public:
+	WheelTimerTest(const std::string& name);
+	~WheelTimerTest();
+
+	void testScheduleClock();
+	void testScheduleInterval();
+	void testScheduleAtFixedRate();
+	void testReschedule();
+	void testCancel();
+	void testCancelMany();
+	void testCancelAllStop();
+	void testFunc();
+
+	void setUp();
+	void tearDown();
+
+	void onTimer(Poco::Util::TimerTask& task);
+
+	static CppUnit::Test* suite();
+
+private:
+	Poco::Event _event;
+};
+
+
+#endif // WheelTimerTest_INCLUDED